@@ -147,6 +147,14 @@ HRESULT wolf_archive(ConfigItem& parent, DWORD dwIndex)
         return hr;
     if (FAILED(hr = parent[dwIndex].AddAttribute(L"childdebug", WOLFLAUNCHER_ARCHIVE_CHILDDEBUG, ConfigItem::OPTION)))
         return hr;
+    if (FAILED(
+            hr = parent[dwIndex].AddAttribute(
+                L"compression_threads", WOLFLAUNCHER_ARCHIVE_COMPRESSION_THREADS, ConfigItem::OPTION)))
+        return hr;
+    if (FAILED(
+            hr = parent[dwIndex].AddAttribute(
+                L"compression_block", WOLFLAUNCHER_ARCHIVE_COMPRESSION_BLOCK, ConfigItem::OPTION)))
+        return hr;
     return S_OK;
 }
 
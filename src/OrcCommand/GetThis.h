@@ -130,6 +130,8 @@ public:
         boost::logic::tribool bAddShadows;
 
         OutputSpec Output;
+        DWORD dwCompressionThreads = 0L;  // 0 for the codec's default
+        DWORDLONG dwlCompressionBlockSize = 0LL;  // 0 for the codec's default
 
         ListOfSampleSpecs listofSpecs;
         std::vector<std::shared_ptr<FileFind::SearchTerm>> listOfExclusions;
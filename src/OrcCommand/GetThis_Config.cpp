@@ -351,6 +351,10 @@ HRESULT Main::GetConfigurationFromArgcArgv(int argc, LPCWSTR argv[])
                         ;
                     else if (ParameterOption(argv[i] + 1, L"Compression", config.Output.Compression))
                         ;
+                    else if (ParameterOption(argv[i] + 1, L"CompressionThreads", config.dwCompressionThreads))
+                        ;
+                    else if (FileSizeOption(argv[i] + 1, L"CompressionBlock", config.dwlCompressionBlockSize))
+                        ;
                     else if (ParameterOption(argv[i] + 1, L"Content", strContent))
                     {
                         config.content = config.GetContentSpecFromString(strContent);
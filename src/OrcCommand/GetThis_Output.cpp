@@ -158,6 +158,8 @@ void Main::PrintUsage()
 
     constexpr std::array kCustomMiscParameters = {
         Usage::kMiscParameterCompression,
+        Usage::Parameter {"/CompressionThreads=<N>", "Number of threads compressing the archive"},
+        Usage::Parameter {"/CompressionBlock=<Size>", "Size of the blocks compressed in parallel"},
         Usage::kMiscParameterPassword,
         Usage::kMiscParameterTempDir,
         Usage::Parameter {"/FlushRegistry", "Flushes registry hives using RegFlushKey API"}};
@@ -174,6 +176,8 @@ void Main::PrintParameters()
     PrintCommonParameters(node);
 
     PrintValue(node, L"Output", config.Output);
+    PrintValue(node, L"CompressionThreads", config.dwCompressionThreads);
+    PrintValue(node, L"CompressionBlock", config.dwlCompressionBlockSize);
     PrintValue(node, L"ReportAll", config.bReportAll);
     PrintValue(node, L"Hash", config.CryptoHashAlgs);
     PrintValue(node, L"FuzzyHash", config.FuzzyHashAlgs);
@@ -54,7 +54,8 @@ enum class CompressorFlags : uint32_t
     kComputeHash = 1
 };
 
-std::unique_ptr<Archive::Appender<Archive::Archive7z>> CreateCompressor(const OutputSpec& outputSpec)
+std::unique_ptr<Archive::Appender<Archive::Archive7z>>
+CreateCompressor(const OutputSpec& outputSpec, DWORD dwThreadCount, DWORDLONG dwlBlockSize)
 {
     using namespace Archive;
 
@@ -66,6 +67,8 @@ std::unique_ptr<Archive::Appender<Archive::Archive7z>> CreateCompressor(const Ou
     }
 
     Archive::Archive7z archiver(Archive::Format::k7z, compressionLevel, outputSpec.Password);
+    archiver.SetThreadCount(dwThreadCount);
+    archiver.SetBlockSize(dwlBlockSize);
 
     auto appender = Appender<Archive7z>::Create(std::move(archiver), fs::path(outputSpec.Path), 1024 * 1024 * 50, ec);
     if (ec)
@@ -891,7 +894,7 @@ HRESULT Main::InitArchiveOutput()
         }
     }
 
-    m_compressor = ::CreateCompressor(config.Output);
+    m_compressor = ::CreateCompressor(config.Output, config.dwCompressionThreads, config.dwlCompressionBlockSize);
     if (m_compressor == nullptr)
     {
         Log::Error(L"Failed to create compressor");
@@ -55,6 +55,9 @@ public:
             bResurrectRecords = boost::logic::indeterminate;
             bAddShadows = boost::logic::indeterminate;
             bPopSystemObjects = boost::logic::indeterminate;
+            bPipeline = boost::logic::indeterminate;
+            bBlockCache = boost::logic::indeterminate;
+            bParallelHash = boost::logic::indeterminate;
             ColumnIntentions = Intentions::FILEINFO_NONE;
             DefaultIntentions = Intentions::FILEINFO_NONE;
 
@@ -96,6 +99,9 @@ public:
         boost::logic::tribool bResurrectRecords;
         boost::logic::tribool bAddShadows;
         boost::logic::tribool bPopSystemObjects;
+        boost::logic::tribool bPipeline;
+        boost::logic::tribool bBlockCache;
+        boost::logic::tribool bParallelHash;
 
         Intentions ColumnIntentions;
         Intentions DefaultIntentions;
@@ -114,6 +120,7 @@ private:
     MultipleOutput<LocationOutput> m_SecDescrOutput;
 
     MFTWalker::FullNameBuilder m_FullNameBuilder;
+    HashingService* m_pHashingService = nullptr;
     DWORD dwTotalFileTreated;
     DWORD m_dwProgress;
 
@@ -298,6 +298,12 @@ HRESULT Main::GetConfigurationFromArgcArgv(int argc, LPCWSTR argv[])
                         ;
                     else if (ParameterOption(argv[i] + 1, L"PopSysObj", config.bPopSystemObjects))
                         ;
+                    else if (BooleanOption(argv[i] + 1, L"Pipeline", config.bPipeline))
+                        ;
+                    else if (BooleanOption(argv[i] + 1, L"BlockCache", config.bBlockCache))
+                        ;
+                    else if (BooleanOption(argv[i] + 1, L"ParallelHash", config.bParallelHash))
+                        ;
                     else if (EncodingOption(argv[i] + 1, config.outFileInfo.OutputEncoding))
                     {
                         config.outI30Info.OutputEncoding = config.outAttrInfo.OutputEncoding =
@@ -432,6 +438,21 @@ HRESULT Main::CheckConfiguration()
         config.bResurrectRecords = false;
     }
 
+    if (boost::logic::indeterminate(config.bPipeline))
+    {
+        config.bPipeline = false;
+    }
+
+    if (boost::logic::indeterminate(config.bBlockCache))
+    {
+        config.bBlockCache = false;
+    }
+
+    if (boost::logic::indeterminate(config.bParallelHash))
+    {
+        config.bParallelHash = false;
+    }
+
     // Default Parser is MFT;
     if (config.strWalker.empty())
         config.strWalker = L"MFT";
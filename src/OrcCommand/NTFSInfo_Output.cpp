@@ -57,7 +57,10 @@ void Main::PrintUsage()
         constexpr std::array kCustomMiscParameters = {
             Usage::kMiscParameterComputer,
             Usage::kMiscParameterResurrectRecords,
-            Usage::Parameter {"/SecDecr=<FilePath>", "Security Descriptor information for the volume"}};
+            Usage::Parameter {"/SecDecr=<FilePath>", "Security Descriptor information for the volume"},
+            Usage::Parameter {"/Pipeline", "Read, fix up and parse MFT records on worker threads while walking"},
+            Usage::Parameter {"/BlockCache", "Cache small volume reads and read ahead sequential ones"},
+            Usage::Parameter {"/ParallelHash", "Compute file hashes on worker threads, rows are written in order"}};
         Usage::PrintMiscellaneousParameters(usageNode, kCustomMiscParameters);
     }
 
@@ -23,6 +23,7 @@
 #include "MFTRecordFileInfo.h"
 #include "MountedVolumeReader.h"
 #include "MFTWalker.h"
+#include "HashingService.h"
 #include "SystemDetails.h"
 #include "SnapshotVolumeReader.h"
 #include "ParameterCheck.h"
@@ -207,6 +208,8 @@ void Main::FileAndDataInformation(
             pDataAttr,
             m_codeVerifier);
 
+        fi.SetHashingService(m_pHashingService);
+
         HRESULT hr = fi.WriteFileInformation(NtfsFileInfo::g_NtfsColumnNames, output, config.Filters);
         ++dwTotalFileTreated;
     }
@@ -238,6 +241,8 @@ void Main::DirectoryInformation(
             nullptr,
             m_codeVerifier);
 
+        fi.SetHashingService(m_pHashingService);
+
         HRESULT hr = fi.WriteFileInformation(NtfsFileInfo::g_NtfsColumnNames, output, config.Filters);
         ++dwTotalFileTreated;
     }
@@ -699,6 +704,12 @@ HRESULT Main::RunThroughMFT()
 
         output.Add(L"Parsing: {} [{}]", loc->GetLocation(), boost::join(loc->GetPaths(), L", "));
 
+        // Destroyed before the writers are closed: pending rows are written when the location is done
+        std::unique_ptr<HashingService> hashing;
+        if (config.bParallelHash && fileinfoIterator->second != nullptr)
+            hashing = std::make_unique<HashingService>(*fileinfoIterator->second);
+        m_pHashingService = hashing.get();
+
         MFTWalker::Callbacks callBacks;
 
         if (fileinfoIterator->second != nullptr)
@@ -770,6 +781,23 @@ HRESULT Main::RunThroughMFT()
         MFTWalker walker;
         HRESULT hr = E_FAIL;
 
+        MFTWalker::PipelineOptions pipeline;
+        pipeline.bEnabled = (bool)config.bPipeline;
+        walker.SetPipelineOptions(pipeline);
+
+        if (config.bBlockCache)
+        {
+            // Enabled before the walker initializes so that the readers it reopens share the cache
+            auto reader = std::dynamic_pointer_cast<CompleteVolumeReader>(loc->GetReader());
+            if (reader && SUCCEEDED(reader->LoadDiskProperties()))
+            {
+                if (FAILED(hr = reader->EnableBlockCache(BlockCache::Options())))
+                {
+                    Log::Warn(L"Failed to enable block cache for '{}' [{}]", loc->GetLocation(), SystemError(hr));
+                }
+            }
+        }
+
         if (FAILED(hr = walker.Initialize(loc, (bool)config.bResurrectRecords)))
         {
             if (hr == HRESULT_FROM_WIN32(ERROR_FILE_SYSTEM_LIMITATION))
@@ -794,6 +822,12 @@ HRESULT Main::RunThroughMFT()
                 walker.Statistics(L"");
             }
         }
+
+        if (hashing != nullptr && FAILED(hr = hashing->Flush()))
+        {
+            Log::Error(L"Failed to write hashed rows for '{}' [{}]", loc->GetLocation(), SystemError(hr));
+        }
+        m_pHashingService = nullptr;
     }
 
     return S_OK;
@@ -223,6 +223,7 @@ HRESULT Main::Run()
                     USNRecordInformation(*dir.second, volreader, szFullName, pElt);
                 };
 
+            walker.SetChunkSize(USNJournalWalkerOffline::kDefaultChunkSize);
             hr = walker.ReadJournal(callbacks);
             if (FAILED(hr))
             {
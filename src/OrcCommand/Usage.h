@@ -119,6 +119,10 @@ auto PrintLoggingParameters(Orc::Text::Tree<T>& root, CustomParameterLists&&...
 
 constexpr std::array kUsageMiscellaneous = {
     Parameter("/Low", "Runs with lowered priority"),
+    Parameter(
+        "/HashProvider=<Native|Portable|CryptoAPI>",
+        "MD5, SHA1 and SHA256 implementation: in process (with or without the CPU SHA extensions) or CryptoAPI "
+        "(default)"),
     Parameter("/Config=<ConfigFile>", "XML configuration file overriding current values")};
 
 constexpr auto kMiscParameterLocal = Usage::Parameter {
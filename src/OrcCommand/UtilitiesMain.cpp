@@ -31,6 +31,7 @@
 #include "EvtLibrary.h"
 #include "PSAPIExtension.h"
 #include "CaseInsensitive.h"
+#include "MultiHash.h"
 
 using namespace std;
 
@@ -608,6 +609,49 @@ bool UtilitiesMain::WaitForDebuggerOption(LPCWSTR szArg)
     return true;
 }
 
+HRESULT UtilitiesMain::HashProvider(int argc, const WCHAR* argv[])
+{
+    for (int i = 0; i < argc; i++)
+    {
+        switch (argv[i][0])
+        {
+            case L'/':
+            case L'-': {
+                std::wstring strProvider;
+                if (ParameterOption(argv[i] + 1, L"HashProvider", strProvider))
+                    return HashProviderOption(strProvider);
+            }
+        }
+    }
+    return S_OK;
+}
+
+HRESULT UtilitiesMain::HashProviderOption(const std::wstring& strProvider)
+{
+    if (equalCaseInsensitive(strProvider, L"Native"))
+    {
+        CryptoHashStream::SetDefaultProvider(CryptoHashStream::Provider::Native);
+        MultiHash::EnableShaExtensions(true);
+    }
+    else if (equalCaseInsensitive(strProvider, L"Portable"))
+    {
+        CryptoHashStream::SetDefaultProvider(CryptoHashStream::Provider::Native);
+        MultiHash::EnableShaExtensions(false);
+    }
+    else if (equalCaseInsensitive(strProvider, L"CryptoAPI"))
+    {
+        CryptoHashStream::SetDefaultProvider(CryptoHashStream::Provider::CryptoAPI);
+    }
+    else
+    {
+        Log::Critical(L"Invalid hash provider '{}', expected Native, Portable or CryptoAPI", strProvider);
+        return E_INVALIDARG;
+    }
+
+    Log::Debug(L"Hash provider: {}", strProvider);
+    return S_OK;
+}
+
 bool UtilitiesMain::IgnoreWaitForDebuggerOption(LPCWSTR szArg)
 {
     using namespace std::chrono_literals;
@@ -637,7 +681,7 @@ bool UtilitiesMain::IgnoreConfigOptions(LPCWSTR szArg)
 
 bool UtilitiesMain::IgnoreEarlyOptions(LPCWSTR szArg)
 {
-    const std::vector<std::wstring_view> kIgnoredList = {L"computer", L"fullcomputer", L"systemtype"};
+    const std::vector<std::wstring_view> kIgnoredList = {L"computer", L"fullcomputer", L"systemtype", L"hashprovider"};
 
     std::wstring arg(szArg);
 
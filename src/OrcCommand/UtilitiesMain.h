@@ -739,6 +739,10 @@ protected:
     bool IgnoreWaitForDebuggerOption(LPCWSTR szArg);
     bool WaitForDebuggerOption(LPCWSTR szArg);
 
+    // /HashProvider=<Native|Portable|CryptoAPI>: implementation of the MD5, SHA1 and SHA256 hashes of every stream
+    HRESULT HashProvider(int argc, const WCHAR* argv[]);
+    HRESULT HashProviderOption(const std::wstring& strProvider);
+
     bool IgnoreLoggingOptions(LPCWSTR szArg);
     bool IgnoreConfigOptions(LPCWSTR szArg);
     bool IgnoreCommonOptions(LPCWSTR szArg);
@@ -814,6 +818,8 @@ public:
         }
 
         Cmd.WaitForDebugger(argc, argv);
+        if (FAILED(hr = Cmd.HashProvider(argc, argv)))
+            return hr;
         Cmd.LoadCommonExtensions();
         Cmd.PrintHeader(UtilityT::ToolName(), UtilityT::ToolDescription(), kOrcFileVerStringW);
 
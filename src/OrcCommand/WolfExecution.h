@@ -83,6 +83,8 @@ private:
 
     std::wstring m_commandSet;
     std::wstring m_strCompressionLevel;
+    DWORD m_dwCompressionThreads = 0L;
+    ULONGLONG m_ullCompressionBlockSize = 0LL;
     DWORD m_dwConcurrency;
 
     std::chrono::milliseconds m_CmdTimeOut;
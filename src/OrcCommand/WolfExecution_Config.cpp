@@ -760,6 +760,22 @@ HRESULT WolfExecution::SetJobConfigFromConfig(const ConfigItem& item)
     if (item[WOLFLAUNCHER_ARCHIVE_COMPRESSION])
         m_strCompressionLevel = (const std::wstring&)item[WOLFLAUNCHER_ARCHIVE_COMPRESSION];
 
+    // <Archive ... compression_threads="4" compression_block="16MB" >: lets the archive agent compress blocks in
+    // parallel while the next commands are running
+    if (item[WOLFLAUNCHER_ARCHIVE_COMPRESSION_THREADS])
+        m_dwCompressionThreads = (DWORD32)item[WOLFLAUNCHER_ARCHIVE_COMPRESSION_THREADS];
+
+    if (item[WOLFLAUNCHER_ARCHIVE_COMPRESSION_BLOCK])
+    {
+        LARGE_INTEGER blockSize;
+        if (FAILED(hr = GetFileSizeFromArg(item[WOLFLAUNCHER_ARCHIVE_COMPRESSION_BLOCK].c_str(), blockSize)))
+        {
+            Log::Error(L"Invalid compression block size: '{}'", item[WOLFLAUNCHER_ARCHIVE_COMPRESSION_BLOCK]);
+            return hr;
+        }
+        m_ullCompressionBlockSize = blockSize.QuadPart;
+    }
+
     if (!item[WOLFLAUNCHER_ARCHIVE_CONCURRENCY])
     {
         m_dwConcurrency = 5;
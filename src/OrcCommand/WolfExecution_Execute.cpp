@@ -304,6 +304,8 @@ HRESULT WolfExecution::CreateArchiveAgent()
 
         auto request = ArchiveMessage::MakeOpenRequest(m_strArchiveFileName, fmt, pFinalStream, m_strCompressionLevel);
         request->SetCommandSet(m_commandSet);
+        request->SetCompressionThreads(m_dwCompressionThreads);
+        request->SetBlockSize(m_ullCompressionBlockSize);
         Concurrency::send(m_ArchiveMessageBuffer, request);
     }
     else
@@ -320,6 +322,8 @@ HRESULT WolfExecution::CreateArchiveAgent()
 
         auto request = ArchiveMessage::MakeOpenRequest(m_strArchiveFileName, fmt, pOutputStream, m_strCompressionLevel);
         request->SetCommandSet(m_commandSet);
+        request->SetCompressionThreads(m_dwCompressionThreads);
+        request->SetBlockSize(m_ullCompressionBlockSize);
         Concurrency::send(m_ArchiveMessageBuffer, request);
     }
 
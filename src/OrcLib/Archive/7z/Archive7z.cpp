@@ -19,6 +19,7 @@
 #include "Archive/7z/OutStreamAdapter.h"
 #include "Archive/7z/ArchiveOpenCallback.h"
 #include "Archive/7z/ArchiveUpdateCallback.h"
+#include "Archive/7z/Archive7zDatabase.h"
 #include "ByteStream.h"
 
 using namespace Orc::Archive;
@@ -105,9 +106,20 @@ Lib7zCompressionLevel ToLib7zLevel(CompressionLevel level)
     }
 }
 
-void SetCompressionLevel(const CComPtr<IOutArchive>& archiver, CompressionLevel level, std::error_code& ec)
+void SetProperties(
+    const CComPtr<IOutArchive>& archiver,
+    CompressionLevel level,
+    uint32_t threadCount,
+    uint64_t blockSize,
+    bool appendable,
+    std::error_code& ec)
 {
-    Log::Debug("Archive7z: SetCompressionLevel to {}", level);
+    Log::Debug(
+        "Archive7z: SetCompressionLevel to {} (threads: {}, block size: {}, appendable: {})",
+        level,
+        threadCount,
+        blockSize,
+        appendable);
 
     CMyComPtr<ISetProperties> setProperties;
     HRESULT hr = archiver->QueryInterface(IID_ISetProperties, (void**)&setProperties);
@@ -118,11 +130,30 @@ void SetCompressionLevel(const CComPtr<IOutArchive>& archiver, CompressionLevel
         return;
     }
 
-    const uint8_t numProps = 1;
-    const wchar_t* names[numProps] = {L"x"};
-    NWindows::NCOM::CPropVariant values[numProps] = {static_cast<UINT32>(::ToLib7zLevel(level))};
+    std::vector<const wchar_t*> names = {L"x"};
+    std::vector<NWindows::NCOM::CPropVariant> values = {static_cast<UINT32>(::ToLib7zLevel(level))};
+
+    // Header is not compressed so that Archive7z::Append can rewrite it
+    if (appendable)
+    {
+        names.push_back(L"hc");
+        values.push_back(false);
+    }
+
+    if (threadCount != 0)
+    {
+        names.push_back(L"mt");
+        values.push_back(static_cast<UINT32>(threadCount));
+    }
+
+    // LZMA2 splits its input in blocks of this size which are compressed in parallel (32 bits for older lib7z)
+    if (blockSize != 0)
+    {
+        names.push_back(L"c");
+        values.push_back(static_cast<UINT32>(std::min<uint64_t>(blockSize, UINT32_MAX)));
+    }
 
-    hr = setProperties->SetProperties(names, values, numProps);
+    hr = setProperties->SetProperties(names.data(), values.data(), static_cast<UInt32>(names.size()));
     if (FAILED(hr))
     {
         ec.assign(hr, std::system_category());
@@ -131,12 +162,59 @@ void SetCompressionLevel(const CComPtr<IOutArchive>& archiver, CompressionLevel
     }
 }
 
+void CopyStream(ByteStream& input, uint64_t offset, uint64_t size, ByteStream& output, std::error_code& ec)
+{
+    HRESULT hr = input.SetFilePointer(offset, FILE_BEGIN, nullptr);
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        return;
+    }
+
+    std::vector<uint8_t> buffer(1024 * 1024);
+    while (size > 0)
+    {
+        ULONGLONG read = 0;
+        hr = input.Read(buffer.data(), std::min<uint64_t>(size, buffer.size()), &read);
+        if (FAILED(hr))
+        {
+            ec.assign(hr, std::system_category());
+            return;
+        }
+
+        if (read == 0)
+        {
+            ec = std::make_error_code(std::errc::io_error);
+            return;
+        }
+
+        ULONGLONG written = 0;
+        hr = output.Write(buffer.data(), read, &written);
+        if (FAILED(hr))
+        {
+            ec.assign(hr, std::system_category());
+            return;
+        }
+
+        if (written != read)
+        {
+            ec = std::make_error_code(std::errc::io_error);
+            return;
+        }
+
+        size -= read;
+    }
+}
+
 }  // namespace
 
 Archive7z::Archive7z(Format format, Archive::CompressionLevel level, std::wstring password)
     : m_format(format)
     , m_compressionLevel(level)
     , m_password(std::move(password))
+    , m_threadCount(0)
+    , m_blockSize(0)
+    , m_appendable(false)
 {
 #ifdef _7ZIP_STATIC
     ::Lib7z::Instance();
@@ -174,7 +252,7 @@ void Archive7z::Compress(
         return;
     }
 
-    ::SetCompressionLevel(archiver, m_compressionLevel, ec);
+    ::SetProperties(archiver, m_compressionLevel, m_threadCount, m_blockSize, m_appendable, ec);
     if (ec)
     {
         Log::Error(L"Failed to update compression level to {} [{}]", m_compressionLevel, ec);
@@ -245,6 +323,89 @@ void Archive7z::Compress(const std::shared_ptr<ByteStream>& output, std::error_c
     Compress(output, {}, ec);
 }
 
+void Archive7z::Append(
+    const std::shared_ptr<ByteStream>& archive,
+    const std::shared_ptr<ByteStream>& temporary,
+    std::error_code& ec)
+{
+    Archive7zDatabase database;
+    database.Read(*archive, ec);
+    if (ec)
+    {
+        if (ec != std::errc::not_supported)
+        {
+            Log::Error("Failed to read archive header [{}]", ec);
+        }
+
+        return;
+    }
+
+    if (m_items.empty())
+    {
+        return;
+    }
+
+    HRESULT hr = temporary->SetFilePointer(0, FILE_BEGIN, nullptr);
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        Log::Error("Failed to seek temporary stream [{}]", ec);
+        return;
+    }
+
+    hr = temporary->SetSize(0);
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        Log::Error("Failed to resize temporary stream [{}]", ec);
+        return;
+    }
+
+    Compress(temporary, {}, ec);
+    if (ec)
+    {
+        Log::Error("Failed to compress new items [{}]", ec);
+        return;
+    }
+
+    Archive7zDatabase newItems;
+    newItems.Read(*temporary, ec);
+    if (ec)
+    {
+        // Items are already consumed, this must not fallback on a rewrite of the archive
+        ec = std::make_error_code(std::errc::io_error);
+        Log::Error("Failed to read header of new items [{}]", ec);
+        return;
+    }
+
+    const auto packSize = newItems.PackEnd() - Archive7zDatabase::kSignatureHeaderSize;
+
+    hr = archive->SetFilePointer(database.PackEnd(), FILE_BEGIN, nullptr);
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        Log::Error("Failed to seek archive [{}]", ec);
+        return;
+    }
+
+    ::CopyStream(*temporary, Archive7zDatabase::kSignatureHeaderSize, packSize, *archive, ec);
+    if (ec)
+    {
+        Log::Error("Failed to copy new items to archive [{}]", ec);
+        return;
+    }
+
+    database.Append(newItems);
+    database.Write(*archive, ec);
+    if (ec)
+    {
+        Log::Error("Failed to write archive header [{}]", ec);
+        return;
+    }
+
+    Log::Debug("Archive7z: appended {} items ({} bytes)", newItems.FileCount(), packSize);
+}
+
 void Archive7z::SetCompressionLevel(Archive::CompressionLevel level, std::error_code& ec)
 {
     m_compressionLevel = level;
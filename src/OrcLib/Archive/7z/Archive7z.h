@@ -32,6 +32,14 @@ public:
         const std::shared_ptr<ByteStream>& inputArchive,
         std::error_code& ec) override;
 
+    // Appends the added items to 'archive' without recompressing its content: they are compressed in 'temporary' whose
+    // packed streams are then copied at the end of 'archive' before its header is rewritten. 'ec' is 'not_supported',
+    // and 'archive' is left untouched, when the header of 'archive' cannot be rewritten (see SetAppendable).
+    void Append(
+        const std::shared_ptr<ByteStream>& archive,
+        const std::shared_ptr<ByteStream>& temporary,
+        std::error_code& ec);
+
     // List of added items waiting to be processed by the Compress method
     const Items& AddedItems() const override;
 
@@ -39,10 +47,25 @@ public:
 
     void SetCompressionLevel(Archive::CompressionLevel level, std::error_code& ec);
 
+    // Archives are written with an uncompressed header which Append can rewrite
+    bool Appendable() const { return m_appendable; }
+    void SetAppendable(bool appendable) { m_appendable = appendable; }
+
+    // Number of compression threads, 0 for one per processor
+    uint32_t ThreadCount() const { return m_threadCount; }
+    void SetThreadCount(uint32_t threadCount) { m_threadCount = threadCount; }
+
+    // Size of the blocks compressed in parallel, 0 for the default which depends on the compression level
+    uint64_t BlockSize() const { return m_blockSize; }
+    void SetBlockSize(uint64_t blockSize) { m_blockSize = blockSize; }
+
 private:
     const Format m_format;
     Archive::CompressionLevel m_compressionLevel;
     const std::wstring m_password;
+    uint32_t m_threadCount;
+    uint64_t m_blockSize;
+    bool m_appendable;
     Items m_items;
 };
 
@@ -0,0 +1,1204 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "Archive/7z/Archive7zDatabase.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+#include "ByteStream.h"
+
+using namespace Orc::Archive;
+using namespace Orc;
+
+namespace {
+
+// Property ids of the 7z header (see 7zFormat.txt)
+enum PropertyId : uint64_t
+{
+    kEnd = 0x00,
+    kHeader = 0x01,
+    kArchiveProperties = 0x02,
+    kAdditionalStreamsInfo = 0x03,
+    kMainStreamsInfo = 0x04,
+    kFilesInfo = 0x05,
+    kPackInfo = 0x06,
+    kUnpackInfo = 0x07,
+    kSubStreamsInfo = 0x08,
+    kSize = 0x09,
+    kCRC = 0x0A,
+    kFolder = 0x0B,
+    kCodersUnpackSize = 0x0C,
+    kNumUnpackStream = 0x0D,
+    kEmptyStream = 0x0E,
+    kEmptyFile = 0x0F,
+    kAnti = 0x10,
+    kName = 0x11,
+    kCTime = 0x12,
+    kATime = 0x13,
+    kMTime = 0x14,
+    kWinAttributes = 0x15,
+    kEncodedHeader = 0x17,
+    kDummy = 0x19
+};
+
+const std::array<uint8_t, 6> kSignature = {'7', 'z', 0xBC, 0xAF, 0x27, 0x1C};
+
+// Bigger headers are not expected from lib7z, this bounds allocations when reading a corrupted archive
+constexpr uint64_t kMaxHeaderSize = 1024 * 1024 * 1024;
+
+constexpr std::array<uint32_t, 256> MakeCrcTable()
+{
+    std::array<uint32_t, 256> table = {};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size)
+{
+    static constexpr auto kTable = MakeCrcTable();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = kTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+template <typename T>
+T ReadLittleEndian(const uint8_t* data)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+template <typename T>
+void WriteLittleEndian(uint8_t* data, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        data[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void ReadAt(ByteStream& stream, uint64_t offset, uint8_t* buffer, uint64_t size, std::error_code& ec)
+{
+    HRESULT hr = stream.SetFilePointer(offset, FILE_BEGIN, nullptr);
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        return;
+    }
+
+    uint64_t read = 0;
+    while (read < size)
+    {
+        ULONGLONG processed = 0;
+        hr = stream.Read(buffer + read, size - read, &processed);
+        if (FAILED(hr))
+        {
+            ec.assign(hr, std::system_category());
+            return;
+        }
+
+        if (processed == 0)
+        {
+            ec = std::make_error_code(std::errc::io_error);
+            return;
+        }
+
+        read += processed;
+    }
+}
+
+void WriteAt(ByteStream& stream, uint64_t offset, const uint8_t* buffer, uint64_t size, std::error_code& ec)
+{
+    HRESULT hr = stream.SetFilePointer(offset, FILE_BEGIN, nullptr);
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        return;
+    }
+
+    ULONGLONG written = 0;
+    hr = stream.Write(const_cast<uint8_t*>(buffer), size, &written);
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        return;
+    }
+
+    if (written != size)
+    {
+        ec = std::make_error_code(std::errc::io_error);
+        return;
+    }
+}
+
+}  // namespace
+
+// Header bytes with the encodings of 7z: errors are sticky, reads past the end return zeroes
+class Archive7zDatabase::Reader
+{
+public:
+    Reader(const std::vector<uint8_t>& data)
+        : m_data(data)
+    {
+    }
+
+    bool Failed() const { return m_failed; }
+    void Fail() { m_failed = true; }
+
+    size_t Position() const { return m_position; }
+    size_t Remaining() const { return m_data.size() - m_position; }
+
+    void Seek(size_t position)
+    {
+        if (position > m_data.size())
+        {
+            Fail();
+            return;
+        }
+
+        m_position = position;
+    }
+
+    uint8_t ReadByte()
+    {
+        if (m_position >= m_data.size())
+        {
+            Fail();
+            return 0;
+        }
+
+        return m_data[m_position++];
+    }
+
+    const uint8_t* ReadBytes(size_t size)
+    {
+        if (size > Remaining())
+        {
+            Fail();
+            return nullptr;
+        }
+
+        const auto data = m_data.data() + m_position;
+        m_position += size;
+        return data;
+    }
+
+    uint32_t ReadUInt32()
+    {
+        const auto data = ReadBytes(sizeof(uint32_t));
+        return data ? ReadLittleEndian<uint32_t>(data) : 0;
+    }
+
+    uint64_t ReadUInt64()
+    {
+        const auto data = ReadBytes(sizeof(uint64_t));
+        return data ? ReadLittleEndian<uint64_t>(data) : 0;
+    }
+
+    uint64_t ReadNumber()
+    {
+        const uint8_t first = ReadByte();
+
+        uint64_t value = 0;
+        uint8_t mask = 0x80;
+        for (int i = 0; i < 8; ++i)
+        {
+            if ((first & mask) == 0)
+            {
+                const uint64_t high = first & (mask - 1);
+                return value | (high << (8 * i));
+            }
+
+            value |= static_cast<uint64_t>(ReadByte()) << (8 * i);
+            mask >>= 1;
+        }
+
+        return value;
+    }
+
+    // A count of items which are at least one byte each, so that a corrupted count fails before any allocation
+    uint64_t ReadCount()
+    {
+        const uint64_t count = ReadNumber();
+        if (count > Remaining())
+        {
+            Fail();
+            return 0;
+        }
+
+        return count;
+    }
+
+    std::vector<bool> ReadBits(uint64_t count)
+    {
+        if ((count + 7) / 8 > Remaining())
+        {
+            Fail();
+            return {};
+        }
+
+        std::vector<bool> bits(count);
+        uint8_t byte = 0;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (i % 8 == 0)
+            {
+                byte = ReadByte();
+            }
+
+            bits[i] = (byte & (0x80 >> (i % 8))) != 0;
+        }
+
+        return bits;
+    }
+
+    std::vector<bool> ReadDefined(uint64_t count)
+    {
+        if (ReadByte() != 0)
+        {
+            return std::vector<bool>(count, true);
+        }
+
+        return ReadBits(count);
+    }
+
+private:
+    const std::vector<uint8_t>& m_data;
+    size_t m_position = 0;
+    bool m_failed = false;
+};
+
+class Archive7zDatabase::Writer
+{
+public:
+    std::vector<uint8_t>& Data() { return m_data; }
+
+    void WriteByte(uint8_t value) { m_data.push_back(value); }
+
+    void WriteBytes(const uint8_t* data, size_t size) { m_data.insert(std::end(m_data), data, data + size); }
+
+    void WriteUInt32(uint32_t value)
+    {
+        uint8_t data[sizeof(value)];
+        WriteLittleEndian(data, value);
+        WriteBytes(data, sizeof(data));
+    }
+
+    void WriteUInt64(uint64_t value)
+    {
+        uint8_t data[sizeof(value)];
+        WriteLittleEndian(data, value);
+        WriteBytes(data, sizeof(data));
+    }
+
+    void WriteNumber(uint64_t value)
+    {
+        uint8_t first = 0;
+        uint8_t mask = 0x80;
+        int i = 0;
+        for (; i < 8; ++i)
+        {
+            if (value < (uint64_t(1) << (7 * (i + 1))))
+            {
+                first |= static_cast<uint8_t>(value >> (8 * i));
+                break;
+            }
+
+            first |= mask;
+            mask >>= 1;
+        }
+
+        WriteByte(first);
+        for (; i > 0; --i)
+        {
+            WriteByte(static_cast<uint8_t>(value));
+            value >>= 8;
+        }
+    }
+
+    void WriteBits(const std::vector<bool>& bits)
+    {
+        uint8_t byte = 0;
+        for (size_t i = 0; i < bits.size(); ++i)
+        {
+            if (bits[i])
+            {
+                byte |= 0x80 >> (i % 8);
+            }
+
+            if (i % 8 == 7)
+            {
+                WriteByte(byte);
+                byte = 0;
+            }
+        }
+
+        if (bits.size() % 8 != 0)
+        {
+            WriteByte(byte);
+        }
+    }
+
+    void WriteDefined(const std::vector<bool>& defined)
+    {
+        if (std::all_of(std::cbegin(defined), std::cend(defined), [](bool isDefined) { return isDefined; }))
+        {
+            WriteByte(1);
+            return;
+        }
+
+        WriteByte(0);
+        WriteBits(defined);
+    }
+
+    // Property of the files info, whose size is written before its content
+    template <typename WriteContent>
+    void WriteProperty(uint64_t id, WriteContent writeContent)
+    {
+        Writer content;
+        writeContent(content);
+
+        WriteNumber(id);
+        WriteNumber(content.m_data.size());
+        WriteBytes(content.m_data.data(), content.m_data.size());
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+void Archive7zDatabase::Read(ByteStream& stream, std::error_code& ec)
+{
+    *this = Archive7zDatabase();
+
+    uint8_t signatureHeader[kSignatureHeaderSize];
+    ::ReadAt(stream, 0, signatureHeader, sizeof(signatureHeader), ec);
+    if (ec)
+    {
+        Log::Error("Failed to read 7z signature header [{}]", ec);
+        return;
+    }
+
+    if (!std::equal(std::cbegin(kSignature), std::cend(kSignature), signatureHeader)
+        || ReadLittleEndian<uint32_t>(signatureHeader + 8) != Crc32(signatureHeader + 12, 20))
+    {
+        Log::Debug("Invalid 7z signature header");
+        ec = std::make_error_code(std::errc::not_supported);
+        return;
+    }
+
+    m_versionMajor = signatureHeader[6];
+    m_versionMinor = signatureHeader[7];
+
+    const auto nextHeaderOffset = ReadLittleEndian<uint64_t>(signatureHeader + 12);
+    const auto nextHeaderSize = ReadLittleEndian<uint64_t>(signatureHeader + 20);
+    const auto nextHeaderCrc = ReadLittleEndian<uint32_t>(signatureHeader + 28);
+
+    if (nextHeaderSize == 0)
+    {
+        // Empty archive
+        return;
+    }
+
+    if (nextHeaderSize > kMaxHeaderSize)
+    {
+        Log::Debug("Unexpected 7z header size: {}", nextHeaderSize);
+        ec = std::make_error_code(std::errc::not_supported);
+        return;
+    }
+
+    std::vector<uint8_t> header(static_cast<size_t>(nextHeaderSize));
+    ::ReadAt(stream, kSignatureHeaderSize + nextHeaderOffset, header.data(), header.size(), ec);
+    if (ec)
+    {
+        Log::Error("Failed to read 7z header [{}]", ec);
+        return;
+    }
+
+    if (Crc32(header.data(), header.size()) != nextHeaderCrc)
+    {
+        Log::Debug("Invalid 7z header checksum");
+        ec = std::make_error_code(std::errc::not_supported);
+        return;
+    }
+
+    Reader reader(header);
+    if (!ReadHeader(reader) || reader.Failed())
+    {
+        Log::Debug("Unsupported 7z header");
+        *this = Archive7zDatabase();
+        ec = std::make_error_code(std::errc::not_supported);
+        return;
+    }
+
+    if (PackEnd() > kSignatureHeaderSize + nextHeaderOffset)
+    {
+        Log::Debug("Packed streams overlap the 7z header");
+        *this = Archive7zDatabase();
+        ec = std::make_error_code(std::errc::not_supported);
+        return;
+    }
+}
+
+bool Archive7zDatabase::ReadHeader(Reader& reader)
+{
+    if (reader.ReadNumber() != kHeader)
+    {
+        // kEncodedHeader: the header is compressed
+        return false;
+    }
+
+    uint64_t id = reader.ReadNumber();
+    if (id == kMainStreamsInfo)
+    {
+        if (!ReadStreamsInfo(reader))
+        {
+            return false;
+        }
+
+        id = reader.ReadNumber();
+    }
+
+    if (id == kFilesInfo)
+    {
+        if (!ReadFilesInfo(reader))
+        {
+            return false;
+        }
+
+        id = reader.ReadNumber();
+    }
+
+    // kArchiveProperties and kAdditionalStreamsInfo are not written by lib7z
+    if (id != kEnd)
+    {
+        return false;
+    }
+
+    const auto streamCount = std::count_if(
+        std::cbegin(m_files), std::cend(m_files), [](const File& file) { return file.hasStream; });
+    return static_cast<size_t>(streamCount) == m_streamSizes.size();
+}
+
+bool Archive7zDatabase::ReadFolder(Reader& reader, Folder& folder, uint64_t& numOutStreams)
+{
+    const auto start = reader.Position();
+
+    const auto numCoders = reader.ReadCount();
+    if (numCoders == 0)
+    {
+        return false;
+    }
+
+    uint64_t numInStreams = 0;
+    numOutStreams = 0;
+    for (uint64_t i = 0; i < numCoders && !reader.Failed(); ++i)
+    {
+        const uint8_t flags = reader.ReadByte();
+        if (flags & 0xC0)
+        {
+            // Alternative methods are not supported by 7-Zip either
+            return false;
+        }
+
+        reader.ReadBytes(flags & 0x0F);
+
+        if (flags & 0x10)
+        {
+            numInStreams += reader.ReadCount();
+            numOutStreams += reader.ReadCount();
+        }
+        else
+        {
+            numInStreams += 1;
+            numOutStreams += 1;
+        }
+
+        if (flags & 0x20)
+        {
+            reader.ReadBytes(static_cast<size_t>(reader.ReadCount()));
+        }
+    }
+
+    if (numOutStreams == 0 || numInStreams < numOutStreams - 1)
+    {
+        return false;
+    }
+
+    const uint64_t numBindPairs = numOutStreams - 1;
+    for (uint64_t i = 0; i < numBindPairs; ++i)
+    {
+        reader.ReadNumber();
+        reader.ReadNumber();
+    }
+
+    folder.numPackStreams = numInStreams - numBindPairs;
+    if (folder.numPackStreams > 1)
+    {
+        for (uint64_t i = 0; i < folder.numPackStreams; ++i)
+        {
+            reader.ReadNumber();
+        }
+    }
+
+    if (reader.Failed())
+    {
+        return false;
+    }
+
+    const auto coders = reader.Position() - start;
+    reader.Seek(start);
+    const auto data = reader.ReadBytes(coders);
+    folder.coders.assign(data, data + coders);
+    return true;
+}
+
+bool Archive7zDatabase::ReadStreamsInfo(Reader& reader)
+{
+    uint64_t id = reader.ReadNumber();
+
+    if (id == kPackInfo)
+    {
+        // Packed streams are expected right after the signature header
+        if (reader.ReadNumber() != 0)
+        {
+            return false;
+        }
+
+        const auto numPackStreams = reader.ReadCount();
+
+        id = reader.ReadNumber();
+        if (id == kSize)
+        {
+            for (uint64_t i = 0; i < numPackStreams; ++i)
+            {
+                m_packSizes.push_back(reader.ReadNumber());
+            }
+
+            id = reader.ReadNumber();
+        }
+
+        if (id == kCRC)
+        {
+            // Checksums of the packed streams are optional, they are not kept
+            const auto defined = reader.ReadDefined(numPackStreams);
+            for (const auto isDefined : defined)
+            {
+                if (isDefined)
+                {
+                    reader.ReadUInt32();
+                }
+            }
+
+            id = reader.ReadNumber();
+        }
+
+        if (id != kEnd || m_packSizes.size() != numPackStreams)
+        {
+            return false;
+        }
+
+        id = reader.ReadNumber();
+    }
+
+    std::vector<std::optional<uint32_t>> folderCrcs;
+    if (id == kUnpackInfo)
+    {
+        if (reader.ReadNumber() != kFolder)
+        {
+            return false;
+        }
+
+        const auto numFolders = reader.ReadCount();
+        if (reader.ReadByte() != 0)
+        {
+            // External folders
+            return false;
+        }
+
+        std::vector<uint64_t> numOutStreams(static_cast<size_t>(numFolders));
+        m_folders.resize(static_cast<size_t>(numFolders));
+        for (size_t i = 0; i < m_folders.size(); ++i)
+        {
+            if (!ReadFolder(reader, m_folders[i], numOutStreams[i]))
+            {
+                return false;
+            }
+        }
+
+        if (reader.ReadNumber() != kCodersUnpackSize)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < m_folders.size() && !reader.Failed(); ++i)
+        {
+            for (uint64_t j = 0; j < numOutStreams[i]; ++j)
+            {
+                m_folders[i].unpackSizes.push_back(reader.ReadNumber());
+            }
+        }
+
+        folderCrcs.resize(m_folders.size());
+
+        id = reader.ReadNumber();
+        if (id == kCRC)
+        {
+            const auto defined = reader.ReadDefined(m_folders.size());
+            for (size_t i = 0; i < defined.size(); ++i)
+            {
+                if (defined[i])
+                {
+                    folderCrcs[i] = reader.ReadUInt32();
+                }
+            }
+
+            id = reader.ReadNumber();
+        }
+
+        if (id != kEnd)
+        {
+            return false;
+        }
+
+        id = reader.ReadNumber();
+    }
+
+    const auto totalPackStreams = std::accumulate(
+        std::cbegin(m_folders), std::cend(m_folders), uint64_t(0), [](uint64_t total, const Folder& folder) {
+            return total + folder.numPackStreams;
+        });
+
+    if (totalPackStreams != m_packSizes.size())
+    {
+        return false;
+    }
+
+    // Size of the output of a folder, when it is not split in several streams
+    const auto UnpackSize = [](const Folder& folder) {
+        return folder.unpackSizes.empty() ? 0 : folder.unpackSizes.back();
+    };
+
+    if (id == kSubStreamsInfo)
+    {
+        id = reader.ReadNumber();
+        if (id == kNumUnpackStream)
+        {
+            for (auto& folder : m_folders)
+            {
+                folder.numUnpackStreams = reader.ReadCount();
+            }
+
+            id = reader.ReadNumber();
+        }
+
+        const bool hasSizes = id == kSize;
+        for (const auto& folder : m_folders)
+        {
+            if (folder.numUnpackStreams == 0)
+            {
+                continue;
+            }
+
+            uint64_t total = 0;
+            for (uint64_t i = 1; i < folder.numUnpackStreams && hasSizes; ++i)
+            {
+                const auto size = reader.ReadNumber();
+                m_streamSizes.push_back(size);
+                total += size;
+            }
+
+            if (folder.numUnpackStreams > 1 && !hasSizes)
+            {
+                return false;
+            }
+
+            m_streamSizes.push_back(UnpackSize(folder) - total);
+        }
+
+        if (hasSizes)
+        {
+            id = reader.ReadNumber();
+        }
+
+        // Streams whose checksum is not the one of their folder
+        size_t numDigests = 0;
+        for (size_t i = 0; i < m_folders.size(); ++i)
+        {
+            if (m_folders[i].numUnpackStreams != 1 || !folderCrcs[i])
+            {
+                numDigests += static_cast<size_t>(m_folders[i].numUnpackStreams);
+            }
+        }
+
+        std::vector<std::optional<uint32_t>> digests(numDigests);
+        if (id == kCRC)
+        {
+            const auto defined = reader.ReadDefined(numDigests);
+            for (size_t i = 0; i < defined.size(); ++i)
+            {
+                if (defined[i])
+                {
+                    digests[i] = reader.ReadUInt32();
+                }
+            }
+
+            id = reader.ReadNumber();
+        }
+
+        auto digest = std::cbegin(digests);
+        for (size_t i = 0; i < m_folders.size(); ++i)
+        {
+            if (m_folders[i].numUnpackStreams == 1 && folderCrcs[i])
+            {
+                m_streamCrcs.push_back(folderCrcs[i]);
+                continue;
+            }
+
+            for (uint64_t j = 0; j < m_folders[i].numUnpackStreams && digest != std::cend(digests); ++j)
+            {
+                m_streamCrcs.push_back(*digest++);
+            }
+        }
+
+        if (id != kEnd)
+        {
+            return false;
+        }
+
+        id = reader.ReadNumber();
+    }
+    else
+    {
+        for (size_t i = 0; i < m_folders.size(); ++i)
+        {
+            m_streamSizes.push_back(UnpackSize(m_folders[i]));
+            m_streamCrcs.push_back(folderCrcs[i]);
+        }
+    }
+
+    return id == kEnd && m_streamCrcs.size() == m_streamSizes.size();
+}
+
+bool Archive7zDatabase::ReadFilesInfo(Reader& reader)
+{
+    const auto numFiles = reader.ReadCount();
+    m_files.resize(static_cast<size_t>(numFiles));
+
+    std::vector<bool> emptyStreams(m_files.size(), false);
+    std::vector<bool> emptyFiles;
+    std::vector<bool> antiFiles;
+
+    const auto ReadTimes = [&](std::optional<uint64_t> File::*time) {
+        const auto defined = reader.ReadDefined(m_files.size());
+        if (reader.ReadByte() != 0)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < defined.size(); ++i)
+        {
+            if (defined[i])
+            {
+                m_files[i].*time = reader.ReadUInt64();
+            }
+        }
+
+        return true;
+    };
+
+    for (;;)
+    {
+        const auto type = reader.ReadNumber();
+        if (type == kEnd || reader.Failed())
+        {
+            break;
+        }
+
+        const auto size = reader.ReadNumber();
+        if (size > reader.Remaining())
+        {
+            return false;
+        }
+
+        const auto end = reader.Position() + static_cast<size_t>(size);
+        switch (type)
+        {
+            case kEmptyStream:
+                emptyStreams = reader.ReadBits(m_files.size());
+                break;
+            // Their number of bits depends on kEmptyStream which may not have been read yet
+            case kEmptyFile:
+                emptyFiles = reader.ReadBits(size * 8);
+                break;
+            case kAnti:
+                antiFiles = reader.ReadBits(size * 8);
+                break;
+            case kName:
+                if (reader.ReadByte() != 0)
+                {
+                    return false;
+                }
+
+                for (auto& file : m_files)
+                {
+                    for (;;)
+                    {
+                        const auto data = reader.ReadBytes(sizeof(uint16_t));
+                        if (data == nullptr)
+                        {
+                            return false;
+                        }
+
+                        const auto c = static_cast<wchar_t>(ReadLittleEndian<uint16_t>(data));
+                        if (c == L'\0')
+                        {
+                            break;
+                        }
+
+                        file.name.push_back(c);
+                    }
+                }
+                break;
+            case kCTime:
+                if (!ReadTimes(&File::cTime))
+                {
+                    return false;
+                }
+                break;
+            case kATime:
+                if (!ReadTimes(&File::aTime))
+                {
+                    return false;
+                }
+                break;
+            case kMTime:
+                if (!ReadTimes(&File::mTime))
+                {
+                    return false;
+                }
+                break;
+            case kWinAttributes: {
+                const auto defined = reader.ReadDefined(m_files.size());
+                if (reader.ReadByte() != 0)
+                {
+                    return false;
+                }
+
+                for (size_t i = 0; i < defined.size(); ++i)
+                {
+                    if (defined[i])
+                    {
+                        m_files[i].attributes = reader.ReadUInt32();
+                    }
+                }
+                break;
+            }
+            case kDummy:
+                break;
+            default:
+                Log::Debug("Unsupported 7z file property: {}", type);
+                return false;
+        }
+
+        if (reader.Failed() || reader.Position() > end)
+        {
+            return false;
+        }
+
+        reader.Seek(end);
+    }
+
+    size_t emptyIndex = 0;
+    for (size_t i = 0; i < m_files.size(); ++i)
+    {
+        auto& file = m_files[i];
+        file.hasStream = !emptyStreams[i];
+        if (!file.hasStream)
+        {
+            const bool isEmptyFile = emptyIndex < emptyFiles.size() && emptyFiles[emptyIndex];
+            file.isDir = !isEmptyFile;
+            file.isAnti = emptyIndex < antiFiles.size() && antiFiles[emptyIndex];
+            ++emptyIndex;
+        }
+    }
+
+    return true;
+}
+
+void Archive7zDatabase::Append(const Archive7zDatabase& other)
+{
+    m_packSizes.insert(std::end(m_packSizes), std::cbegin(other.m_packSizes), std::cend(other.m_packSizes));
+    m_folders.insert(std::end(m_folders), std::cbegin(other.m_folders), std::cend(other.m_folders));
+    m_streamSizes.insert(std::end(m_streamSizes), std::cbegin(other.m_streamSizes), std::cend(other.m_streamSizes));
+    m_streamCrcs.insert(std::end(m_streamCrcs), std::cbegin(other.m_streamCrcs), std::cend(other.m_streamCrcs));
+    m_files.insert(std::end(m_files), std::cbegin(other.m_files), std::cend(other.m_files));
+}
+
+uint64_t Archive7zDatabase::PackEnd() const
+{
+    return std::accumulate(std::cbegin(m_packSizes), std::cend(m_packSizes), kSignatureHeaderSize);
+}
+
+void Archive7zDatabase::WriteHeader(Writer& writer) const
+{
+    writer.WriteNumber(kHeader);
+
+    if (!m_folders.empty())
+    {
+        writer.WriteNumber(kMainStreamsInfo);
+
+        writer.WriteNumber(kPackInfo);
+        writer.WriteNumber(0);
+        writer.WriteNumber(m_packSizes.size());
+        writer.WriteNumber(kSize);
+        for (const auto size : m_packSizes)
+        {
+            writer.WriteNumber(size);
+        }
+        writer.WriteNumber(kEnd);
+
+        // Checksums are all written with the streams, not with the folders
+        writer.WriteNumber(kUnpackInfo);
+        writer.WriteNumber(kFolder);
+        writer.WriteNumber(m_folders.size());
+        writer.WriteByte(0);
+        for (const auto& folder : m_folders)
+        {
+            writer.WriteBytes(folder.coders.data(), folder.coders.size());
+        }
+
+        writer.WriteNumber(kCodersUnpackSize);
+        for (const auto& folder : m_folders)
+        {
+            for (const auto size : folder.unpackSizes)
+            {
+                writer.WriteNumber(size);
+            }
+        }
+        writer.WriteNumber(kEnd);
+
+        writer.WriteNumber(kSubStreamsInfo);
+        if (std::any_of(std::cbegin(m_folders), std::cend(m_folders), [](const Folder& folder) {
+                return folder.numUnpackStreams != 1;
+            }))
+        {
+            writer.WriteNumber(kNumUnpackStream);
+            for (const auto& folder : m_folders)
+            {
+                writer.WriteNumber(folder.numUnpackStreams);
+            }
+        }
+
+        if (std::any_of(std::cbegin(m_folders), std::cend(m_folders), [](const Folder& folder) {
+                return folder.numUnpackStreams > 1;
+            }))
+        {
+            writer.WriteNumber(kSize);
+
+            auto size = std::cbegin(m_streamSizes);
+            for (const auto& folder : m_folders)
+            {
+                for (uint64_t i = 0; i < folder.numUnpackStreams; ++i, ++size)
+                {
+                    // The size of the last stream of a folder is implied
+                    if (i + 1 < folder.numUnpackStreams)
+                    {
+                        writer.WriteNumber(*size);
+                    }
+                }
+            }
+        }
+
+        std::vector<bool> defined;
+        for (const auto& crc : m_streamCrcs)
+        {
+            defined.push_back(crc.has_value());
+        }
+
+        if (std::find(std::cbegin(defined), std::cend(defined), true) != std::cend(defined))
+        {
+            writer.WriteNumber(kCRC);
+            writer.WriteDefined(defined);
+            for (const auto& crc : m_streamCrcs)
+            {
+                if (crc)
+                {
+                    writer.WriteUInt32(*crc);
+                }
+            }
+        }
+
+        writer.WriteNumber(kEnd);
+        writer.WriteNumber(kEnd);
+    }
+
+    if (!m_files.empty())
+    {
+        writer.WriteNumber(kFilesInfo);
+        writer.WriteNumber(m_files.size());
+
+        std::vector<bool> emptyStreams;
+        std::vector<bool> emptyFiles;
+        std::vector<bool> antiFiles;
+        for (const auto& file : m_files)
+        {
+            emptyStreams.push_back(!file.hasStream);
+            if (!file.hasStream)
+            {
+                emptyFiles.push_back(!file.isDir);
+                antiFiles.push_back(file.isAnti);
+            }
+        }
+
+        const auto AnyOf = [](const std::vector<bool>& bits) {
+            return std::find(std::cbegin(bits), std::cend(bits), true) != std::cend(bits);
+        };
+
+        if (AnyOf(emptyStreams))
+        {
+            writer.WriteProperty(kEmptyStream, [&](Writer& content) { content.WriteBits(emptyStreams); });
+
+            if (AnyOf(emptyFiles))
+            {
+                writer.WriteProperty(kEmptyFile, [&](Writer& content) { content.WriteBits(emptyFiles); });
+            }
+
+            if (AnyOf(antiFiles))
+            {
+                writer.WriteProperty(kAnti, [&](Writer& content) { content.WriteBits(antiFiles); });
+            }
+        }
+
+        writer.WriteProperty(kName, [&](Writer& content) {
+            content.WriteByte(0);
+            for (const auto& file : m_files)
+            {
+                for (const auto c : file.name)
+                {
+                    content.WriteByte(static_cast<uint8_t>(c));
+                    content.WriteByte(static_cast<uint8_t>(c >> 8));
+                }
+
+                content.WriteByte(0);
+                content.WriteByte(0);
+            }
+        });
+
+        const auto WriteTimes = [&](uint64_t id, std::optional<uint64_t> File::*time) {
+            std::vector<bool> defined;
+            for (const auto& file : m_files)
+            {
+                defined.push_back((file.*time).has_value());
+            }
+
+            if (!AnyOf(defined))
+            {
+                return;
+            }
+
+            writer.WriteProperty(id, [&](Writer& content) {
+                content.WriteDefined(defined);
+                content.WriteByte(0);
+                for (const auto& file : m_files)
+                {
+                    if (file.*time)
+                    {
+                        content.WriteUInt64(*(file.*time));
+                    }
+                }
+            });
+        };
+
+        WriteTimes(kCTime, &File::cTime);
+        WriteTimes(kATime, &File::aTime);
+        WriteTimes(kMTime, &File::mTime);
+
+        std::vector<bool> definedAttributes;
+        for (const auto& file : m_files)
+        {
+            definedAttributes.push_back(file.attributes.has_value());
+        }
+
+        if (AnyOf(definedAttributes))
+        {
+            writer.WriteProperty(kWinAttributes, [&](Writer& content) {
+                content.WriteDefined(definedAttributes);
+                content.WriteByte(0);
+                for (const auto& file : m_files)
+                {
+                    if (file.attributes)
+                    {
+                        content.WriteUInt32(*file.attributes);
+                    }
+                }
+            });
+        }
+
+        writer.WriteNumber(kEnd);
+    }
+
+    writer.WriteNumber(kEnd);
+}
+
+void Archive7zDatabase::Write(ByteStream& stream, std::error_code& ec) const
+{
+    Writer writer;
+    WriteHeader(writer);
+    const auto& header = writer.Data();
+
+    const auto packEnd = PackEnd();
+    ::WriteAt(stream, packEnd, header.data(), header.size(), ec);
+    if (ec)
+    {
+        Log::Error("Failed to write 7z header [{}]", ec);
+        return;
+    }
+
+    HRESULT hr = stream.SetSize(packEnd + header.size());
+    if (FAILED(hr))
+    {
+        ec.assign(hr, std::system_category());
+        Log::Error("Failed to truncate 7z archive [{}]", ec);
+        return;
+    }
+
+    uint8_t signatureHeader[kSignatureHeaderSize];
+    std::copy(std::cbegin(kSignature), std::cend(kSignature), signatureHeader);
+    signatureHeader[6] = m_versionMajor;
+    signatureHeader[7] = m_versionMinor;
+    WriteLittleEndian<uint64_t>(signatureHeader + 12, packEnd - kSignatureHeaderSize);
+    WriteLittleEndian<uint64_t>(signatureHeader + 20, header.size());
+    WriteLittleEndian<uint32_t>(signatureHeader + 28, Crc32(header.data(), header.size()));
+    WriteLittleEndian<uint32_t>(signatureHeader + 8, Crc32(signatureHeader + 12, 20));
+
+    ::WriteAt(stream, 0, signatureHeader, sizeof(signatureHeader), ec);
+    if (ec)
+    {
+        Log::Error("Failed to write 7z signature header [{}]", ec);
+        return;
+    }
+}
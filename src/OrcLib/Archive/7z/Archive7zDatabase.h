@@ -0,0 +1,87 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace Orc {
+
+class ByteStream;
+
+namespace Archive {
+
+//
+// Archive7zDatabase: header of a 7z archive, as written by lib7z without header compression. Packed streams are only
+// referenced by their sizes so that the items of an archive can be appended to another one by copying its packed
+// streams after those of the other archive and writing a header listing the items of both.
+//
+class Archive7zDatabase
+{
+public:
+    static constexpr uint64_t kSignatureHeaderSize = 32;
+
+    // Reads the header of 'stream', 'ec' is 'not_supported' for a header this class cannot rewrite (compressed or
+    // encrypted headers, external or unknown properties...)
+    void Read(ByteStream& stream, std::error_code& ec);
+
+    // Adds the folders and the files of 'other', whose packed streams are copied at PackEnd()
+    void Append(const Archive7zDatabase& other);
+
+    // Writes the header at PackEnd(), truncates the stream after it and updates the signature header
+    void Write(ByteStream& stream, std::error_code& ec) const;
+
+    // Offset of the end of the packed streams, where the header starts
+    uint64_t PackEnd() const;
+
+    size_t FileCount() const { return m_files.size(); }
+
+private:
+    struct Folder
+    {
+        std::vector<uint8_t> coders;  // as encoded in the header, from the number of coders to the packed streams
+        uint64_t numPackStreams = 0;
+        std::vector<uint64_t> unpackSizes;
+        uint64_t numUnpackStreams = 1;
+    };
+
+    struct File
+    {
+        std::wstring name;
+        bool hasStream = true;
+        bool isDir = false;
+        bool isAnti = false;
+        std::optional<uint64_t> cTime;
+        std::optional<uint64_t> aTime;
+        std::optional<uint64_t> mTime;
+        std::optional<uint32_t> attributes;
+    };
+
+    class Reader;
+    class Writer;
+
+    bool ReadHeader(Reader& reader);
+    bool ReadStreamsInfo(Reader& reader);
+    bool ReadFolder(Reader& reader, Folder& folder, uint64_t& numOutStreams);
+    bool ReadFilesInfo(Reader& reader);
+
+    void WriteHeader(Writer& writer) const;
+
+    uint8_t m_versionMajor = 0;
+    uint8_t m_versionMinor = 4;
+    std::vector<uint64_t> m_packSizes;
+    std::vector<Folder> m_folders;
+    std::vector<uint64_t> m_streamSizes;
+    std::vector<std::optional<uint32_t>> m_streamCrcs;
+    std::vector<File> m_files;
+};
+
+}  // namespace Archive
+}  // namespace Orc
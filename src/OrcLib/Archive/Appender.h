@@ -24,6 +24,9 @@ namespace Archive {
 //
 // Appender: Add new items to existing archives for archiver that does not support this feature natively.
 //
+// Each flush appends the new items to the archive with 'T::Append' so its cost does not depend on the archive size,
+// the whole archive is rewritten when 'T::Append' fails with 'not_supported'.
+//
 template <typename T>
 class Appender
 {
@@ -57,6 +60,9 @@ public:
             }
         }
 
+        // Flushes append to the archive written by the first one
+        archiver.SetAppendable(true);
+
         auto appender = std::make_unique<Appender<T>>(
             std::move(archiver), std::move(output), std::move(tempStreams[0]), std::move(tempStreams[1]));
 
@@ -97,6 +103,34 @@ public:
         auto& srcStream = m_tempStreams[m_srcStreamIndex];
         auto& dstStream = m_tempStreams[(m_srcStreamIndex + 1) % 2];
 
+        // Only new items are compressed, the other stream is used as a scratch buffer
+        m_archiver.Append(srcStream, dstStream, ec);
+        if (!ec)
+        {
+            HRESULT hr = dstStream->SetFilePointer(0, FILE_BEGIN, nullptr);
+            if (SUCCEEDED(hr))
+            {
+                hr = dstStream->SetSize(0);
+            }
+
+            if (FAILED(hr))
+            {
+                ec.assign(hr, std::system_category());
+                Log::Error("Failed to resize scratch stream [{}]", ec);
+            }
+
+            return;
+        }
+
+        if (ec != std::errc::not_supported)
+        {
+            Log::Error("Failed to append to stream [{}]", ec);
+            return;
+        }
+
+        Log::Debug("Archive cannot be appended, rewrite it");
+        ec.clear();
+
         m_archiver.Compress(dstStream, srcStream, ec);
         if (ec)
         {
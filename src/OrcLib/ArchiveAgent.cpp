@@ -216,6 +216,8 @@ void ArchiveAgent::run()
                         {
                             if (!request->GetCompressionLevel().empty())
                                 m_compressor->SetCompressionLevel(request->GetCompressionLevel());
+                            m_compressor->SetCompressionThreads(request->GetCompressionThreads());
+                            m_compressor->SetBlockSize(request->GetBlockSize());
 
                             if (FAILED(hr = m_compressor->InitArchive(request->Name().c_str())))
                                 notification = ArchiveNotification::MakeFailureNotification(
@@ -259,6 +261,8 @@ void ArchiveAgent::run()
                     {
                         if (!request->GetCompressionLevel().empty())
                             m_compressor->SetCompressionLevel(request->GetCompressionLevel());
+                        m_compressor->SetCompressionThreads(request->GetCompressionThreads());
+                        m_compressor->SetBlockSize(request->GetBlockSize());
 
                         if (FAILED(hr = m_compressor->InitArchive(request->GetStream())))
                             notification = ArchiveNotification::MakeFailureNotification(
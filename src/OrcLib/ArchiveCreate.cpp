@@ -42,6 +42,8 @@ std::shared_ptr<ArchiveCreate> ArchiveCreate::MakeCreate(ArchiveFormat fmt, bool
 
 ArchiveCreate::ArchiveCreate(bool bComputeHash)
     : OrcArchive(bComputeHash)
+    , m_dwCompressionThreads(0L)
+    , m_ullBlockSize(0LL)
 {
 }
 
@@ -31,6 +31,9 @@ protected:
     ArchiveFormat m_Format;
     ArchiveItems m_Queue;
 
+    DWORD m_dwCompressionThreads;  // 0 lets the archiver use all processors
+    ULONGLONG m_ullBlockSize;  // 0 keeps the archiver default
+
     std::shared_ptr<ByteStream> GetStreamToAdd(const std::shared_ptr<ByteStream>& astream);
 
     ArchiveCreate(bool bComputeHash);
@@ -46,6 +49,18 @@ public:
 
     STDMETHOD(SetCompressionLevel)(__in const std::wstring& strLevel) PURE;
 
+    // Compression threads and size of the blocks they compress concurrently (where the format supports it)
+    HRESULT SetCompressionThreads(DWORD dwThreads)
+    {
+        m_dwCompressionThreads = dwThreads;
+        return S_OK;
+    }
+    HRESULT SetBlockSize(ULONGLONG ullBlockSize)
+    {
+        m_ullBlockSize = ullBlockSize;
+        return S_OK;
+    }
+
     STDMETHOD(AddFile)(__in PCWSTR pwzNameInArchive, __in PCWSTR pwzFileName, bool bDeleteWhenDone);
     STDMETHOD(AddBuffer)(__in_opt PCWSTR pwzNameInArchive, __in PVOID pData, __in DWORD cbData);
     STDMETHOD(AddStream)
@@ -65,6 +65,9 @@ private:
     std::wstring m_compressionLevel;
     std::wstring m_password;
 
+    DWORD m_compressionThreads;
+    ULONGLONG m_blockSize;
+
     ArchiveFormat m_format;
     std::shared_ptr<ByteStream> m_stream;
 
@@ -77,6 +80,8 @@ protected:
         , m_status(Open)
         , m_bHashData(false)
         , m_bDeleteWhenDone(false)
+        , m_compressionThreads(0L)
+        , m_blockSize(0LL)
         , m_format(ArchiveFormat::Unknown) {};
 
 public:
@@ -137,6 +142,12 @@ public:
 
     ArchiveFormat GetArchiveFormat() const { return m_format; };
     const std::wstring& GetCompressionLevel() const { return m_compressionLevel; }
+
+    DWORD GetCompressionThreads() const { return m_compressionThreads; }
+    void SetCompressionThreads(DWORD threads) { m_compressionThreads = threads; }
+
+    ULONGLONG GetBlockSize() const { return m_blockSize; }
+    void SetBlockSize(ULONGLONG blockSize) { m_blockSize = blockSize; }
     const std::wstring& GetPassword() const { return m_password; }
 
     virtual ~ArchiveMessage();
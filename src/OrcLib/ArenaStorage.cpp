@@ -0,0 +1,174 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "ArenaStorage.h"
+
+#include <unordered_set>
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+namespace {
+
+constexpr size_t Align(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+ArenaStorage::ArenaStorage(size_t ChunkSize)
+    : m_ChunkSize(ChunkSize)
+{
+}
+
+LPVOID ArenaStorage::Allocate(size_t Size, size_t Alignment)
+{
+    if (Size == 0)
+        return nullptr;
+
+    size_t padding = Align(reinterpret_cast<size_t>(m_pCurrent), Alignment) - reinterpret_cast<size_t>(m_pCurrent);
+
+    if (m_pCurrent == nullptr || padding + Size > m_Available)
+    {
+        // oversized requests get a chunk of their own
+        const size_t chunkSize = std::max(m_ChunkSize, Align(Size + Alignment, 0x1000));
+
+        auto pChunk = (LPBYTE)VirtualAlloc(NULL, chunkSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (pChunk == nullptr)
+            return nullptr;
+
+        m_Chunks.emplace_back(pChunk, chunkSize);
+        m_pCurrent = pChunk;
+        m_Available = chunkSize;
+        m_Stats.Chunks++;
+        m_Stats.ReservedBytes += chunkSize;
+
+        padding = Align(reinterpret_cast<size_t>(m_pCurrent), Alignment) - reinterpret_cast<size_t>(m_pCurrent);
+    }
+
+    LPVOID retval = m_pCurrent + padding;
+    m_pCurrent += padding + Size;
+    m_Available -= padding + Size;
+
+    m_Stats.UsedBytes += Size;
+    m_Stats.Allocations++;
+    return retval;
+}
+
+void ArenaStorage::Release()
+{
+    for (const auto& chunk : m_Chunks)
+        VirtualFree(chunk.first, 0L, MEM_RELEASE);
+
+    m_Chunks.clear();
+    m_pCurrent = nullptr;
+    m_Available = 0;
+    m_Stats = Statistics();
+}
+
+ArenaStorage::~ArenaStorage()
+{
+    Release();
+}
+
+HRESULT SlabStorage::InitializeStore(const DWORD dwCellsPerSlab, const DWORD dwElementSize)
+{
+    if (dwElementSize == 0)
+        return E_INVALIDARG;
+
+    m_dwElementSize = dwElementSize;
+    m_dwCellSize = static_cast<DWORD>(Align(std::max<size_t>(dwElementSize, sizeof(FreeCellEntry)), 16));
+    m_dwCellsPerSlab = dwCellsPerSlab > 0 ? dwCellsPerSlab : std::max<DWORD>((1024 * 1024) / m_dwCellSize, 1);
+    m_dwUsedInLastSlab = m_dwCellsPerSlab;  // forces the allocation of a first slab
+    m_Initialized = true;
+    return S_OK;
+}
+
+LPVOID SlabStorage::GetNewCell()
+{
+    if (!m_Initialized)
+        throw "Storage is not initialized!!!";
+
+    LPBYTE pCell = nullptr;
+
+    if (m_pFreeList != nullptr)
+    {
+        pCell = reinterpret_cast<LPBYTE>(m_pFreeList);
+        m_pFreeList = m_pFreeList->pNext;
+        ZeroMemory(pCell, m_dwElementSize);
+    }
+    else
+    {
+        if (m_dwUsedInLastSlab >= m_dwCellsPerSlab)
+        {
+            const size_t slabSize = static_cast<size_t>(m_dwCellsPerSlab) * m_dwCellSize;
+
+            // fresh pages are zeroed
+            auto pSlab = (LPBYTE)VirtualAlloc(NULL, slabSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+            if (pSlab == nullptr)
+            {
+                Log::Debug(L"{}: failed to allocate a new slab of {} bytes", m_szStoreDescription, slabSize);
+                return nullptr;
+            }
+
+            m_Slabs.push_back(pSlab);
+            m_dwUsedInLastSlab = 0L;
+            m_Stats.Slabs++;
+            m_Stats.ReservedBytes += slabSize;
+        }
+        pCell = m_Slabs.back() + (static_cast<size_t>(m_dwUsedInLastSlab) * m_dwCellSize);
+        m_dwUsedInLastSlab++;
+    }
+
+    m_Stats.AllocatedCells++;
+    m_Stats.TotalAllocations++;
+    m_Stats.PeakCells = std::max(m_Stats.PeakCells, m_Stats.AllocatedCells);
+    return pCell;
+}
+
+void SlabStorage::FreeCell(LPVOID cell)
+{
+    if (!m_Initialized)
+        throw "Storage is not initialized!!!";
+
+    if (cell)
+    {
+        auto pEntry = reinterpret_cast<FreeCellEntry*>(cell);
+        pEntry->pNext = m_pFreeList;
+        m_pFreeList = pEntry;
+        m_Stats.AllocatedCells--;
+    }
+}
+
+HRESULT SlabStorage::EnumCells(std::function<void(void* lpData)> pCallback)
+{
+    std::unordered_set<LPBYTE> freeCells;
+    for (auto pEntry = m_pFreeList; pEntry != nullptr; pEntry = pEntry->pNext)
+        freeCells.insert(reinterpret_cast<LPBYTE>(pEntry));
+
+    for (size_t i = 0; i < m_Slabs.size(); i++)
+    {
+        const DWORD dwCells = (i + 1 == m_Slabs.size()) ? m_dwUsedInLastSlab : m_dwCellsPerSlab;
+
+        for (DWORD j = 0; j < dwCells; j++)
+        {
+            LPBYTE pCell = m_Slabs[i] + (static_cast<size_t>(j) * m_dwCellSize);
+            if (freeCells.find(pCell) == end(freeCells))
+                pCallback(pCell);
+        }
+    }
+    return S_OK;
+}
+
+SlabStorage::~SlabStorage()
+{
+    for (auto pSlab : m_Slabs)
+        VirtualFree(pSlab, 0L, MEM_RELEASE);
+}
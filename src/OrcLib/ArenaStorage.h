@@ -0,0 +1,111 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include <functional>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Bump allocator: memory is carved out of large chunks and only released, in bulk, when the arena is destroyed.
+// Not thread safe.
+class ORCLIB_API ArenaStorage
+{
+public:
+    class Statistics
+    {
+    public:
+        size_t Chunks = 0;
+        size_t ReservedBytes = 0;
+        size_t UsedBytes = 0;
+        size_t Allocations = 0;
+    };
+
+    ArenaStorage(size_t ChunkSize = 1024 * 1024);
+
+    ArenaStorage(const ArenaStorage&) = delete;
+    ArenaStorage& operator=(const ArenaStorage&) = delete;
+
+    LPVOID Allocate(size_t Size, size_t Alignment = MEMORY_ALLOCATION_ALIGNMENT);
+
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+    void Release();
+
+    ~ArenaStorage();
+
+private:
+    size_t m_ChunkSize;
+    std::vector<std::pair<LPBYTE, size_t>> m_Chunks;
+    LPBYTE m_pCurrent = nullptr;
+    size_t m_Available = 0;
+
+    Statistics m_Stats;
+};
+
+// Fixed size cells carved out of arena slabs. Freed cells are recycled by later allocations, memory goes back to the
+// system when the store is destroyed. Drop-in replacement for HeapStorage, not thread safe either.
+class ORCLIB_API SlabStorage
+{
+public:
+    class Statistics
+    {
+    public:
+        size_t AllocatedCells = 0;
+        size_t PeakCells = 0;
+        size_t TotalAllocations = 0;
+        size_t Slabs = 0;
+        size_t ReservedBytes = 0;
+    };
+
+    SlabStorage(const LPCWSTR szDescription)
+        : m_szStoreDescription(szDescription)
+    {
+    }
+
+    SlabStorage(const SlabStorage&) = delete;
+    SlabStorage& operator=(const SlabStorage&) = delete;
+
+    HRESULT InitializeStore(const DWORD dwCellsPerSlab, const DWORD dwElementSize);
+
+    size_t AllocatedCells() const { return m_Stats.AllocatedCells; }
+
+    LPVOID GetNewCell();
+    void FreeCell(LPVOID cell);
+
+    HRESULT EnumCells(std::function<void(void* lpData)> pCallback);
+
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+    ~SlabStorage();
+
+private:
+    struct FreeCellEntry
+    {
+        FreeCellEntry* pNext;
+    };
+
+    const LPCWSTR m_szStoreDescription;
+    bool m_Initialized = false;
+
+    DWORD m_dwElementSize = 0L;
+    DWORD m_dwCellSize = 0L;
+    DWORD m_dwCellsPerSlab = 0L;
+
+    std::vector<LPBYTE> m_Slabs;
+    DWORD m_dwUsedInLastSlab = 0L;
+    FreeCellEntry* m_pFreeList = nullptr;
+
+    Statistics m_Stats;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -0,0 +1,240 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "BlockCache.h"
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+BlockCache::BlockCache(const Options& options)
+    : m_Options(options)
+{
+    if (m_Options.ulBlockSize == 0)
+        m_Options.ulBlockSize = Options().ulBlockSize;
+    if (m_Options.ulShards == 0)
+        m_Options.ulShards = 1;
+    if (m_Options.ulReadAheadBlocks == 0)
+        m_Options.ulReadAheadBlocks = 1;
+
+    m_ullMaxBytesPerShard = std::max<ULONGLONG>(m_Options.ullMaxBytes / m_Options.ulShards, m_Options.ulBlockSize);
+
+    m_Shards.reserve(m_Options.ulShards);
+    for (ULONG i = 0; i < m_Options.ulShards; i++)
+        m_Shards.push_back(std::make_unique<Shard>());
+}
+
+bool BlockCache::Lookup(ULONGLONG ullBlockIndex, ULONG ulOffsetInBlock, LPBYTE pBuffer, ULONG ulBytes, ULONG& ulCopied)
+{
+    ulCopied = 0L;
+
+    auto& shard = GetShard(ullBlockIndex);
+    concurrency::critical_section::scoped_lock sl(shard.cs);
+
+    auto it = shard.Map.find(ullBlockIndex);
+    if (it == end(shard.Map))
+        return false;
+
+    // Move the block in front of the LRU list
+    shard.LRU.splice(begin(shard.LRU), shard.LRU, it->second);
+
+    const auto& data = it->second->Data;
+    if (ulOffsetInBlock < data.GetCount())
+    {
+        ulCopied = static_cast<ULONG>(std::min<size_t>(ulBytes, data.GetCount() - ulOffsetInBlock));
+        CopyMemory(pBuffer, data.GetData() + ulOffsetInBlock, ulCopied);
+    }
+    return true;
+}
+
+void BlockCache::Insert(ULONGLONG ullBlockIndex, const BYTE* pData, ULONG ulBytes)
+{
+    auto& shard = GetShard(ullBlockIndex);
+    concurrency::critical_section::scoped_lock sl(shard.cs);
+
+    if (shard.Map.find(ullBlockIndex) != end(shard.Map))
+        return;  // another reader loaded it first
+
+    Block block;
+    block.ullIndex = ullBlockIndex;
+    if (FAILED(block.Data.SetData(pData, ulBytes)))
+        return;
+
+    shard.LRU.push_front(std::move(block));
+    shard.Map[ullBlockIndex] = begin(shard.LRU);
+    shard.ullBytes += ulBytes;
+
+    while (shard.ullBytes > m_ullMaxBytesPerShard && shard.LRU.size() > 1)
+    {
+        auto& victim = shard.LRU.back();
+        shard.ullBytes -= victim.Data.GetCount();
+        shard.Map.erase(victim.ullIndex);
+        shard.LRU.pop_back();
+        m_ullEvictions++;
+    }
+}
+
+ULONG BlockCache::ClampToLength(ULONGLONG ullOffset, ULONG ulBytes) const
+{
+    if (m_Options.ullLength == 0)
+        return ulBytes;  // unknown length
+    if (ullOffset >= m_Options.ullLength)
+        return 0L;
+    return static_cast<ULONG>(std::min<ULONGLONG>(ulBytes, m_Options.ullLength - ullOffset));
+}
+
+HRESULT BlockCache::Load(ULONGLONG ullBlockIndex, const BlockReadCall& ReadBlocks)
+{
+    HRESULT hr = E_FAIL;
+
+    // A miss on the block following the previous miss (or the previous read ahead) is a sequential scan
+    ULONG ulBlocks = 1L;
+    const ULONGLONG ullLastMiss = m_ullLastMissedBlock.exchange(ullBlockIndex);
+    if (ullLastMiss != (ULONGLONG)-1 && ullBlockIndex == ullLastMiss + 1)
+        ulBlocks = m_Options.ulReadAheadBlocks;
+
+    // Reads must not run past the end of the volume, the device would fail them as a whole
+    const ULONGLONG ullBlockOffset = ullBlockIndex * m_Options.ulBlockSize;
+    ULONG ulBytesToRead = ClampToLength(ullBlockOffset, ulBlocks * m_Options.ulBlockSize);
+    if (ulBytesToRead == 0)
+    {
+        Insert(ullBlockIndex, nullptr, 0L);
+        return S_OK;
+    }
+    ulBlocks = (ulBytesToRead + m_Options.ulBlockSize - 1) / m_Options.ulBlockSize;
+
+    CBinaryBuffer buffer(true);
+    if (!buffer.SetCount(static_cast<size_t>(ulBlocks) * m_Options.ulBlockSize))
+        return E_OUTOFMEMORY;
+
+    ULONG ulRead = 0L;
+    hr = ReadBlocks(ullBlockOffset, buffer.GetData(), ulBytesToRead, ulRead);
+    if (FAILED(hr) && ulBlocks > 1)
+    {
+        // The volume length may be unknown: only the requested block is needed
+        Log::Debug(
+            "Failed to read ahead {} blocks at index {}, reading one [{}]", ulBlocks, ullBlockIndex, SystemError(hr));
+        ulBlocks = 1L;
+        ulBytesToRead = std::min(ulBytesToRead, m_Options.ulBlockSize);
+        ulRead = 0L;
+        hr = ReadBlocks(ullBlockOffset, buffer.GetData(), ulBytesToRead, ulRead);
+    }
+    if (FAILED(hr))
+    {
+        Log::Debug("Failed to read {} block(s) at index {} [{}]", ulBlocks, ullBlockIndex, SystemError(hr));
+        return hr;
+    }
+
+    m_ullReads++;
+    m_ullBytesRead += ulRead;
+    if (ulBlocks > 1)
+    {
+        m_ullReadAheads++;
+        m_ullLastMissedBlock = ullBlockIndex + ulBlocks - 1;
+    }
+
+    // An empty block records that we are past the end of the volume
+    for (ULONG i = 0; i < ulBlocks; i++)
+    {
+        const ULONG ulOffset = i * m_Options.ulBlockSize;
+        if (i > 0 && ulOffset >= ulRead)
+            break;
+        const ULONG ulBytes = ulOffset < ulRead ? std::min(m_Options.ulBlockSize, ulRead - ulOffset) : 0L;
+        Insert(ullBlockIndex + i, buffer.GetData() + ulOffset, ulBytes);
+    }
+    return S_OK;
+}
+
+HRESULT BlockCache::Read(
+    ULONGLONG ullOffset,
+    LPBYTE pBuffer,
+    ULONG ulBytesToRead,
+    ULONG& ulBytesRead,
+    const BlockReadCall& ReadBlocks)
+{
+    HRESULT hr = E_FAIL;
+
+    ulBytesRead = 0L;
+
+    while (ulBytesRead < ulBytesToRead)
+    {
+        const ULONGLONG ullPosition = ullOffset + ulBytesRead;
+        const ULONGLONG ullBlockIndex = ullPosition / m_Options.ulBlockSize;
+        const ULONG ulOffsetInBlock = static_cast<ULONG>(ullPosition % m_Options.ulBlockSize);
+        const ULONG ulWanted = std::min(m_Options.ulBlockSize - ulOffsetInBlock, ulBytesToRead - ulBytesRead);
+
+        ULONG ulCopied = 0L;
+        if (Lookup(ullBlockIndex, ulOffsetInBlock, pBuffer + ulBytesRead, ulWanted, ulCopied))
+        {
+            m_ullHits++;
+        }
+        else
+        {
+            m_ullMisses++;
+
+            if (FAILED(hr = Load(ullBlockIndex, ReadBlocks)))
+                return hr;
+
+            if (!Lookup(ullBlockIndex, ulOffsetInBlock, pBuffer + ulBytesRead, ulWanted, ulCopied))
+            {
+                // Evicted before we could use it (tiny cache and concurrent readers), read it uncached
+                CBinaryBuffer buffer(true);
+                if (!buffer.SetCount(m_Options.ulBlockSize))
+                    return E_OUTOFMEMORY;
+
+                const ULONGLONG ullBlockOffset = ullBlockIndex * m_Options.ulBlockSize;
+                ULONG ulRead = 0L;
+                if (FAILED(
+                        hr = ReadBlocks(
+                            ullBlockOffset,
+                            buffer.GetData(),
+                            ClampToLength(ullBlockOffset, m_Options.ulBlockSize),
+                            ulRead)))
+                    return hr;
+
+                if (ulOffsetInBlock < ulRead)
+                {
+                    ulCopied = std::min(ulWanted, ulRead - ulOffsetInBlock);
+                    CopyMemory(pBuffer + ulBytesRead, buffer.GetData() + ulOffsetInBlock, ulCopied);
+                }
+            }
+        }
+
+        ulBytesRead += ulCopied;
+
+        if (ulCopied < ulWanted)
+            break;  // end of volume
+    }
+    return S_OK;
+}
+
+BlockCache::Statistics BlockCache::GetStatistics() const
+{
+    Statistics stats;
+    stats.ullHits = m_ullHits;
+    stats.ullMisses = m_ullMisses;
+    stats.ullReadAheads = m_ullReadAheads;
+    stats.ullReads = m_ullReads;
+    stats.ullBytesRead = m_ullBytesRead;
+    stats.ullEvictions = m_ullEvictions;
+    return stats;
+}
+
+void BlockCache::Clear()
+{
+    for (auto& shard : m_Shards)
+    {
+        concurrency::critical_section::scoped_lock sl(shard->cs);
+        shard->LRU.clear();
+        shard->Map.clear();
+        shard->ullBytes = 0LLU;
+    }
+    m_ullLastMissedBlock = (ULONGLONG)-1;
+}
+
+BlockCache::~BlockCache() {}
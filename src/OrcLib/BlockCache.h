@@ -0,0 +1,119 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include "BinaryBuffer.h"
+
+#include <concrt.h>
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Size bounded cache of aligned volume blocks. Blocks are spread over independently locked shards (each one with its
+// own LRU list) so that concurrent readers rarely contend. Sequential misses are detected and turned into a single
+// read of several blocks.
+class ORCLIB_API BlockCache
+{
+public:
+    class Options
+    {
+    public:
+        ULONG ulBlockSize = 64 * 1024;  // must be a multiple of the sector size
+        ULONGLONG ullMaxBytes = 64 * 1024 * 1024;
+        ULONG ulShards = 16;
+        ULONG ulReadAheadBlocks = 16;  // blocks read at once when a sequential scan is detected
+        ULONG ulBypassSize = 512 * 1024;  // larger reads go straight to the volume
+        ULONGLONG ullLength = 0LLU;  // when known, read aheads stop at the end of the volume
+    };
+
+    class Statistics
+    {
+    public:
+        ULONGLONG ullHits = 0LLU;
+        ULONGLONG ullMisses = 0LLU;
+        ULONGLONG ullReadAheads = 0LLU;
+        ULONGLONG ullReads = 0LLU;  // read operations issued to the volume
+        ULONGLONG ullBytesRead = 0LLU;
+        ULONGLONG ullEvictions = 0LLU;
+    };
+
+    // Reads ulBytesToRead bytes at the aligned ullOffset into an aligned pBuffer
+    using BlockReadCall =
+        std::function<HRESULT(ULONGLONG ullOffset, LPBYTE pBuffer, ULONG ulBytesToRead, ULONG& ulBytesRead)>;
+
+    BlockCache(const Options& options);
+
+    const Options& GetOptions() const { return m_Options; }
+
+    bool ShouldBypass(ULONGLONG ullBytesToRead) const { return ullBytesToRead > m_Options.ulBypassSize; }
+
+    HRESULT Read(
+        ULONGLONG ullOffset,
+        LPBYTE pBuffer,
+        ULONG ulBytesToRead,
+        ULONG& ulBytesRead,
+        const BlockReadCall& ReadBlocks);
+
+    Statistics GetStatistics() const;
+    void Clear();
+
+    ~BlockCache();
+
+private:
+    class Block
+    {
+    public:
+        ULONGLONG ullIndex = 0LLU;
+        CBinaryBuffer Data;
+    };
+
+    class Shard
+    {
+    public:
+        concurrency::critical_section cs;
+        std::list<Block> LRU;  // most recently used first
+        std::unordered_map<ULONGLONG, std::list<Block>::iterator> Map;
+        ULONGLONG ullBytes = 0LLU;
+    };
+
+    Options m_Options;
+    ULONGLONG m_ullMaxBytesPerShard = 0LLU;
+    std::vector<std::unique_ptr<Shard>> m_Shards;
+
+    std::atomic<ULONGLONG> m_ullLastMissedBlock = (ULONGLONG)-1;
+
+    std::atomic<ULONGLONG> m_ullHits = 0LLU;
+    std::atomic<ULONGLONG> m_ullMisses = 0LLU;
+    std::atomic<ULONGLONG> m_ullReadAheads = 0LLU;
+    std::atomic<ULONGLONG> m_ullReads = 0LLU;
+    std::atomic<ULONGLONG> m_ullBytesRead = 0LLU;
+    std::atomic<ULONGLONG> m_ullEvictions = 0LLU;
+
+    Shard& GetShard(ULONGLONG ullBlockIndex) { return *m_Shards[ullBlockIndex % m_Shards.size()]; }
+
+    // Copies the cached part of a block, returns false if the block is not cached
+    bool Lookup(ULONGLONG ullBlockIndex, ULONG ulOffsetInBlock, LPBYTE pBuffer, ULONG ulBytes, ULONG& ulCopied);
+    void Insert(ULONGLONG ullBlockIndex, const BYTE* pData, ULONG ulBytes);
+
+    // Bytes of a read at ullOffset that are within the volume, when its length is known
+    ULONG ClampToLength(ULONGLONG ullOffset, ULONG ulBytes) const;
+
+    HRESULT Load(ULONGLONG ullBlockIndex, const BlockReadCall& ReadBlocks);
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
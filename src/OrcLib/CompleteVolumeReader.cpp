@@ -49,16 +49,32 @@ CompleteVolumeReader::Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullB
 {
     HRESULT hr = E_FAIL;
 
-    concurrency::critical_section::scoped_lock sl(m_cs);
+    if (offset > m_Extents[0].GetLength())
+        return E_INVALIDARG;
 
-    if (FAILED(hr = Seek(offset)))
-        return hr;
+    if (m_BlockCache && !m_BlockCache->ShouldBypass(ullBytesToRead))
+        return CachedRead(offset, data, ullBytesToRead, ullBytesRead);
 
-    if (m_LocalPositionOffset > 0)
+    // Reads are positional: they do not use the current position of Seek(), hence no lock is needed. Concurrent
+    // callers run in parallel on the extent's overlapped handle (see CDiskExtent::ReadAt)
+    ULONG ulHeadOffset = 0L;
+    if (m_BytesPerSector && offset % m_BytesPerSector)
+    {
+        // we round to the lower sector
+        ulHeadOffset = offset % m_BytesPerSector;
+        offset = (offset / m_BytesPerSector) * m_BytesPerSector;
+    }
+
+    const CDiskExtent& Extent = m_Extents[0];
+    auto ReadAtOffset = [&Extent, offset](PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) -> HRESULT {
+        return Extent.ReadAt(offset, lpBuf, dwCount, pdwBytesRead);
+    };
+
+    if (ulHeadOffset > 0)
     {
         CBinaryBuffer localReadBuffer(true);
         ULONGLONG ullBytesToReadWithOffset =
-            (((ullBytesToRead + m_LocalPositionOffset) / m_BytesPerSector) + 1) * m_BytesPerSector;
+            (((ullBytesToRead + ulHeadOffset) / m_BytesPerSector) + 1) * m_BytesPerSector;
 
         if (data.GetCount() < ullBytesToReadWithOffset)
         {
@@ -68,11 +84,13 @@ CompleteVolumeReader::Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullB
                     return E_OUTOFMEMORY;
                 ULONGLONG ullBytesReadWithOffset = 0LL;
 
-                if (FAILED(hr = Read(localReadBuffer, ullBytesToReadWithOffset, ullBytesReadWithOffset)))
+                if (FAILED(
+                        hr = ReadChunk(
+                            localReadBuffer, ullBytesToReadWithOffset, ullBytesReadWithOffset, ReadAtOffset)))
                     return hr;
 
-                if (ullBytesReadWithOffset > m_LocalPositionOffset)
-                    ullBytesRead = ullBytesReadWithOffset - m_LocalPositionOffset;
+                if (ullBytesReadWithOffset > ulHeadOffset)
+                    ullBytesRead = ullBytesReadWithOffset - ulHeadOffset;
                 else
                     ullBytesRead = 0LL;
 
@@ -87,11 +105,10 @@ CompleteVolumeReader::Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullB
                     }
                     CopyMemory(
                         data.GetData(),
-                        localReadBuffer.GetData() + m_LocalPositionOffset,
+                        localReadBuffer.GetData() + ulHeadOffset,
                         static_cast<size_t>(ullBytesRead));
                     localReadBuffer.RemoveAll();
                 }
-                m_LocalPositionOffset = 0;
             }
             else
             {
@@ -99,11 +116,13 @@ CompleteVolumeReader::Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullB
                     return E_OUTOFMEMORY;
 
                 ULONGLONG ullBytesReadWithOffset = 0LL;
-                if (FAILED(hr = Read(localReadBuffer, ullBytesToReadWithOffset, ullBytesReadWithOffset)))
+                if (FAILED(
+                        hr = ReadChunk(
+                            localReadBuffer, ullBytesToReadWithOffset, ullBytesReadWithOffset, ReadAtOffset)))
                     return hr;
 
-                if (ullBytesReadWithOffset > m_LocalPositionOffset)
-                    ullBytesRead = ullBytesReadWithOffset - m_LocalPositionOffset;
+                if (ullBytesReadWithOffset > ulHeadOffset)
+                    ullBytesRead = ullBytesReadWithOffset - ulHeadOffset;
                 else
                     ullBytesRead = 0LL;
 
@@ -113,21 +132,20 @@ CompleteVolumeReader::Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullB
                 {
                     CopyMemory(
                         data.GetData(),
-                        localReadBuffer.GetData() + m_LocalPositionOffset,
+                        localReadBuffer.GetData() + ulHeadOffset,
                         static_cast<size_t>(ullBytesRead));
                     localReadBuffer.RemoveAll();
                 }
-                m_LocalPositionOffset = 0L;
             }
         }
         else
         {
             ULONGLONG ullBytesReadWithOffset = 0LL;
-            if (FAILED(hr = Read(data, ullBytesToReadWithOffset, ullBytesReadWithOffset)))
+            if (FAILED(hr = ReadChunk(data, ullBytesToReadWithOffset, ullBytesReadWithOffset, ReadAtOffset)))
                 return hr;
 
-            if (ullBytesReadWithOffset > m_LocalPositionOffset)
-                ullBytesRead = ullBytesReadWithOffset - m_LocalPositionOffset;
+            if (ullBytesReadWithOffset > ulHeadOffset)
+                ullBytesRead = ullBytesReadWithOffset - ulHeadOffset;
             else
                 ullBytesRead = 0LL;
 
@@ -135,20 +153,82 @@ CompleteVolumeReader::Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullB
                 ullBytesRead = ullBytesToRead;
             if (ullBytesRead > 0)
             {
-                MoveMemory(data.GetData(), data.GetData() + m_LocalPositionOffset, static_cast<size_t>(ullBytesRead));
+                MoveMemory(data.GetData(), data.GetData() + ulHeadOffset, static_cast<size_t>(ullBytesRead));
                 localReadBuffer.RemoveAll();
             }
-            m_LocalPositionOffset = 0L;
         }
     }
     else
     {
-        if (FAILED(hr = Read(data, ullBytesToRead, ullBytesRead)))
+        if (FAILED(hr = ReadChunk(data, ullBytesToRead, ullBytesRead, ReadAtOffset)))
             return hr;
     }
     return S_OK;
 }
 
+HRESULT CompleteVolumeReader::EnableBlockCache(const BlockCache::Options& options)
+{
+    if (m_BytesPerSector == 0)
+    {
+        Log::Debug(L"Cannot enable block cache before disk properties are loaded");
+        return E_UNEXPECTED;
+    }
+
+    auto cacheOptions = options;
+
+    // blocks are read straight from the extent, they must span whole sectors
+    if (cacheOptions.ulBlockSize % m_BytesPerSector)
+        cacheOptions.ulBlockSize = ((cacheOptions.ulBlockSize / m_BytesPerSector) + 1) * m_BytesPerSector;
+    if (!m_Extents.empty())
+        cacheOptions.ullLength = m_Extents[0].GetLength();
+
+    m_BlockCache = std::make_shared<BlockCache>(cacheOptions);
+    return S_OK;
+}
+
+HRESULT CompleteVolumeReader::CachedRead(
+    ULONGLONG offset,
+    CBinaryBuffer& data,
+    ULONGLONG ullBytesToRead,
+    ULONGLONG& ullBytesRead)
+{
+    HRESULT hr = E_FAIL;
+
+    ullBytesRead = 0LL;
+
+    size_t toRead = static_cast<size_t>(std::min((ULONGLONG)DEFAULT_READ_SIZE, ullBytesToRead));
+
+    if (data.OwnsBuffer())
+    {
+        if (!data.SetCount(toRead))
+            return E_OUTOFMEMORY;
+    }
+    else if (toRead > data.GetCount())
+    {
+        toRead = data.GetCount();
+    }
+
+    const CDiskExtent& Extent = m_Extents[0];
+
+    ULONG ulBytesRead = 0L;
+    if (FAILED(
+            hr = m_BlockCache->Read(
+                offset,
+                data.GetData(),
+                static_cast<ULONG>(toRead),
+                ulBytesRead,
+                [&Extent](ULONGLONG ullOffset, LPBYTE pBuffer, ULONG ulBytesToRead, ULONG& ulBlocksRead) -> HRESULT {
+                    DWORD dwBytesRead = 0L;
+                    HRESULT hrRead = Extent.ReadAt(ullOffset, pBuffer, ulBytesToRead, &dwBytesRead);
+                    ulBlocksRead = dwBytesRead;
+                    return hrRead;
+                })))
+        return hr;
+
+    ullBytesRead = ulBytesRead;
+    return S_OK;
+}
+
 std::shared_ptr<VolumeReader> CompleteVolumeReader::ReOpen(DWORD dwDesiredAccess, DWORD dwShareMode, DWORD dwFlags)
 {
     auto retval = DuplicateReader();
@@ -159,17 +239,31 @@ std::shared_ptr<VolumeReader> CompleteVolumeReader::ReOpen(DWORD dwDesiredAccess
     {
         complete_reader->m_Extents.push_back(extent.ReOpen(dwDesiredAccess, dwShareMode, dwFlags));
     }
+    complete_reader->m_BlockCache = m_BlockCache;
 
     return retval;
 }
 
-// Read from disk.
+// Read from disk, at the current position.
 HRESULT CompleteVolumeReader::Read(CBinaryBuffer& data, ULONGLONG ullBytesToRead, ULONGLONG& ullBytesRead)
+{
+    CDiskExtent& Extent = m_Extents[0];
+
+    return ReadChunk(
+        data, ullBytesToRead, ullBytesRead, [&Extent](PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) -> HRESULT {
+            return Extent.Read(lpBuf, dwCount, pdwBytesRead);
+        });
+}
+
+HRESULT CompleteVolumeReader::ReadChunk(
+    CBinaryBuffer& data,
+    ULONGLONG ullBytesToRead,
+    ULONGLONG& ullBytesRead,
+    const ExtentReadCall& ReadExtent)
 {
     HRESULT hr = E_FAIL;
 
     ullBytesRead = 0LL;
-    CDiskExtent& Extent = m_Extents[0];
 
     //
     // how big do we want the read to be?
@@ -199,7 +293,7 @@ HRESULT CompleteVolumeReader::Read(CBinaryBuffer& data, ULONGLONG ullBytesToRead
             // now read
             //
             DWORD dwBytesRead = 0;
-            if (FAILED(hr = Extent.Read(localReadBuffer.GetData(), chunk, &dwBytesRead)))
+            if (FAILED(hr = ReadExtent(localReadBuffer.GetData(), chunk, &dwBytesRead)))
             {
                 return hr;
             }
@@ -218,7 +312,7 @@ HRESULT CompleteVolumeReader::Read(CBinaryBuffer& data, ULONGLONG ullBytesToRead
             // now read
             //
             DWORD dwBytesRead = 0;
-            if (FAILED(hr = Extent.Read(data.GetData(), chunk, &dwBytesRead)))
+            if (FAILED(hr = ReadExtent(data.GetData(), chunk, &dwBytesRead)))
             {
                 return hr;
             }
@@ -248,7 +342,7 @@ HRESULT CompleteVolumeReader::Read(CBinaryBuffer& data, ULONGLONG ullBytesToRead
             // now read
             //
             DWORD dwBytesRead = 0;
-            if (FAILED(hr = Extent.Read(localReadBuffer.GetData(), chunk, &dwBytesRead)))
+            if (FAILED(hr = ReadExtent(localReadBuffer.GetData(), chunk, &dwBytesRead)))
             {
                 return hr;
             }
@@ -264,7 +358,7 @@ HRESULT CompleteVolumeReader::Read(CBinaryBuffer& data, ULONGLONG ullBytesToRead
             // now read
             //
             DWORD dwBytesRead = 0;
-            if (FAILED(hr = Extent.Read(localReadBuffer.GetData(), chunk, &dwBytesRead)))
+            if (FAILED(hr = ReadExtent(localReadBuffer.GetData(), chunk, &dwBytesRead)))
             {
                 return hr;
             }
@@ -10,8 +10,9 @@
 #include "VolumeReader.h"
 #include "DiskExtent.h"
 #include "BinaryBuffer.h"
+#include "BlockCache.h"
 
-#include <concrt.h>
+#include <functional>
 
 #pragma managed(push, off)
 
@@ -25,11 +26,17 @@ public:
 
     void Accept(VolumeReaderVisitor& visitor) const override { return visitor.Visit(*this); }
 
+    // Seek() and the protected Read() share a current position and must not be called concurrently, Read(offset, ...)
+    // does not use it and is thread safe
     HRESULT Seek(ULONGLONG offset);
     HRESULT Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullBytesToRead, ULONGLONG& ullBytesRead);
 
     virtual std::shared_ptr<VolumeReader> ReOpen(DWORD dwDesiredAccess, DWORD dwShareMode, DWORD dwFlags);
 
+    // Small positional reads are served from a block cache, shared with the readers returned by ReOpen
+    HRESULT EnableBlockCache(const BlockCache::Options& options);
+    const std::shared_ptr<BlockCache>& GetBlockCache() const { return m_BlockCache; }
+
     virtual ~CompleteVolumeReader();
 
 protected:
@@ -39,7 +46,17 @@ protected:
     HRESULT Read(CBinaryBuffer& data, ULONGLONG ullBytesToRead, ULONGLONG& ullBytesRead);
 
 private:
-    concurrency::critical_section m_cs;
+    std::shared_ptr<BlockCache> m_BlockCache;
+
+    HRESULT CachedRead(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullBytesToRead, ULONGLONG& ullBytesRead);
+
+    using ExtentReadCall = std::function<HRESULT(PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead)>;
+
+    HRESULT ReadChunk(
+        CBinaryBuffer& data,
+        ULONGLONG ullBytesToRead,
+        ULONGLONG& ullBytesRead,
+        const ExtentReadCall& ReadExtent);
 };
 
 }  // namespace Orc
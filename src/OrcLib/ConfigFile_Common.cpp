@@ -213,6 +213,9 @@ HRESULT Orc::Config::Common::yara(ConfigItem& parent, DWORD dwIndex)
         return hr;
     if (FAILED(hr = parent.SubItems[dwIndex].AddAttribute(L"scan_method", CONFIG_YARA_SCAN_METHOD, ConfigItem::OPTION)))
         return hr;
+    if (FAILED(
+            hr = parent.SubItems[dwIndex].AddAttribute(L"scan_workers", CONFIG_YARA_SCAN_WORKERS, ConfigItem::OPTION)))
+        return hr;
     return S_OK;
 };
 
@@ -260,6 +260,7 @@ constexpr auto CONFIG_YARA_BLOCK = 1L;
 constexpr auto CONFIG_YARA_OVERLAP = 2L;
 constexpr auto CONFIG_YARA_TIMEOUT = 3L;
 constexpr auto CONFIG_YARA_SCAN_METHOD = 4L;
+constexpr auto CONFIG_YARA_SCAN_WORKERS = 5L;
 
 constexpr auto CONFIG_TEMPLATE_NAME = 0L;
 constexpr auto CONFIG_TEMPLATE_LOCATION = 1L;
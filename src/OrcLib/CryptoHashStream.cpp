@@ -18,6 +18,7 @@
 
 #include <sstream>
 #include <iomanip>
+#include <atomic>
 
 using namespace std;
 
@@ -25,6 +26,23 @@ using namespace Orc;
 
 HCRYPTPROV CryptoHashStream::g_hProv = NULL;
 
+namespace {
+
+// the in process implementation is opt-in (see /HashProvider)
+std::atomic<CryptoHashStream::Provider> g_DefaultProvider = CryptoHashStream::Provider::CryptoAPI;
+
+}  // namespace
+
+void CryptoHashStream::SetDefaultProvider(Provider provider)
+{
+    g_DefaultProvider.store(provider);
+}
+
+CryptoHashStream::Provider CryptoHashStream::GetDefaultProvider()
+{
+    return g_DefaultProvider.load();
+}
+
 CryptoHashStream::~CryptoHashStream(void)
 {
     Close();
@@ -87,9 +105,15 @@ HRESULT CryptoHashStream::ResetHash(bool bContinue)
         CryptDestroyHash(m_Sha256);
 
     m_MD5 = m_Sha1 = m_Sha256 = NULL;
+    m_pMultiHash.reset();
     m_bHashIsValid = false;
 
-    if (bContinue)
+    if (bContinue && m_Provider == Provider::Native)
+    {
+        m_pMultiHash = std::make_unique<MultiHash>(m_Algorithms);
+        m_bHashIsValid = true;
+    }
+    else if (bContinue)
     {
         if (g_hProv == NULL)
         {
@@ -126,6 +150,12 @@ HRESULT CryptoHashStream::HashData(LPBYTE pBuffer, DWORD dwBytesToHash)
 {
     if (m_bHashIsValid)
     {
+        if (m_pMultiHash)
+        {
+            m_pMultiHash->Update(pBuffer, dwBytesToHash);
+            return S_OK;
+        }
+
         if (m_MD5)
             if (!CryptHashData(m_MD5, pBuffer, dwBytesToHash, 0))
                 return HRESULT_FROM_WIN32(GetLastError());
@@ -141,7 +171,11 @@ HRESULT CryptoHashStream::HashData(LPBYTE pBuffer, DWORD dwBytesToHash)
 
 HRESULT CryptoHashStream::GetHash(Algorithm alg, CBinaryBuffer& hash)
 {
-    if (m_bHashIsValid)
+    if (m_bHashIsValid && m_pMultiHash)
+    {
+        return m_pMultiHash->GetHash(alg, hash);
+    }
+    else if (m_bHashIsValid)
     {
         HCRYPTHASH hHash = NULL;
         DWORD cbHash = 0L;
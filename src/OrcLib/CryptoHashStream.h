@@ -14,6 +14,7 @@
 
 #include "CryptoUtilities.h"
 #include "CryptoHashStreamAlgorithm.h"
+#include "MultiHash.h"
 #include "Output/Text/Fmt/CryptoHashStreamAlgorithm.h"
 
 #pragma managed(push, off)
@@ -25,8 +26,20 @@ class ORCLIB_API CryptoHashStream : public HashStream
 public:
     using Algorithm = CryptoHashStreamAlgorithm;
 
+    // Native: in process, all the algorithms in one pass over the data (see MultiHash)
+    // CryptoAPI: one CryptoAPI hash object per algorithm
+    enum class Provider
+    {
+        Native,
+        CryptoAPI
+    };
+
     CryptoHashStream()
+        : CryptoHashStream(GetDefaultProvider()) {};
+
+    CryptoHashStream(Provider provider)
         : HashStream()
+        , m_Provider(provider)
         , m_Algorithms(Algorithm::Undefined)
         , m_Sha256(NULL)
         , m_Sha1(NULL)
@@ -47,14 +60,22 @@ public:
     HRESULT GetSHA1(CBinaryBuffer& hash) { return GetHash(Algorithm::SHA1, hash); };
     HRESULT GetMD5(CBinaryBuffer& hash) { return GetHash(Algorithm::MD5, hash); };
 
+    Provider GetProvider() const { return m_Provider; }
+
+    // Provider of the streams created afterwards
+    static void SetDefaultProvider(Provider provider);
+    static Provider GetDefaultProvider();
+
     static Algorithm GetSupportedAlgorithm(std::wstring_view svAlgo);
     static std::wstring GetSupportedAlgorithm(Algorithm algs);
 
 protected:
+    Provider m_Provider;
     Algorithm m_Algorithms;
     HCRYPTHASH m_Sha256;
     HCRYPTHASH m_Sha1;
     HCRYPTHASH m_MD5;
+    std::unique_ptr<MultiHash> m_pMultiHash;
 
     static HCRYPTPROV g_hProv;
 
@@ -29,11 +29,118 @@
 
 #include "Log/Log.h"
 
+#if defined(_M_IX86) || defined(_M_X64)
+#    include <intrin.h>
+#    include <emmintrin.h>
+#    define ORC_CSV_SSE2
+#endif
+
 using namespace Orc;
 namespace fs = std::filesystem;
 
 namespace {
 
+// Encodes 'cchUtf16' code units to 'utf8', which must have room for 3 bytes per code unit, returns the number of bytes
+// written. Unpaired surrogates are replaced with U+FFFD, like WideCharToMultiByte does.
+size_t EncodeUtf8(const WCHAR* utf16, size_t cchUtf16, char* utf8)
+{
+    auto out = reinterpret_cast<uint8_t*>(utf8);
+    size_t i = 0;
+
+    while (i < cchUtf16)
+    {
+#ifdef ORC_CSV_SSE2
+        // ASCII runs are narrowed 16 code units at a time
+        const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+        while (i + 16 <= cchUtf16)
+        {
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16 + i));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16 + i + 8));
+            const __m128i bits = _mm_and_si128(_mm_or_si128(low, high), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(bits, _mm_setzero_si128())) != 0xFFFF)
+                break;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(low, high));
+            i += 16;
+            out += 16;
+        }
+
+        const size_t end = std::min(i + 16, cchUtf16);
+#else
+        const size_t end = cchUtf16;
+#endif
+        while (i < end)
+        {
+            uint32_t cp = utf16[i++];
+
+            if (cp < 0x80)
+            {
+                *out++ = static_cast<uint8_t>(cp);
+                continue;
+            }
+            if (cp < 0x800)
+            {
+                *out++ = static_cast<uint8_t>(0xC0 | (cp >> 6));
+                *out++ = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+                continue;
+            }
+            if (cp >= 0xD800 && cp <= 0xDFFF)
+            {
+                if (cp <= 0xDBFF && i < cchUtf16 && utf16[i] >= 0xDC00 && utf16[i] <= 0xDFFF)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (utf16[i++] - 0xDC00);
+                    *out++ = static_cast<uint8_t>(0xF0 | (cp >> 18));
+                    *out++ = static_cast<uint8_t>(0x80 | ((cp >> 12) & 0x3F));
+                    *out++ = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+                    *out++ = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+                    continue;
+                }
+                cp = 0xFFFD;
+            }
+            *out++ = static_cast<uint8_t>(0xE0 | (cp >> 12));
+            *out++ = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+            *out++ = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    return out - reinterpret_cast<uint8_t*>(utf8);
+}
+
+std::string EncodeUtf8(const std::wstring_view& utf16)
+{
+    std::string utf8;
+    utf8.resize(utf16.size() * 3);
+    utf8.resize(EncodeUtf8(utf16.data(), utf16.size(), utf8.data()));
+    return utf8;
+}
+
+// Position of the first quote in [from, to), std::string_view::npos if none
+size_t FindQuote(const char* data, size_t from, size_t to)
+{
+    size_t i = from;
+
+#ifdef ORC_CSV_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    for (; i + 16 <= to; i += 16)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, quote)); mask != 0)
+        {
+            unsigned long index = 0;
+            _BitScanForward(&index, static_cast<unsigned long>(mask));
+            return i + index;
+        }
+    }
+#endif
+
+    for (; i < to; i++)
+    {
+        if (data[i] == '"')
+            return i;
+    }
+    return std::string_view::npos;
+}
+
 // Enable the use of std::make_shared with Writer protected constructor
 struct WriterT : public Orc::TableOutput::CSV::Writer
 {
@@ -71,6 +178,12 @@ HRESULT Orc::TableOutput::CSV::WriterTermination::operator()()
 Orc::TableOutput::CSV::Writer::Writer(std::unique_ptr<Options>&& options)
     : m_Options(std::move(options))
 {
+    if (m_Options && m_Options->bDirectUtf8 && m_Options->Encoding == OutputSpec::Encoding::UTF8)
+    {
+        m_bDirectUtf8 = true;
+        m_Utf8Delimiter = EncodeUtf8(m_Options->Delimiter);
+        m_Utf8EndOfLine = EncodeUtf8(m_Options->EndOfLine);
+    }
 }
 
 std::shared_ptr<Orc::TableOutput::CSV::Writer>
@@ -127,6 +240,23 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::SetSchema(const Schema& schema)
                 fmt::format(L"{}{}", bFirst ? emptyStr : m_Options->Delimiter, csv_col->Format.value_or(L"{}"));
         }
 
+        if (m_bDirectUtf8)
+        {
+            csv_col->FormatColumnUtf8 = EncodeUtf8(csv_col->FormatColumn);
+            csv_col->bEscapeQuotes = csv_col->FormatColumn.find(L"\"{}\"") != std::wstring::npos;
+
+            // Without any other replacement field nor escaped brace, formatting a string is a mere concatenation
+            const auto& format = csv_col->FormatColumnUtf8;
+            const auto field = format.find("{}");
+            if (field != std::string::npos && format.find_first_of("{}") == field
+                && format.find_first_of("{}", field + 2) == std::string::npos)
+            {
+                csv_col->bPlainFormat = true;
+                csv_col->Utf8Prefix = format.substr(0, field);
+                csv_col->Utf8Suffix = format.substr(field + 2);
+            }
+        }
+
         m_Schema.AddColumn(std::move(csv_col));
         bFirst = false;
     }
@@ -166,6 +296,13 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::InitializeBuffer(DWORD dwBufferSize)
         dwPagesToAlloc++;
 
     DWORD dwBytesToAlloc = dwPagesToAlloc * PageSize();
+
+    if (m_bDirectUtf8)
+    {
+        m_directBuffer.reserve(dwBytesToAlloc);
+        return S_OK;
+    }
+
     m_buffer.reserve(dwBytesToAlloc / sizeof(decltype(m_buffer)::value_type));
     m_bufferUtf8.reserve(dwBytesToAlloc);
 
@@ -254,7 +391,11 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::Flush()
 
     // Always clearing the buffer is the best trade-off. It is a growable buffer, a failure in this function coud
     // trigger a massive memory usage as caller will continue to fill it
-    BOOST_SCOPE_EXIT(&m_buffer) { m_buffer.clear(); }
+    BOOST_SCOPE_EXIT(&m_buffer, &m_directBuffer)
+    {
+        m_buffer.clear();
+        m_directBuffer.clear();
+    }
     BOOST_SCOPE_EXIT_END;
 
     if (m_pByteStream == nullptr)
@@ -262,6 +403,11 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::Flush()
         return S_OK;
     }
 
+    if (m_bDirectUtf8 && m_directBuffer.size() == 0)
+    {
+        return S_OK;
+    }
+
     std::string_view writeBuffer;
     DWORD dwBytesToWrite = 0L;
 
@@ -269,7 +415,7 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::Flush()
     // utf8 buffer size must follow utf16 buffer with a margin for conversion
     const auto kBufferElementCb = sizeof(decltype(m_buffer)::value_type);
     const auto kExpectedUtf8Cb = (m_buffer.size() + 8192) * kBufferElementCb;
-    if (m_bufferUtf8.capacity() < kExpectedUtf8Cb)
+    if (!m_bDirectUtf8 && m_bufferUtf8.capacity() < kExpectedUtf8Cb)
     {
         m_bufferUtf8.reserve(kExpectedUtf8Cb);
     }
@@ -277,6 +423,13 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::Flush()
     switch (m_Options->Encoding)
     {
         case OutputSpec::Encoding::UTF8:
+            if (m_bDirectUtf8)
+            {
+                dwBytesToWrite = static_cast<DWORD>(m_directBuffer.size());
+                writeBuffer = std::string_view(m_directBuffer.data(), m_directBuffer.size());
+                break;
+            }
+
             dwBytesToWrite = WideCharToMultiByte(
                 CP_UTF8,
                 0L,
@@ -361,6 +514,22 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::WriteHeaders(const TableOutput::Sche
     using namespace std::string_view_literals;
     auto format_string = fmt::format(L"{}{{}}", m_Options->Delimiter);
 
+    if (m_bDirectUtf8)
+    {
+        auto utf8_format_string = fmt::format("{}{{}}", m_Utf8Delimiter);
+
+        for (const auto& column : columns)
+        {
+            if (auto hr = FormatToUtf8Buffer(bFirst ? "{}"sv : utf8_format_string, false, column->ColumnName);
+                FAILED(hr))
+                AbandonColumn();
+            bFirst = false;
+            m_dwColumnCounter++;
+        }
+        WriteEndOfLine();
+        return S_OK;
+    }
+
     for (const auto& column : columns)
     {
         if (bFirst)
@@ -384,7 +553,8 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::WriteNothing()
 {
     if (m_dwColumnCounter > 0)  // First column does not need the ",", second column will be prepended with it
     {
-        if (auto hr = FormatToBuffer(m_Options->Delimiter); FAILED(hr))
+        if (auto hr = m_bDirectUtf8 ? FormatToUtf8Buffer(m_Utf8Delimiter, false) : FormatToBuffer(m_Options->Delimiter);
+            FAILED(hr))
             return hr;
     }
     AddColumnAndCheckNumbers();
@@ -417,6 +587,11 @@ HRESULT Orc::TableOutput::CSV::Writer::WriteFormated_(const std::string_view& sz
 
     std::string_view result_string((LPCSTR)buffer, buffer.size());
 
+    if (m_bDirectUtf8 && IsUtf8(result_string))
+    {
+        return WriteUtf8Column(result_string);
+    }
+
     if (auto [hr, wstr] = AnsiToWide(result_string); SUCCEEDED(hr))
     {
         if (auto hr = FormatColumn(wstr); FAILED(hr))
@@ -465,14 +640,8 @@ HRESULT Orc::TableOutput::CSV::Writer::WriteFileTime(FILETIME fileTime)
     SYSTEMTIME stUTC;
     FileTimeToSystemTime(&fileTime, &stUTC);
 
-    if (auto hr = FormatColumn(
-            fmt::arg(L"YYYY", stUTC.wYear),
-            fmt::arg(L"MM", stUTC.wMonth),
-            fmt::arg(L"DD", stUTC.wDay),
-            fmt::arg(L"hh", stUTC.wHour),
-            fmt::arg(L"mm", stUTC.wMinute),
-            fmt::arg(L"ss", stUTC.wSecond),
-            fmt::arg(L"mmm", stUTC.wMilliseconds));
+    if (auto hr = FormatTimeColumn(
+            stUTC.wYear, stUTC.wMonth, stUTC.wDay, stUTC.wHour, stUTC.wMinute, stUTC.wSecond, stUTC.wMilliseconds);
         FAILED(hr))
     {
         AbandonColumn();
@@ -482,6 +651,42 @@ HRESULT Orc::TableOutput::CSV::Writer::WriteFileTime(FILETIME fileTime)
     return S_OK;
 }
 
+HRESULT Orc::TableOutput::CSV::Writer::FormatTimeColumn(
+    int year,
+    int month,
+    int day,
+    int hour,
+    int minute,
+    int second,
+    int milliseconds)
+{
+    auto pCol = static_cast<const Column*>(&m_Schema[m_dwColumnCounter]);
+
+    if (m_bDirectUtf8)
+    {
+        return FormatToUtf8Buffer(
+            pCol->FormatColumnUtf8,
+            pCol->bEscapeQuotes,
+            fmt::arg("YYYY", year),
+            fmt::arg("MM", month),
+            fmt::arg("DD", day),
+            fmt::arg("hh", hour),
+            fmt::arg("mm", minute),
+            fmt::arg("ss", second),
+            fmt::arg("mmm", milliseconds));
+    }
+
+    return FormatToBuffer(
+        pCol->FormatColumn,
+        fmt::arg(L"YYYY", year),
+        fmt::arg(L"MM", month),
+        fmt::arg(L"DD", day),
+        fmt::arg(L"hh", hour),
+        fmt::arg(L"mm", minute),
+        fmt::arg(L"ss", second),
+        fmt::arg(L"mmm", milliseconds));
+}
+
 STDMETHODIMP Orc::TableOutput::CSV::Writer::WriteFileTime(LONGLONG fileTime)
 {
     return WriteFileTime(*((FILETIME*)(&fileTime)));
@@ -502,14 +707,14 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::WriteTimeStamp(time_t time)
 
 STDMETHODIMP Orc::TableOutput::CSV::Writer::WriteTimeStamp(tm tmStamp)
 {
-    if (auto hr = FormatColumn(
-            fmt::arg(L"YYYY", tmStamp.tm_year + 1900),
-            fmt::arg(L"MM", tmStamp.tm_mon + 1),
-            fmt::arg(L"DD", tmStamp.tm_mday),
-            fmt::arg(L"hh", tmStamp.tm_hour),
-            fmt::arg(L"mm", tmStamp.tm_min),
-            fmt::arg(L"ss", tmStamp.tm_sec),
-            fmt::arg(L"mmm", 0));
+    if (auto hr = FormatTimeColumn(
+            tmStamp.tm_year + 1900,
+            tmStamp.tm_mon + 1,
+            tmStamp.tm_mday,
+            tmStamp.tm_hour,
+            tmStamp.tm_min,
+            tmStamp.tm_sec,
+            0);
         FAILED(hr))
     {
         AbandonColumn();
@@ -554,7 +759,8 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::AbandonColumn()
 
 HRESULT Orc::TableOutput::CSV::Writer::WriteEndOfLine()
 {
-    if (auto hr = FormatToBuffer(m_Options->EndOfLine); FAILED(hr))
+    if (auto hr = m_bDirectUtf8 ? FormatToUtf8Buffer(m_Utf8EndOfLine, false) : FormatToBuffer(m_Options->EndOfLine);
+        FAILED(hr))
         return hr;
 
     auto counter = m_dwColumnCounter;
@@ -947,6 +1153,182 @@ STDMETHODIMP Orc::TableOutput::CSV::Writer::WriteBytes(const CBinaryBuffer& buff
     return WriteBytes(buffer.GetData(), (DWORD)buffer.GetCount());
 }
 
+std::string_view Orc::TableOutput::CSV::Writer::Utf8ArgBuffer(const std::wstring_view& utf16)
+{
+    if (m_dwUtf8ArgsUsed == m_Utf8Args.size())
+    {
+        m_Utf8Args.emplace_back();
+    }
+
+    auto& buffer = m_Utf8Args[m_dwUtf8ArgsUsed++];
+    buffer.resize(utf16.size() * 3);
+    buffer.resize(EncodeUtf8(utf16.data(), utf16.size(), buffer.data()));
+    return std::string_view(buffer.data(), buffer.size());
+}
+
+std::string_view Orc::TableOutput::CSV::Writer::Utf8ArgBuffer(const WCHAR* szUtf16)
+{
+    if (szUtf16 == nullptr)
+    {
+        throw fmt::format_error("string pointer is null");
+    }
+
+    return Utf8ArgBuffer(std::wstring_view(szUtf16));
+}
+
+HRESULT Orc::TableOutput::CSV::Writer::AppendUtf8Column(const Column& column, const std::wstring_view& utf16)
+{
+    const auto start = m_directBuffer.size();
+
+    m_directBuffer.append(column.Utf8Prefix.data(), column.Utf8Prefix.data() + column.Utf8Prefix.size());
+
+    const auto offset = m_directBuffer.size();
+    m_directBuffer.resize(offset + utf16.size() * 3);
+    m_directBuffer.resize(offset + EncodeUtf8(utf16.data(), utf16.size(), m_directBuffer.data() + offset));
+
+    m_directBuffer.append(column.Utf8Suffix.data(), column.Utf8Suffix.data() + column.Utf8Suffix.size());
+
+    if (column.bEscapeQuotes)
+    {
+        EscapeQuotes(start);
+    }
+
+    return FlushIfFull();
+}
+
+HRESULT Orc::TableOutput::CSV::Writer::AppendUtf8Column(const Column& column, const WCHAR* szUtf16)
+{
+    if (szUtf16 == nullptr)
+    {
+        // Let fmt report the error like the UTF-16 writer does
+        return FormatToUtf8Buffer(column.FormatColumnUtf8, column.bEscapeQuotes, szUtf16);
+    }
+
+    return AppendUtf8Column(column, std::wstring_view(szUtf16));
+}
+
+//
+// Same rule as EscapeQuoteInserter on the column formatted from 'start': the first quote and the last character are
+// left alone, any other quote is doubled. The quote scan is vectorized and most columns have no quote but the opening
+// one, the column is only rewritten from its second quote when there is one.
+//
+void Orc::TableOutput::CSV::Writer::EscapeQuotes(size_t start)
+{
+    const auto length = m_directBuffer.size() - start;
+    if (length < 2)
+    {
+        return;
+    }
+
+    const auto data = m_directBuffer.data() + start;
+    const auto first = FindQuote(data, 0, length - 1);
+    if (first == std::string_view::npos)
+    {
+        return;
+    }
+
+    const auto second = FindQuote(data, first + 1, length - 1);
+    if (second == std::string_view::npos)
+    {
+        return;
+    }
+
+    m_EscapedTail.assign(data + second, length - second);
+    m_directBuffer.resize(start + second);
+
+    const auto tail = m_EscapedTail.data();
+    size_t from = 0;
+    for (auto quote = FindQuote(tail, 0, m_EscapedTail.size() - 1); quote != std::string_view::npos;
+         quote = FindQuote(tail, quote + 1, m_EscapedTail.size() - 1))
+    {
+        m_directBuffer.append(tail + from, tail + quote + 1);
+        m_directBuffer.push_back('"');
+        from = quote + 1;
+    }
+    m_directBuffer.append(tail + from, tail + m_EscapedTail.size());
+}
+
+HRESULT Orc::TableOutput::CSV::Writer::FlushIfFull()
+{
+    // Flush when buffer is over 80% of its capacity
+    if (m_directBuffer.size() > (80 * m_directBuffer.capacity() / 100))
+    {
+        if (auto hr = Flush(); FAILED(hr))
+        {
+            return hr;
+        }
+    }
+
+    return S_OK;
+}
+
+bool Orc::TableOutput::CSV::Writer::IsUtf8(const std::string_view& str)
+{
+    const auto data = reinterpret_cast<const uint8_t*>(str.data());
+    const auto size = str.size();
+    size_t i = 0;
+
+    while (i < size)
+    {
+#ifdef ORC_CSV_SSE2
+        // ASCII runs, 16 bytes at a time
+        while (i + 16 <= size
+               && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))) == 0)
+        {
+            i += 16;
+        }
+        if (i == size)
+        {
+            break;
+        }
+#endif
+
+        const auto c = data[i];
+        if (c < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        // Well-formed sequences only (no overlong form, no surrogate, nothing above U+10FFFF): anything else would be
+        // replaced by the conversion to UTF-16
+        size_t cbSequence = 0;
+        uint8_t secondMin = 0x80, secondMax = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF)
+            cbSequence = 2;
+        else if (c >= 0xE0 && c <= 0xEF)
+        {
+            cbSequence = 3;
+            if (c == 0xE0)
+                secondMin = 0xA0;
+            else if (c == 0xED)
+                secondMax = 0x9F;
+        }
+        else if (c >= 0xF0 && c <= 0xF4)
+        {
+            cbSequence = 4;
+            if (c == 0xF0)
+                secondMin = 0x90;
+            else if (c == 0xF4)
+                secondMax = 0x8F;
+        }
+        else
+            return false;
+
+        if (i + cbSequence > size || data[i + 1] < secondMin || data[i + 1] > secondMax)
+            return false;
+
+        for (size_t j = 2; j < cbSequence; j++)
+        {
+            if (data[i + j] < 0x80 || data[i + j] > 0xBF)
+                return false;
+        }
+        i += cbSequence;
+    }
+
+    return true;
+}
+
 Orc::TableOutput::CSV::Writer::~Writer(void)
 {
     Close();
@@ -16,6 +16,8 @@
 #include "WideAnsi.h"
 #include "CriticalSection.h"
 
+#include <deque>
+
 #pragma managed(push, off)
 
 namespace Orc::TableOutput::CSV {
@@ -29,6 +31,13 @@ public:
         : ::Orc::TableOutput::Column(base) {};
     std::wstring FormatColumn;
 
+    // Direct UTF-8 mode
+    std::string FormatColumnUtf8;
+    bool bEscapeQuotes = false;
+    bool bPlainFormat = false;  // format is "{}" between Utf8Prefix and Utf8Suffix: strings are transcoded in place
+    std::string Utf8Prefix;
+    std::string Utf8Suffix;
+
     virtual ~Column() override final {};
 };
 
@@ -46,6 +55,10 @@ public:
         wcscpy_s(m_szFileName, other.m_szFileName);
         std::swap(m_buffer, other.m_buffer);
         std::swap(m_bufferUtf8, other.m_bufferUtf8);
+        std::swap(m_bDirectUtf8, other.m_bDirectUtf8);
+        std::swap(m_directBuffer, other.m_directBuffer);
+        std::swap(m_Utf8Delimiter, other.m_Utf8Delimiter);
+        std::swap(m_Utf8EndOfLine, other.m_Utf8EndOfLine);
         std::swap(m_Options, other.m_Options);
         std::swap(m_bBOMWritten, other.m_bBOMWritten);
         std::swap(m_pByteStream, other.m_pByteStream);
@@ -90,6 +103,11 @@ public:
             return WriteNothing();
         }
 
+        if (m_bDirectUtf8 && IsUtf8(strString))
+        {
+            return WriteUtf8Column(std::string_view(strString));
+        }
+
         auto [hr, wstr] = AnsiToWide(strString);
         if (FAILED(hr))
         {
@@ -105,6 +123,11 @@ public:
             return WriteNothing();
         }
 
+        if (m_bDirectUtf8 && IsUtf8(strString))
+        {
+            return WriteUtf8Column(strString);
+        }
+
         auto [hr, wstr] = AnsiToWide(strString);
         if (FAILED(hr))
         {
@@ -221,6 +244,15 @@ protected:
 
     std::vector<char> m_bufferUtf8;
 
+    // Direct UTF-8 mode: columns are formatted in m_directBuffer, m_buffer and m_bufferUtf8 are not used
+    bool m_bDirectUtf8 = false;
+    fmt::memory_buffer m_directBuffer;
+    std::string m_Utf8Delimiter;
+    std::string m_Utf8EndOfLine;
+    std::deque<fmt::memory_buffer> m_Utf8Args;  // UTF-8 conversions of the arguments of the column being formatted
+    size_t m_dwUtf8ArgsUsed = 0;
+    std::string m_EscapedTail;
+
     bool m_bBOMWritten = false;
     std::shared_ptr<ByteStream> m_pByteStream = nullptr;
     bool m_bCloseStream = true;
@@ -322,10 +354,93 @@ protected:
         return S_OK;
     }
 
+    //
+    // Direct UTF-8 mode: UTF-16 arguments are transcoded before being formatted with the UTF-8 version of the column
+    // format, quotes are then escaped in place with the same rule as EscapeQuoteInserter
+    //
+    template <typename T>
+    static constexpr bool IsUtf16String = std::is_same_v<std::decay_t<T>, std::wstring>
+        || std::is_same_v<std::decay_t<T>, std::wstring_view> || std::is_same_v<std::decay_t<T>, WCHAR*>
+        || std::is_same_v<std::decay_t<T>, const WCHAR*>;
+
+    template <typename T>
+    decltype(auto) Utf8Arg(T&& arg)
+    {
+        if constexpr (IsUtf16String<T>)
+        {
+            return Utf8ArgBuffer(arg);
+        }
+        else if constexpr (std::is_same_v<std::decay_t<T>, WCHAR>)
+        {
+            return Utf8ArgBuffer(std::wstring_view(&arg, 1));
+        }
+        else
+        {
+            return std::forward<T>(arg);
+        }
+    }
+
+    template <typename... Args>
+    HRESULT FormatToUtf8Buffer(const std::string_view& strFormat, bool bEscapeQuotes, Args&&... args)
+    {
+        const auto start = m_directBuffer.size();
+
+        try
+        {
+            m_dwUtf8ArgsUsed = 0;
+            fmt::format_to(m_directBuffer, strFormat, Utf8Arg(std::forward<Args>(args))...);
+        }
+        catch (const fmt::format_error& error)
+        {
+            Log::Error("fmt::format_error: {}", error.what());
+            return E_INVALIDARG;
+        }
+
+        if (bEscapeQuotes)
+        {
+            EscapeQuotes(start);
+        }
+
+        return FlushIfFull();
+    }
+
+    template <typename... Args>
+    HRESULT FormatUtf8Column(Args&&... args)
+    {
+        auto pCol = static_cast<const Column*>(&m_Schema[m_dwColumnCounter]);
+
+        if constexpr (sizeof...(Args) == 1 && (IsUtf16String<Args> && ...))
+        {
+            if (pCol->bPlainFormat)
+            {
+                return AppendUtf8Column(*pCol, std::forward<Args>(args)...);
+            }
+        }
+
+        return FormatToUtf8Buffer(pCol->FormatColumnUtf8, pCol->bEscapeQuotes, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    HRESULT WriteUtf8Column(Args&&... args)
+    {
+        if (auto hr = FormatUtf8Column(std::forward<Args>(args)...); FAILED(hr))
+        {
+            AbandonColumn();
+            return hr;
+        }
+        AddColumnAndCheckNumbers();
+        return S_OK;
+    }
+
     template <typename... Args>
     HRESULT FormatColumn(Args&&... args)
     {
 
+        if (m_bDirectUtf8)
+        {
+            return FormatUtf8Column(std::forward<Args>(args)...);
+        }
+
         auto pCol = static_cast<const Column*>(&m_Schema[m_dwColumnCounter]);
 
         return FormatToBuffer(pCol->FormatColumn, std::forward<Args>(args)...);
@@ -335,9 +450,7 @@ protected:
     HRESULT WriteColumn(Args&&... args)
     {
 
-        auto pCol = static_cast<const Column*>(&m_Schema[m_dwColumnCounter]);
-
-        if (auto hr = FormatToBuffer(pCol->FormatColumn, std::forward<Args>(args)...); FAILED(hr))
+        if (auto hr = FormatColumn(std::forward<Args>(args)...); FAILED(hr))
         {
             AbandonColumn();
             return hr;
@@ -346,6 +459,19 @@ protected:
         return S_OK;
     }
 
+    std::string_view Utf8ArgBuffer(const std::wstring_view& utf16);
+    std::string_view Utf8ArgBuffer(const WCHAR* szUtf16);
+
+    HRESULT AppendUtf8Column(const Column& column, const std::wstring_view& utf16);
+    HRESULT AppendUtf8Column(const Column& column, const WCHAR* szUtf16);
+    void EscapeQuotes(size_t start);
+    HRESULT FlushIfFull();
+
+    // Narrow strings are UTF-8 (see AnsiToWide): valid ones are written as is in direct UTF-8 mode
+    static bool IsUtf8(const std::string_view& str);
+
+    HRESULT FormatTimeColumn(int year, int month, int day, int hour, int minute, int second, int milliseconds);
+
     HRESULT AddColumnAndCheckNumbers();
 
     STDMETHOD(InitializeBuffer)(DWORD dwBufferSize);
@@ -18,6 +18,7 @@
 namespace Orc {
 
 class ByteStream;
+class HashJob;
 
 class DataDetails
 {
@@ -44,6 +45,7 @@ private:
     bool m_bHasAuthData = false;
 
     bool m_bHashChecked = false;
+    std::shared_ptr<HashJob> m_HashJob;
 
     CBinaryBuffer m_pVersionInfoBlock;
     VS_FIXEDFILEINFO* m_pFFI;
@@ -134,6 +136,10 @@ public:
     void SetHashChecked(bool bChecked) { m_bHashChecked = bChecked; }
     bool HashChecked() const { return m_bHashChecked; }
 
+    // Hashes being computed by a HashingService, shared by the names (hard links) of the data
+    void SetHashJob(const std::shared_ptr<HashJob>& job) { m_HashJob = job; }
+    const std::shared_ptr<HashJob>& GetHashJob() const { return m_HashJob; }
+
     HRESULT SetPeSHA1(CBinaryBuffer&& buffer)
     {
         std::swap(m_PEHashs.sha1, buffer);
@@ -0,0 +1,209 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "DirectoryNameTable.h"
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+DirectoryNameTable::DirectoryNameTable(size_t MaxPathBytes)
+    : m_MaxPathBytes(MaxPathBytes)
+{
+}
+
+void DirectoryNameTable::Reserve(ULONG ulSegments)
+{
+    if (ulSegments > m_Index.size())
+        m_Index.resize(ulSegments, 0L);
+}
+
+const WCHAR* DirectoryNameTable::Intern(const std::wstring_view& Name)
+{
+    if (auto it = m_Names.find(Name); it != end(m_Names))
+        return it->data();
+
+    auto szName = (WCHAR*)m_NameStore.Allocate(std::max<size_t>(Name.size(), 1) * sizeof(WCHAR), sizeof(WCHAR));
+    if (szName == nullptr)
+        return nullptr;
+
+    std::copy(begin(Name), end(Name), szName);
+    m_Names.insert(std::wstring_view(szName, Name.size()));
+    return szName;
+}
+
+bool DirectoryNameTable::Insert(
+    const MFT_SEGMENT_REFERENCE& FileReference,
+    const MFT_SEGMENT_REFERENCE& ParentDirectory,
+    const std::wstring_view& Name)
+{
+    const ULONGLONG ullFileReference = NtfsFullSegmentNumber(&FileReference);
+    const ULONGLONG ullSegment = SegmentIndex(ullFileReference);
+
+    if (ullSegment >= MAXULONG)
+    {
+        Log::Debug("Directory {}: segment number out of range, not inserted", ullFileReference);
+        return false;
+    }
+
+    if (ullSegment >= m_Index.size())
+        m_Index.resize(std::max<size_t>(static_cast<size_t>(ullSegment) + 1, m_Index.size() + m_Index.size() / 2), 0L);
+
+    if (m_Index[ullSegment] != 0L)
+        return false;
+
+    Entry entry;
+    entry.ullFileReference = ullFileReference;
+    entry.ParentDirectory = ParentDirectory;
+    entry.cchName = static_cast<USHORT>(std::min<size_t>(Name.size(), MAXUSHORT));
+    entry.szName = Intern(Name.substr(0, entry.cchName));
+    if (entry.szName == nullptr)
+        return false;
+
+    m_Entries.push_back(entry);
+    m_Index[ullSegment] = static_cast<ULONG>(m_Entries.size());
+    return true;
+}
+
+const DirectoryNameTable::Entry* DirectoryNameTable::Find(ULONGLONG ullFileReference) const
+{
+    const ULONGLONG ullSegment = SegmentIndex(ullFileReference);
+
+    if (ullSegment >= m_Index.size() || m_Index[ullSegment] == 0L)
+        return nullptr;
+
+    const auto& entry = m_Entries[m_Index[ullSegment] - 1];
+
+    // the segment may have been reused, sequence numbers must match too
+    if (entry.ullFileReference != ullFileReference)
+        return nullptr;
+
+    return &entry;
+}
+
+DirectoryNameTable::Entry* DirectoryNameTable::Find(ULONGLONG ullFileReference)
+{
+    return const_cast<Entry*>(static_cast<const DirectoryNameTable*>(this)->Find(ullFileReference));
+}
+
+bool DirectoryNameTable::GetPath(
+    ULONGLONG ullFileReference,
+    ULONGLONG ullRoot,
+    std::wstring_view& Path,
+    ULONGLONG& ullMissing)
+{
+    m_Chain.clear();
+
+    std::wstring_view base(L"", 0);
+    bool bComplete = true;
+
+    // Walk up to the root or to the first ancestor whose path is already known
+    ULONGLONG ullCurrent = ullFileReference;
+    while (ullCurrent != ullRoot)
+    {
+        const Entry* pEntry = Find(ullCurrent);
+
+        // a loop in (corrupted) parent references is treated like a missing parent
+        if (pEntry == nullptr || m_Chain.size() > m_Entries.size())
+        {
+            bComplete = false;
+            ullMissing = ullCurrent;
+            break;
+        }
+
+        if (pEntry->HasPath())
+        {
+            base = std::wstring_view(pEntry->szPath, pEntry->cchPath);
+            break;
+        }
+
+        m_Chain.push_back(static_cast<ULONG>(pEntry - m_Entries.data()));
+        ullCurrent = NtfsFullSegmentNumber(&pEntry->ParentDirectory);
+    }
+
+    if (m_Chain.empty())
+    {
+        if (bComplete)
+            m_PathHits++;
+        Path = base;
+        return bComplete;
+    }
+
+    m_PathBuilds++;
+
+    const bool bMemoize = bComplete && m_PathStore.GetStatistics().UsedBytes < m_MaxPathBytes;
+
+    // Each directory's path is a prefix of its deepest descendant's: one copy serves the whole chain
+    m_Scratch.assign(base);
+    for (auto it = m_Chain.rbegin(); it != m_Chain.rend(); ++it)
+    {
+        auto& entry = m_Entries[*it];
+
+        if (!entry.IsDot())
+        {
+            m_Scratch.push_back(L'\\');
+            m_Scratch.append(entry.Name());
+        }
+        if (bMemoize)
+            entry.cchPath = static_cast<ULONG>(m_Scratch.size());
+    }
+
+    if (bMemoize)
+    {
+        auto szPath =
+            (WCHAR*)m_PathStore.Allocate(std::max<size_t>(m_Scratch.size(), 1) * sizeof(WCHAR), sizeof(WCHAR));
+
+        for (const auto index : m_Chain)
+        {
+            auto& entry = m_Entries[index];
+            entry.szPath = szPath;
+            if (szPath == nullptr)
+                entry.cchPath = 0L;
+        }
+
+        if (szPath != nullptr)
+        {
+            std::copy(begin(m_Scratch), end(m_Scratch), szPath);
+            m_CachedPaths += m_Chain.size();
+            Path = std::wstring_view(szPath, m_Scratch.size());
+            return true;
+        }
+    }
+
+    Path = m_Scratch;
+    return bComplete;
+}
+
+DirectoryNameTable::Statistics DirectoryNameTable::GetStatistics() const
+{
+    Statistics stats;
+    stats.Entries = m_Entries.size();
+    stats.UniqueNames = m_Names.size();
+    stats.NameBytes = m_NameStore.GetStatistics().UsedBytes;
+    stats.CachedPaths = m_CachedPaths;
+    stats.PathBytes = m_PathStore.GetStatistics().UsedBytes;
+    stats.PathHits = m_PathHits;
+    stats.PathBuilds = m_PathBuilds;
+    return stats;
+}
+
+void DirectoryNameTable::Clear()
+{
+    m_Index.clear();
+    m_Entries.clear();
+    m_Names.clear();
+    m_NameStore.Release();
+    m_PathStore.Release();
+    m_CachedPaths = 0;
+    m_Chain.clear();
+    m_Scratch.clear();
+    m_PathHits = 0;
+    m_PathBuilds = 0;
+}
+
+DirectoryNameTable::~DirectoryNameTable() {}
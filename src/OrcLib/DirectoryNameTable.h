@@ -0,0 +1,113 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include "NtfsDataStructures.h"
+#include "ArenaStorage.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/logic/tribool.hpp>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Directories met during an MFT walk: entries are packed in a vector indexed by segment number, their names are
+// interned and their full paths are built once, from their parent's, and kept in an arena.
+// Not thread safe.
+class ORCLIB_API DirectoryNameTable
+{
+public:
+    class Entry
+    {
+    public:
+        ULONGLONG ullFileReference = 0LL;
+        MFT_SEGMENT_REFERENCE ParentDirectory = {0};
+        const WCHAR* szName = nullptr;
+        const WCHAR* szPath = nullptr;  // nullptr until the path is resolved up to the root
+        ULONG cchPath = 0L;
+        USHORT cchName = 0;
+        boost::logic::tribool InLocation = boost::indeterminate;
+
+        std::wstring_view Name() const { return std::wstring_view(szName, cchName); }
+        bool HasPath() const { return szPath != nullptr; }
+        bool IsDot() const { return cchName == 1 && *szName == L'.'; }
+    };
+
+    class Statistics
+    {
+    public:
+        size_t Entries = 0;
+        size_t UniqueNames = 0;
+        size_t NameBytes = 0;
+        size_t CachedPaths = 0;
+        size_t PathBytes = 0;
+        size_t PathHits = 0;
+        size_t PathBuilds = 0;
+    };
+
+    // Once MaxPathBytes are used by memoized paths, new paths are rebuilt on each query
+    DirectoryNameTable(size_t MaxPathBytes = 128 * 1024 * 1024);
+
+    DirectoryNameTable(const DirectoryNameTable&) = delete;
+    DirectoryNameTable& operator=(const DirectoryNameTable&) = delete;
+
+    void Reserve(ULONG ulSegments);
+
+    // Returns false if the directory is already known
+    bool Insert(
+        const MFT_SEGMENT_REFERENCE& FileReference,
+        const MFT_SEGMENT_REFERENCE& ParentDirectory,
+        const std::wstring_view& Name);
+
+    Entry* Find(ULONGLONG ullFileReference);
+    const Entry* Find(ULONGLONG ullFileReference) const;
+
+    size_t size() const { return m_Entries.size(); }
+    bool empty() const { return m_Entries.empty(); }
+
+    // Full path of a directory, like "\Windows\System32" (empty for the root). When a parent is unknown, returns false
+    // with the path below it in Path and its reference in ullMissing.
+    // Path is only valid until the next call to GetPath.
+    bool GetPath(ULONGLONG ullFileReference, ULONGLONG ullRoot, std::wstring_view& Path, ULONGLONG& ullMissing);
+
+    Statistics GetStatistics() const;
+
+    void Clear();
+
+    ~DirectoryNameTable();
+
+private:
+    static ULONGLONG SegmentIndex(ULONGLONG ullFileReference) { return ullFileReference & 0x0000FFFFFFFFFFFF; }
+
+    const WCHAR* Intern(const std::wstring_view& Name);
+
+    std::vector<ULONG> m_Index;  // segment number -> 1 + entry index, 0 when unknown
+    std::vector<Entry> m_Entries;
+
+    ArenaStorage m_NameStore;
+    std::unordered_set<std::wstring_view> m_Names;
+
+    ArenaStorage m_PathStore;
+    size_t m_MaxPathBytes;
+    size_t m_CachedPaths = 0;
+
+    std::vector<ULONG> m_Chain;
+    std::wstring m_Scratch;
+
+    size_t m_PathHits = 0;
+    size_t m_PathBuilds = 0;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -44,6 +44,8 @@ CDiskExtent::CDiskExtent(CDiskExtent&& Other) noexcept
 {
     m_hFile = Other.m_hFile;
     Other.m_hFile = INVALID_HANDLE_VALUE;
+    m_hOverlapped = Other.m_hOverlapped;
+    Other.m_hOverlapped = INVALID_HANDLE_VALUE;
     m_Length = Other.m_Length;
     Other.m_Length = 0;
     m_LogicalSectorSize = Other.m_LogicalSectorSize;
@@ -112,6 +114,8 @@ HRESULT CDiskExtent::Open(DWORD dwShareMode, DWORD dwCreationDisposition, DWORD
         return hr;
     }
 
+    OpenOverlapped(dwShareMode, dwFlags);
+
     ULARGE_INTEGER liLength = {0};
     DWORD dwOutBytes = 0;
     DWORD ioctlLastError, lastError;
@@ -172,17 +176,67 @@ HRESULT CDiskExtent::Read(__in_bcount(dwCount) PVOID lpBuf, DWORD dwCount, PDWOR
     _ASSERT(INVALID_HANDLE_VALUE != m_hFile);
     _ASSERT(pdwBytesRead != nullptr);
 
+    // The current position is m_liCurrentPos, not the file pointer of the handle that ReadAt moves
+    if (FAILED(hr = ReadAt(m_liCurrentPos.QuadPart - m_Start, lpBuf, dwCount, pdwBytesRead)))
+        return hr;
+
+    m_liCurrentPos.QuadPart += *pdwBytesRead;
+    return S_OK;
+}
+
+HRESULT
+CDiskExtent::ReadAt(ULONGLONG ullOffset, __in_bcount(dwCount) PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) const
+{
+    HRESULT hr = S_OK;
+    _ASSERT(INVALID_HANDLE_VALUE != m_hFile);
+    _ASSERT(pdwBytesRead != nullptr);
+
+    // ReadFile reads at the OVERLAPPED offset, whatever the file pointer. On the overlapped handle, concurrent
+    // callers are not serialized: each one waits for its own request on its own event. Without it, the synchronous
+    // handle is used: the requests are serialized by the I/O manager, and the file pointer is moved past the bytes
+    // read, hence Read() and Seek() do not rely on it.
+    ULARGE_INTEGER liPosition;
+    liPosition.QuadPart = m_Start + ullOffset;
+
+    OVERLAPPED overlapped;
+    ZeroMemory(&overlapped, sizeof(OVERLAPPED));
+    overlapped.Offset = liPosition.LowPart;
+    overlapped.OffsetHigh = liPosition.HighPart;
+
+    HANDLE hFile = m_hFile;
+    if (m_hOverlapped != INVALID_HANDLE_VALUE)
+    {
+        overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+        if (overlapped.hEvent != NULL)
+            hFile = m_hOverlapped;
+    }
+
     DWORD dwBytesRead = 0;
-    Log::Debug(L"CDiskExtent: Reading {} bytes", dwCount);
-    if (!ReadFile(m_hFile, lpBuf, dwCount, &dwBytesRead, NULL))
+    Log::Debug(L"CDiskExtent: Reading {} bytes at {}", dwCount, liPosition.QuadPart);
+    const BOOL bRead = ReadFile(hFile, lpBuf, dwCount, &dwBytesRead, &overlapped)
+        || (GetLastError() == ERROR_IO_PENDING && GetOverlappedResult(hFile, &overlapped, &dwBytesRead, TRUE));
+    const DWORD dwLastError = GetLastError();
+
+    if (overlapped.hEvent != NULL)
+        CloseHandle(overlapped.hEvent);
+
+    if (!bRead)
     {
-        hr = HRESULT_FROM_WIN32(GetLastError());
-        Log::Warn(L"Failed to read {} bytes from disk extent [{}]", dwCount, SystemError(hr));
+        hr = HRESULT_FROM_WIN32(dwLastError);
+        if (hr == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF))
+        {
+            *pdwBytesRead = 0;
+            return S_OK;
+        }
+        Log::Warn(
+            L"Failed to read {} bytes at offset {} from disk extent [{}]",
+            dwCount,
+            liPosition.QuadPart,
+            SystemError(hr));
         *pdwBytesRead = 0;
         return hr;
     }
 
-    m_liCurrentPos.QuadPart += dwBytesRead;
     *pdwBytesRead = dwBytesRead;
     return S_OK;
 }
@@ -193,6 +247,12 @@ HRESULT CDiskExtent::Seek(LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER pliNewF
 
     if (dwFrom == FILE_BEGIN)
         liDistanceToMove.QuadPart += m_Start;
+    else if (dwFrom == FILE_CURRENT)
+    {
+        // from m_liCurrentPos, the file pointer may have been moved by ReadAt
+        liDistanceToMove.QuadPart += m_liCurrentPos.QuadPart;
+        dwFrom = FILE_BEGIN;
+    }
 
     Log::Debug(L"Moving from {} to {}", m_liCurrentPos.QuadPart, liDistanceToMove.QuadPart);
 
@@ -208,8 +268,29 @@ HRESULT CDiskExtent::Seek(LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER pliNewF
     return S_OK;
 }
 
+void CDiskExtent::OpenOverlapped(DWORD dwShareMode, DWORD dwFlags)
+{
+    const auto k32 = ExtensionLibrary::GetLibrary<Kernel32Extension>();
+    if (k32 == nullptr)
+        return;
+
+    m_hOverlapped = k32->ReOpenFile(m_hFile, GENERIC_READ, dwShareMode, dwFlags | FILE_FLAG_OVERLAPPED);
+    if (m_hOverlapped == INVALID_HANDLE_VALUE)
+    {
+        Log::Debug(
+            L"Failed to reopen '{}' for overlapped reads, they will be serialized [{}]",
+            m_Name,
+            LastWin32Error());
+    }
+}
+
 void CDiskExtent::Close()
 {
+    if (INVALID_HANDLE_VALUE != m_hOverlapped)
+    {
+        CloseHandle(m_hOverlapped);
+        m_hOverlapped = INVALID_HANDLE_VALUE;
+    }
     if (INVALID_HANDLE_VALUE != m_hFile)
     {
         CloseHandle(m_hFile);
@@ -245,6 +326,9 @@ CDiskExtent CDiskExtent::ReOpen(DWORD dwDesiredAccess, DWORD dwShareMode, DWORD
             ext.m_hFile = INVALID_HANDLE_VALUE;
         }
     }
+
+    if (ext.m_hFile != INVALID_HANDLE_VALUE)
+        ext.OpenOverlapped(dwShareMode, dwFlags);
     return ext;
 }
 
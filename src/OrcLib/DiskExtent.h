@@ -50,11 +50,19 @@ private:
     ULONG m_PhysicalSectorSize = 0LU;
     HANDLE m_hFile = INVALID_HANDLE_VALUE;
 
+    // Handle of ReadAt: the I/O manager serializes the requests on a synchronous handle, not on an overlapped one
+    HANDLE m_hOverlapped = INVALID_HANDLE_VALUE;
+    void OpenOverlapped(DWORD dwShareMode, DWORD dwFlags);
+
 public:
     // from IDiskExtend
     virtual HRESULT Open(DWORD dwShareMode, DWORD dwCreationDisposition, DWORD dwFlags);
     virtual HRESULT Seek(LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER pliNewFilePointer, DWORD dwFrom);
     virtual HRESULT Read(__in_bcount(dwCount) PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead);
+    // Positional read (offset is relative to the extent's start): neither uses nor moves the current position of
+    // Seek() and Read(), which is not thread safe. Concurrent calls run in parallel on the overlapped handle.
+    virtual HRESULT
+    ReadAt(ULONGLONG ullOffset, __in_bcount(dwCount) PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) const;
     virtual void Close();
 
     virtual const std::wstring& GetName() const { return m_Name; }
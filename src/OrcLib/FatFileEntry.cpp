@@ -53,47 +53,34 @@ const std::wstring FatFileEntry::GetFullName() const
     return fullName;
 }
 
-/*
- * we could be more smart here and merge contiguous segments
- */
 void FatFileEntry::FillSegmentDetailsMap(ULONGLONG rootDirectoryOffset, ULONG ulClusterSize)
 {
-    if (m_ClusterChain.empty())
+    // entries only given a cluster chain get their runs from it
+    if (m_ClusterRuns.empty())
+        FatTable::ToClusterRuns(m_ClusterChain, m_ClusterRuns);
+
+    if (m_ClusterRuns.empty())
         return;
 
     m_SegmentDetailsMap.clear();
-    ULONG ulTotalSize = 0;
-
-    std::for_each(
-        std::begin(m_ClusterChain),
-        std::end(m_ClusterChain),
-        [this, &ulTotalSize, rootDirectoryOffset, ulClusterSize](const FatTableEntry& entry) {
-            ULONG clusterNumber = 0;
-
-            if (m_ulSize > ulTotalSize && (entry.IsUsed() && (clusterNumber = entry.GetValue()) >= 2))
-            {
-                SegmentDetails segmentDetails;
-                ULONGLONG startOffset =
-                    rootDirectoryOffset + ((ULONGLONG)(clusterNumber - 2) * (ULONGLONG)ulClusterSize);
-                ULONGLONG endOffset = 0;
-
-                segmentDetails.mStartOffset = startOffset;
-
-                if (m_ulSize > ulTotalSize + ulClusterSize)
-                {
-                    segmentDetails.mEndOffset = startOffset + ulClusterSize;
-                    segmentDetails.mSize = ulClusterSize;
-                }
-                else
-                {
-                    segmentDetails.mSize = m_ulSize - ulTotalSize;
-                    segmentDetails.mEndOffset = startOffset + (segmentDetails.mSize);
-                }
-
-                m_SegmentDetailsMap.insert(std::pair<ULONGLONG, SegmentDetails>(ulTotalSize, segmentDetails));
-                ulTotalSize += segmentDetails.mSize;
-            }
-        });
+    ULONGLONG ullTotalSize = 0;
+
+    // contiguous clusters are merged into a single segment
+    for (const auto& run : m_ClusterRuns)
+    {
+        if (ullTotalSize >= m_ulSize)
+            break;
+
+        SegmentDetails segmentDetails;
+        segmentDetails.mStartOffset =
+            rootDirectoryOffset + ((ULONGLONG)(run.m_FirstCluster - 2) * (ULONGLONG)ulClusterSize);
+        segmentDetails.mSize = static_cast<DWORD>(
+            std::min<ULONGLONG>((ULONGLONG)run.m_Count * (ULONGLONG)ulClusterSize, m_ulSize - ullTotalSize));
+        segmentDetails.mEndOffset = segmentDetails.mStartOffset + segmentDetails.mSize;
+
+        m_SegmentDetailsMap.insert(std::pair<ULONGLONG, SegmentDetails>(ullTotalSize, segmentDetails));
+        ullTotalSize += segmentDetails.mSize;
+    }
 }
 
 std::wostream& Orc::operator<<(std::wostream& os, const FatFileEntry& fatFatFileEntry)
@@ -38,6 +38,7 @@ public:
     bool IsDeleted() const { return m_bIsDeleted; }
 
     const FatTable::ClusterChain& GetClusterChain() const { return m_ClusterChain; }
+    const FatTable::ClusterRuns& GetClusterRuns() const { return m_ClusterRuns; }
     void FillSegmentDetailsMap(ULONGLONG rootDirectoryOffset, ULONG ulClusterSize);
 
     static HRESULT StreamDate(std::wostream& os, const std::wstring& dateTypeStr, const FILETIME& time);
@@ -48,6 +49,7 @@ public:
     UCHAR m_Checksum;
     DWORD m_Attributes;
     FatTable::ClusterChain m_ClusterChain;
+    FatTable::ClusterRuns m_ClusterRuns;
     SegmentDetailsMap m_SegmentDetailsMap;
 
     FILETIME m_CreationTime;
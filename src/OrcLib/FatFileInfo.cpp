@@ -8,7 +8,7 @@
 #include "stdafx.h"
 
 #include "FatFileInfo.h"
-#include "FileSystem.h"
+#include "FatFileEntry.h"
 #include "FatStream.h"
 
 #include "VolumeReader.h"
@@ -50,6 +50,11 @@ std::shared_ptr<ByteStream> FatFileInfo::GetFileStream()
     return m_FileStream;
 }
 
+std::shared_ptr<ByteStream> FatFileInfo::GetHashingStream()
+{
+    return std::make_shared<FatStream>(m_pVolReader, m_FatFileEntry);
+}
+
 const std::unique_ptr<DataDetails>& FatFileInfo::GetDetails()
 {
     if (m_Details == nullptr)
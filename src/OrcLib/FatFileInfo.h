@@ -48,6 +48,8 @@ public:
     const std::shared_ptr<VolumeReader>& GetVolumeReader() const { return m_pVolReader; }
 
 private:
+    virtual std::shared_ptr<ByteStream> GetHashingStream();
+
     virtual HRESULT WriteFileName(ITableOutput& output);
     virtual HRESULT WriteShortName(ITableOutput& output);
 
@@ -129,6 +129,22 @@ HRESULT FatStream::Write(
     return E_NOTIMPL;
 }
 
+SegmentDetailsMap::const_iterator FatStream::FindSegmentDetails(ULONGLONG ullPosition) const
+{
+    // segments are keyed by their offset in the file
+    const SegmentDetailsMap& map(m_FatFileEntry->m_SegmentDetailsMap);
+
+    auto it = map.upper_bound(ullPosition);
+    if (it == map.begin())
+        return map.end();
+
+    --it;
+    if (ullPosition >= it->first + it->second.mSize)
+        return map.end();
+
+    return it;
+}
+
 HRESULT
 FatStream::SetFilePointer(__in LONGLONG distanceToMove, __in DWORD dwMoveMethod, __out_opt PULONG64 pCurrPointer)
 {
@@ -137,58 +153,14 @@ FatStream::SetFilePointer(__in LONGLONG distanceToMove, __in DWORD dwMoveMethod,
 
     ULONGLONG ullNewFilePointer = 0;
     const SegmentDetailsMap& map(m_FatFileEntry->m_SegmentDetailsMap);
-    SegmentDetailsMap::const_iterator begin = map.begin();
-    SegmentDetailsMap::const_iterator end = map.end();
 
-    if (begin == end || GetSize() == 0)
+    if (map.empty() || GetSize() == 0)
         return E_FAIL;
 
     switch (dwMoveMethod)
     {
         case FILE_CURRENT:
             ullNewFilePointer = m_CurrentPosition + distanceToMove;
-
-            if (ullNewFilePointer > GetSize())
-            {
-                m_CurrentPosition = GetSize();
-                m_CurrentSegmentDetails = end;
-            }
-            else
-            {
-                // find the right segment
-                if (distanceToMove > 0)
-                {
-                    for (SegmentDetailsMap::const_iterator it = m_CurrentSegmentDetails; it != end; it++)
-                    {
-                        const SegmentDetails& segmentDetails(it->second);
-
-                        if (it->first <= ullNewFilePointer && ullNewFilePointer < it->first + segmentDetails.mSize)
-                        {
-                            m_CurrentPosition = ullNewFilePointer;
-                            m_CurrentSegmentDetails = it;
-                            break;
-                        }
-                    }
-                }
-                else if (distanceToMove < 0)
-                {
-                    for (SegmentDetailsMap::const_iterator it = m_CurrentSegmentDetails; it != begin; it--)
-                    {
-                        if (it != end)
-                        {
-                            const SegmentDetails& segmentDetails(it->second);
-
-                            if (it->first <= ullNewFilePointer && ullNewFilePointer < it->first + segmentDetails.mSize)
-                            {
-                                m_CurrentPosition = ullNewFilePointer;
-                                m_CurrentSegmentDetails = it;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-
             break;
 
         case FILE_END:
@@ -199,23 +171,6 @@ FatStream::SetFilePointer(__in LONGLONG distanceToMove, __in DWORD dwMoveMethod,
             }
 
             ullNewFilePointer = GetSize() + distanceToMove;
-            m_CurrentSegmentDetails = end;
-
-            for (SegmentDetailsMap::const_iterator it = m_CurrentSegmentDetails; it != begin; it--)
-            {
-                if (it != end)
-                {
-                    const SegmentDetails& segmentDetails(it->second);
-
-                    if (it->first <= ullNewFilePointer && ullNewFilePointer < it->first + segmentDetails.mSize)
-                    {
-                        m_CurrentPosition = ullNewFilePointer;
-                        m_CurrentSegmentDetails = it;
-                        break;
-                    }
-                }
-            }
-
             break;
 
         case FILE_BEGIN:
@@ -226,42 +181,14 @@ FatStream::SetFilePointer(__in LONGLONG distanceToMove, __in DWORD dwMoveMethod,
             }
 
             ullNewFilePointer = distanceToMove;
-            m_CurrentSegmentDetails = begin;
-
-            if (ullNewFilePointer > 0LL)
-            {
-                if (ullNewFilePointer <= GetSize())
-                {
-                    for (SegmentDetailsMap::const_iterator it = begin; it != end; it++)
-                    {
-                        const SegmentDetails& segmentDetails(it->second);
-
-                        if (it->first <= ullNewFilePointer && ullNewFilePointer < it->first + segmentDetails.mSize)
-                        {
-                            m_CurrentPosition = ullNewFilePointer;
-                            m_CurrentSegmentDetails = it;
-                            break;
-                        }
-                    }
-                }
-                else
-                {
-                    m_CurrentPosition = GetSize();
-                    m_CurrentSegmentDetails = end;
-                }
-            }
-            else
-            {
-                m_CurrentPosition = 0LL;
-            }
-
             break;
 
         default:
             return E_INVALIDARG;
     }
 
-    m_CurrentPosition = std::min(GetSize(), m_CurrentPosition);
+    m_CurrentPosition = std::min(GetSize(), ullNewFilePointer);
+    m_CurrentSegmentDetails = FindSegmentDetails(m_CurrentPosition);
 
     if (pCurrPointer)
         *pCurrPointer = m_CurrentPosition;
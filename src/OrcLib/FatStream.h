@@ -46,6 +46,8 @@ public:
     STDMETHOD(Close)();
 
 private:
+    SegmentDetailsMap::const_iterator FindSegmentDetails(ULONGLONG ullPosition) const;
+
     const std::shared_ptr<VolumeReader> m_pVolReader;
     const std::shared_ptr<FatFileEntry> m_FatFileEntry;
     ULONGLONG m_CurrentPosition;
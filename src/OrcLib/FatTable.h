@@ -13,6 +13,7 @@
 #include "BinaryBuffer.h"
 
 #include <algorithm>
+#include <vector>
 
 #pragma managed(push, off)
 
@@ -31,6 +32,14 @@ public:
     using ClusterChain = std::vector<FatTableEntry>;
     using FatTableChunks = std::vector<std::shared_ptr<CBinaryBuffer>>;
 
+    // contiguous clusters of a chain
+    struct ClusterRun
+    {
+        ULONG m_FirstCluster = 0;
+        ULONG m_Count = 0;
+    };
+    using ClusterRuns = std::vector<ClusterRun>;
+
     FatTable(FatTableType type)
         : m_FatTableType(type)
     {
@@ -52,7 +61,15 @@ public:
             return 32;
     }
 
-    void AddChunk(const std::shared_ptr<CBinaryBuffer>& chunk) { mFatTableChunks.push_back(chunk); }
+    void AddChunk(const std::shared_ptr<CBinaryBuffer>& chunk)
+    {
+        const ULONGLONG ullChunkOffset =
+            mFatTableChunks.empty() ? 0LL : m_ChunkOffsets.back() + mFatTableChunks.back()->GetCount();
+
+        mFatTableChunks.push_back(chunk);
+        m_ChunkOffsets.push_back(ullChunkOffset);
+        m_ChainIndex.clear();
+    }
 
     const FatTableChunks& GetFatTableChunks() { return mFatTableChunks; }
 
@@ -75,28 +92,16 @@ public:
 
     HRESULT GetEntry(ULONG entryNumber, FatTableEntry& entry) const
     {
-        ULONGLONG ulCurrentOffset = 0;
         ULONGLONG ulTargetOffset = (static_cast<ULONGLONG>(entryNumber) * GetEntrySizeInBits()) / 8;
 
-        auto chunkIter = std::find_if(
-            mFatTableChunks.begin(),
-            mFatTableChunks.end(),
-            [this, &ulCurrentOffset, ulTargetOffset, &entry](const std::shared_ptr<CBinaryBuffer>& chunk) -> bool {
-                ULONGLONG ulChunkEndOffset = ulCurrentOffset + chunk->GetCount();
-
-                if (ulTargetOffset >= ulCurrentOffset && ulTargetOffset < ulChunkEndOffset)
-                {
-                    return true;
-                }
-
-                ulCurrentOffset += chunk->GetCount();
-                return false;
-            });
+        // chunks are sorted by offset, the target is in the last one starting before it
+        auto offsetIter = std::upper_bound(m_ChunkOffsets.begin(), m_ChunkOffsets.end(), ulTargetOffset);
 
-        if (chunkIter != mFatTableChunks.end())
+        if (offsetIter != m_ChunkOffsets.begin())
         {
-            ULONGLONG index = ulTargetOffset - ulCurrentOffset;
-            const std::shared_ptr<CBinaryBuffer>& buffer(*chunkIter);
+            const size_t chunkIndex = std::distance(m_ChunkOffsets.begin(), offsetIter) - 1;
+            ULONGLONG index = ulTargetOffset - m_ChunkOffsets[chunkIndex];
+            const std::shared_ptr<CBinaryBuffer>& buffer(mFatTableChunks[chunkIndex]);
 
             if (index >= buffer->GetCount())
                 return E_FAIL;
@@ -128,8 +133,138 @@ public:
         }
     }
 
+    ULONG GetEntryCount() const
+    {
+        if (mFatTableChunks.empty())
+            return 0;
+
+        const ULONGLONG ullSize = m_ChunkOffsets.back() + mFatTableChunks.back()->GetCount();
+        return static_cast<ULONG>(std::min<ULONGLONG>((ullSize * 8) / GetEntrySizeInBits(), MAXULONG));
+    }
+
+    // Decodes the whole table once into runs of clusters pointing to their successor, so that chains are resolved
+    // with one lookup per fragment instead of one per cluster
+    HRESULT BuildChainIndex()
+    {
+        m_ChainIndex.clear();
+
+        const ULONG ulEntryCount = GetEntryCount();
+        FatTableEntry entry;
+
+        for (ULONG cluster = 2; cluster < ulEntryCount; cluster++)
+        {
+            if (FAILED(GetEntry(cluster, entry)))
+                return E_FAIL;
+
+            if (entry.IsFree())
+                continue;
+
+            if (!m_ChainIndex.empty())
+            {
+                ChainIndexEntry& last(m_ChainIndex.back());
+                if (last.m_FirstCluster + last.m_Count == cluster && last.m_Next == cluster)
+                {
+                    last.m_Count++;
+                    last.m_Next = entry.GetValue();
+                    continue;
+                }
+            }
+
+            m_ChainIndex.push_back({cluster, 1, entry.GetValue()});
+        }
+
+        m_ChainIndex.shrink_to_fit();
+        return S_OK;
+    }
+
+    HRESULT FillClusterRuns(ULONG firstClusterNumber, ClusterRuns& clusterRuns) const
+    {
+        clusterRuns.clear();
+
+        if (m_ChainIndex.empty())
+        {
+            ClusterChain clusterChain;
+            if (FAILED(FillClusterChain(firstClusterNumber, clusterChain)))
+                return E_FAIL;
+
+            ToClusterRuns(clusterChain, clusterRuns);
+            return S_OK;
+        }
+
+        const ULONG ulEntryCount = GetEntryCount();
+        ULONGLONG ullClusters = 0;
+        FatTableEntry next(firstClusterNumber, GetEntrySizeInBits());
+
+        while (next.IsUsed() && next.GetValue() >= 2)
+        {
+            const ULONG cluster = next.GetValue();
+            if (cluster >= ulEntryCount)
+            {
+                clusterRuns.clear();
+                return E_FAIL;
+            }
+
+            auto it = std::upper_bound(
+                m_ChainIndex.begin(), m_ChainIndex.end(), cluster, [](ULONG value, const ChainIndexEntry& run) {
+                    return value < run.m_FirstCluster;
+                });
+
+            if (it == m_ChainIndex.begin() || cluster >= std::prev(it)->m_FirstCluster + std::prev(it)->m_Count)
+            {
+                // a free cluster ends the chain
+                clusterRuns.push_back({cluster, 1});
+                break;
+            }
+
+            const ChainIndexEntry& run(*std::prev(it));
+            const ULONG ulCount = run.m_FirstCluster + run.m_Count - cluster;
+
+            // a chain longer than the table loops on itself
+            ullClusters += ulCount;
+            if (ullClusters > ulEntryCount)
+            {
+                clusterRuns.clear();
+                return E_FAIL;
+            }
+
+            clusterRuns.push_back({cluster, ulCount});
+            next = FatTableEntry(run.m_Next, GetEntrySizeInBits());
+        }
+
+        return S_OK;
+    }
+
+    static void ToClusterRuns(const ClusterChain& clusterChain, ClusterRuns& clusterRuns)
+    {
+        clusterRuns.clear();
+
+        for (const auto& entry : clusterChain)
+        {
+            if (!entry.IsUsed() || entry.GetValue() < 2)
+                continue;
+
+            if (!clusterRuns.empty()
+                && clusterRuns.back().m_FirstCluster + clusterRuns.back().m_Count == entry.GetValue())
+            {
+                clusterRuns.back().m_Count++;
+                continue;
+            }
+
+            clusterRuns.push_back({entry.GetValue(), 1});
+        }
+    }
+
 private:
+    struct ChainIndexEntry
+    {
+        ULONG m_FirstCluster;
+        ULONG m_Count;
+        ULONG m_Next;  // entry value of the last cluster of the run
+    };
+
     FatTableChunks mFatTableChunks;
+    std::vector<ULONGLONG> m_ChunkOffsets;
+    std::vector<ChainIndexEntry> m_ChainIndex;
     FatTableType m_FatTableType;
 };
 
@@ -15,11 +15,15 @@
 #include <sstream>
 #include <algorithm>
 
+#include <ppl.h>
+
 using namespace Orc;
 
 FatWalker::FatWalker()
     : m_ullRootDirectoryOffset(0)
+    , m_ulClusterSize(0)
     , m_bResurrectRecords(false)
+    , m_Entries(std::make_shared<std::deque<FatFileEntry>>())
 {
 }
 
@@ -43,6 +47,7 @@ HRESULT FatWalker::Init(const std::shared_ptr<Location>& loc, bool bResurrectRec
     const CBinaryBuffer& vbr(reader->GetBootSector());
     ULONG ulSectorSize = reader->GetBytesPerSector();
     ULONG ulClusterSize = reader->GetBytesPerCluster();
+    m_ulClusterSize = ulClusterSize;
     FSVBR::FSType fsType = reader->GetFSType();
 
     int nbReservedSectors = 0;
@@ -139,6 +144,13 @@ HRESULT FatWalker::Init(const std::shared_ptr<Location>& loc, bool bResurrectRec
         fatTable.AddChunk(bufferPtr);
     }
 
+    // cluster chains are resolved from runs of contiguous clusters rather than entry by entry
+    if (FAILED(hr = fatTable.BuildChainIndex()))
+    {
+        Log::Error(L"Failed to index the Fat table from location {} [{}]", m_Location->GetLocation(), SystemError(hr));
+        return hr;
+    }
+
     m_ullRootDirectoryOffset =
         ullFirstFatTableOffset + ((ULONGLONG)nbFatTables * (ULONGLONG)nbSectorPerFatTable * (ULONGLONG)ulSectorSize);
 
@@ -157,11 +169,11 @@ HRESULT FatWalker::Init(const std::shared_ptr<Location>& loc, bool bResurrectRec
     else
     {
         // get root directory clusters and read them
-        FatTable::ClusterChain clusterChain;
-        fatTable.FillClusterChain(rootDirectoryCluster, clusterChain);
+        FatTable::ClusterRuns clusterRuns;
+        fatTable.FillClusterRuns(rootDirectoryCluster, clusterRuns);
 
         // read root directory - it starts at cluster 2. there is actually no cluster 0 and no cluster 1
-        if (S_OK != (hr = ReadClusterChain(clusterChain, m_RootDirectoryBuffer)))
+        if (S_OK != (hr = ReadClusterRuns(clusterRuns, m_RootDirectoryBuffer)))
         {
             Log::Error(
                 L"Failed to read root directory from location {} [{}]", m_Location->GetLocation(), SystemError(hr));
@@ -175,59 +187,82 @@ HRESULT FatWalker::Init(const std::shared_ptr<Location>& loc, bool bResurrectRec
 
     // parse root directory
     FatFileEntryList subFolders;
-    ParseFolder(fatTable, m_RootDirectoryBuffer, m_RootFolder, subFolders);
+    {
+        FatFileEntries entries;
+        ParseFolder(fatTable, m_RootDirectoryBuffer, m_RootFolder, entries);
+        AddFolderEntries(entries, subFolders);
+    }
+
+    // subfolders are processed by batches: their cluster chains are read with one read per contiguous run of clusters,
+    // then they are parsed in parallel and their entries are added in order to the file system
+    const size_t batchSize = std::max<size_t>(4 * concurrency::GetProcessorCount(), 4);
+    std::vector<FolderToParse> batch;
+    batch.reserve(batchSize);
 
     while (!subFolders.empty())
     {
         // we put the deleted folder entries at the end of the structure
-        // we need to parse active folders first
+        // we need to parse active folders first, deleted ones are only batched once there is no active one left
         std::partition(subFolders.begin(), subFolders.end(), [](const FatFileEntry* subfolder) {
             return subfolder != nullptr && !subfolder->IsDeleted();
         });
 
-        // get current subfolder
-        const FatFileEntry* subfolder(subFolders.front());
-        subFolders.pop_front();
+        const bool bActiveBatch = subFolders.front() != nullptr && !subFolders.front()->IsDeleted();
 
-        if (nullptr == subfolder || !subfolder->IsFolder())
-            continue;
+        batch.clear();
+        while (!subFolders.empty() && batch.size() < batchSize)
+        {
+            // get current subfolder
+            const FatFileEntry* subfolder(subFolders.front());
 
-        // get the subfolder cluster chain and check if we have already parsed at least one its clusters
-        bool alreadyParsed = false;
-        const FatTable::ClusterChain& clusterChain(subfolder->GetClusterChain());
-        std::for_each(
-            std::begin(clusterChain),
-            std::end(clusterChain),
-            [&parsedClusterSet, &alreadyParsed](const FatTableEntry& entry) {
-                if (entry.IsUsed())
-                {
-                    if (parsedClusterSet.find(entry.GetValue()) != parsedClusterSet.end())
-                        alreadyParsed = true;
-                }
-            });
+            if (bActiveBatch && (nullptr == subfolder || subfolder->IsDeleted()))
+                break;
 
-        if (alreadyParsed)
-            continue;
+            subFolders.pop_front();
 
-        // read subfolder entries
-        CBinaryBuffer buffer;
-        if (S_OK != (hr = ReadClusterChain(clusterChain, buffer)))
-        {
-            Log::Error(L"Failed to read subfolder {} [{}]", subfolder->m_Name, SystemError(hr));
-            continue;
+            if (nullptr == subfolder || !subfolder->IsFolder())
+                continue;
+
+            // get the subfolder cluster runs and check if we have already parsed at least one its clusters
+            const FatTable::ClusterRuns& clusterRuns(subfolder->GetClusterRuns());
+            const bool alreadyParsed =
+                std::any_of(std::begin(clusterRuns), std::end(clusterRuns), [&parsedClusterSet](const auto& run) {
+                    auto it = parsedClusterSet.lower_bound(run.m_FirstCluster);
+                    return it != parsedClusterSet.end() && *it < run.m_FirstCluster + run.m_Count;
+                });
+
+            if (alreadyParsed)
+                continue;
+
+            // read subfolder entries
+            FolderToParse folder;
+            folder.m_Folder = subfolder;
+            if (S_OK != (hr = ReadClusterRuns(clusterRuns, folder.m_Buffer)))
+            {
+                Log::Error(L"Failed to read subfolder {} [{}]", subfolder->m_Name, SystemError(hr));
+                continue;
+            }
+
+            // update parsed cluster set
+            for (const auto& run : clusterRuns)
+            {
+                for (ULONG i = 0; i < run.m_Count; i++)
+                    parsedClusterSet.insert(run.m_FirstCluster + i);
+            }
+
+            batch.push_back(std::move(folder));
         }
 
-        // update parsed cluster set
-        std::for_each(
-            std::begin(clusterChain), std::end(clusterChain), [&parsedClusterSet](const FatTableEntry& entry) {
-                if (entry.IsUsed())
-                {
-                    parsedClusterSet.insert(entry.GetValue());
-                }
-            });
+        // parse subfolders
+        concurrency::parallel_for(size_t(0), batch.size(), [this, &fatTable, &batch](size_t i) {
+            auto& folder = batch[i];
+            ParseFolder(fatTable, folder.m_Buffer, folder.m_Folder, folder.m_Entries);
+        });
 
-        // parse subfolder
-        ParseFolder(fatTable, buffer, subfolder, subFolders);
+        for (auto& folder : batch)
+        {
+            AddFolderEntries(folder.m_Entries, subFolders);
+        }
     }
 
     return S_OK;
@@ -250,17 +285,26 @@ HRESULT FatWalker::Process(const Callbacks& callbacks)
         const FatFileEntry* fileEntry(fileEntryList.front());
         fileEntryList.pop_front();
 
-        FatFileSystemByName::iterator it0, it1;
-        boost::tie(it0, it1) = m_FatFS.equal_range(boost::make_tuple(fileEntry));
+        auto folderEntries = m_FolderEntries.find(fileEntry);
+        if (folderEntries == m_FolderEntries.end())
+            continue;
 
-        std::for_each(it0, it1, [callbacks, &fileEntryList, &reader](const std::shared_ptr<FatFileEntry>& fileEntry) {
-            if (fileEntry->IsFolder())
+        const size_t first = folderEntries->second.first;
+        const size_t count = folderEntries->second.second;
+
+        for (size_t i = first; i < first + count; i++)
+        {
+            FatFileEntry& entry((*m_Entries)[i]);
+
+            if (entry.IsFolder())
             {
-                fileEntryList.push_back(fileEntry.get());
+                fileEntryList.push_back(&entry);
             }
 
-            callbacks.m_FileEntryCall(reader, fileEntry->GetFullName().c_str(), fileEntry);
-        });
+            // entries share the ownership of the table
+            callbacks.m_FileEntryCall(
+                reader, entry.GetFullName().c_str(), std::shared_ptr<FatFileEntry>(m_Entries, &entry));
+        }
     }
 
     return S_OK;
@@ -319,7 +363,7 @@ HRESULT FatWalker::ReadRootDirectory(CBinaryBuffer& buffer, DWORD size)
     return S_OK;
 }
 
-HRESULT FatWalker::ReadClusterChain(const FatTable::ClusterChain& clusterChain, CBinaryBuffer& buffer)
+HRESULT FatWalker::ReadClusterRuns(const FatTable::ClusterRuns& clusterRuns, CBinaryBuffer& buffer)
 {
     HRESULT hr = E_FAIL;
     std::shared_ptr<VolumeReader> reader(m_Location->GetReader());
@@ -333,8 +377,12 @@ HRESULT FatWalker::ReadClusterChain(const FatTable::ClusterChain& clusterChain,
     ULONG ulClusterSize = reader->GetBytesPerCluster();
     ULONGLONG offset = 0;
 
+    size_t totalClusters = 0;
+    for (const auto& run : clusterRuns)
+        totalClusters += run.m_Count;
+
     size_t buffer_size = 0;
-    if (!msl::utilities::SafeMultiply(clusterChain.size(), ulClusterSize, buffer_size))
+    if (!msl::utilities::SafeMultiply(totalClusters, ulClusterSize, buffer_size))
         return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
 
     buffer.SetCount(buffer_size);
@@ -342,48 +390,52 @@ HRESULT FatWalker::ReadClusterChain(const FatTable::ClusterChain& clusterChain,
 
     hr = S_OK;
 
-    std::for_each(
-        std::begin(clusterChain),
-        std::end(clusterChain),
-        [this, &hr, ulClusterSize, &offset, &reader, &buffer](const FatTableEntry& entry) {
-            ULONG clusterNumber = 0;
+    // contiguous clusters are read at once
+    CBinaryBuffer localBuffer;
+    for (const auto& run : clusterRuns)
+    {
+        const ULONG clusterNumber = run.m_FirstCluster;
+        const ULONG nbClusters = run.m_Count;
+        const ULONGLONG ullRunSize = (ULONGLONG)nbClusters * (ULONGLONG)ulClusterSize;
+        const ULONGLONG seekOffset =
+            m_ullRootDirectoryOffset + ((ULONGLONG)(clusterNumber - 2) * (ULONGLONG)ulClusterSize);
 
-            if (entry.IsUsed() && (clusterNumber = entry.GetValue()) >= 2)
-            {
-                CBinaryBuffer localBuffer;
-                localBuffer.SetCount(ulClusterSize);
-                ULONGLONG ullBytesRead;
-                ULONGLONG seekOffset =
-                    m_ullRootDirectoryOffset + ((ULONGLONG)(clusterNumber - 2) * (ULONGLONG)ulClusterSize);
+        if (S_OK != (hr = reader->Seek(seekOffset)))
+        {
+            Log::Error(
+                L"Failed to seek to cluster number {} from location {} [{}]",
+                clusterNumber,
+                m_Location->GetLocation(),
+                SystemError(hr));
+            continue;
+        }
 
-                if (S_OK != (hr = reader->Seek(seekOffset)))
-                {
-                    Log::Error(
-                        L"Failed to seek to cluster number {} from location {} [{}]",
-                        clusterNumber,
-                        m_Location->GetLocation(),
-                        SystemError(hr));
-                }
-                else
-                {
-                    if (S_OK
-                        == (hr = reader->Read(localBuffer, ulClusterSize, ullBytesRead)
-                                && ulClusterSize == ullBytesRead))
-                    {
-                        memcpy(buffer.GetData() + offset, localBuffer.GetData(), ulClusterSize);
-                        offset += ulClusterSize;
-                    }
-                    else
-                    {
-                        Log::Error(
-                            L"Failed to read cluster number {} from location {} [{}]",
-                            clusterNumber,
-                            m_Location->GetLocation(),
-                            SystemError(hr));
-                    }
-                }
+        // reader may return less than requested for large runs
+        ULONGLONG ullRunRead = 0;
+        while (ullRunRead < ullRunSize)
+        {
+            ULONGLONG ullBytesRead = 0;
+            if (FAILED(hr = reader->Read(localBuffer, ullRunSize - ullRunRead, ullBytesRead)) || ullBytesRead == 0)
+            {
+                if (SUCCEEDED(hr))
+                    hr = HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+                Log::Error(
+                    L"Failed to read {} clusters from cluster number {} from location {} [{}]",
+                    nbClusters,
+                    clusterNumber,
+                    m_Location->GetLocation(),
+                    SystemError(hr));
+                break;
             }
-        });
+
+            ullBytesRead = std::min(ullBytesRead, ullRunSize - ullRunRead);
+            memcpy(buffer.GetData() + offset + ullRunRead, localBuffer.GetData(), static_cast<size_t>(ullBytesRead));
+            ullRunRead += ullBytesRead;
+        }
+
+        offset += ullRunRead;
+    }
 
     return hr;
 }
@@ -392,7 +444,7 @@ HRESULT FatWalker::ParseFolder(
     const FatTable& fatTable,
     CBinaryBuffer& folder,
     const FatFileEntry* parentFolder,
-    FatFileEntryList& subFolders)
+    FatFileEntries& entries)
 {
     HRESULT hr = E_FAIL;
     LongFilenamesByChecksums longFilenamesByChecksums;
@@ -481,18 +533,44 @@ HRESULT FatWalker::ParseFolder(
             }
 
             fileEntry.m_ParentFolder = parentFolder;
+            entries.push_back(std::move(fileEntry));
+        }
+    }
 
-            PrintFileEntry(fileEntry);
-            FatFileSystem::iterator it = m_FatFS.insert(std::make_shared<FatFileEntry>(fileEntry)).first;
+    return S_OK;
+}
 
-            if (fileEntry.IsFolder())
-            {
-                subFolders.push_back(it->get());
-            }
+void FatWalker::AddFolderEntries(FatFileEntries& entries, FatFileEntryList& subFolders)
+{
+    if (entries.empty())
+        return;
+
+    // entries of a folder are stored together sorted by name, only the first entry with a given name is kept
+    std::stable_sort(std::begin(entries), std::end(entries), [](const FatFileEntry& lhs, const FatFileEntry& rhs) {
+        return lhs.m_Name < rhs.m_Name;
+    });
+
+    entries.erase(
+        std::unique(
+            std::begin(entries),
+            std::end(entries),
+            [](const FatFileEntry& lhs, const FatFileEntry& rhs) { return lhs.m_Name == rhs.m_Name; }),
+        std::end(entries));
+
+    m_FolderEntries.emplace(entries.front().m_ParentFolder, std::make_pair(m_Entries->size(), entries.size()));
+
+    for (auto& fileEntry : entries)
+    {
+        PrintFileEntry(fileEntry);
+        m_Entries->push_back(std::move(fileEntry));
+
+        if (m_Entries->back().IsFolder())
+        {
+            subFolders.push_back(&m_Entries->back());
         }
     }
 
-    return S_OK;
+    entries.clear();
 }
 
 HRESULT FatWalker::ParseFileEntry(
@@ -628,7 +706,7 @@ HRESULT FatWalker::ParseFileEntry(
                 firstCluster = fatFile83->FirstClusterLow2Bytes;
             }
 
-            if (S_OK != fatTable.FillClusterChain(firstCluster, fileEntry.m_ClusterChain))
+            if (S_OK != fatTable.FillClusterRuns(firstCluster, fileEntry.m_ClusterRuns))
             {
                 return E_FAIL;
             }
@@ -637,8 +715,7 @@ HRESULT FatWalker::ParseFileEntry(
             fileEntry.m_ulSize = fatFile83->FileSize;
 
             // now we can update the map of segments for this file entry
-            // I assume here that the reader object is not null
-            fileEntry.FillSegmentDetailsMap(m_ullRootDirectoryOffset, m_Location->GetReader()->GetBytesPerCluster());
+            fileEntry.FillSegmentDetailsMap(m_ullRootDirectoryOffset, m_ulClusterSize);
 
             // times
             DosDateTimeToFileTime(fatFile83->CreationDate, fatFile83->CreationTime, &fileEntry.m_CreationTime);
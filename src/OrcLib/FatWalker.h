@@ -12,12 +12,14 @@
 #include "FatTable.h"
 #include "FatFileEntry.h"
 #include "FatDataStructures.h"
-#include "FileSystem.h"
 
+#include <deque>
 #include <list>
 #include <set>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #pragma managed(push, off)
 
@@ -59,19 +61,28 @@ public:
     typedef std::pair<const FatFileEntry*, const FatFileEntry*> ParentFolderAndSubFolder;
     typedef std::list<ParentFolderAndSubFolder> SubFolderList;
     typedef std::list<const FatFileEntry*> FatFileEntryList;
+    typedef std::vector<FatFileEntry> FatFileEntries;
     typedef std::set<DWORD> ParsedClusterSet;
     typedef std::vector<LongFilename> LongFilenameList;
     typedef std::map<UCHAR, LongFilenameList> LongFilenamesByChecksums;
 
 private:
+    struct FolderToParse
+    {
+        const FatFileEntry* m_Folder = nullptr;
+        CBinaryBuffer m_Buffer;
+        FatFileEntries m_Entries;
+    };
+
     HRESULT ReadRootDirectory(CBinaryBuffer& buffer, DWORD size);
-    HRESULT ReadClusterChain(const FatTable::ClusterChain& clusterChain, CBinaryBuffer& buffer);
+    HRESULT ReadClusterRuns(const FatTable::ClusterRuns& clusterRuns, CBinaryBuffer& buffer);
 
     HRESULT ParseFolder(
         const FatTable& fatTable,
         CBinaryBuffer& folder,
         const FatFileEntry* parentFolder,
-        FatFileEntryList& subFolders);
+        FatFileEntries& entries);
+    void AddFolderEntries(FatFileEntries& entries, FatFileEntryList& subFolders);
     HRESULT ParseFileEntry(
         const FatTable& fatTable,
         GenFatFile* genFatFile,
@@ -92,13 +103,13 @@ private:
     std::shared_ptr<Location> m_Location;
     CBinaryBuffer m_RootDirectoryBuffer;
     ULONGLONG m_ullRootDirectoryOffset;
+    ULONG m_ulClusterSize;
     bool m_bResurrectRecords;
 
-    FatFileSystem m_FatFS;
+    // flat table of the entries, those of a folder are contiguous and sorted by name
+    std::shared_ptr<std::deque<FatFileEntry>> m_Entries;
+    std::unordered_map<const FatFileEntry*, std::pair<size_t, size_t>> m_FolderEntries;  // first entry and count
     const FatFileEntry* m_RootFolder = nullptr;
-
-    FatFileSystemByName& m_FatFSByName = m_FatFS;
-    FatFileSystemBySize& m_FatFSBySize = boost::multi_index::get<1>(m_FatFS);
 };  // FatWalker
 
 }  // namespace Orc
@@ -2874,31 +2874,60 @@ std::pair<Orc::FileFind::SearchTerm::Criteria, std::optional<MatchingRuleCollect
             Log::Debug("Failed to yara scan data attribute [{}]", SystemError(hr));
             return {SearchTerm::Criteria::NONE, std::nullopt};
         }
-        if (!matchingRules.empty())
+        return MatchYara(aTerm, matchingRules);
+    }
+    return {matchedSpec, std::nullopt};
+}
+
+std::pair<Orc::FileFind::SearchTerm::Criteria, std::optional<MatchingRuleCollection>>
+Orc::FileFind::MatchYara(const std::shared_ptr<SearchTerm>& aTerm, const MatchingRuleCollection& matchingRules) const
+{
+    if (!matchingRules.empty())
+    {
+        if (!aTerm->YaraRules.empty())
         {
-            if (!aTerm->YaraRules.empty())
+            for (const auto& termRule : aTerm->YaraRules)
             {
-                for (const auto& termRule : aTerm->YaraRules)
+                for (const auto& matchingRule : matchingRules)
                 {
-                    for (const auto& matchingRule : matchingRules)
+                    if (PathMatchSpecA(matchingRule.c_str(), termRule.c_str()))
                     {
-                        if (PathMatchSpecA(matchingRule.c_str(), termRule.c_str()))
-                        {
-                            return {
-                                SearchTerm::Criteria::YARA,
-                                matchingRules};  // With the first matchingRule in the rules spec, we have a winner
-                        }
+                        return {
+                            SearchTerm::Criteria::YARA,
+                            matchingRules};  // With the first matchingRule in the rules spec, we have a winner
                     }
                 }
-                return {
-                    SearchTerm::Criteria::NONE,
-                    std::nullopt};  // the stream matched more than one rule but not the specified one
             }
-            else
-                return {SearchTerm::Criteria::YARA, std::nullopt};
+            return {
+                SearchTerm::Criteria::NONE,
+                std::nullopt};  // the stream matched more than one rule but not the specified one
         }
+        else
+            return {SearchTerm::Criteria::YARA, std::nullopt};
     }
-    return {matchedSpec, std::nullopt};
+    return {SearchTerm::Criteria::NONE, std::nullopt};
+}
+
+std::shared_ptr<YaraScanJob> FileFind::SubmitYaraScan(const std::shared_ptr<DataAttribute>& pDataAttr) const
+{
+    // several terms may require the yara rules of the same data: it is scanned once per record
+    auto scanned = std::find_if(begin(m_RecordYaraScans), end(m_RecordYaraScans), [&pDataAttr](const auto& scan) {
+        return scan.first == pDataAttr.get();
+    });
+    if (scanned != end(m_RecordYaraScans))
+        return scanned->second;
+
+    // the worker reads its own stream: the attribute's one is still used by this thread
+    std::shared_ptr<ByteStream> rawStream, dataStream;
+    if (HRESULT hr = pDataAttr->OpenStreams(m_pVolReader, rawStream, dataStream); FAILED(hr))
+    {
+        Log::Debug("Failed to open data attribute for yara scan [{}]", SystemError(hr));
+        return nullptr;
+    }
+
+    auto job = m_YaraScanService->Submit(std::move(dataStream));
+    m_RecordYaraScans.emplace_back(pDataAttr.get(), job);
+    return job;
 }
 
 FileFind::SearchTerm::Criteria FileFind::MatchHeader(
@@ -3041,6 +3070,7 @@ FileFind::SearchTerm::Criteria FileFind::AddMatchingData(
     {
         auto matchedDataSpecs = SearchTerm::Criteria::NONE;
         MatchingRuleCollection matchedRules;
+        std::shared_ptr<YaraScanJob> yaraJob;
 
         auto dataStream = data_attr->GetDataStream(m_pVolReader);
         if (dataStream == nullptr)
@@ -3084,12 +3114,23 @@ FileFind::SearchTerm::Criteria FileFind::AddMatchingData(
         }
         if (requiredDataSpecs & SearchTerm::Criteria::YARA)
         {
-            auto [aSpec, matched] = MatchYara(aTerm, data_attr);
-            if (matched.has_value())
-                std::swap(matchedRules, matched.value());
-            if (aSpec == SearchTerm::Criteria::NONE)
-                continue;
-            matchedDataSpecs |= aSpec;
+            if (m_YaraScanService)
+            {
+                // the criteria is assumed until the scan completes the match
+                yaraJob = SubmitYaraScan(data_attr);
+                if (yaraJob == nullptr)
+                    continue;
+                matchedDataSpecs |= SearchTerm::Criteria::YARA;
+            }
+            else
+            {
+                auto [aSpec, matched] = MatchYara(aTerm, data_attr);
+                if (matched.has_value())
+                    std::swap(matchedRules, matched.value());
+                if (aSpec == SearchTerm::Criteria::NONE)
+                    continue;
+                matchedDataSpecs |= aSpec;
+            }
         }
         if (matchedDataSpecs == requiredSpec)
         {
@@ -3097,6 +3138,12 @@ FileFind::SearchTerm::Criteria FileFind::AddMatchingData(
                 aFileMatch = std::make_shared<Match>(
                     m_pVolReader, aTerm, pElt->GetFileReferenceNumber(), !pElt->IsRecordInUse());
 
+            const auto IsDataAttr = [&data_attr](const Match::AttributeMatch& attrMatch) {
+                return attrMatch.Type == data_attr->TypeCode() && attrMatch.InstanceID == data_attr->Header()->Instance;
+            };
+            const bool bMatchedBefore =
+                std::any_of(begin(aFileMatch->MatchingAttributes), end(aFileMatch->MatchingAttributes), IsDataAttr);
+
             data_attr->GetHashInformation(m_pVolReader, m_MatchHash);
 
             if (m_bProvideStream)
@@ -3104,6 +3151,17 @@ FileFind::SearchTerm::Criteria FileFind::AddMatchingData(
             else
                 aFileMatch->AddAttributeMatch(data_attr, std::move(matchedRules));
 
+            if (yaraJob != nullptr)
+            {
+                auto attrMatch =
+                    std::find_if(begin(aFileMatch->MatchingAttributes), end(aFileMatch->MatchingAttributes), IsDataAttr);
+                if (attrMatch != end(aFileMatch->MatchingAttributes))
+                {
+                    attrMatch->PendingYara = yaraJob;
+                    attrMatch->MatchedBeforeYara = bMatchedBefore;
+                }
+            }
+
             retval = requiredSpec;
         }
     }
@@ -3589,11 +3647,232 @@ HRESULT FileFind::EvaluateMatchCallCallback(
     return S_OK;
 }
 
+HRESULT FileFind::StartYaraScanService()
+{
+    if (!m_YaraScan || m_YaraScan->Config().scanWorkers() == 0L)
+        return S_OK;
+
+    // excluding a match on its data needs the record, which is gone once the match is completed
+    const auto DependsOnData = [](const auto& aPair) { return aPair.second->DependsOnData(); };
+    if (std::any_of(begin(m_ExcludeNameTerms), end(m_ExcludeNameTerms), DependsOnData)
+        || std::any_of(begin(m_ExcludePathTerms), end(m_ExcludePathTerms), DependsOnData)
+        || std::any_of(begin(m_ExcludeSizeTerms), end(m_ExcludeSizeTerms), DependsOnData)
+        || std::any_of(begin(m_ExcludeTerms), end(m_ExcludeTerms), [](const std::shared_ptr<SearchTerm>& aTerm) {
+               return aTerm->DependsOnData();
+           }))
+    {
+        Log::Debug("Exclusion terms depend on data, yara scans are not run on workers");
+        return S_OK;
+    }
+
+    YaraScanService::Options options;
+    options.dwWorkers = m_YaraScan->Config().scanWorkers();
+
+    m_YaraScanService = std::make_unique<YaraScanService>(*m_YaraScan, options);
+    if (m_YaraScanService->GetWorkers() == 0L)
+    {
+        Log::Warn("Failed to start yara scan workers, yara scans are run inline");
+        m_YaraScanService.reset();
+        return S_OK;
+    }
+
+    m_dwMaxPendingMatches = 256 * m_YaraScanService->GetWorkers();
+    return S_OK;
+}
+
+void FileFind::StopYaraScanService()
+{
+    m_RecordYaraScans.clear();
+    m_PendingMatches.clear();
+    m_YaraScanService.reset();
+}
+
+HRESULT FileFind::QueueMatch(
+    FileFind::FoundMatchCallback aCallback,
+    bool& bStop,
+    const std::shared_ptr<Match>& aMatch)
+{
+    if (!m_YaraScanService)
+        return EvaluateMatchCallCallback(aCallback, bStop, aMatch);
+
+    // every match is queued, even those not waiting for a scan, to keep the order they were found in
+    m_PendingMatches.push_back(aMatch);
+
+    return CompletePendingMatches(aCallback, bStop, false);
+}
+
+HRESULT FileFind::CompletePendingMatches(FileFind::FoundMatchCallback aCallback, bool& bStop, bool bFlush)
+{
+    HRESULT hr = E_FAIL;
+
+    const auto IsComplete = [](const std::shared_ptr<Match>& aMatch) {
+        return std::all_of(
+            begin(aMatch->MatchingAttributes),
+            end(aMatch->MatchingAttributes),
+            [](const Match::AttributeMatch& attrMatch) {
+                return attrMatch.PendingYara == nullptr || attrMatch.PendingYara->IsDone();
+            });
+    };
+
+    // past the queue's limit, the oldest match is waited for
+    while (!m_PendingMatches.empty()
+           && (bFlush || m_PendingMatches.size() > m_dwMaxPendingMatches || IsComplete(m_PendingMatches.front())))
+    {
+        auto aMatch = std::move(m_PendingMatches.front());
+        m_PendingMatches.pop_front();
+
+        // once stopped, the matches still pending are dropped
+        if (bStop)
+            continue;
+
+        if (FAILED(hr = CompleteYaraMatch(aMatch)))
+            return hr;
+        if (hr == S_FALSE)
+            continue;
+
+        if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, aMatch)))
+            return hr;
+    }
+    return S_OK;
+}
+
+HRESULT FileFind::CompleteYaraMatch(const std::shared_ptr<Match>& aMatch)
+{
+    bool bPending = false;
+    bool bMatched = false;
+
+    for (auto it = begin(aMatch->MatchingAttributes); it != end(aMatch->MatchingAttributes);)
+    {
+        auto job = std::move(it->PendingYara);
+        if (job == nullptr)
+        {
+            ++it;
+            continue;
+        }
+
+        bPending = true;
+
+        std::optional<MatchingRuleCollection> matchedRules;
+        auto aSpec = SearchTerm::Criteria::NONE;
+
+        if (HRESULT hr = job->Wait(); FAILED(hr))
+            Log::Debug("Failed to yara scan data attribute [{}]", SystemError(hr));
+        else
+            std::tie(aSpec, matchedRules) = MatchYara(aMatch->Term, job->MatchingRules());
+
+        if (aSpec == SearchTerm::Criteria::NONE)
+        {
+            if (it->MatchedBeforeYara)
+                ++it;
+            else
+                it = aMatch->MatchingAttributes.erase(it);
+            continue;
+        }
+
+        bMatched = true;
+        if (matchedRules.has_value())
+        {
+            if (it->YaraRules.has_value())
+                it->YaraRules.value().insert(
+                    end(it->YaraRules.value()), begin(matchedRules.value()), end(matchedRules.value()));
+            else
+                std::swap(it->YaraRules, matchedRules);
+        }
+        ++it;
+    }
+
+    // a term requiring yara rules matches if the data of at least one attribute matched them
+    if (bPending && !bMatched)
+    {
+        Log::Debug(L"Match did not match the yara rules of '{}'", aMatch->Term->GetDescription());
+        return S_FALSE;
+    }
+    return S_OK;
+}
+
+HRESULT FileFind::CompileNameMatcher()
+{
+    HRESULT hr = E_FAIL;
+
+    m_NameMatcher.Clear();
+    m_TermNamePatterns.assign(m_Terms.size(), MultiPatternMatcher::NoPattern);
+
+    for (size_t i = 0; i < m_Terms.size(); i++)
+    {
+        const auto& aTerm = m_Terms[i];
+
+        // any name matching the term contains this literal
+        std::wstring strLiteral;
+        if (aTerm->Required & SearchTerm::Criteria::NAME_REGEX)
+            strLiteral = MultiPatternMatcher::RequiredLiteralOfRegex(aTerm->FileName);
+        else if (aTerm->Required & SearchTerm::Criteria::NAME_MATCH)
+            strLiteral = MultiPatternMatcher::RequiredLiteralOfSpec(aTerm->FileName);
+        else if (aTerm->Required & SearchTerm::Criteria::NAME_EXACT)
+            strLiteral = aTerm->FileName;
+
+        m_TermNamePatterns[i] = m_NameMatcher.AddPattern(strLiteral);
+    }
+
+    if (FAILED(hr = m_NameMatcher.Compile()))
+    {
+        Log::Warn("Failed to compile file name patterns, terms will not be pre-filtered [{}]", SystemError(hr));
+        m_NameMatcher.Clear();
+        m_TermNamePatterns.assign(m_Terms.size(), MultiPatternMatcher::NoPattern);
+    }
+
+    m_NamePatternHits.assign(m_NameMatcher.PatternCount(), 0L);
+    m_ulNameScan = 0L;
+
+    Log::Debug(
+        "{} of {} search terms are pre-filtered on {} name literal(s)",
+        std::count_if(
+            begin(m_TermNamePatterns),
+            end(m_TermNamePatterns),
+            [](ULONG ulPattern) { return ulPattern != MultiPatternMatcher::NoPattern; }),
+        m_Terms.size(),
+        m_NameMatcher.PatternCount());
+    return S_OK;
+}
+
+void FileFind::ScanNames(const PFILE_NAME* pFileNames, size_t count)
+{
+    if (m_NameMatcher.empty())
+        return;
+
+    if (++m_ulNameScan == 0L)
+    {
+        // wrapped around, hits of older scans must be forgotten
+        std::fill(begin(m_NamePatternHits), end(m_NamePatternHits), 0L);
+        m_ulNameScan = 1L;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pFileNames[i] == nullptr)
+            continue;
+
+        m_NameMatcher.Scan(pFileNames[i]->FileName, pFileNames[i]->FileNameLength, [this](ULONG ulPattern) {
+            m_NamePatternHits[ulPattern] = m_ulNameScan;
+        });
+    }
+}
+
+bool FileFind::IsNameCandidate(size_t termIndex) const
+{
+    if (termIndex >= m_TermNamePatterns.size())
+        return true;
+
+    const ULONG ulPattern = m_TermNamePatterns[termIndex];
+    return ulPattern == MultiPatternMatcher::NoPattern || m_NamePatternHits[ulPattern] == m_ulNameScan;
+}
+
 HRESULT FileFind::FindMatch(MFTRecord* pElt, bool& bStop, FileFind::FoundMatchCallback aCallback)
 {
     HRESULT hr = E_FAIL;
     shared_ptr<FileFind::Match> retval;
 
+    m_RecordYaraScans.clear();
+
     if (!m_ExactNameTerms.empty() || (!m_ExactPathTerms.empty() && m_FullNameBuilder != nullptr))
     {
         auto& names = pElt->GetFileNames();
@@ -3620,7 +3899,7 @@ HRESULT FileFind::FindMatch(MFTRecord* pElt, bool& bStop, FileFind::FoundMatchCa
                     if (matched != SearchTerm::Criteria::NONE)
                     {
                         // we do have a match!
-                        if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, retval)))
+                        if (FAILED(hr = QueueMatch(aCallback, bStop, retval)))
                             return hr;
                         retval.reset();
                     }
@@ -3641,7 +3920,7 @@ HRESULT FileFind::FindMatch(MFTRecord* pElt, bool& bStop, FileFind::FoundMatchCa
                     if (matched != SearchTerm::Criteria::NONE)
                     {
                         // we do have a match!
-                        if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, retval)))
+                        if (FAILED(hr = QueueMatch(aCallback, bStop, retval)))
                             return hr;
                         retval.reset();
                     }
@@ -3674,7 +3953,7 @@ HRESULT FileFind::FindMatch(MFTRecord* pElt, bool& bStop, FileFind::FoundMatchCa
                 if (matched != SearchTerm::Criteria::NONE)
                 {
                     // we do have a match!
-                    if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, retval)))
+                    if (FAILED(hr = QueueMatch(aCallback, bStop, retval)))
                         return hr;
                     retval.reset();
                 }
@@ -3684,13 +3963,19 @@ HRESULT FileFind::FindMatch(MFTRecord* pElt, bool& bStop, FileFind::FoundMatchCa
         }
     }
 
-    for (auto term_it : m_Terms)
+    // all the names of the record are scanned once for the literals of every term
+    ScanNames(pElt->GetFileNames().data(), pElt->GetFileNames().size());
+
+    for (size_t i = 0; i < m_Terms.size(); i++)
     {
-        auto matched = LookupTermInRecordAddMatching(term_it, SearchTerm::Criteria::NONE, retval, pElt);
+        if (!IsNameCandidate(i))
+            continue;
+
+        auto matched = LookupTermInRecordAddMatching(m_Terms[i], SearchTerm::Criteria::NONE, retval, pElt);
         if (matched != SearchTerm::Criteria::NONE)
         {
             // we do have a match!
-            if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, retval)))
+            if (FAILED(hr = QueueMatch(aCallback, bStop, retval)))
                 return hr;
             retval.reset();
         }
@@ -3722,7 +4007,7 @@ HRESULT FileFind::FindI30Match(const PFILE_NAME pFileName, bool& bStop, FileFind
 
             if (matched != SearchTerm::Criteria::NONE)
             {
-                if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, retval)))
+                if (FAILED(hr = QueueMatch(aCallback, bStop, retval)))
                     return hr;
                 retval.reset();
             }
@@ -3743,7 +4028,7 @@ HRESULT FileFind::FindI30Match(const PFILE_NAME pFileName, bool& bStop, FileFind
             if (matched != SearchTerm::Criteria::NONE)
             {
                 // we do have a match!
-                if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, retval)))
+                if (FAILED(hr = QueueMatch(aCallback, bStop, retval)))
                     return hr;
                 retval.reset();
             }
@@ -3751,13 +4036,18 @@ HRESULT FileFind::FindI30Match(const PFILE_NAME pFileName, bool& bStop, FileFind
                 retval->Reset();
         }
     }
-    for (auto term_it = begin(m_Terms); term_it != end(m_Terms); ++term_it)
+    ScanNames(&pFileName, 1);
+
+    for (size_t i = 0; i < m_Terms.size(); i++)
     {
-        auto matched = LookupTermIn$I30AddMatching(*term_it, SearchTerm::Criteria::NONE, retval, pFileName);
+        if (!IsNameCandidate(i))
+            continue;
+
+        auto matched = LookupTermIn$I30AddMatching(m_Terms[i], SearchTerm::Criteria::NONE, retval, pFileName);
         if (matched != SearchTerm::Criteria::NONE)
         {
             // we do have a match!
-            if (FAILED(hr = EvaluateMatchCallCallback(aCallback, bStop, retval)))
+            if (FAILED(hr = QueueMatch(aCallback, bStop, retval)))
                 return hr;
             retval.reset();
         }
@@ -3928,9 +4218,15 @@ HRESULT FileFind::Find(const LocationSet& locations, FileFind::FoundMatchCallbac
 
     m_NeededHash = GetNeededHashAlgorithms();
 
+    if (FAILED(hr = CompileNameMatcher()))
+        return hr;
+
     if (FAILED(hr = InitializeYara()))
         return hr;
 
+    if (FAILED(hr = StartYaraScanService()))
+        return hr;
+
     for (const auto& aLoc : locs)
     {
         HRESULT hr = E_FAIL;
@@ -4027,9 +4323,17 @@ HRESULT FileFind::Find(const LocationSet& locations, FileFind::FoundMatchCallbac
                 Log::Debug(L"Done!");
                 walk.Statistics(L"Done");
             }
+
+            // the matches of this volume still waiting for their scans
+            if (FAILED(hr = CompletePendingMatches(aCallback, bStop, true)))
+            {
+                Log::Error(
+                    L"Failed to complete pending matches of volume '{}' [{}]", aLoc->GetLocation(), SystemError(hr));
+            }
         }
     }
 
+    StopYaraScanService();
     return S_OK;
 }
 
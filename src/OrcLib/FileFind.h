@@ -19,7 +19,10 @@
 #include "LocationSet.h"
 #include "TableOutput.h"
 #include "YaraScanner.h"
+#include "YaraScanService.h"
+#include "MultiPatternMatcher.h"
 
+#include <deque>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -243,6 +246,7 @@ public:
 
         public:
             AttributeMatch(AttributeMatch&& other) noexcept = default;
+            AttributeMatch& operator=(AttributeMatch&& other) noexcept = default;
 
             ATTRIBUTE_TYPE_CODE Type;
             USHORT InstanceID;
@@ -253,6 +257,11 @@ public:
             std::shared_ptr<ByteStream> RawStream;
             CBinaryBuffer MD5, SHA1, SHA256;
             std::optional<MatchingRuleCollection> YaraRules;
+
+        private:
+            // Yara criteria evaluated by the scan service: the attribute matches once the job found a term's rule
+            std::shared_ptr<YaraScanJob> PendingYara;
+            bool MatchedBeforeYara = false;  // matched another criteria, kept whatever the scan finds
         };
 
         Match(Match&& other) noexcept = default;
@@ -395,6 +404,12 @@ private:
 
     std::vector<std::shared_ptr<SearchTerm>> m_AllTerms;
 
+    // Name pre-filter of m_Terms: the literal each term's names must contain, all searched in one pass per name
+    MultiPatternMatcher m_NameMatcher;
+    std::vector<ULONG> m_TermNamePatterns;  // m_Terms index -> pattern id, NoPattern if the term cannot be filtered
+    std::vector<ULONG> m_NamePatternHits;  // pattern id -> last name scan where it was found
+    ULONG m_ulNameScan = 0L;
+
     static std::wregex& DOSPattern();
     static std::wregex& RegexPattern();
     static std::wregex& RegexOnlyPattern();
@@ -407,6 +422,13 @@ private:
 
     std::unique_ptr<YaraScanner> m_YaraScan;
 
+    // Yara scans of the data matching a term's other criteria run on the service's workers during a Find. Matches
+    // wait for their scans in m_PendingMatches and are completed in the order they were found.
+    std::unique_ptr<YaraScanService> m_YaraScanService;
+    std::deque<std::shared_ptr<Match>> m_PendingMatches;
+    DWORD m_dwMaxPendingMatches = 0L;
+    mutable std::vector<std::pair<const MftRecordAttribute*, std::shared_ptr<YaraScanJob>>> m_RecordYaraScans;
+
     std::vector<std::shared_ptr<Match>> m_Matches;
 
     bool m_bProvideStream = false;
@@ -503,6 +525,9 @@ private:
     MatchContains(const std::shared_ptr<SearchTerm>& aTerm, const std::shared_ptr<DataAttribute>& pDataAttr) const;
     std::pair<SearchTerm::Criteria, std::optional<MatchingRuleCollection>>
     MatchYara(const std::shared_ptr<SearchTerm>& aTerm, const std::shared_ptr<DataAttribute>& pDataAttr) const;
+    std::pair<SearchTerm::Criteria, std::optional<MatchingRuleCollection>>
+    MatchYara(const std::shared_ptr<SearchTerm>& aTerm, const MatchingRuleCollection& matchingRules) const;
+    std::shared_ptr<YaraScanJob> SubmitYaraScan(const std::shared_ptr<DataAttribute>& pDataAttr) const;
 
     SearchTerm::Criteria AddMatchingData(
         const std::shared_ptr<SearchTerm>& aTerm,
@@ -570,6 +595,17 @@ private:
 
     HRESULT ExcludeMatch(const std::shared_ptr<Match>& aMatch);
 
+    HRESULT StartYaraScanService();
+    void StopYaraScanService();
+
+    HRESULT QueueMatch(FileFind::FoundMatchCallback aCallback, bool& bStop, const std::shared_ptr<Match>& aMatch);
+    HRESULT CompletePendingMatches(FileFind::FoundMatchCallback aCallback, bool& bStop, bool bFlush);
+    HRESULT CompleteYaraMatch(const std::shared_ptr<Match>& aMatch);
+
+    HRESULT CompileNameMatcher();
+    void ScanNames(const PFILE_NAME* pFileNames, size_t count);
+    bool IsNameCandidate(size_t termIndex) const;
+
     HRESULT FindMatch(MFTRecord* pElt, bool& bStop, FileFind::FoundMatchCallback aCallback);
 
     HRESULT FindI30Match(const PFILE_NAME pFileName, bool& bStop, FileFind::FoundMatchCallback aCallback);
@@ -12,6 +12,7 @@
 
 #include "CryptoHashStream.h"
 #include "FuzzyHashStream.h"
+#include "HashingService.h"
 #include "MemoryStream.h"
 
 #include "VolumeReader.h"
@@ -30,6 +31,32 @@
 
 using namespace Orc;
 
+namespace {
+
+CryptoHashStream::Algorithm CryptoAlgorithms(Intentions localIntentions)
+{
+    CryptoHashStream::Algorithm crypto_algs = CryptoHashStream::Algorithm::Undefined;
+    if (HasFlag(localIntentions, Intentions::FILEINFO_MD5))
+        crypto_algs |= CryptoHashStream::Algorithm::MD5;
+    if (HasFlag(localIntentions, Intentions::FILEINFO_SHA1))
+        crypto_algs |= CryptoHashStream::Algorithm::SHA1;
+    if (HasFlag(localIntentions, Intentions::FILEINFO_SHA256))
+        crypto_algs |= CryptoHashStream::Algorithm::SHA256;
+    return crypto_algs;
+}
+
+FuzzyHashStream::Algorithm FuzzyAlgorithms(Intentions localIntentions)
+{
+    FuzzyHashStream::Algorithm fuzzy_algs = FuzzyHashStream::Algorithm::Undefined;
+    if (HasFlag(localIntentions, Intentions::FILEINFO_SSDEEP))
+        fuzzy_algs |= FuzzyHashStream::Algorithm::SSDeep;
+    if (HasFlag(localIntentions, Intentions::FILEINFO_TLSH))
+        fuzzy_algs |= FuzzyHashStream::Algorithm::TLSH;
+    return fuzzy_algs;
+}
+
+}  // namespace
+
 const WCHAR* FileInfo::g_pszExecutableFileExtensions[] = {
     L".COM", L".DLL", L".CPL", L".OCX", L".SYS", L".DRV", L".FON", L".TLB", L".EXE", L".PIF", L".APP", L".PRF", L".MSI",
     L".MSP", L".CHM", L".HLP", L".SCR", L".MDB", L".WMA", L".WMV", L".MP3", L".AX",  L".ACM", L".ANI", L".ANR", NULL};
@@ -257,6 +284,28 @@ HRESULT FileInfo::WriteFileInformation(
     const ColumnNameDef columnNames[],
     ITableOutput& output,
     const std::vector<Filter>& filters)
+{
+    if (m_pHashingService == nullptr || &output != &m_pHashingService->GetOutput())
+        return WriteColumns(columnNames, output, filters);
+
+    // Rows are written in order: once one waits for its hashes, the following ones wait too
+    if (SubmitHash() != S_OK && !m_pHashingService->HasPendingRows())
+        return WriteColumns(columnNames, output, filters);
+
+    auto row = m_pHashingService->NewRow();
+
+    HRESULT hr = WriteColumns(columnNames, *row, filters);
+    m_HashJob.reset();
+
+    if (HRESULT hrPush = m_pHashingService->Push(std::move(row)); FAILED(hrPush))
+        return hrPush;
+    return hr;
+}
+
+HRESULT FileInfo::WriteColumns(
+    const ColumnNameDef columnNames[],
+    ITableOutput& output,
+    const std::vector<Filter>& filters)
 {
     HRESULT hr = E_FAIL;
 
@@ -540,6 +589,50 @@ HRESULT FileInfo::CheckHash()
     return OpenHash();
 }
 
+HRESULT FileInfo::SubmitHash()
+{
+    Intentions localIntentions = FilterIntentions(m_Filters);
+
+    if (!HasAnyFlag(
+            localIntentions,
+            Intentions::FILEINFO_MD5 | Intentions::FILEINFO_SHA1 | Intentions::FILEINFO_SHA256
+                | Intentions::FILEINFO_SSDEEP | Intentions::FILEINFO_TLSH))
+        return S_FALSE;
+
+    // PE hashes and authenticode share the file's hashing pass, they are computed inline
+    if (HasAnyFlag(
+            localIntentions,
+            Intentions::FILEINFO_PE_MD5 | Intentions::FILEINFO_PE_SHA1 | Intentions::FILEINFO_PE_SHA256
+                | Intentions::FILEINFO_AUTHENTICODE_STATUS | Intentions::FILEINFO_AUTHENTICODE_SIGNER
+                | Intentions::FILEINFO_AUTHENTICODE_SIGNER_THUMBPRINT | Intentions::FILEINFO_AUTHENTICODE_CA
+                | Intentions::FILEINFO_AUTHENTICODE_CA_THUMBPRINT | Intentions::FILEINFO_SIGNED_HASH))
+        return S_FALSE;
+
+    if (IsDirectory())
+        return S_FALSE;
+
+    const auto& details = GetDetails();
+    if (details == nullptr || details->HashChecked() || details->HashAvailable())
+        return S_FALSE;
+
+    const auto crypto_algs = CryptoAlgorithms(localIntentions);
+    const auto fuzzy_algs = FuzzyAlgorithms(localIntentions);
+
+    if (const auto& job = details->GetHashJob(); job != nullptr && job->Covers(crypto_algs, fuzzy_algs))
+    {
+        m_HashJob = job;
+        return S_OK;
+    }
+
+    auto stream = GetHashingStream();
+    if (stream == nullptr)
+        return S_FALSE;
+
+    m_HashJob = m_pHashingService->Submit(std::move(stream), crypto_algs, fuzzy_algs);
+    details->SetHashJob(m_HashJob);
+    return S_OK;
+}
+
 HRESULT FileInfo::OpenHash()
 {
     HRESULT hr = E_FAIL;
@@ -712,19 +805,8 @@ HRESULT FileInfo::OpenCryptoAndFuzzyHash(Intentions localIntentions)
     if (GetDetails()->HashAvailable())
         return S_OK;
 
-    CryptoHashStream::Algorithm crypto_algs = CryptoHashStream::Algorithm::Undefined;
-    if (HasFlag(localIntentions, Intentions::FILEINFO_MD5))
-        crypto_algs |= CryptoHashStream::Algorithm::MD5;
-    if (HasFlag(localIntentions, Intentions::FILEINFO_SHA1))
-        crypto_algs |= CryptoHashStream::Algorithm::SHA1;
-    if (HasFlag(localIntentions, Intentions::FILEINFO_SHA256))
-        crypto_algs |= CryptoHashStream::Algorithm::SHA256;
-
-    FuzzyHashStream::Algorithm fuzzy_algs = FuzzyHashStream::Algorithm::Undefined;
-    if (HasFlag(localIntentions, Intentions::FILEINFO_SSDEEP))
-        fuzzy_algs |= FuzzyHashStream::Algorithm::SSDeep;
-    if (HasFlag(localIntentions, Intentions::FILEINFO_TLSH))
-        fuzzy_algs |= FuzzyHashStream::Algorithm::TLSH;
+    const auto crypto_algs = CryptoAlgorithms(localIntentions);
+    const auto fuzzy_algs = FuzzyAlgorithms(localIntentions);
 
     auto stream = GetDetails()->GetDataStream();
 
@@ -1308,6 +1390,9 @@ HRESULT FileInfo::WritePeSHA256(ITableOutput& output)
 
 HRESULT FileInfo::WriteMD5(ITableOutput& output)
 {
+    if (m_HashJob != nullptr)
+        return WriteDeferredHash(output, Intentions::FILEINFO_MD5);
+
     HRESULT hr = E_FAIL;
 
     if (FAILED(hr = CheckHash()))
@@ -1321,6 +1406,9 @@ HRESULT FileInfo::WriteMD5(ITableOutput& output)
 
 HRESULT FileInfo::WriteSHA1(ITableOutput& output)
 {
+    if (m_HashJob != nullptr)
+        return WriteDeferredHash(output, Intentions::FILEINFO_SHA1);
+
     HRESULT hr = E_FAIL;
     if (FAILED(hr = CheckHash()))
     {
@@ -1334,6 +1422,9 @@ HRESULT FileInfo::WriteSHA1(ITableOutput& output)
 
 HRESULT FileInfo::WriteSHA256(ITableOutput& output)
 {
+    if (m_HashJob != nullptr)
+        return WriteDeferredHash(output, Intentions::FILEINFO_SHA256);
+
     HRESULT hr = E_FAIL;
     if (FAILED(hr = CheckHash()))
     {
@@ -1347,6 +1438,9 @@ HRESULT FileInfo::WriteSHA256(ITableOutput& output)
 HRESULT FileInfo::WriteSSDeep(ITableOutput& output)
 {
 #ifdef ORC_BUILD_SSDEEP
+    if (m_HashJob != nullptr)
+        return WriteDeferredHash(output, Intentions::FILEINFO_SSDEEP);
+
     HRESULT hr = E_FAIL;
     if (FAILED(hr = CheckHash()))
     {
@@ -1362,6 +1456,9 @@ HRESULT FileInfo::WriteSSDeep(ITableOutput& output)
 
 HRESULT FileInfo::WriteTLSH(ITableOutput& output)
 {
+    if (m_HashJob != nullptr)
+        return WriteDeferredHash(output, Intentions::FILEINFO_TLSH);
+
     HRESULT hr = E_FAIL;
     if (FAILED(hr = CheckHash()))
     {
@@ -1372,6 +1469,31 @@ HRESULT FileInfo::WriteTLSH(ITableOutput& output)
     return output.WriteString(GetDetails()->TLSH());
 }
 
+HRESULT FileInfo::WriteDeferredHash(ITableOutput& output, Intentions intention)
+{
+    auto row = dynamic_cast<HashingService::Row*>(&output);
+    if (row == nullptr)
+        return E_UNEXPECTED;
+
+    return row->Defer(m_HashJob, [job = m_HashJob, intention](ITableOutput& deferred) -> HRESULT {
+        switch (intention)
+        {
+            case Intentions::FILEINFO_MD5:
+                return job->MD5().GetCount() > 0 ? deferred.WriteBytes(job->MD5()) : deferred.WriteNothing();
+            case Intentions::FILEINFO_SHA1:
+                return job->SHA1().GetCount() > 0 ? deferred.WriteBytes(job->SHA1()) : deferred.WriteNothing();
+            case Intentions::FILEINFO_SHA256:
+                return job->SHA256().GetCount() > 0 ? deferred.WriteBytes(job->SHA256()) : deferred.WriteNothing();
+            case Intentions::FILEINFO_SSDEEP:
+                return deferred.WriteString(job->SSDeep());
+            case Intentions::FILEINFO_TLSH:
+                return deferred.WriteString(job->TLSH());
+            default:
+                return deferred.WriteNothing();
+        }
+    });
+}
+
 HRESULT FileInfo::WriteSignedHash(ITableOutput& output)
 {
     HRESULT hr = E_FAIL;
@@ -24,6 +24,8 @@ namespace Orc {
 class VolumeReader;
 using ITableOutput = TableOutput::IOutput;
 class Writer;
+class HashingService;
+class HashJob;
 
 class ORCLIB_API FileInfo : public IIntentionsHandler
 {
@@ -46,6 +48,9 @@ public:
     HRESULT
     WriteFileInformation(const ColumnNameDef columnNames[], ITableOutput& output, const std::vector<Filter>& filters);
 
+    // Rows written to the service's output have their hashes computed by the service's workers
+    void SetHashingService(HashingService* pService) { m_pHashingService = pService; }
+
     // abstract methods
     virtual bool IsDirectory() = 0;
     virtual std::shared_ptr<ByteStream> GetFileStream() = 0;
@@ -80,6 +85,9 @@ protected:
     // abstract method
     virtual HRESULT Open() = 0;
 
+    // A new stream over the file's data, to be read by another thread (nullptr: hashes are computed inline)
+    virtual std::shared_ptr<ByteStream> GetHashingStream() { return nullptr; }
+
     DWORD GetRequiredAccessMask(const ColumnNameDef columnNames[]);
 
     // open methods
@@ -167,6 +175,15 @@ protected:
 
 private:
     Intentions FilterIntentions(const std::vector<Filter>& Filters);
+
+    HRESULT
+    WriteColumns(const ColumnNameDef columnNames[], ITableOutput& output, const std::vector<Filter>& filters);
+
+    HRESULT SubmitHash();
+    HRESULT WriteDeferredHash(ITableOutput& output, Intentions intention);
+
+    HashingService* m_pHashingService = nullptr;
+    std::shared_ptr<HashJob> m_HashJob;
     bool FilterApplies(const Filter& filter);
 
     size_t FindVersionQueryValueRec(
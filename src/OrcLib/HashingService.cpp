@@ -0,0 +1,479 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "HashingService.h"
+
+#include "ByteStream.h"
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+HRESULT HashJob::Run()
+{
+    return Complete([this]() { return Hash(); });
+}
+
+HRESULT HashJob::Hash()
+{
+    HRESULT hr = E_FAIL;
+
+    if (m_Stream == nullptr)
+        return E_POINTER;
+
+    m_Stream->SetFilePointer(0L, FILE_BEGIN, NULL);
+
+    std::shared_ptr<ByteStream> hashing_stream;
+    std::shared_ptr<CryptoHashStream> crypto_hashstream;
+    std::shared_ptr<FuzzyHashStream> fuzzy_hashstream;
+
+    if (m_CryptoAlgs != CryptoHashStream::Algorithm::Undefined)
+    {
+        crypto_hashstream = std::make_shared<CryptoHashStream>();
+        if (FAILED(hr = crypto_hashstream->OpenToWrite(m_CryptoAlgs, nullptr)))
+            return hr;
+
+        hashing_stream = crypto_hashstream;
+    }
+
+    if (m_FuzzyAlgs != FuzzyHashStream::Algorithm::Undefined)
+    {
+        fuzzy_hashstream = std::make_shared<FuzzyHashStream>();
+        if (FAILED(hr = fuzzy_hashstream->OpenToWrite(m_FuzzyAlgs, hashing_stream)))
+            return hr;
+
+        hashing_stream = fuzzy_hashstream;
+    }
+
+    if (hashing_stream == nullptr)
+        return S_OK;
+
+    if (FAILED(hr = m_Stream->CopyTo(*hashing_stream, &m_ullHashed)))
+        return hr;
+
+    if (m_ullHashed == 0)
+        return S_OK;
+
+    const auto GetCryptoHash = [&](CryptoHashStream::Algorithm alg, CBinaryBuffer& hash) -> HRESULT {
+        if (!HasFlag(m_CryptoAlgs, alg))
+            return S_OK;
+        if (FAILED(hr = crypto_hashstream->GetHash(alg, hash)) && hr != MK_E_UNAVAILABLE)
+            return hr;
+        return S_OK;
+    };
+
+    const auto GetFuzzyHash = [&](FuzzyHashStream::Algorithm alg, std::wstring& hash) -> HRESULT {
+        if (!HasFlag(m_FuzzyAlgs, alg))
+            return S_OK;
+        if (FAILED(hr = fuzzy_hashstream->GetHash(alg, hash)) && hr != MK_E_UNAVAILABLE)
+            return hr;
+        return S_OK;
+    };
+
+    if (FAILED(hr = GetCryptoHash(CryptoHashStream::Algorithm::MD5, m_MD5)))
+        return hr;
+    if (FAILED(hr = GetCryptoHash(CryptoHashStream::Algorithm::SHA1, m_Sha1)))
+        return hr;
+    if (FAILED(hr = GetCryptoHash(CryptoHashStream::Algorithm::SHA256, m_Sha256)))
+        return hr;
+#ifdef ORC_BUILD_SSDEEP
+    if (FAILED(hr = GetFuzzyHash(FuzzyHashStream::Algorithm::SSDeep, m_ssdeep)))
+        return hr;
+#endif
+    if (FAILED(hr = GetFuzzyHash(FuzzyHashStream::Algorithm::TLSH, m_tlsh)))
+        return hr;
+
+    return S_OK;
+}
+
+HRESULT HashingService::Row::Defer(const std::shared_ptr<Job>& job, Writer writer)
+{
+    if (job == nullptr)
+        return E_POINTER;
+
+    if (std::find(begin(m_Jobs), end(m_Jobs), job) == end(m_Jobs))
+        m_Jobs.push_back(job);
+
+    return Record([job, writer = std::move(writer)](ITableOutput& output) -> HRESULT {
+        if (FAILED(job->GetResult()))
+            return output.WriteNothing();
+        return writer(output);
+    });
+}
+
+bool HashingService::Row::IsReady() const
+{
+    return std::all_of(begin(m_Jobs), end(m_Jobs), [](const auto& job) { return job->IsDone(); });
+}
+
+HRESULT HashingService::Row::Wait()
+{
+    HRESULT hr = S_OK;
+    for (const auto& job : m_Jobs)
+    {
+        if (HRESULT hrJob = job->Wait(); FAILED(hrJob))
+            hr = hrJob;
+    }
+    return hr;
+}
+
+HRESULT HashingService::Row::Replay(ITableOutput& output)
+{
+    HRESULT hr = S_OK;
+
+    for (const auto& column : m_Columns)
+    {
+        const DWORD dwColumnID = output.GetCurrentColumnID();
+
+        if (HRESULT hrColumn = column(output); FAILED(hrColumn))
+        {
+            hr = hrColumn;
+            Log::Debug(
+                L"Failed to write deferred column '{}' [{}]",
+                output.GetCurrentColumn().ColumnName,
+                SystemError(hrColumn));
+            if (output.GetCurrentColumnID() == dwColumnID)
+                output.AbandonColumn();
+        }
+    }
+
+    if (m_bAbandoned)
+        return output.AbandonRow();
+
+    if (m_bEndOfLine)
+        return output.WriteEndOfLine();
+
+    return hr;
+}
+
+STDMETHODIMP HashingService::Row::WriteNothing()
+{
+    return Record([](ITableOutput& output) { return output.WriteNothing(); });
+}
+
+STDMETHODIMP HashingService::Row::WriteString(const std::wstring& strString)
+{
+    return Record([strString](ITableOutput& output) { return output.WriteString(strString); });
+}
+
+STDMETHODIMP HashingService::Row::WriteString(const std::wstring_view& strString)
+{
+    return WriteString(std::wstring(strString));
+}
+
+STDMETHODIMP HashingService::Row::WriteString(const WCHAR* szString)
+{
+    if (szString == nullptr)
+        return Record([](ITableOutput& output) { return output.WriteString(static_cast<const WCHAR*>(nullptr)); });
+    return WriteString(std::wstring(szString));
+}
+
+STDMETHODIMP HashingService::Row::WriteCharArray(const WCHAR* szArray, DWORD dwCharCount)
+{
+    return Record([str = std::wstring(szArray, dwCharCount)](ITableOutput& output) {
+        return output.WriteCharArray(str.c_str(), static_cast<DWORD>(str.size()));
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteString(const std::string& strString)
+{
+    return Record([strString](ITableOutput& output) { return output.WriteString(strString); });
+}
+
+STDMETHODIMP HashingService::Row::WriteString(const std::string_view& strString)
+{
+    return WriteString(std::string(strString));
+}
+
+STDMETHODIMP HashingService::Row::WriteString(const CHAR* szString)
+{
+    if (szString == nullptr)
+        return Record([](ITableOutput& output) { return output.WriteString(static_cast<const CHAR*>(nullptr)); });
+    return WriteString(std::string(szString));
+}
+
+STDMETHODIMP HashingService::Row::WriteCharArray(const CHAR* szArray, DWORD dwCharCount)
+{
+    return Record([str = std::string(szArray, dwCharCount)](ITableOutput& output) {
+        return output.WriteCharArray(str.c_str(), static_cast<DWORD>(str.size()));
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteAttributes(DWORD dwAttibutes)
+{
+    return Record([dwAttibutes](ITableOutput& output) { return output.WriteAttributes(dwAttibutes); });
+}
+
+STDMETHODIMP HashingService::Row::WriteFileTime(FILETIME fileTime)
+{
+    return Record([fileTime](ITableOutput& output) { return output.WriteFileTime(fileTime); });
+}
+
+STDMETHODIMP HashingService::Row::WriteFileTime(LONGLONG fileTime)
+{
+    return Record([fileTime](ITableOutput& output) { return output.WriteFileTime(fileTime); });
+}
+
+STDMETHODIMP HashingService::Row::WriteTimeStamp(time_t tmStamp)
+{
+    return Record([tmStamp](ITableOutput& output) { return output.WriteTimeStamp(tmStamp); });
+}
+
+STDMETHODIMP HashingService::Row::WriteTimeStamp(tm tmStamp)
+{
+    return Record([tmStamp](ITableOutput& output) { return output.WriteTimeStamp(tmStamp); });
+}
+
+STDMETHODIMP HashingService::Row::WriteFileSize(LARGE_INTEGER fileSize)
+{
+    return Record([fileSize](ITableOutput& output) { return output.WriteFileSize(fileSize); });
+}
+
+STDMETHODIMP HashingService::Row::WriteFileSize(ULONGLONG fileSize)
+{
+    return Record([fileSize](ITableOutput& output) { return output.WriteFileSize(fileSize); });
+}
+
+STDMETHODIMP HashingService::Row::WriteFileSize(DWORD nFileSizeHigh, DWORD nFileSizeLow)
+{
+    return Record([nFileSizeHigh, nFileSizeLow](ITableOutput& output) {
+        return output.WriteFileSize(nFileSizeHigh, nFileSizeLow);
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteInteger(DWORD dwInteger)
+{
+    return Record([dwInteger](ITableOutput& output) { return output.WriteInteger(dwInteger); });
+}
+
+STDMETHODIMP HashingService::Row::WriteInteger(LONGLONG dw64Integer)
+{
+    return Record([dw64Integer](ITableOutput& output) { return output.WriteInteger(dw64Integer); });
+}
+
+STDMETHODIMP HashingService::Row::WriteInteger(ULONGLONG dw64Integer)
+{
+    return Record([dw64Integer](ITableOutput& output) { return output.WriteInteger(dw64Integer); });
+}
+
+STDMETHODIMP HashingService::Row::WriteBytes(const BYTE pBytes[], DWORD dwLen)
+{
+    return Record([bytes = std::vector<BYTE>(pBytes, pBytes + dwLen)](ITableOutput& output) {
+        return output.WriteBytes(bytes.data(), static_cast<DWORD>(bytes.size()));
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteBytes(const CBinaryBuffer& Buffer)
+{
+    return WriteBytes(Buffer.GetData(), static_cast<DWORD>(Buffer.GetCount()));
+}
+
+STDMETHODIMP HashingService::Row::WriteBool(bool bBoolean)
+{
+    return Record([bBoolean](ITableOutput& output) { return output.WriteBool(bBoolean); });
+}
+
+STDMETHODIMP HashingService::Row::WriteEnum(DWORD dwEnum)
+{
+    return Record([dwEnum](ITableOutput& output) { return output.WriteEnum(dwEnum); });
+}
+
+// Enum and flags definitions are static tables, they are kept by pointer
+STDMETHODIMP HashingService::Row::WriteEnum(DWORD dwEnum, const WCHAR* EnumValues[])
+{
+    return Record([dwEnum, EnumValues](ITableOutput& output) { return output.WriteEnum(dwEnum, EnumValues); });
+}
+
+STDMETHODIMP HashingService::Row::WriteFlags(DWORD dwFlags)
+{
+    return Record([dwFlags](ITableOutput& output) { return output.WriteFlags(dwFlags); });
+}
+
+STDMETHODIMP HashingService::Row::WriteFlags(DWORD dwFlags, const FlagsDefinition FlagValues[], WCHAR cSeparator)
+{
+    return Record([dwFlags, FlagValues, cSeparator](ITableOutput& output) {
+        return output.WriteFlags(dwFlags, FlagValues, cSeparator);
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteExactFlags(DWORD dwFlags)
+{
+    return Record([dwFlags](ITableOutput& output) { return output.WriteExactFlags(dwFlags); });
+}
+
+STDMETHODIMP HashingService::Row::WriteExactFlags(DWORD dwFlags, const FlagsDefinition FlagValues[])
+{
+    return Record([dwFlags, FlagValues](ITableOutput& output) { return output.WriteExactFlags(dwFlags, FlagValues); });
+}
+
+STDMETHODIMP HashingService::Row::WriteGUID(const GUID& guid)
+{
+    return Record([guid](ITableOutput& output) { return output.WriteGUID(guid); });
+}
+
+STDMETHODIMP HashingService::Row::WriteXML(const WCHAR* szString)
+{
+    return Record([str = std::wstring(szString != nullptr ? szString : L"")](ITableOutput& output) {
+        return output.WriteXML(str.c_str());
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteXML(const CHAR* szString)
+{
+    return Record([str = std::string(szString != nullptr ? szString : "")](ITableOutput& output) {
+        return output.WriteXML(str.c_str());
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteXML(const WCHAR* szArray, DWORD dwCharCount)
+{
+    return Record([str = std::wstring(szArray, dwCharCount)](ITableOutput& output) {
+        return output.WriteXML(str.c_str(), static_cast<DWORD>(str.size()));
+    });
+}
+
+STDMETHODIMP HashingService::Row::WriteXML(const CHAR* szArray, DWORD dwCharCount)
+{
+    return Record([str = std::string(szArray, dwCharCount)](ITableOutput& output) {
+        return output.WriteXML(str.c_str(), static_cast<DWORD>(str.size()));
+    });
+}
+
+STDMETHODIMP HashingService::Row::AbandonRow()
+{
+    m_bAbandoned = true;
+    return S_OK;
+}
+
+STDMETHODIMP HashingService::Row::AbandonColumn()
+{
+    return Record([](ITableOutput& output) { return output.AbandonColumn(); });
+}
+
+HRESULT HashingService::Row::WriteEndOfLine()
+{
+    m_bEndOfLine = true;
+    return S_OK;
+}
+
+HRESULT HashingService::Row::WriteFormated_(const std::wstring_view& szFormat, fmt::wformat_args args)
+{
+    return WriteString(fmt::vformat(szFormat, args));
+}
+
+HRESULT HashingService::Row::WriteFormated_(const std::string_view& szFormat, fmt::format_args args)
+{
+    return WriteString(fmt::vformat(szFormat, args));
+}
+
+HashingService::HashingService(ITableOutput& output, const Options& options)
+    : m_Output(output)
+{
+    DWORD dwWorkers = options.dwWorkers;
+    if (dwWorkers == 0L)
+        dwWorkers = JobPool<Job>::DefaultWorkers();
+
+    m_dwMaxPendingRows = options.dwMaxPendingRows;
+    if (m_dwMaxPendingRows == 0L)
+        m_dwMaxPendingRows = 256 * dwWorkers;
+
+    m_Pool.Start(dwWorkers, [this](Job& job, DWORD) {
+        if (FAILED(job.Run()))
+            m_ullFailedJobs++;
+        m_ullHashedBytes += job.GetHashedBytes();
+    });
+
+    Log::Debug("Hashing service started with {} workers ({} pending rows at most)", dwWorkers, m_dwMaxPendingRows);
+}
+
+HashingService::~HashingService()
+{
+    if (HRESULT hr = Flush(); FAILED(hr))
+        Log::Error("Failed to write pending hashed rows [{}]", SystemError(hr));
+
+    m_Pool.Stop();
+
+    Log::Debug(
+        "Hashing service: {} jobs ({} failed, {} bytes), {} deferred rows, waited {} times",
+        m_Pool.GetSubmittedJobs(),
+        m_ullFailedJobs.load(),
+        m_ullHashedBytes.load(),
+        m_ullDeferredRows,
+        m_ullWaits);
+}
+
+std::shared_ptr<HashJob> HashingService::Submit(
+    std::shared_ptr<ByteStream> stream,
+    CryptoHashStream::Algorithm cryptoAlgs,
+    FuzzyHashStream::Algorithm fuzzyAlgs)
+{
+    auto job = std::make_shared<Job>(std::move(stream), cryptoAlgs, fuzzyAlgs);
+    m_Pool.Submit(job);
+    return job;
+}
+
+std::unique_ptr<HashingService::Row> HashingService::NewRow()
+{
+    return std::make_unique<Row>(m_Output.GetCurrentColumnID());
+}
+
+HRESULT HashingService::Push(std::unique_ptr<Row> row)
+{
+    if (row == nullptr)
+        return E_POINTER;
+
+    m_ullDeferredRows++;
+    m_Rows.push_back(std::move(row));
+
+    if (m_Rows.size() > m_dwMaxPendingRows)
+    {
+        m_ullWaits++;
+        m_Rows.front()->Wait();
+    }
+
+    return WriteReadyRows();
+}
+
+HRESULT HashingService::Flush()
+{
+    HRESULT hr = S_OK;
+
+    while (!m_Rows.empty())
+    {
+        m_Rows.front()->Wait();
+        if (HRESULT hrWrite = WriteReadyRows(); FAILED(hrWrite))
+            hr = hrWrite;
+    }
+    return hr;
+}
+
+HRESULT HashingService::WriteReadyRows()
+{
+    HRESULT hr = S_OK;
+
+    while (!m_Rows.empty() && m_Rows.front()->IsReady())
+    {
+        auto row = std::move(m_Rows.front());
+        m_Rows.pop_front();
+
+        if (HRESULT hrRow = row->Replay(m_Output); FAILED(hrRow))
+            hr = hrRow;
+    }
+    return hr;
+}
+
+HashingService::Statistics HashingService::GetStatistics() const
+{
+    Statistics statistics;
+    statistics.ullJobs = m_Pool.GetSubmittedJobs();
+    statistics.ullHashedBytes = m_ullHashedBytes;
+    statistics.ullFailedJobs = m_ullFailedJobs;
+    statistics.ullDeferredRows = m_ullDeferredRows;
+    statistics.ullWaits = m_ullWaits;
+    return statistics;
+}
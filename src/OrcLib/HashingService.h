@@ -0,0 +1,234 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include "BinaryBuffer.h"
+#include "CryptoHashStream.h"
+#include "FuzzyHashStream.h"
+#include "JobPool.h"
+#include "TableOutput.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Hashes of one data stream, computed by a worker of a HashingService
+class ORCLIB_API HashJob : public StreamJob
+{
+public:
+    HashJob(
+        std::shared_ptr<ByteStream> stream,
+        CryptoHashStream::Algorithm cryptoAlgs,
+        FuzzyHashStream::Algorithm fuzzyAlgs)
+        : StreamJob(std::move(stream))
+        , m_CryptoAlgs(cryptoAlgs)
+        , m_FuzzyAlgs(fuzzyAlgs)
+    {
+    }
+
+    // True if the job computes (at least) these hashes
+    bool Covers(CryptoHashStream::Algorithm cryptoAlgs, FuzzyHashStream::Algorithm fuzzyAlgs) const
+    {
+        return HasFlag(m_CryptoAlgs, cryptoAlgs) && HasFlag(m_FuzzyAlgs, fuzzyAlgs);
+    }
+
+    // Valid once the job is done
+    ULONGLONG GetHashedBytes() const { return m_ullHashed; }
+
+    const CBinaryBuffer& MD5() const { return m_MD5; }
+    const CBinaryBuffer& SHA1() const { return m_Sha1; }
+    const CBinaryBuffer& SHA256() const { return m_Sha256; }
+    const std::wstring& SSDeep() const { return m_ssdeep; }
+    const std::wstring& TLSH() const { return m_tlsh; }
+
+    // Hashes the stream on the calling thread
+    HRESULT Run();
+
+private:
+    HRESULT Hash();
+
+    const CryptoHashStream::Algorithm m_CryptoAlgs;
+    const FuzzyHashStream::Algorithm m_FuzzyAlgs;
+
+    ULONGLONG m_ullHashed = 0LL;
+
+    CBinaryBuffer m_MD5;
+    CBinaryBuffer m_Sha1;
+    CBinaryBuffer m_Sha256;
+    std::wstring m_ssdeep;
+    std::wstring m_tlsh;
+};
+
+// Hashes data streams on a bounded pool of workers while the caller moves on to the next files.
+// Rows needing a digest are recorded and written to the output once their jobs complete, in the order they were
+// pushed: every write to the output happens on the thread calling Push/Flush.
+class ORCLIB_API HashingService
+{
+public:
+    using Job = HashJob;
+
+    struct Options
+    {
+        DWORD dwWorkers = 0L;  // 0: one per logical processor, the caller's excepted
+        DWORD dwMaxPendingRows = 0L;  // rows kept before Push waits for the oldest one, 0: 256 per worker
+    };
+
+    // Records the columns written to it, to replay them on the real output
+    class ORCLIB_API Row : public ITableOutput
+    {
+    public:
+        using Writer = std::function<HRESULT(ITableOutput& output)>;
+
+        Row(DWORD dwFirstColumnID)
+            : m_dwFirstColumnID(dwFirstColumnID)
+        {
+        }
+
+        // Column written by 'writer' once 'job' is done
+        HRESULT Defer(const std::shared_ptr<Job>& job, Writer writer);
+
+        bool IsReady() const;
+        HRESULT Wait();
+
+        HRESULT Replay(ITableOutput& output);
+
+        DWORD GetCurrentColumnID() override { return m_dwFirstColumnID + static_cast<DWORD>(m_Columns.size()); }
+        const TableOutput::Column& GetCurrentColumn() override { return m_Column; }
+
+        STDMETHOD(WriteNothing)() override;
+
+        STDMETHOD(WriteString)(const std::wstring& strString) override;
+        STDMETHOD(WriteString)(const std::wstring_view& strString) override;
+        STDMETHOD(WriteString)(const WCHAR* szString) override;
+        STDMETHOD(WriteCharArray)(const WCHAR* szArray, DWORD dwCharCount) override;
+
+        STDMETHOD(WriteString)(const std::string& strString) override;
+        STDMETHOD(WriteString)(const std::string_view& strString) override;
+        STDMETHOD(WriteString)(const CHAR* szString) override;
+        STDMETHOD(WriteCharArray)(const CHAR* szArray, DWORD dwCharCount) override;
+
+        STDMETHOD(WriteAttributes)(DWORD dwAttibutes) override;
+
+        STDMETHOD(WriteFileTime)(FILETIME fileTime) override;
+        STDMETHOD(WriteFileTime)(LONGLONG fileTime) override;
+        STDMETHOD(WriteTimeStamp)(time_t tmStamp) override;
+        STDMETHOD(WriteTimeStamp)(tm tmStamp) override;
+
+        STDMETHOD(WriteFileSize)(LARGE_INTEGER fileSize) override;
+        STDMETHOD(WriteFileSize)(ULONGLONG fileSize) override;
+        STDMETHOD(WriteFileSize)(DWORD nFileSizeHigh, DWORD nFileSizeLow) override;
+
+        STDMETHOD(WriteInteger)(DWORD dwInteger) override;
+        STDMETHOD(WriteInteger)(LONGLONG dw64Integer) override;
+        STDMETHOD(WriteInteger)(ULONGLONG dw64Integer) override;
+
+        STDMETHOD(WriteBytes)(const BYTE pBytes[], DWORD dwLen) override;
+        STDMETHOD(WriteBytes)(const CBinaryBuffer& Buffer) override;
+
+        STDMETHOD(WriteBool)(bool bBoolean) override;
+
+        STDMETHOD(WriteEnum)(DWORD dwEnum) override;
+        STDMETHOD(WriteEnum)(DWORD dwEnum, const WCHAR* EnumValues[]) override;
+
+        STDMETHOD(WriteFlags)(DWORD dwFlags) override;
+        STDMETHOD(WriteFlags)(DWORD dwFlags, const FlagsDefinition FlagValues[], WCHAR cSeparator) override;
+
+        STDMETHOD(WriteExactFlags)(DWORD dwFlags) override;
+        STDMETHOD(WriteExactFlags)(DWORD dwFlags, const FlagsDefinition FlagValues[]) override;
+
+        STDMETHOD(WriteGUID)(const GUID& guid) override;
+
+        STDMETHOD(WriteXML)(const WCHAR* szString) override;
+        STDMETHOD(WriteXML)(const CHAR* szString) override;
+        STDMETHOD(WriteXML)(const WCHAR* szArray, DWORD dwCharCount) override;
+        STDMETHOD(WriteXML)(const CHAR* szArray, DWORD dwCharCount) override;
+
+        STDMETHOD(AbandonRow)() override;
+        STDMETHOD(AbandonColumn)() override;
+
+        HRESULT WriteEndOfLine() override;
+
+    protected:
+        HRESULT WriteFormated_(const std::wstring_view& szFormat, fmt::wformat_args args) override;
+        HRESULT WriteFormated_(const std::string_view& szFormat, fmt::format_args args) override;
+
+    private:
+        HRESULT Record(Writer writer)
+        {
+            m_Columns.push_back(std::move(writer));
+            return S_OK;
+        }
+
+        const DWORD m_dwFirstColumnID;
+        std::vector<Writer> m_Columns;
+        std::vector<std::shared_ptr<Job>> m_Jobs;
+        bool m_bEndOfLine = false;
+        bool m_bAbandoned = false;
+
+        TableOutput::Column m_Column;
+    };
+
+    struct Statistics
+    {
+        ULONGLONG ullJobs = 0LL;
+        ULONGLONG ullHashedBytes = 0LL;
+        ULONGLONG ullFailedJobs = 0LL;
+        ULONGLONG ullDeferredRows = 0LL;
+        ULONGLONG ullWaits = 0LL;  // times Push had to wait for the oldest row
+    };
+
+    HashingService(ITableOutput& output, const Options& options = Options());
+    ~HashingService();
+
+    // Queues the hashing of 'stream' (which must not be used by any other thread until the job is done)
+    std::shared_ptr<Job> Submit(
+        std::shared_ptr<ByteStream> stream,
+        CryptoHashStream::Algorithm cryptoAlgs,
+        FuzzyHashStream::Algorithm fuzzyAlgs);
+
+    // A row to record the columns of the next line into, it must be pushed back to the service
+    std::unique_ptr<Row> NewRow();
+
+    // Queues the row after the pending ones and writes those that are ready
+    HRESULT Push(std::unique_ptr<Row> row);
+
+    // Waits for all the pending rows and writes them
+    HRESULT Flush();
+
+    bool HasPendingRows() const { return !m_Rows.empty(); }
+
+    ITableOutput& GetOutput() const { return m_Output; }
+    DWORD GetWorkers() const { return m_Pool.GetWorkers(); }
+    Statistics GetStatistics() const;
+
+private:
+    HRESULT WriteReadyRows();
+
+    ITableOutput& m_Output;
+
+    DWORD m_dwMaxPendingRows = 0L;
+
+    std::deque<std::unique_ptr<Row>> m_Rows;
+
+    JobPool<Job> m_Pool;
+
+    ULONGLONG m_ullDeferredRows = 0LL;
+    ULONGLONG m_ullWaits = 0LL;
+    std::atomic<ULONGLONG> m_ullHashedBytes = 0LL;
+    std::atomic<ULONGLONG> m_ullFailedJobs = 0LL;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -30,6 +30,7 @@ public:
     virtual HRESULT Open(DWORD dwShareMode, DWORD dwCreationDisposition, DWORD dwFlags) PURE;
     virtual HRESULT Seek(LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER pliNewFilePointer, DWORD dwFrom) PURE;
     virtual HRESULT Read(PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) PURE;
+    virtual HRESULT ReadAt(ULONGLONG ullOffset, PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) const PURE;
     virtual void Close() PURE;
 
     virtual ~IDiskExtent() {}
@@ -24,8 +24,13 @@ public:
     virtual ULONG64 GetMftOffset() PURE;
 
     virtual HRESULT EnumMFTRecord(MFTUtils::EnumMFTRecordCall pCallBack) PURE;
+    virtual HRESULT EnumMFTBlocks(ULONG ulBytesPerBlock, MFTUtils::EnumMFTBlockCall pCallBack) PURE;
     virtual HRESULT FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUtils::EnumMFTRecordCall pCallBack) PURE;
 
+    // Records fetched in one read may be separated by up to ulRecords unwanted records
+    virtual void SetFetchGapTolerance(ULONG ulRecords) PURE;
+    virtual const MFTUtils::FetchStatistics& GetFetchStatistics() const PURE;
+
     virtual ULONG GetMFTRecordCount() const PURE;
     virtual MFTUtils::SafeMFTSegmentNumber GetUSNRoot() const PURE;
 };  // IMFT
@@ -0,0 +1,41 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "JobPool.h"
+
+#include "ByteStream.h"
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+HRESULT StreamJob::Complete(const std::function<HRESULT()>& work)
+{
+    try
+    {
+        m_hr = work();
+    }
+    catch (const std::exception& e)
+    {
+        Log::Error("Stream job threw exception '{}'", e.what());
+        m_hr = E_FAIL;
+    }
+
+    m_Stream.reset();
+
+    m_bDone = true;
+    m_Done.set();
+    return m_hr;
+}
+
+HRESULT StreamJob::Wait()
+{
+    if (!m_bDone)
+        m_Done.wait();
+    return m_hr;
+}
@@ -0,0 +1,123 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <agents.h>
+#include <ppl.h>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+class ByteStream;
+
+// Work on one data stream, run by a worker of a JobPool while the submitter moves on
+class ORCLIB_API StreamJob
+{
+public:
+    StreamJob(std::shared_ptr<ByteStream> stream)
+        : m_Stream(std::move(stream))
+    {
+    }
+    virtual ~StreamJob() = default;
+
+    // Blocks (cooperatively) until the job is done, returns its result
+    HRESULT Wait();
+    bool IsDone() const { return m_bDone; }
+
+    // Valid once the job is done
+    HRESULT GetResult() const { return m_hr; }
+
+protected:
+    // Runs 'work' on the calling thread then releases the stream (which may hold a volume reader) and wakes the
+    // waiters up
+    HRESULT Complete(const std::function<HRESULT()>& work);
+
+    std::shared_ptr<ByteStream> m_Stream;
+
+private:
+    HRESULT m_hr = E_PENDING;
+
+    std::atomic<bool> m_bDone = false;
+    concurrency::event m_Done;
+};
+
+// Fixed number of workers running the jobs submitted to them, in order. A worker is identified by its index, for
+// the state it owns (a yara scanner...).
+template <typename JobT>
+class JobPool
+{
+public:
+    using RunCall = std::function<void(JobT& job, DWORD dwWorker)>;
+
+    // One worker per logical processor, the caller's excepted
+    static DWORD DefaultWorkers() { return std::max(concurrency::GetProcessorCount(), 2u) - 1; }
+
+    JobPool() = default;
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    // Starts dwWorkers workers (a pool is started once), 'run' is called on a worker for each job it receives
+    void Start(DWORD dwWorkers, RunCall run)
+    {
+        m_Run = std::move(run);
+        m_dwWorkers = dwWorkers;
+
+        for (DWORD i = 0; i < m_dwWorkers; i++)
+        {
+            m_Workers.run([this, i]() {
+                for (;;)
+                {
+                    auto job = concurrency::receive(m_Jobs);
+                    if (job == nullptr)
+                        break;
+                    m_Run(*job, i);
+                }
+            });
+        }
+    }
+
+    // Queues 'job', whose stream must not be used by any other thread until it is done
+    void Submit(const std::shared_ptr<JobT>& job)
+    {
+        m_ullJobs++;
+        concurrency::send(m_Jobs, job);
+    }
+
+    // Runs the jobs queued so far then stops the workers
+    void Stop()
+    {
+        // one end marker per worker
+        for (DWORD i = 0; i < m_dwWorkers; i++)
+            concurrency::send(m_Jobs, std::shared_ptr<JobT>());
+        m_Workers.wait();
+        m_dwWorkers = 0L;
+    }
+
+    DWORD GetWorkers() const { return m_dwWorkers; }
+    ULONGLONG GetSubmittedJobs() const { return m_ullJobs; }
+
+    ~JobPool() { Stop(); }
+
+private:
+    RunCall m_Run;
+    DWORD m_dwWorkers = 0L;
+
+    concurrency::unbounded_buffer<std::shared_ptr<JobT>> m_Jobs;
+    concurrency::task_group m_Workers;
+
+    ULONGLONG m_ullJobs = 0LL;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
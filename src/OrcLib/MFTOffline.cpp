@@ -110,6 +110,81 @@ HRESULT MFTOffline::EnumMFTRecord(MFTUtils::EnumMFTRecordCall pCallBack)
     return S_OK;
 }
 
+HRESULT MFTOffline::EnumMFTBlocks(ULONG ulBytesPerBlock, MFTUtils::EnumMFTBlockCall pCallBack)
+{
+    HRESULT hr = E_FAIL;
+
+    if (pCallBack == NULL)
+        return E_POINTER;
+
+    const ULONG ulBytesPerFRS = m_pVolReader->GetBytesPerFRS();
+    if (ulBytesPerFRS == 0)
+        return E_UNEXPECTED;
+
+    LARGE_INTEGER Start = {0};
+    LARGE_INTEGER End = {0};
+
+    GetFileSizeEx(m_pVolReader->GetHandle(), &End);
+
+    if (INVALID_SET_FILE_POINTER
+        == SetFilePointer(m_pVolReader->GetHandle(), Start.LowPart, &Start.HighPart, FILE_BEGIN))
+    {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+        Log::Error(L"Could not seek to offset {} in MFT file [{}]", Start.LowPart, SystemError(hr));
+        return hr;
+    }
+
+    // Blocks are always made of complete records
+    const ULONG ulFRSPerBlock = std::max<ULONG>(ulBytesPerBlock / ulBytesPerFRS, 1);
+
+    ULONGLONG ullCurrentIndex = 0;
+    ULONGLONG ullLastIndex = (End.QuadPart - Start.QuadPart) / ulBytesPerFRS;
+
+    while (ullCurrentIndex < ullLastIndex)
+    {
+        const ULONG ulFRSToRead =
+            static_cast<ULONG>(std::min<ULONGLONG>(ullLastIndex - ullCurrentIndex, ulFRSPerBlock));
+
+        // A new buffer per block: the callback is free to keep it (i.e. hand it over to another thread)
+        CBinaryBuffer blockBuffer(true);
+        if (!blockBuffer.SetCount(static_cast<size_t>(ulFRSToRead) * ulBytesPerFRS))
+            return E_OUTOFMEMORY;
+
+        DWORD dwBytesRead = 0;
+        if (!ReadFile(
+                m_pVolReader->GetHandle(), blockBuffer.GetData(), ulFRSToRead * ulBytesPerFRS, &dwBytesRead, NULL))
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+            Log::Error(L"Could not read in MFT file [{}]", SystemError(hr));
+            return hr;
+        }
+
+        const ULONG ulFRSRead = dwBytesRead / ulBytesPerFRS;
+        if (ulFRSRead == 0)
+        {
+            Log::Debug(L"Reached end of offline MFT");
+            return S_OK;
+        }
+
+        blockBuffer.SetCount(static_cast<size_t>(ulFRSRead) * ulBytesPerFRS);
+
+        if (FAILED(hr = pCallBack(ullCurrentIndex, blockBuffer)))
+        {
+            if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
+            {
+                Log::Debug("INFO: stopping enumeration [{}]", SystemError(hr));
+                return hr;
+            }
+            Log::Error("Block Callback failed [{}]", SystemError(hr));
+            return hr;
+        }
+
+        ullCurrentIndex += ulFRSRead;
+    }
+
+    return S_OK;
+}
+
 HRESULT MFTOffline::FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUtils::EnumMFTRecordCall pCallBack)
 {
     HRESULT hr = E_FAIL;
@@ -126,98 +201,128 @@ HRESULT MFTOffline::FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTU
             return leftRFN.SegmentNumberLowPart < rigthRFN.SegmentNumberLowPart;
         });
 
-    ULONGLONG ullCurrentIndex = 0;
-    // go through each extent of mft and search for the files
-
-    ULONGLONG ullCorrection = 0LL;
-
     ULONG ulBytesPerFRS = m_pVolReader->GetBytesPerFRS();
 
-    CBinaryBuffer localReadBuffer(true);
+    // Adjacent and nearby records are fetched with a single read, up to this many records
+    const ULONGLONG ullMaxFRSPerRead = 1024;
 
-    if (!localReadBuffer.CheckCount(ulBytesPerFRS))
-        return E_OUTOFMEMORY;
+    CBinaryBuffer localReadBuffer(true);
 
-    for (const auto& idx : frn)
+    size_t frnIdx = 0;
+    while (frnIdx < frn.size())
     {
+        const ULONGLONG ullFirst = NtfsSegmentNumber(&frn[frnIdx]);
+
+        // coalesce the following records while the gaps remain tolerable
+        size_t lastIdx = frnIdx;
+        while (lastIdx + 1 < frn.size())
+        {
+            const ULONGLONG ullNext = NtfsSegmentNumber(&frn[lastIdx + 1]);
+
+            if (ullNext > NtfsSegmentNumber(&frn[lastIdx]) + 1 + m_ulFetchGapTolerance)
+                break;
+            if (ullNext - ullFirst + 1 > ullMaxFRSPerRead)
+                break;
+            lastIdx++;
+        }
+
+        const ULONGLONG ullLast = NtfsSegmentNumber(&frn[lastIdx]);
+        const DWORD dwBytesToRead = static_cast<DWORD>((ullLast - ullFirst + 1) * ulBytesPerFRS);
+
+        if (!localReadBuffer.CheckCount(dwBytesToRead))
+            return E_OUTOFMEMORY;
+
         LARGE_INTEGER Index;
+        Index.QuadPart = ullFirst * ulBytesPerFRS;
 
-        Index.LowPart = idx.SegmentNumberLowPart;
-        Index.HighPart = idx.SegmentNumberHighPart;
+        OVERLAPPED overlapped;
+        ZeroMemory(&overlapped, sizeof(OVERLAPPED));
+        overlapped.Offset = Index.LowPart;
+        overlapped.OffsetHigh = Index.HighPart;
 
-        Index.QuadPart *= ulBytesPerFRS;
+        m_FetchStats.ullReads++;
 
-        if (INVALID_SET_FILE_POINTER
-            == SetFilePointer(m_pFetchReader->GetHandle(), Index.LowPart, &Index.HighPart, FILE_BEGIN))
+        DWORD dwBytesRead = 0LL;
+        if (!ReadFile(m_pFetchReader->GetHandle(), localReadBuffer.GetData(), dwBytesToRead, &dwBytesRead, &overlapped))
         {
             hr = HRESULT_FROM_WIN32(GetLastError());
-            Log::Error(L"Could not seek to offset {} in MFT file [{}]", Index.QuadPart, SystemError(hr));
+            Log::Error(
+                L"Could not read {} bytes at offset {} in MFT file [{}]",
+                dwBytesToRead,
+                Index.QuadPart,
+                SystemError(hr));
+            frnIdx = lastIdx + 1;
             continue;
         }
 
-        DWORD dwBytesRead = 0LL;
-        if (!ReadFile(
-                m_pFetchReader->GetHandle(),
-                localReadBuffer.GetData(),
-                m_pFetchReader->GetBytesPerFRS(),
-                &dwBytesRead,
-                NULL))
+        for (; frnIdx <= lastIdx; frnIdx++)
         {
-            hr = HRESULT_FROM_WIN32(GetLastError());
-            Log::Error(L"Could not read {} bytes in MFT file [{}]", m_pFetchReader->GetBytesPerFRS(), SystemError(hr));
-            continue;
-        }
+            const auto& idx = frn[frnIdx];
+            const ULONGLONG ullRecord = NtfsSegmentNumber(&idx);
+            const ULONGLONG ullOffsetInBuffer = (ullRecord - ullFirst) * ulBytesPerFRS;
 
-        PFILE_RECORD_SEGMENT_HEADER pHeader = (PFILE_RECORD_SEGMENT_HEADER)localReadBuffer.GetData();
+            if (ullOffsetInBuffer + ulBytesPerFRS > dwBytesRead)
+            {
+                Log::Debug(L"Skipping... {} is beyond the end of the MFT file", ullRecord);
+                continue;
+            }
 
-        if ((pHeader->MultiSectorHeader.Signature[0] != 'F') || (pHeader->MultiSectorHeader.Signature[1] != 'I')
-            || (pHeader->MultiSectorHeader.Signature[2] != 'L') || (pHeader->MultiSectorHeader.Signature[3] != 'E'))
-        {
-            Log::Debug(
-                L"Skipping... MultiSectorHeader.Signature is not FILE - '{}{}{}{}'",
-                pHeader->MultiSectorHeader.Signature[0],
-                pHeader->MultiSectorHeader.Signature[1],
-                pHeader->MultiSectorHeader.Signature[2],
-                pHeader->MultiSectorHeader.Signature[3]);
-            continue;
-        }
+            CBinaryBuffer recordBuffer(
+                localReadBuffer.GetData() + static_cast<size_t>(ullOffsetInBuffer), ulBytesPerFRS);
 
-        MFT_SEGMENT_REFERENCE read_record_frn = {0};
-        read_record_frn.SegmentNumberHighPart = pHeader->SegmentNumberHighPart;
-        read_record_frn.SegmentNumberLowPart = pHeader->SegmentNumberLowPart;
-        read_record_frn.SequenceNumber = pHeader->SequenceNumber;
+            PFILE_RECORD_SEGMENT_HEADER pHeader = (PFILE_RECORD_SEGMENT_HEADER)recordBuffer.GetData();
 
-        if (NtfsSegmentNumber(&read_record_frn) != NtfsSegmentNumber(&idx))
-        {
-            Log::Debug(
-                L"Skipping... {} does not match the expected {}",
-                NtfsSegmentNumber(&read_record_frn),
-                NtfsSegmentNumber(&idx));
-            continue;
-        }
-        if (read_record_frn.SequenceNumber != idx.SequenceNumber)
-        {
-            Log::Debug(
-                L"Skipping... Sequence numbed {} does not match the expected {}",
-                read_record_frn.SequenceNumber,
-                idx.SequenceNumber);
-            continue;
-        }
+            if ((pHeader->MultiSectorHeader.Signature[0] != 'F') || (pHeader->MultiSectorHeader.Signature[1] != 'I')
+                || (pHeader->MultiSectorHeader.Signature[2] != 'L') || (pHeader->MultiSectorHeader.Signature[3] != 'E'))
+            {
+                Log::Debug(
+                    L"Skipping... MultiSectorHeader.Signature is not FILE - '{}{}{}{}'",
+                    pHeader->MultiSectorHeader.Signature[0],
+                    pHeader->MultiSectorHeader.Signature[1],
+                    pHeader->MultiSectorHeader.Signature[2],
+                    pHeader->MultiSectorHeader.Signature[3]);
+                continue;
+            }
 
-        MFTUtils::SafeMFTSegmentNumber safeFRN = (ULONGLONG)Index.QuadPart;
-        if (FAILED(hr = pCallBack(safeFRN, localReadBuffer)))
-        {
-            if (hr == E_OUTOFMEMORY)
+            MFT_SEGMENT_REFERENCE read_record_frn = {0};
+            read_record_frn.SegmentNumberHighPart = pHeader->SegmentNumberHighPart;
+            read_record_frn.SegmentNumberLowPart = pHeader->SegmentNumberLowPart;
+            read_record_frn.SequenceNumber = pHeader->SequenceNumber;
+
+            if (NtfsSegmentNumber(&read_record_frn) != NtfsSegmentNumber(&idx))
             {
-                Log::Error(L"Add Record Callback failed, not enough memory to continue [{}]", SystemError(hr));
-                return hr;
+                Log::Debug(
+                    L"Skipping... {} does not match the expected {}",
+                    NtfsSegmentNumber(&read_record_frn),
+                    NtfsSegmentNumber(&idx));
+                continue;
             }
-            else if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
+            if (read_record_frn.SequenceNumber != idx.SequenceNumber)
             {
-                Log::Debug(L"Add Record Callback asks for enumeration to stop... [{}]", SystemError(hr));
-                return hr;
+                Log::Debug(
+                    L"Skipping... Sequence numbed {} does not match the expected {}",
+                    read_record_frn.SequenceNumber,
+                    idx.SequenceNumber);
+                continue;
+            }
+
+            m_FetchStats.ullRecords++;
+
+            MFTUtils::SafeMFTSegmentNumber safeFRN = ullRecord;
+            if (FAILED(hr = pCallBack(safeFRN, recordBuffer)))
+            {
+                if (hr == E_OUTOFMEMORY)
+                {
+                    Log::Error(L"Add Record Callback failed, not enough memory to continue [{}]", SystemError(hr));
+                    return hr;
+                }
+                else if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
+                {
+                    Log::Debug(L"Add Record Callback asks for enumeration to stop... [{}]", SystemError(hr));
+                    return hr;
+                }
+                Log::Debug(L"WARNING: Add Record Callback failed");
             }
-            Log::Debug(L"WARNING: Add Record Callback failed");
         }
     }
 
@@ -28,7 +28,10 @@ public:
     virtual ULONG64 GetMftOffset() { return 0LL; }
 
     virtual HRESULT EnumMFTRecord(MFTUtils::EnumMFTRecordCall pCallBack);
+    virtual HRESULT EnumMFTBlocks(ULONG ulBytesPerBlock, MFTUtils::EnumMFTBlockCall pCallBack);
     virtual HRESULT FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUtils::EnumMFTRecordCall pCallBack);
+    virtual void SetFetchGapTolerance(ULONG ulRecords) { m_ulFetchGapTolerance = ulRecords; }
+    virtual const MFTUtils::FetchStatistics& GetFetchStatistics() const { return m_FetchStats; }
     virtual ULONG GetMFTRecordCount() const;
     virtual MFTUtils::SafeMFTSegmentNumber GetUSNRoot() const;
 
@@ -37,6 +40,9 @@ private:
     std::shared_ptr<OfflineMFTReader> m_pFetchReader;
 
     MFTUtils::SafeMFTSegmentNumber m_RootUSN;
+
+    ULONG m_ulFetchGapTolerance = 8L;
+    MFTUtils::FetchStatistics m_FetchStats;
 };
 }  // namespace Orc
 
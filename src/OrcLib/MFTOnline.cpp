@@ -375,6 +375,89 @@ HRESULT MFTOnline::EnumMFTRecord(MFTUtils::EnumMFTRecordCall pCallBack)
     return S_OK;
 }
 
+HRESULT MFTOnline::EnumMFTBlocks(ULONG ulBytesPerBlock, MFTUtils::EnumMFTBlockCall pCallBack)
+{
+    HRESULT hr = E_FAIL;
+
+    if (pCallBack == nullptr)
+        return E_POINTER;
+
+    ULONG ulBytesPerFRS = m_pVolReader->GetBytesPerFRS();
+
+    if (ulBytesPerFRS == 0)
+        return E_UNEXPECTED;
+
+    // Blocks are always made of complete records
+    const ULONG ulFRSPerBlock = std::max<ULONG>(ulBytesPerBlock / ulBytesPerFRS, 1);
+
+    ULONGLONG ullCurrentFRNIndex = 0LL;
+
+    for (const auto& NRAE : m_MFT0Info.ExtentsVector)
+    {
+        if (NRAE.bZero)
+            continue;
+
+        ULONGLONG end = NRAE.DiskOffset + NRAE.DataSize;
+        ULONGLONG extent_position = NRAE.DiskOffset;
+
+        while (extent_position < end)
+        {
+            ULONGLONG ullFRSToRead = std::min<ULONGLONG>((end - extent_position) / ulBytesPerFRS, ulFRSPerBlock);
+
+            if (ullFRSToRead == 0)
+                break;
+
+            // A new buffer per block: the callback is free to keep it (i.e. hand it over to another thread)
+            CBinaryBuffer blockBuffer(true);
+
+            if (!blockBuffer.CheckCount(static_cast<size_t>(ulBytesPerFRS * ullFRSToRead)))
+                return E_OUTOFMEMORY;
+
+            ULONGLONG ullBytesRead = 0LL;
+            if (FAILED(
+                    hr = m_pVolReader->Read(extent_position, blockBuffer, ulBytesPerFRS * ullFRSToRead, ullBytesRead)))
+            {
+                Log::Error(
+                    L"Failed to read {} bytes from at position {} [{}]",
+                    ulBytesPerFRS * ullFRSToRead,
+                    extent_position,
+                    SystemError(hr));
+                return hr;
+            }
+
+            if (ullBytesRead % ulBytesPerFRS > 0)
+            {
+                Log::Warn(
+                    L"Failed to read only complete records {} at position {}",
+                    ulBytesPerFRS * ullFRSToRead,
+                    extent_position);
+            }
+
+            const ULONGLONG ullFRSRead = ullBytesRead / ulBytesPerFRS;
+            if (ullFRSRead == 0)
+                break;
+
+            blockBuffer.SetCount(static_cast<size_t>(ullFRSRead * ulBytesPerFRS));
+
+            if (FAILED(hr = pCallBack(ullCurrentFRNIndex, blockBuffer)))
+            {
+                if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
+                {
+                    Log::Debug("Block Callback asks for enumeration to stop [{}]", SystemError(hr));
+                    return hr;
+                }
+                Log::Error("Block Callback failed [{}]", SystemError(hr));
+                return hr;
+            }
+
+            ullCurrentFRNIndex += ullFRSRead;
+            extent_position += ullFRSRead * ulBytesPerFRS;
+        }
+    }
+
+    return S_OK;
+}
+
 HRESULT MFTOnline::FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUtils::EnumMFTRecordCall pCallBack)
 {
     HRESULT hr = E_FAIL;
@@ -394,12 +477,16 @@ HRESULT MFTOnline::FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUt
 
     ULONG ulBytesPerFRS = m_pVolReader->GetBytesPerFRS();
 
+    // Adjacent and nearby records are fetched with a single read, up to the size of a volume reader read
+    const ULONGLONG ullMaxFRSPerRead = std::max<ULONGLONG>(DEFAULT_READ_SIZE / ulBytesPerFRS, 1);
+
     CBinaryBuffer localReadBuffer(true);
+    CBinaryBuffer chunkBuffer(true);
 
-    if (!localReadBuffer.CheckCount(ulBytesPerFRS))
+    if (!localReadBuffer.CheckCount(static_cast<size_t>(ullMaxFRSPerRead * ulBytesPerFRS)))
         return E_OUTOFMEMORY;
 
-    UINT frnIdx = 0;
+    size_t frnIdx = 0;
     ULONGLONG ullCurrentIndex = 0;
 
     for (const auto& NRAE : m_MFT0Info.ExtentsVector)
@@ -409,96 +496,135 @@ HRESULT MFTOnline::FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUt
         if (NRAE.bZero)
             continue;
 
-        ULARGE_INTEGER current;
-        current.HighPart = frn[frnIdx].SegmentNumberHighPart;
-        current.LowPart = frn[frnIdx].SegmentNumberLowPart;
+        // records located before this extent cannot be fetched
+        while (frnIdx < frn.size() && (NtfsSegmentNumber(&frn[frnIdx]) * ulBytesPerFRS) < ullCurrentIndex)
+        {
+            Log::Debug(L"Skipping... {} is not located in a MFT extent", NtfsSegmentNumber(&frn[frnIdx]));
+            frnIdx++;
+        }
 
-        while (ullCurrentIndex <= (current.QuadPart * ulBytesPerFRS) && (current.QuadPart * ulBytesPerFRS) < ullEnd)
+        while (frnIdx < frn.size() && (NtfsSegmentNumber(&frn[frnIdx]) * ulBytesPerFRS) < ullEnd)
         {
-            // this segment contains the first FRN
-            ULONGLONG ullVolumeOffset = NRAE.DiskOffset + ((current.QuadPart * ulBytesPerFRS) - ullCurrentIndex);
+            const ULONGLONG ullFirst = NtfsSegmentNumber(&frn[frnIdx]);
 
-            ULONGLONG ullBytesRead = 0LL;
-            if (FAILED(hr = m_pFetchReader->Read(ullVolumeOffset, localReadBuffer, ulBytesPerFRS, ullBytesRead)))
+            // coalesce the following records of this extent while the gaps remain tolerable
+            size_t lastIdx = frnIdx;
+            while (lastIdx + 1 < frn.size())
             {
-                Log::Error(
-                    L"Failed to read {} bytes from at position {} [{}]",
-                    ullVolumeOffset,
-                    ulBytesPerFRS,
-                    SystemError(hr));
-                break;
-            }
+                const ULONGLONG ullNext = NtfsSegmentNumber(&frn[lastIdx + 1]);
 
-            PFILE_RECORD_SEGMENT_HEADER pHeader = (PFILE_RECORD_SEGMENT_HEADER)localReadBuffer.GetData();
-
-            if ((pHeader->MultiSectorHeader.Signature[0] != 'F') || (pHeader->MultiSectorHeader.Signature[1] != 'I')
-                || (pHeader->MultiSectorHeader.Signature[2] != 'L') || (pHeader->MultiSectorHeader.Signature[3] != 'E'))
-            {
-                Log::Debug(
-                    L"Skipping... MultiSectorHeader.Signature is not FILE - '{}{}{}{}'",
-                    pHeader->MultiSectorHeader.Signature[0],
-                    pHeader->MultiSectorHeader.Signature[1],
-                    pHeader->MultiSectorHeader.Signature[2],
-                    pHeader->MultiSectorHeader.Signature[3]);
-                frnIdx++;
-                if (frnIdx >= frn.size())
+                if ((ullNext * ulBytesPerFRS) >= ullEnd)
+                    break;
+                if (ullNext > NtfsSegmentNumber(&frn[lastIdx]) + 1 + m_ulFetchGapTolerance)
                     break;
-                current.HighPart = frn[frnIdx].SegmentNumberHighPart;
-                current.LowPart = frn[frnIdx].SegmentNumberLowPart;
+                if (ullNext - ullFirst + 1 > ullMaxFRSPerRead)
+                    break;
+                lastIdx++;
             }
 
-            MFT_SEGMENT_REFERENCE read_record_frn = {0};
-            read_record_frn.SegmentNumberHighPart = pHeader->SegmentNumberHighPart;
-            read_record_frn.SegmentNumberLowPart = pHeader->SegmentNumberLowPart;
-            read_record_frn.SequenceNumber = pHeader->SequenceNumber;
+            const ULONGLONG ullLast = NtfsSegmentNumber(&frn[lastIdx]);
+            const ULONGLONG ullBytesToRead = (ullLast - ullFirst + 1) * ulBytesPerFRS;
+            const ULONGLONG ullVolumeOffset = NRAE.DiskOffset + ((ullFirst * ulBytesPerFRS) - ullCurrentIndex);
 
-            if (NtfsSegmentNumber(&read_record_frn) != NtfsSegmentNumber(&frn[frnIdx]))
+            // the reader may return less than asked for, the group is read until complete
+            ULONGLONG ullBytesRead = 0LL;
+            while (ullBytesRead < ullBytesToRead)
             {
-                Log::Debug(
-                    L"Skipping... {} does not match the expected {}",
-                    NtfsSegmentNumber(&read_record_frn),
-                    NtfsSegmentNumber(&frn[frnIdx]));
-                frnIdx++;
-                if (frnIdx >= frn.size())
+                ULONGLONG ullChunkRead = 0LL;
+                m_FetchStats.ullReads++;
+                if (FAILED(
+                        hr = m_pFetchReader->Read(
+                            ullVolumeOffset + ullBytesRead, chunkBuffer, ullBytesToRead - ullBytesRead, ullChunkRead)))
+                {
+                    Log::Error(
+                        L"Failed to read {} bytes from at position {} [{}]",
+                        ullBytesToRead - ullBytesRead,
+                        ullVolumeOffset + ullBytesRead,
+                        SystemError(hr));
                     break;
-                current.HighPart = frn[frnIdx].SegmentNumberHighPart;
-                current.LowPart = frn[frnIdx].SegmentNumberLowPart;
-                continue;
-            }
-            if (read_record_frn.SequenceNumber != frn[frnIdx].SequenceNumber)
-            {
-                Log::Debug(
-                    L"Skipping... Sequence numbed {} does not match the expected {}",
-                    read_record_frn.SequenceNumber,
-                    frn[frnIdx].SequenceNumber);
-                frnIdx++;
-                if (frnIdx >= frn.size())
+                }
+                if (ullChunkRead == 0LL)
                     break;
-                current.HighPart = frn[frnIdx].SegmentNumberHighPart;
-                current.LowPart = frn[frnIdx].SegmentNumberLowPart;
-                continue;
+
+                ullChunkRead = std::min(ullChunkRead, ullBytesToRead - ullBytesRead);
+                CopyMemory(
+                    localReadBuffer.GetData() + static_cast<size_t>(ullBytesRead),
+                    chunkBuffer.GetData(),
+                    static_cast<size_t>(ullChunkRead));
+                ullBytesRead += ullChunkRead;
             }
 
-            if (FAILED(hr = pCallBack(current.QuadPart, localReadBuffer)))
+            for (; frnIdx <= lastIdx; frnIdx++)
             {
-                if (hr == E_OUTOFMEMORY)
+                const ULONGLONG ullRecord = NtfsSegmentNumber(&frn[frnIdx]);
+                const ULONGLONG ullOffsetInBuffer = (ullRecord - ullFirst) * ulBytesPerFRS;
+
+                if (ullOffsetInBuffer + ulBytesPerFRS > ullBytesRead)
                 {
-                    Log::Error("Add Record Callback failed, not enough memory to continue");
-                    break;
+                    Log::Debug(L"Skipping... {} could not be read", ullRecord);
+                    continue;
                 }
-                else if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
+
+                CBinaryBuffer recordBuffer(
+                    localReadBuffer.GetData() + static_cast<size_t>(ullOffsetInBuffer), ulBytesPerFRS);
+
+                PFILE_RECORD_SEGMENT_HEADER pHeader = (PFILE_RECORD_SEGMENT_HEADER)recordBuffer.GetData();
+
+                if ((pHeader->MultiSectorHeader.Signature[0] != 'F')
+                    || (pHeader->MultiSectorHeader.Signature[1] != 'I')
+                    || (pHeader->MultiSectorHeader.Signature[2] != 'L')
+                    || (pHeader->MultiSectorHeader.Signature[3] != 'E'))
                 {
-                    Log::Debug("Add Record Callback asks for enumeration to stop...");
-                    return hr;
+                    Log::Debug(
+                        L"Skipping... MultiSectorHeader.Signature is not FILE - '{}{}{}{}'",
+                        pHeader->MultiSectorHeader.Signature[0],
+                        pHeader->MultiSectorHeader.Signature[1],
+                        pHeader->MultiSectorHeader.Signature[2],
+                        pHeader->MultiSectorHeader.Signature[3]);
+                    continue;
+                }
+
+                MFT_SEGMENT_REFERENCE read_record_frn = {0};
+                read_record_frn.SegmentNumberHighPart = pHeader->SegmentNumberHighPart;
+                read_record_frn.SegmentNumberLowPart = pHeader->SegmentNumberLowPart;
+                read_record_frn.SequenceNumber = pHeader->SequenceNumber;
+
+                if (NtfsSegmentNumber(&read_record_frn) != ullRecord)
+                {
+                    Log::Debug(
+                        L"Skipping... {} does not match the expected {}",
+                        NtfsSegmentNumber(&read_record_frn),
+                        ullRecord);
+                    continue;
                 }
+                if (read_record_frn.SequenceNumber != frn[frnIdx].SequenceNumber)
+                {
+                    Log::Debug(
+                        L"Skipping... Sequence numbed {} does not match the expected {}",
+                        read_record_frn.SequenceNumber,
+                        frn[frnIdx].SequenceNumber);
+                    continue;
+                }
+
+                m_FetchStats.ullRecords++;
 
-                Log::Warn("Add Record Callback failed [{}]", SystemError(hr));
+                MFTUtils::SafeMFTSegmentNumber ullRecordIndex = ullRecord;
+                if (FAILED(hr = pCallBack(ullRecordIndex, recordBuffer)))
+                {
+                    if (hr == E_OUTOFMEMORY)
+                    {
+                        Log::Error("Add Record Callback failed, not enough memory to continue");
+                        return hr;
+                    }
+                    else if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
+                    {
+                        Log::Debug("Add Record Callback asks for enumeration to stop...");
+                        return hr;
+                    }
+
+                    Log::Warn("Add Record Callback failed [{}]", SystemError(hr));
+                }
             }
-            frnIdx++;
-            if (frnIdx >= frn.size())
-                break;
-            current.HighPart = frn[frnIdx].SegmentNumberHighPart;
-            current.LowPart = frn[frnIdx].SegmentNumberLowPart;
         }
         // this segment must be skipped
         ullCurrentIndex = ullEnd;
@@ -510,5 +636,6 @@ HRESULT MFTOnline::FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUt
         frn.clear();
     }
 
+    Log::Debug(L"Fetched records so far: {} in {} reads", m_FetchStats.ullRecords, m_FetchStats.ullReads);
     return S_OK;
 }
@@ -27,7 +27,10 @@ public:
     virtual ULONG64 GetMftOffset() { return m_MftOffset; }
 
     virtual HRESULT EnumMFTRecord(MFTUtils::EnumMFTRecordCall pCallBack);
+    virtual HRESULT EnumMFTBlocks(ULONG ulBytesPerBlock, MFTUtils::EnumMFTBlockCall pCallBack);
     virtual HRESULT FetchMFTRecord(std::vector<MFT_SEGMENT_REFERENCE>& frn, MFTUtils::EnumMFTRecordCall pCallBack);
+    virtual void SetFetchGapTolerance(ULONG ulRecords) { m_ulFetchGapTolerance = ulRecords; }
+    virtual const MFTUtils::FetchStatistics& GetFetchStatistics() const { return m_FetchStats; }
     virtual ULONG GetMFTRecordCount() const;
     virtual MFTUtils::SafeMFTSegmentNumber GetUSNRoot() const { return m_RootUSN; }
 
@@ -43,6 +46,9 @@ private:
     MFTUtils::NonResidentDataAttrInfo m_MFT0Info;
 
     MFTUtils::SafeMFTSegmentNumber m_RootUSN;
+
+    ULONG m_ulFetchGapTolerance = 8L;
+    MFTUtils::FetchStatistics m_FetchStats;
 };
 }  // namespace Orc
 
@@ -152,6 +152,18 @@ std::shared_ptr<ByteStream> MFTRecordFileInfo::GetFileStream()
     return retval;
 }
 
+std::shared_ptr<ByteStream> MFTRecordFileInfo::GetHashingStream()
+{
+    if (m_pDataAttr == nullptr)
+        return nullptr;
+
+    std::shared_ptr<ByteStream> rawStream, dataStream;
+    if (FAILED(m_pDataAttr->OpenStreams(m_pVolReader, rawStream, dataStream)))
+        return nullptr;
+
+    return dataStream;
+}
+
 bool MFTRecordFileInfo::ExceedsFileThreshold(DWORD nFileSizeHigh, DWORD nFileSizeLow)
 {
     if (m_pMFTRecord == NULL)
@@ -95,6 +95,7 @@ private:
     std::shared_ptr<DataAttribute> m_pDataAttr;
 
     virtual HRESULT Open();
+    virtual std::shared_ptr<ByteStream> GetHashingStream();
 
     virtual ULONGLONG GetFileReferenceNumber()
     {
@@ -91,6 +91,16 @@ public:
 
     typedef std::function<HRESULT(SafeMFTSegmentNumber& ulRecordIndex, CBinaryBuffer& Data)> EnumMFTRecordCall;
 
+    // Called with a buffer of contiguous FRS, the first of which is located at ulFirstRecordIndex
+    typedef std::function<HRESULT(SafeMFTSegmentNumber ulFirstRecordIndex, CBinaryBuffer& Data)> EnumMFTBlockCall;
+
+    class FetchStatistics
+    {
+    public:
+        ULONGLONG ullReads = 0LLU;  // read operations issued
+        ULONGLONG ullRecords = 0LLU;  // records handed to the callback
+    };
+
     static HRESULT GetAttributeNRExtents(
         PATTRIBUTE_RECORD_HEADER pRecord,
         NonResidentDataAttrInfo& FSRAttribInfo,
@@ -18,6 +18,12 @@
 #include "MFTOffline.h"
 
 #include "OrcException.h"
+#include "Semaphore.h"
+
+#include <atomic>
+
+#include <agents.h>
+#include <ppl.h>
 
 #include <boost/scope_exit.hpp>
 
@@ -32,17 +38,39 @@ constexpr auto SEGMENT_MAX_NUMBER = (0x10000);
 
 HCRYPTPROV MFTRecord::g_hProv = NULL;
 
-MFTWalker::MFTFileNameWrapper::MFTFileNameWrapper(const PFILE_NAME pFileName)
+namespace {
+
+bool HasFileSignature(const FILE_RECORD_SEGMENT_HEADER* pHeader)
 {
-    _ASSERT(pFileName != NULL);
-    const size_t size = sizeof(FILE_NAME) + (pFileName->FileNameLength * sizeof(WCHAR));
-    m_pFileName = (PFILE_NAME)malloc(size);
-    if (m_pFileName == NULL)
-        throw std::exception("Out of memory");
-    CopyMemory(m_pFileName, pFileName, size);
-    m_InLocation = boost::indeterminate;
+    return pHeader->MultiSectorHeader.Signature[0] == 'F' && pHeader->MultiSectorHeader.Signature[1] == 'I'
+        && pHeader->MultiSectorHeader.Signature[2] == 'L' && pHeader->MultiSectorHeader.Signature[3] == 'E';
+}
+
+MFT_SEGMENT_REFERENCE
+GetRecordReference(MFTUtils::SafeMFTSegmentNumber ullRecordIndex, const FILE_RECORD_SEGMENT_HEADER* pHeader)
+{
+    MFT_SEGMENT_REFERENCE SafeReference;
+
+    if (pHeader->MultiSectorHeader.UpdateSequenceArrayOffset == 0x2A && pHeader->FirstAttributeOffset == 0x30)
+    {
+        Log::Debug("Weird case of NTFS from 2K upgraded to XP");
+        ULARGE_INTEGER FRN {0};
+        FRN.QuadPart = ullRecordIndex;
+        SafeReference.SegmentNumberLowPart = FRN.LowPart;
+        SafeReference.SegmentNumberHighPart = static_cast<USHORT>(FRN.HighPart);
+        SafeReference.SequenceNumber = pHeader->SequenceNumber;
+    }
+    else
+    {
+        SafeReference.SegmentNumberHighPart = pHeader->SegmentNumberHighPart;
+        SafeReference.SegmentNumberLowPart = pHeader->SegmentNumberLowPart;
+        SafeReference.SequenceNumber = pHeader->SequenceNumber;
+    }
+    return SafeReference;
 }
 
+}  // namespace
+
 HRESULT MFTWalker::Initialize(const shared_ptr<Location>& loc, bool bIncludeNoInUse)
 {
     HRESULT hr = E_FAIL;
@@ -75,6 +103,8 @@ HRESULT MFTWalker::Initialize(const shared_ptr<Location>& loc, bool bIncludeNoIn
     if (FAILED(m_pMFT->Initialize()))
         return hr;
 
+    m_pMFT->SetFetchGapTolerance(m_ulFetchGapTolerance);
+
     if (!loc->GetSubDirs().empty())
     {
         auto& SpecificLocations = loc->GetSubDirs();
@@ -116,49 +146,6 @@ HRESULT MFTWalker::Initialize(const shared_ptr<Location>& loc, bool bIncludeNoIn
     return S_OK;
 }
 
-HRESULT MFTWalker::ExtendNameBuffer(WCHAR** pCurrent)
-{
-    WCHAR* pNewBuf = NULL;
-
-    pNewBuf = (WCHAR*)HeapAlloc(GetProcessHeap(), 0L, m_dwFullNameBufferLen + m_pVolReader->MaxComponentLength());
-    if (!pNewBuf)
-        return E_OUTOFMEMORY;
-
-    if (m_pFullNameBuffer)
-    {
-#ifdef DEBUG
-        wmemset(pNewBuf, L'#', (m_dwFullNameBufferLen + m_pVolReader->MaxComponentLength()) / sizeof(WCHAR));
-        pNewBuf[(m_dwFullNameBufferLen + m_pVolReader->MaxComponentLength()) / sizeof(WCHAR) - 1] = 0;
-#endif
-        memcpy_s(
-            pNewBuf + (m_pVolReader->MaxComponentLength() / sizeof(WCHAR)) - 1,
-            m_dwFullNameBufferLen + m_pVolReader->MaxComponentLength(),
-            m_pFullNameBuffer,
-            m_dwFullNameBufferLen);
-    }
-
-    if (pCurrent)
-    {
-        DWORD dwIndex = (DWORD)(*pCurrent - m_pFullNameBuffer);
-
-        *pCurrent = pNewBuf + (m_pVolReader->MaxComponentLength() / sizeof(WCHAR)) - 1;
-        *pCurrent += dwIndex;
-        if (*pCurrent >= (pNewBuf + (m_dwFullNameBufferLen + m_pVolReader->MaxComponentLength()) / sizeof(WCHAR)))
-        {
-            HeapFree(GetProcessHeap(), 0L, pNewBuf);
-            return E_FAIL;
-        }
-    }
-
-    if (m_pFullNameBuffer)
-        HeapFree(GetProcessHeap(), 0L, m_pFullNameBuffer);
-
-    m_pFullNameBuffer = pNewBuf;
-    m_dwFullNameBufferLen += m_pVolReader->MaxComponentLength();
-
-    return S_OK;
-}
-
 HRESULT MFTWalker::UpdateAttributeList(MFTRecord* pRecord)
 {
     HRESULT hr = E_FAIL;
@@ -227,8 +214,7 @@ HRESULT MFTWalker::UpdateAttributeList(MFTRecord* pRecord)
     }
     if (pRecord->IsBaseRecord() && pRecord->IsDirectory())
     {
-        auto it = m_DirectoryNames.find(NtfsFullSegmentNumber(&pRecord->m_FileReferenceNumber));
-        if (it == end(m_DirectoryNames))
+        if (m_DirectoryNames.Find(NtfsFullSegmentNumber(&pRecord->m_FileReferenceNumber)) == nullptr)
         {
             if (FAILED(hr = AddDirectoryName(pRecord)))
             {
@@ -248,21 +234,21 @@ bool MFTWalker::IsInLocation(PFILE_NAME pFileName)
     boost::logic::tribool bInLocation = boost::indeterminate;
 
     MFTUtils::SafeMFTSegmentNumber ulLastSegmentNumber = NtfsFullSegmentNumber(&(pFileName->ParentDirectory));
-    auto it = m_DirectoryNames.find(ulLastSegmentNumber);
+    auto pParent = m_DirectoryNames.Find(ulLastSegmentNumber);
 
-    if (it == end(m_DirectoryNames))
+    if (pParent == nullptr)
     {
         // parent directory not found :'( we return not in location
         return false;
     }
     else
     {
-        if (it->second.m_InLocation)
+        if (pParent->InLocation)
         {
             // Direct parent is in location, return true!
             return true;
         }
-        else if (!it->second.m_InLocation)
+        else if (!pParent->InLocation)
         {
             // if direct parent is determined and false then, Record is not in location!
             return false;
@@ -272,7 +258,7 @@ bool MFTWalker::IsInLocation(PFILE_NAME pFileName)
             // direct parent is indeterminate... need to determinate!
             bool bNameInLocation = false;
             GetFullNameAndIfInLocation(pFileName, nullptr, nullptr, &bNameInLocation);
-            it->second.m_InLocation = bNameInLocation;  // result saved for future queries
+            pParent->InLocation = bNameInLocation;  // result saved for future queries
             return bNameInLocation;
         }
     }
@@ -284,49 +270,13 @@ const WCHAR* MFTWalker::GetFullNameAndIfInLocation(
     DWORD* pdwLen,
     bool* pbInSpecificLocation)
 {
-    WCHAR* pCurrent = NULL;
-
     if (m_Locations.empty() && pbInSpecificLocation != nullptr)
         *pbInSpecificLocation = true;
 
-    if (m_pFullNameBuffer == NULL)
-    {
-        m_dwFullNameBufferLen = msl::utilities::SafeInt(m_pVolReader->MaxComponentLength()) * 2;
-        m_pFullNameBuffer = (WCHAR*)HeapAlloc(GetProcessHeap(), 0L, m_dwFullNameBufferLen);
-        if (!m_pFullNameBuffer)
-            return NULL;
-    }
-#ifdef DEBUG
-    wmemset(m_pFullNameBuffer, L'_', m_dwFullNameBufferLen / sizeof(WCHAR));
-    m_pFullNameBuffer[(m_pVolReader->MaxComponentLength() / sizeof(WCHAR)) - 1] = 0;
-#endif
-
-    DWORD dwCount = 0;
-    DWORD dwBaseNameCount = 0;
-
-    // Doing trailing \0
-    if (dwCount > m_dwFullNameBufferLen)
-    {
-        if (FAILED(ExtendNameBuffer(&pCurrent)))
-            return NULL;
-    }
-    _ASSERT(dwCount < m_dwFullNameBufferLen);
-    {
-        dwCount += sizeof(WCHAR);
-
-        if (dwCount > m_dwFullNameBufferLen)
-        {
-            if (FAILED(ExtendNameBuffer(&pCurrent)))
-                return NULL;
-        }
-        _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-        pCurrent = m_pFullNameBuffer + (m_dwFullNameBufferLen / sizeof(WCHAR)) - 1;
-        _ASSERT(pCurrent >= m_pFullNameBuffer);
-        *pCurrent = 0;
-    }
+    m_FullName.clear();
 
     // Doing Stream name
+    std::wstring_view streamName;
     if (pDataAttr != NULL)
     {
         PATTRIBUTE_RECORD_HEADER pHeader = pDataAttr->Header();
@@ -334,173 +284,65 @@ const WCHAR* MFTWalker::GetFullNameAndIfInLocation(
         if (pHeader->NameLength)
         {
             // Stream has a name, we have to add it
-            {
-                dwCount += pHeader->NameLength * sizeof(WCHAR);
-                dwBaseNameCount += pHeader->NameLength;
-
-                if (dwCount > m_dwFullNameBufferLen)
-                {
-                    if (FAILED(ExtendNameBuffer(&pCurrent)))
-                        return NULL;
-                }
-                _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-                pCurrent -= pHeader->NameLength;
-                _ASSERT(pCurrent >= m_pFullNameBuffer);
-
-                memcpy_s(
-                    pCurrent, dwCount, ((BYTE*)pHeader) + pHeader->NameOffset, pHeader->NameLength * sizeof(WCHAR));
-            }
-
-            // adding colon
-            {
-                dwCount += 1 * sizeof(WCHAR);
-                dwBaseNameCount += 1;
-
-                if (dwCount > m_dwFullNameBufferLen)
-                {
-                    if (FAILED(ExtendNameBuffer(&pCurrent)))
-                        return NULL;
-                }
-                _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-                pCurrent -= 1;
-                _ASSERT(pCurrent >= m_pFullNameBuffer);
-
-                *pCurrent = L':';
-            }
+            streamName =
+                std::wstring_view((const WCHAR*)(((BYTE*)pHeader) + pHeader->NameOffset), pHeader->NameLength);
         }
     }
 
-    // Doing base file name
-    PFILE_NAME pCurFileName = pFileName;
-    if (pCurFileName != nullptr)
-    {
-        dwCount += pCurFileName->FileNameLength * sizeof(WCHAR);
-        dwBaseNameCount += pCurFileName->FileNameLength;
-
-        if (dwCount > m_dwFullNameBufferLen)
+    const auto AppendBaseName = [this, &streamName](const std::wstring_view& fileName) {
+        m_FullName.append(fileName);
+        if (!streamName.empty())
         {
-            if (FAILED(ExtendNameBuffer(&pCurrent)))
-                return NULL;
+            m_FullName.push_back(L':');
+            m_FullName.append(streamName);
         }
-        _ASSERT(dwCount <= m_dwFullNameBufferLen);
+    };
 
-        pCurrent -= pCurFileName->FileNameLength;
-        _ASSERT(pCurrent >= m_pFullNameBuffer);
-        memcpy_s(pCurrent, dwCount, pCurFileName->FileName, pCurFileName->FileNameLength * sizeof(WCHAR));
-    }
-    else
+    if (pFileName == nullptr)
     {
-        const WCHAR szNullFileName[] = L"<NoName>";
-        const DWORD dwNullFileName = (DWORD)wcslen(szNullFileName);
-
-        dwCount += dwNullFileName * sizeof(WCHAR);
-        dwBaseNameCount += dwNullFileName;
-
-        if (dwCount > m_dwFullNameBufferLen)
-        {
-            if (FAILED(ExtendNameBuffer(&pCurrent)))
-                return NULL;
-        }
-        _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-        pCurrent -= dwNullFileName;
-        _ASSERT(pCurrent >= m_pFullNameBuffer);
-        memcpy_s(pCurrent, dwCount, szNullFileName, dwNullFileName * sizeof(WCHAR));
+        AppendBaseName(L"<NoName>");
 
         // Entries with lost parents are
         if (pbInSpecificLocation != nullptr)
             *pbInSpecificLocation = m_Locations.empty() ? true : false;
 
         if (pdwLen)
-            *pdwLen = dwCount;
-        return pCurrent;
+            *pdwLen = static_cast<DWORD>((m_FullName.size() + 1) * sizeof(WCHAR));
+        return m_FullName.c_str();
     }
 
-    MFTUtils::SafeMFTSegmentNumber ulLastSegmentNumber = NtfsFullSegmentNumber(&(pCurFileName->ParentDirectory));
+    // Parent paths are memoized by the directory table: only the file's own name is added here
+    const MFTUtils::SafeMFTSegmentNumber ulParentSegmentNumber = NtfsFullSegmentNumber(&(pFileName->ParentDirectory));
 
-    auto pParentPair = m_DirectoryNames.find(NtfsFullSegmentNumber(&(pCurFileName->ParentDirectory)));
-    auto pDirectParent = pParentPair;
+    std::wstring_view parentPath;
+    MFTUtils::SafeMFTSegmentNumber ulMissingSegmentNumber = 0LL;
+    const bool bComplete =
+        m_DirectoryNames.GetPath(ulParentSegmentNumber, m_pMFT->GetUSNRoot(), parentPath, ulMissingSegmentNumber);
 
-    while (pParentPair != end(m_DirectoryNames))
+    if (!bComplete)
     {
-        PFILE_NAME pParentName = pParentPair->second.FileName();
-
-        if (pParentName == NULL)
-        {
-            std::wstring_view fileName(pCurFileName->FileName, pCurFileName->FileNameLength);
-            Log::Debug(L"Could not determine main parent file name for '{}'", fileName);
-            break;
-        }
-
-        if (!(pParentName->FileNameLength == 1 && *pParentName->FileName == L'.'))
-        {
-            // Adding \\ (i.e. one backslash)
-            {
-                dwCount += sizeof(WCHAR);
-                if (dwCount > m_dwFullNameBufferLen)
-                {
-                    if (FAILED(ExtendNameBuffer(&pCurrent)))
-                        return NULL;
-                }
-                _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-                pCurrent--;
-                _ASSERT(pCurrent >= m_pFullNameBuffer);
-
-                *pCurrent = L'\\';
-            }
-
-            // Adding parent file name
-            {
-                dwCount += pParentName->FileNameLength * sizeof(WCHAR);
-                if (dwCount > m_dwFullNameBufferLen)
-                {
-                    if (FAILED(ExtendNameBuffer(&pCurrent)))
-                        return NULL;
-                }
-                _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-                pCurrent -= pParentName->FileNameLength;
-                _ASSERT(pCurrent >= m_pFullNameBuffer);
-
-                memcpy_s(pCurrent, dwCount, pParentName->FileName, pParentName->FileNameLength * sizeof(WCHAR));
-            }
-        }
-        ulLastSegmentNumber = NtfsFullSegmentNumber(&(pParentName->ParentDirectory));
-        pParentPair = m_DirectoryNames.find(NtfsFullSegmentNumber(&(pParentName->ParentDirectory)));
-
-        if (ulLastSegmentNumber == m_pMFT->GetUSNRoot())
-            break;
+        // Parent folder was _not_ found, inserting "place holder"
+        WCHAR szPlaceHolder[24];
+        swprintf_s(szPlaceHolder, L"\\__%.16I64X__", ulMissingSegmentNumber);
+        m_FullName.append(szPlaceHolder);
     }
 
-    if (ulLastSegmentNumber == m_pMFT->GetUSNRoot())
-    {
-        // Adding \\ (i.e. one backslash)
-        {
-            dwCount += sizeof(WCHAR);
-            if (dwCount > m_dwFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            _ASSERT(dwCount <= m_dwFullNameBufferLen);
+    m_FullName.append(parentPath);
+    m_FullName.push_back(L'\\');
+    AppendBaseName(std::wstring_view(pFileName->FileName, pFileName->FileNameLength));
 
-            pCurrent--;
-            _ASSERT(pCurrent >= m_pFullNameBuffer);
-
-            *pCurrent = L'\\';
-        }
+    if (bComplete)
+    {
+        auto pDirectParent = m_DirectoryNames.Find(ulParentSegmentNumber);
 
-        if (pDirectParent != end(m_DirectoryNames))
+        if (pDirectParent != nullptr)
         {
             // Looking for presence in specific locations
-            if (!m_Locations.empty() && boost::logic::indeterminate(pDirectParent->second.m_InLocation))
+            if (!m_Locations.empty() && boost::logic::indeterminate(pDirectParent->InLocation))
             {
-                pDirectParent->second.m_InLocation = std::any_of(
-                    begin(m_Locations), end(m_Locations), [pCurrent, pbInSpecificLocation](const wstring& item) {
-                        return !_wcsnicmp(pCurrent, item.c_str(), item.size());
+                pDirectParent->InLocation =
+                    std::any_of(begin(m_Locations), end(m_Locations), [this](const wstring& item) {
+                        return !_wcsnicmp(m_FullName.c_str(), item.c_str(), item.size());
                     });
             }
             if (pbInSpecificLocation != nullptr)
@@ -509,75 +351,24 @@ const WCHAR* MFTWalker::GetFullNameAndIfInLocation(
                     *pbInSpecificLocation = true;
                 else
                 {
-                    if (pDirectParent->second.m_InLocation)
+                    if (pDirectParent->InLocation)
                         *pbInSpecificLocation = true;
-                    else if (!pDirectParent->second.m_InLocation)
+                    else if (!pDirectParent->InLocation)
                         *pbInSpecificLocation = false;
                     else
                     {
-                        Log::Error(L"Failed to determine if in location for '{}'", pCurrent);
+                        Log::Error(L"Failed to determine if in location for '{}'", m_FullName);
                         *pbInSpecificLocation = false;
                     }
                 }
             }
         }
-
-        // And we're done :-)
-        if (pdwLen)
-            *pdwLen = dwCount;
-        return pCurrent;
     }
-    else
-    {
-        // Parent folder was _not_ found, inserting "place holder"
-        // Adding \\ (i.e. one backslash)
-
-        {
-            dwCount += sizeof(WCHAR);
-            if (dwCount > m_dwFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-            pCurrent--;
-            _ASSERT(pCurrent >= m_pFullNameBuffer);
-            *pCurrent = L'\\';
-        }
-
-        {
-            dwCount += sizeof(WCHAR) * 20;
-            if (dwCount > m_dwFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-            pCurrent -= 20;
-            swprintf_s(pCurrent, 21, L"__%.16I64X__", ulLastSegmentNumber);
-            pCurrent[20] = L'\\';
-        }
-
-        {
-            dwCount += sizeof(WCHAR);
-            if (dwCount > m_dwFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            _ASSERT(dwCount <= m_dwFullNameBufferLen);
-
-            pCurrent--;
-            _ASSERT(pCurrent >= m_pFullNameBuffer);
-            *pCurrent = L'\\';
-        }
 
-        if (pdwLen)
-            *pdwLen = dwCount;
-        return pCurrent;
-    }
+    // And we're done :-)
+    if (pdwLen)
+        *pdwLen = static_cast<DWORD>((m_FullName.size() + 1) * sizeof(WCHAR));
+    return m_FullName.c_str();
 }
 
 bool MFTWalker::AreAttributesComplete(const MFTRecord* pBaseRecord, std::vector<MFT_SEGMENT_REFERENCE>& missingRecords)
@@ -687,9 +478,9 @@ bool MFTWalker::IsRecordComplete(
                 break;
             }
 
-            const auto& pParentPair = m_DirectoryNames.find(NtfsFullSegmentNumber(&(pFileName->ParentDirectory)));
+            const auto pParentEntry = m_DirectoryNames.Find(NtfsFullSegmentNumber(&(pFileName->ParentDirectory)));
 
-            if (pParentPair == end(m_DirectoryNames))
+            if (pParentEntry == nullptr)
             {
                 Log::Trace(
                     "Record {}: Incomplete due to missing file name parent record {}",
@@ -705,9 +496,10 @@ bool MFTWalker::IsRecordComplete(
                 break;
             }
 
-            auto pParentName = pParentPair->second.FileName();
+            auto pParentName = pParentEntry;
 
-            while (pParentName != nullptr)
+            // a memoized path means the whole chain up to the root is known
+            while (pParentName != nullptr && !pParentName->HasPath())
             {
                 MFTUtils::UnSafeMFTSegmentNumber UnSafeSegmentNumber =
                     NtfsSegmentNumber(&(pParentName->ParentDirectory));
@@ -715,16 +507,15 @@ bool MFTWalker::IsRecordComplete(
                 if (SafeSegmentNumber == m_pMFT->GetUSNRoot() || UnSafeSegmentNumber == 0)
                     break;
 
-                const auto& pOtherParentPair =
-                    m_DirectoryNames.find(NtfsFullSegmentNumber(&(pParentName->ParentDirectory)));
-                if (pOtherParentPair == end(m_DirectoryNames))
+                const auto pOtherParentEntry = m_DirectoryNames.Find(SafeSegmentNumber);
+                if (pOtherParentEntry == nullptr)
                 {
                     Log::Trace(
                         "Record {}: Incomplete due to missing file name parent record {}",
                         NtfsFullSegmentNumber(&pRecord->GetFileReferenceNumber()),
                         pParentName->ParentDirectory.SegmentNumberLowPart);
 
-                    auto pParent = m_MFTMap.find(NtfsFullSegmentNumber(&(pParentName->ParentDirectory)));
+                    auto pParent = m_MFTMap.find(SafeSegmentNumber);
                     if (pParent == end(m_MFTMap))
                     {
                         missingRecords.push_back(pParentName->ParentDirectory);
@@ -734,7 +525,7 @@ bool MFTWalker::IsRecordComplete(
                 }
                 else
                 {
-                    pParentName = pOtherParentPair->second.FileName();
+                    pParentName = pOtherParentEntry;
                 }
             }
         }
@@ -1312,20 +1103,50 @@ HRESULT MFTWalker::DeleteRecord(MFTRecord* pRecord)
         if (aPair.second != nullptr && aPair.second != pRecord && aPair.first != ullRecordIndex)
         {
             Log::Trace("Deleting record {} (child of {})", aPair.first, ullRecordIndex);
-            aPair.second->~MFTRecord();
-            m_SegmentStore.FreeCell(aPair.second);
+            FreeRecord(aPair.second);
             m_MFTMap[aPair.first] = nullptr;
         }
     }
 
     Log::Trace("Deleting record {}", ullRecordIndex);
 
-    pRecord->~MFTRecord();
-    m_SegmentStore.FreeCell(pRecord);
+    FreeRecord(pRecord);
     m_MFTMap[ullRecordIndex] = nullptr;
     return S_OK;
 }
 
+LPVOID MFTWalker::NewRecordCell(bool bPrepared)
+{
+    concurrency::critical_section::scoped_lock sl(m_SegmentStoreCS);
+    LPVOID pCell = m_SegmentStore.GetNewCell();
+    if (pCell != nullptr && bPrepared)
+        m_PreparedCells++;
+    return pCell;
+}
+
+void MFTWalker::FreeRecord(MFTRecord* pRecord)
+{
+    if (pRecord == nullptr)
+        return;
+
+    pRecord->~MFTRecord();
+
+    concurrency::critical_section::scoped_lock sl(m_SegmentStoreCS);
+    m_SegmentStore.FreeCell(pRecord);
+}
+
+size_t MFTWalker::AllocatedRecordCells()
+{
+    concurrency::critical_section::scoped_lock sl(m_SegmentStoreCS);
+    return m_SegmentStore.AllocatedCells();
+}
+
+size_t MFTWalker::AddedRecordCells()
+{
+    concurrency::critical_section::scoped_lock sl(m_SegmentStoreCS);
+    return m_SegmentStore.AllocatedCells() - m_PreparedCells;
+}
+
 HRESULT MFTWalker::AddDirectoryName(MFTRecord* pRecord)
 {
     if (pRecord->m_pBaseFileRecord == nullptr && pRecord->IsDirectory())
@@ -1333,8 +1154,10 @@ HRESULT MFTWalker::AddDirectoryName(MFTRecord* pRecord)
         // simple case, record is not a child and a directory... let's add it!
         PFILE_NAME pFileName = pRecord->GetMain_PFILE_NAME();
         if (pFileName != NULL)
-            m_DirectoryNames.insert(pair<MFTUtils::SafeMFTSegmentNumber, MFTFileNameWrapper>(
-                NtfsFullSegmentNumber(&pRecord->m_FileReferenceNumber), MFTFileNameWrapper(pFileName)));
+            m_DirectoryNames.Insert(
+                pRecord->m_FileReferenceNumber,
+                pFileName->ParentDirectory,
+                std::wstring_view(pFileName->FileName, pFileName->FileNameLength));
         else
         {
             Log::Trace(
@@ -1345,16 +1168,15 @@ HRESULT MFTWalker::AddDirectoryName(MFTRecord* pRecord)
     else if (pRecord->m_pBaseFileRecord != nullptr && pRecord->m_pBaseFileRecord->IsDirectory())
     {
         // we need to check if master record is already in m_DirectoryNames....
-        auto iter = m_DirectoryNames.find(NtfsFullSegmentNumber(&pRecord->m_pBaseFileRecord->m_FileReferenceNumber));
-
-        if (iter == end(m_DirectoryNames))
+        if (m_DirectoryNames.Find(NtfsFullSegmentNumber(&pRecord->m_pBaseFileRecord->m_FileReferenceNumber)) == nullptr)
         {
             // it's not... we need to add it!
             PFILE_NAME pFileName = pRecord->m_pBaseFileRecord->GetMain_PFILE_NAME();
             if (pFileName != NULL)
-                m_DirectoryNames.insert(pair<MFTUtils::SafeMFTSegmentNumber, MFTFileNameWrapper>(
-                    NtfsFullSegmentNumber(&pRecord->m_pBaseFileRecord->m_FileReferenceNumber),
-                    MFTFileNameWrapper(pFileName)));
+                m_DirectoryNames.Insert(
+                    pRecord->m_pBaseFileRecord->m_FileReferenceNumber,
+                    pFileName->ParentDirectory,
+                    std::wstring_view(pFileName->FileName, pFileName->FileNameLength));
             else
             {
                 Log::Trace(
@@ -1368,6 +1190,15 @@ HRESULT MFTWalker::AddDirectoryName(MFTRecord* pRecord)
 
 HRESULT
 MFTWalker::AddRecord(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuffer& Data, MFTRecord*& pAddedRecord)
+{
+    return AddRecord(ullRecordIndex, Data, nullptr, pAddedRecord);
+}
+
+HRESULT MFTWalker::AddRecord(
+    MFTUtils::SafeMFTSegmentNumber& ullRecordIndex,
+    CBinaryBuffer& Data,
+    const PreparedRecord* pPrepared,
+    MFTRecord*& pAddedRecord)
 {
     HRESULT hr = E_FAIL;
 
@@ -1376,10 +1207,10 @@ MFTWalker::AddRecord(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuff
     try
     {
 
-        PFILE_RECORD_SEGMENT_HEADER pHeader = (PFILE_RECORD_SEGMENT_HEADER)Data.GetData();
+        PFILE_RECORD_SEGMENT_HEADER pHeader = pPrepared != nullptr ? pPrepared->pRecord->m_pRecord
+                                                                   : (PFILE_RECORD_SEGMENT_HEADER)Data.GetData();
 
-        if ((pHeader->MultiSectorHeader.Signature[0] != 'F') || (pHeader->MultiSectorHeader.Signature[1] != 'I')
-            || (pHeader->MultiSectorHeader.Signature[2] != 'L') || (pHeader->MultiSectorHeader.Signature[3] != 'E'))
+        if (!HasFileSignature(pHeader))
         {
             Log::Debug(
                 "Skipping... MultiSectorHeader.Signature is not FILE - '{}{}{}{}'",
@@ -1387,26 +1218,12 @@ MFTWalker::AddRecord(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuff
                 pHeader->MultiSectorHeader.Signature[1],
                 pHeader->MultiSectorHeader.Signature[2],
                 pHeader->MultiSectorHeader.Signature[3]);
+            if (pPrepared != nullptr)
+                FreeRecord(pPrepared->pRecord);
             return S_OK;
         }
 
-        MFT_SEGMENT_REFERENCE SafeReference;
-
-        if (pHeader->MultiSectorHeader.UpdateSequenceArrayOffset == 0x2A && pHeader->FirstAttributeOffset == 0x30)
-        {
-            Log::Debug("Weird case of NTFS from 2K upgraded to XP");
-            ULARGE_INTEGER FRN {0};
-            FRN.QuadPart = ullRecordIndex;
-            SafeReference.SegmentNumberLowPart = FRN.LowPart;
-            SafeReference.SegmentNumberHighPart = static_cast<USHORT>(FRN.HighPart);
-            SafeReference.SequenceNumber = pHeader->SequenceNumber;
-        }
-        else
-        {
-            SafeReference.SegmentNumberHighPart = pHeader->SegmentNumberHighPart;
-            SafeReference.SegmentNumberLowPart = pHeader->SegmentNumberLowPart;
-            SafeReference.SequenceNumber = pHeader->SequenceNumber;
-        }
+        MFT_SEGMENT_REFERENCE SafeReference = GetRecordReference(ullRecordIndex, pHeader);
 
         MFTUtils::SafeMFTSegmentNumber SafeFRN = NtfsFullSegmentNumber(&SafeReference);
 
@@ -1415,49 +1232,57 @@ MFTWalker::AddRecord(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuff
         if (pIter != end(m_MFTMap) && pIter->second == nullptr)
         {
             // This record was added, treated and deleted) --> Now SKIP it!
+            if (pPrepared != nullptr)
+                FreeRecord(pPrepared->pRecord);
             return S_FALSE;
         }
 
         MFTRecord* pRecord = nullptr;
         if (pIter == end(m_MFTMap))
         {
-            if (m_SegmentStore.AllocatedCells() >= m_CellStoreLastWalk + m_CellStoreThreshold)
+            if (AddedRecordCells() >= m_CellStoreLastWalk + m_CellStoreThreshold)
             {
                 WalkRecords(false);
-                m_CellStoreLastWalk = m_SegmentStore.AllocatedCells();
+                m_CellStoreLastWalk = AddedRecordCells();
             }
 
-            LPVOID pBuf = m_SegmentStore.GetNewCell();
-            if (pBuf == nullptr)
-                return E_OUTOFMEMORY;
-
-            pRecord = new (pBuf) MFTRecord;
-
-            if (pRecord == NULL)
+            if (pPrepared != nullptr)
             {
-                // We walk through FILES for our already recorded nodes with hope this will free some space
-                WalkRecords(false);
-                pBuf = m_SegmentStore.GetNewCell();
-                pRecord = new (pBuf) MFTRecord;
-                if (pRecord == NULL)
+                pRecord = pPrepared->pRecord;
+            }
+            else
+            {
+                LPVOID pBuf = NewRecordCell();
+                if (pBuf == nullptr)
                 {
-                    // We are still unable to move forward...
-                    return E_OUTOFMEMORY;
+                    // We walk through FILES for our already recorded nodes with hope this will free some space
+                    WalkRecords(false);
+                    pBuf = NewRecordCell();
+                    if (pBuf == nullptr)
+                    {
+                        // We are still unable to move forward...
+                        return E_OUTOFMEMORY;
+                    }
                 }
-            }
 
-            pRecord->m_pRecord = (PFILE_RECORD_SEGMENT_HEADER)(((BYTE*)pRecord) + sizeof(MFTRecord));
+                pRecord = new (pBuf) MFTRecord;
+
+                pRecord->m_pRecord = (PFILE_RECORD_SEGMENT_HEADER)(((BYTE*)pRecord) + sizeof(MFTRecord));
 
-            memcpy_s(
-                (LPBYTE)pRecord->m_pRecord,
-                m_pVolReader->GetBytesPerFRS(),
-                Data.GetData(),
-                m_pVolReader->GetBytesPerFRS());
+                memcpy_s(
+                    (LPBYTE)pRecord->m_pRecord,
+                    m_pVolReader->GetBytesPerFRS(),
+                    Data.GetData(),
+                    m_pVolReader->GetBytesPerFRS());
 
-            pRecord->m_FileReferenceNumber = SafeReference;
+                pRecord->m_FileReferenceNumber = SafeReference;
+            }
         }
         else
         {
+            // Record was fetched before the enumeration reached it, the prepared copy is useless
+            if (pPrepared != nullptr)
+                FreeRecord(pPrepared->pRecord);
             pRecord = pIter->second;
         }
 
@@ -1494,7 +1319,11 @@ MFTWalker::AddRecord(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuff
                 }
             }
 
-            hr = pRecord->ParseRecord(m_pVolReader, pRecord->m_pRecord, m_pVolReader->GetBytesPerFRS(), pBaseRecord);
+            if (pPrepared != nullptr && pPrepared->pRecord == pRecord && pPrepared->bParsed)
+                hr = pPrepared->hr;
+            else
+                hr = pRecord->ParseRecord(
+                    m_pVolReader, pRecord->m_pRecord, m_pVolReader->GetBytesPerFRS(), pBaseRecord);
 
             if (hr == S_FALSE)
             {
@@ -1632,7 +1461,10 @@ MFTWalker::AddRecord(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuff
     return S_OK;
 }
 
-HRESULT MFTWalker::AddRecordCallback(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuffer& Data)
+HRESULT MFTWalker::AddRecordCallback(
+    MFTUtils::SafeMFTSegmentNumber& ullRecordIndex,
+    CBinaryBuffer& Data,
+    const PreparedRecord* pPrepared)
 {
     HRESULT hr = E_FAIL;
 
@@ -1641,7 +1473,7 @@ HRESULT MFTWalker::AddRecordCallback(MFTUtils::SafeMFTSegmentNumber& ullRecordIn
 
         MFTRecord* pRecord = nullptr;
 
-        if (FAILED(hr = AddRecord(ullRecordIndex, Data, pRecord)))
+        if (FAILED(hr = AddRecord(ullRecordIndex, Data, pPrepared, pRecord)))
         {
             Log::Error("Failed to add record {} [{}]", ullRecordIndex, SystemError(hr));
             return hr;
@@ -1821,6 +1653,218 @@ HRESULT MFTWalker::AddRecordCallback(MFTUtils::SafeMFTSegmentNumber& ullRecordIn
     return S_OK;
 }
 
+void MFTWalker::PrepareRecord(PreparedRecord& prepared, const BYTE* pData)
+{
+    const auto pHeader = reinterpret_cast<const FILE_RECORD_SEGMENT_HEADER*>(pData);
+
+    if (!HasFileSignature(pHeader))
+        return;  // nothing to prepare, the dispatching thread skips empty slots
+
+    try
+    {
+        LPVOID pBuf = NewRecordCell(true);
+        if (pBuf == nullptr)
+        {
+            prepared.hr = E_OUTOFMEMORY;
+            return;
+        }
+
+        MFTRecord* pRecord = new (pBuf) MFTRecord;
+        pRecord->m_pRecord = (PFILE_RECORD_SEGMENT_HEADER)(((BYTE*)pRecord) + sizeof(MFTRecord));
+
+        memcpy_s(
+            (LPBYTE)pRecord->m_pRecord, m_pVolReader->GetBytesPerFRS(), pData, m_pVolReader->GetBytesPerFRS());
+
+        pRecord->m_FileReferenceNumber = GetRecordReference(prepared.ullRecordIndex, pHeader);
+        prepared.pRecord = pRecord;
+
+        if (FAILED(prepared.hr = MFTUtils::MultiSectorFixup(pRecord->m_pRecord, m_pVolReader)))
+        {
+            // ParseRecord would have failed the same way
+            prepared.bParsed = true;
+            return;
+        }
+        pRecord->m_bIsMultiSectorFixed = true;
+
+        // Child records need their base record, which only the dispatching thread can look up
+        if (0 == NtfsSegmentNumber(&(pRecord->m_pRecord->BaseFileRecordSegment))
+            && (m_bIncludeNotInUse || (pRecord->m_pRecord->Flags & FILE_RECORD_SEGMENT_IN_USE)))
+        {
+            prepared.hr =
+                pRecord->ParseRecord(m_pVolReader, pRecord->m_pRecord, m_pVolReader->GetBytesPerFRS(), nullptr);
+            prepared.bParsed = true;
+        }
+    }
+    catch (const Orc::Exception& e)
+    {
+        Log::Error(L"Error while preparing record {:#x}: {}", prepared.ullRecordIndex, e.Description);
+        prepared.hr = E_FAIL;
+        prepared.bParsed = true;
+    }
+    catch (const std::exception& e)
+    {
+        Log::Error("Preparing record {:#x} threw exception '{}'", prepared.ullRecordIndex, e.what());
+        prepared.hr = E_FAIL;
+        prepared.bParsed = true;
+    }
+}
+
+HRESULT MFTWalker::PipelinedEnumMFTRecord()
+{
+    struct Block
+    {
+        MFTUtils::SafeMFTSegmentNumber ullFirstRecordIndex = 0LL;
+        CBinaryBuffer Data;
+        std::vector<PreparedRecord> Records;
+        bool bLast = false;
+        HRESULT hr = S_OK;
+    };
+
+    const ULONG ulBytesPerFRS = m_pVolReader->GetBytesPerFRS();
+    if (ulBytesPerFRS == 0)
+        return E_UNEXPECTED;
+
+    Log::Debug(
+        "Pipelined MFT enumeration ({} bytes per block, {} blocks in flight)",
+        m_Pipeline.ulBytesPerBlock,
+        m_Pipeline.ulBlocksInFlight);
+
+    // Each block read holds a slot until the dispatching thread is done with it
+    Semaphore blocksInFlight(static_cast<LONG>(std::max<ULONG>(m_Pipeline.ulBlocksInFlight, 1)));
+    concurrency::unbounded_buffer<std::shared_ptr<Block>> readBlocks;
+    concurrency::unbounded_buffer<std::shared_ptr<Block>> preparedBlocks;
+    std::atomic<bool> bStop = false;
+
+    concurrency::task_group stages;
+
+    // Stage 1: read ahead the MFT blocks
+    stages.run([&]() {
+        HRESULT hr = E_FAIL;
+        try
+        {
+            hr = m_pMFT->EnumMFTBlocks(
+                m_Pipeline.ulBytesPerBlock,
+                [&](MFTUtils::SafeMFTSegmentNumber ullFirstRecordIndex, CBinaryBuffer& Data) -> HRESULT {
+                    blocksInFlight.Acquire();
+                    if (bStop)
+                    {
+                        blocksInFlight.Release();
+                        return HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES);
+                    }
+                    auto block = std::make_shared<Block>();
+                    block->ullFirstRecordIndex = ullFirstRecordIndex;
+                    block->Data = std::move(Data);
+                    concurrency::send(readBlocks, block);
+                    return S_OK;
+                });
+        }
+        catch (const std::exception& e)
+        {
+            Log::Error("MFT block enumeration threw exception '{}'", e.what());
+            hr = E_FAIL;
+        }
+
+        auto last = std::make_shared<Block>();
+        last->bLast = true;
+        last->hr = hr;
+        concurrency::send(readBlocks, last);
+    });
+
+    // Stage 2: fixup every record of a block (and parse base records) across the worker pool
+    stages.run([&]() {
+        for (;;)
+        {
+            auto block = concurrency::receive(readBlocks);
+            if (!block->bLast && !bStop)
+            {
+                const size_t ulRecords = block->Data.GetCount() / ulBytesPerFRS;
+                block->Records.resize(ulRecords);
+
+                concurrency::parallel_for(size_t(0), ulRecords, [&block, ulBytesPerFRS, this](size_t i) {
+                    auto& prepared = block->Records[i];
+                    prepared.ullRecordIndex = block->ullFirstRecordIndex + i;
+                    PrepareRecord(prepared, block->Data.GetData() + (i * ulBytesPerFRS));
+                });
+                block->Data.RemoveAll();
+            }
+            concurrency::send(preparedBlocks, block);
+            if (block->bLast)
+                break;
+        }
+    });
+
+    // Stage 3: add records to the map and call the callbacks in MFT order on this thread
+    HRESULT hr = S_OK;
+    CBinaryBuffer noData;
+    for (;;)
+    {
+        auto block = concurrency::receive(preparedBlocks);
+        if (block->bLast)
+        {
+            if (SUCCEEDED(hr))
+                hr = block->hr;
+            break;
+        }
+
+        for (auto& prepared : block->Records)
+        {
+            if (prepared.pRecord != nullptr)
+                m_PreparedCells--;  // from now on the cell is either added to the map or freed
+
+            if (bStop)
+            {
+                // Keep draining so that the other stages can complete
+                FreeRecord(prepared.pRecord);
+                continue;
+            }
+
+            if (prepared.pRecord == nullptr)
+            {
+                if (FAILED(prepared.hr))
+                {
+                    Log::Error("Failed to prepare record {} [{}]", prepared.ullRecordIndex, SystemError(prepared.hr));
+                    if (prepared.hr == E_OUTOFMEMORY)
+                    {
+                        hr = prepared.hr;
+                        bStop = true;
+                    }
+                }
+                continue;
+            }
+
+            HRESULT hrRecord = AddRecordCallback(prepared.ullRecordIndex, noData, &prepared);
+            if (FAILED(hrRecord))
+            {
+                if (hrRecord == E_OUTOFMEMORY)
+                {
+                    Log::Error(
+                        "Add Record Callback failed, not enough memory to continue [{}]", SystemError(hrRecord));
+                    hr = hrRecord;
+                    bStop = true;
+                }
+                else if (hrRecord == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
+                {
+                    Log::Debug("Add Record Callback asks for enumeration to stop [{}]", SystemError(hrRecord));
+                    hr = hrRecord;
+                    bStop = true;
+                }
+                else
+                {
+                    Log::Warn("Add Record Callback failed [{}]", SystemError(hrRecord));
+                }
+            }
+        }
+        blocksInFlight.Release();
+    }
+
+    stages.wait();
+
+    if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES) && !bStop)
+        hr = S_OK;  // the reader stopped on its own
+
+    return hr;
+}
+
 HRESULT MFTWalker::Walk(const Callbacks& Callbacks)
 {
     HRESULT hr = E_FAIL;
@@ -1829,13 +1873,21 @@ HRESULT MFTWalker::Walk(const Callbacks& Callbacks)
         return hr;
 
     m_ulMFTRecordCount = GetMFTRecordCount();
+    m_DirectoryNames.Reserve(m_ulMFTRecordCount);
 
     if (m_ulMFTRecordCount > 0)
     {
-        hr = m_pMFT->EnumMFTRecord(
-            [this](MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuffer& Data) -> HRESULT {
-                return AddRecordCallback(ullRecordIndex, Data);
-            });
+        if (m_Pipeline.bEnabled)
+        {
+            hr = PipelinedEnumMFTRecord();
+        }
+        else
+        {
+            hr = m_pMFT->EnumMFTRecord(
+                [this](MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuffer& Data) -> HRESULT {
+                    return AddRecordCallback(ullRecordIndex, Data);
+                });
+        }
     }
 
     if (hr == HRESULT_FROM_WIN32(ERROR_NO_MORE_FILES))
@@ -1910,6 +1962,49 @@ HRESULT MFTWalker::Statistics(const WCHAR* szMsg)
         Log::Warn("Heap still maintains {} entries", m_SegmentStore.AllocatedCells());
     }
 
+    {
+        const auto& records = m_SegmentStore.GetStatistics();
+        Log::Debug(
+            "Record store -> Allocated: {}, Peak: {}, Total allocations: {}, Slabs: {} ({} bytes)",
+            records.AllocatedCells,
+            records.PeakCells,
+            records.TotalAllocations,
+            records.Slabs,
+            records.ReservedBytes);
+
+        const auto names = m_DirectoryNames.GetStatistics();
+        Log::Debug(
+            "Directory names -> Entries: {}, Unique names: {} ({} bytes), Cached paths: {} ({} bytes), Path hits: {}, "
+            "Path builds: {}",
+            names.Entries,
+            names.UniqueNames,
+            names.NameBytes,
+            names.CachedPaths,
+            names.PathBytes,
+            names.PathHits,
+            names.PathBuilds);
+    }
+
+    if (m_pMFT != nullptr)
+    {
+        const auto& fetchStats = m_pMFT->GetFetchStatistics();
+        Log::Debug("Fetched records -> Reads: {}, Records: {}", fetchStats.ullReads, fetchStats.ullRecords);
+    }
+
+    if (auto pCompleteReader = std::dynamic_pointer_cast<CompleteVolumeReader>(m_pVolReader);
+        pCompleteReader && pCompleteReader->GetBlockCache())
+    {
+        const auto stats = pCompleteReader->GetBlockCache()->GetStatistics();
+        Log::Debug(
+            "Block cache -> Hits: {}, Misses: {}, Read aheads: {}, Reads: {} ({} bytes), Evictions: {}",
+            stats.ullHits,
+            stats.ullMisses,
+            stats.ullReadAheads,
+            stats.ullReads,
+            stats.ullBytesRead,
+            stats.ullEvictions);
+    }
+
 #ifdef _DEBUG
 
     if (FAILED(hr = m_SegmentStore.EnumCells([this](void* pData) {
@@ -11,7 +11,8 @@
 
 #include "VolumeReader.h"
 
-#include "HeapStorage.h"
+#include "ArenaStorage.h"
+#include "DirectoryNameTable.h"
 
 #include "Location.h"
 
@@ -25,9 +26,12 @@
 #include <set>
 #include <map>
 #include <unordered_map>
+#include <atomic>
 #include <unordered_set>
 #include <boost/logic/tribool.hpp>
 
+#include <concrt.h>
+
 #pragma managed(push, off)
 
 namespace Orc {
@@ -98,6 +102,16 @@ public:
         std::function<const WCHAR*(const PFILE_NAME pFileName, const std::shared_ptr<DataAttribute>& pDataAttr)>;
     using InLocationBuilder = std::function<bool(const PFILE_NAME pFileName)>;
 
+    // Pipelined walk: MFT blocks are read ahead on one thread, records are fixed up (and base records parsed) by a
+    // worker pool while the calling thread adds them to the map and calls the callbacks, in MFT order.
+    class PipelineOptions
+    {
+    public:
+        bool bEnabled = false;
+        ULONG ulBytesPerBlock = 1024 * 1024;  // rounded down to a multiple of the FRS size
+        ULONG ulBlocksInFlight = 8;  // blocks read ahead of the calling thread
+    };
+
 public:
     MFTWalker()
         : m_SegmentStore(L"MFTSegmentStore")
@@ -106,6 +120,12 @@ public:
 
     HRESULT Initialize(const std::shared_ptr<Location>& loc, bool bIncludeNoInUse = true);
 
+    void SetPipelineOptions(const PipelineOptions& options) { m_Pipeline = options; }
+    const PipelineOptions& GetPipelineOptions() const { return m_Pipeline; }
+
+    // Missing records closer than ulRecords records are fetched together with a single read
+    void SetFetchGapTolerance(ULONG ulRecords) { m_ulFetchGapTolerance = ulRecords; }
+
     FullNameBuilder GetFullNameBuilder()
     {
         return [this](PFILE_NAME pFileName, const std::shared_ptr<DataAttribute>& pDataAttr) -> const WCHAR* {
@@ -126,38 +146,28 @@ public:
     ~MFTWalker();
 
 private:
-    HeapStorage m_SegmentStore;
+    SlabStorage m_SegmentStore;
+    concurrency::critical_section m_SegmentStoreCS;  // the store is also used by the pipeline workers
+    std::atomic<size_t> m_PreparedCells = 0L;  // cells held by the pipeline, not yet added to the map
     size_t m_CellStoreLastWalk = 0L;
     size_t m_CellStoreThreshold = 50 * 1024;
 
-    std::unordered_map<MFTUtils::SafeMFTSegmentNumber, MFTRecord*> m_MFTMap;
+    PipelineOptions m_Pipeline;
+    ULONG m_ulFetchGapTolerance = 8L;
 
-    class ORCLIB_API MFTFileNameWrapper
+    // A record copied in the segment store, fixed up and, if it is a base record, parsed by a pipeline worker
+    class PreparedRecord
     {
     public:
-        PFILE_NAME m_pFileName;
-        boost::logic::tribool m_InLocation;
-
-        MFTFileNameWrapper(const MFTFileNameWrapper& pFileName)
-            : m_InLocation(boost::indeterminate)
-        {
-            if (pFileName.m_pFileName != nullptr)
-                throw std::exception("Invalid MFTFileNameWrapper construction");
-            m_pFileName = nullptr;
-        };
-        MFTFileNameWrapper(const PFILE_NAME pFileName);
-        MFTFileNameWrapper(MFTFileNameWrapper&& Other) noexcept
-        {
-            m_pFileName = Other.m_pFileName;
-            Other.m_pFileName = nullptr;
-            m_InLocation = Other.m_InLocation;
-        }
-        ~MFTFileNameWrapper() { free(m_pFileName); };
-
-        PFILE_NAME FileName() const { return m_pFileName; };
+        MFTUtils::SafeMFTSegmentNumber ullRecordIndex = 0LL;
+        MFTRecord* pRecord = nullptr;
+        bool bParsed = false;
+        HRESULT hr = S_OK;
     };
 
-    std::unordered_map<MFTUtils::SafeMFTSegmentNumber, MFTFileNameWrapper> m_DirectoryNames;
+    std::unordered_map<MFTUtils::SafeMFTSegmentNumber, MFTRecord*> m_MFTMap;
+
+    DirectoryNameTable m_DirectoryNames;
     std::unordered_set<std::wstring, CaseInsensitiveUnordered> m_Locations;
 
     bool m_bIncludeNotInUse = false;
@@ -182,10 +192,7 @@ private:
 
     DWORD m_dwWalkedItems = 0L;
 
-    WCHAR* m_pFullNameBuffer = nullptr;
-    DWORD m_dwFullNameBufferLen = 0LU;
-
-    HRESULT ExtendNameBuffer(WCHAR** pCurrent);
+    std::wstring m_FullName;
 
     HRESULT UpdateAttributeList(MFTRecord* pRecord);
 
@@ -198,10 +205,26 @@ private:
 
     HRESULT DeleteRecord(MFTRecord* pRecord);
 
+    LPVOID NewRecordCell(bool bPrepared = false);
+    void FreeRecord(MFTRecord* pRecord);
+    size_t AllocatedRecordCells();
+    size_t AddedRecordCells();
+
     HRESULT AddDirectoryName(MFTRecord* pRecord);
 
     HRESULT AddRecord(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuffer& Data, MFTRecord*& pRecord);
-    HRESULT AddRecordCallback(MFTUtils::SafeMFTSegmentNumber& ullRecordIndex, CBinaryBuffer& Data);
+    HRESULT AddRecord(
+        MFTUtils::SafeMFTSegmentNumber& ullRecordIndex,
+        CBinaryBuffer& Data,
+        const PreparedRecord* pPrepared,
+        MFTRecord*& pRecord);
+    HRESULT AddRecordCallback(
+        MFTUtils::SafeMFTSegmentNumber& ullRecordIndex,
+        CBinaryBuffer& Data,
+        const PreparedRecord* pPrepared = nullptr);
+
+    void PrepareRecord(PreparedRecord& prepared, const BYTE* pData);
+    HRESULT PipelinedEnumMFTRecord();
 
     HRESULT ParseI30AndCallback(MFTRecord* pRecord);
 
@@ -19,6 +19,7 @@
 #include "BufferStream.h"
 #include "NTFSStream.h"
 #include "UncompressNTFSStream.h"
+#include "UncompressWofStream.h"
 
 #include "SystemDetails.h"
 
@@ -28,6 +29,13 @@ using namespace std;
 
 using namespace Orc;
 
+namespace {
+
+// 1MB with 4K clusters
+constexpr DWORD kCompressedReadAheadUnits = 16;
+
+}  // namespace
+
 HRESULT MftRecordAttribute::AddContinuationAttribute(const shared_ptr<MftRecordAttribute>& pMftRecordAttribute)
 {
     if (m_pHeader == NULL || pMftRecordAttribute == NULL)
@@ -257,6 +265,92 @@ HRESULT MftRecordAttribute::GetStreams(
         dataStream = m_Details->GetRawStream();
     }
 
+    if (FAILED(hr = OpenStreams(pVolReader, rawStream, dataStream)))
+        return hr;
+
+    if (m_Details == nullptr)
+        m_Details = std::make_unique<DataDetails>();
+    if (m_Details != nullptr)
+    {
+        m_Details->SetDataStream(dataStream);
+        m_Details->SetRawStream(rawStream);
+    }
+    return S_OK;
+}
+
+HRESULT MftRecordAttribute::OpenStreams(
+    const std::shared_ptr<VolumeReader>& pVolReader,
+    std::shared_ptr<ByteStream>& rawStream,
+    std::shared_ptr<ByteStream>& dataStream)
+{
+    HRESULT hr = E_FAIL;
+
+    if (FAILED(hr = OpenAttributeStreams(pVolReader, rawStream, dataStream)))
+        return hr;
+
+    // the unnamed data of a file compressed by WOF is sparse, its content is in the WofCompressedData stream
+    if (m_pHostRecord != nullptr && m_pHostRecord->IsOverlayFile() && TypeCode() == $DATA && NameLength() == 0)
+    {
+        std::shared_ptr<ByteStream> wofStream;
+        if (FAILED(hr = OpenWofStream(pVolReader, wofStream)))
+        {
+            Log::Debug(
+                "Failed to open WOF compressed data of record {:#x}, using its unnamed data stream [{}]",
+                m_pHostRecord->GetSafeMFTSegmentNumber(),
+                SystemError(hr));
+        }
+        else
+            dataStream = wofStream;
+    }
+    return S_OK;
+}
+
+HRESULT MftRecordAttribute::OpenWofStream(
+    const std::shared_ptr<VolumeReader>& pVolReader,
+    std::shared_ptr<ByteStream>& dataStream)
+{
+    HRESULT hr = E_FAIL;
+
+    const auto& attributes = m_pHostRecord->GetAttributeList();
+    const auto reparse = std::find_if(std::cbegin(attributes), std::cend(attributes), [](const auto& entry) {
+        return entry.TypeCode() == $REPARSE_POINT && entry.Attribute() != nullptr
+            && ReparsePointAttribute::IsWindowsOverlayFile(
+                   ReparsePointAttribute::GetReparsePointType(entry.Attribute()->Header()));
+    });
+    if (reparse == std::cend(attributes))
+        return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+    WofAlgorithm algorithm;
+    if (FAILED(hr = WOFReparseAttribute::GetCompressionAlgorithm(reparse->Attribute()->Header(), algorithm)))
+        return hr;
+
+    const auto compressedData = m_pHostRecord->GetDataAttribute(L"WofCompressedData");
+    if (compressedData == nullptr)
+        return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+    std::shared_ptr<ByteStream> compressedRawStream, compressedStream;
+    if (FAILED(hr = compressedData->OpenStreams(pVolReader, compressedRawStream, compressedStream)))
+        return hr;
+
+    DWORDLONG ullSize = 0LL;
+    if (FAILED(hr = DataSize(pVolReader, ullSize)))
+        return hr;
+
+    auto stream = make_shared<UncompressWofStream>();
+    if (FAILED(hr = stream->Open(compressedStream, algorithm, ullSize)))
+        return hr;
+
+    dataStream = std::move(stream);
+    return S_OK;
+}
+
+HRESULT MftRecordAttribute::OpenAttributeStreams(
+    const std::shared_ptr<VolumeReader>& pVolReader,
+    std::shared_ptr<ByteStream>& rawStream,
+    std::shared_ptr<ByteStream>& dataStream)
+{
+    HRESULT hr = E_FAIL;
+
     _ASSERT(pVolReader);
 
     _ASSERT(m_pHeader != nullptr);
@@ -273,13 +367,6 @@ HRESULT MftRecordAttribute::GetStreams(
                     return hr;
                 }
                 dataStream = rawStream = stream;
-                if (m_Details == nullptr)
-                    m_Details = std::make_unique<DataDetails>();
-                if (m_Details != nullptr)
-                {
-                    m_Details->SetDataStream(dataStream);
-                    m_Details->SetRawStream(rawStream);
-                }
                 return S_OK;
             }
             case 1:
@@ -295,13 +382,6 @@ HRESULT MftRecordAttribute::GetStreams(
                     return hr;
                 }
                 dataStream = rawStream = stream;
-                if (m_Details == nullptr)
-                    m_Details = std::make_unique<DataDetails>();
-                if (m_Details != nullptr)
-                {
-                    m_Details->SetDataStream(dataStream);
-                    m_Details->SetRawStream(rawStream);
-                }
                 return S_OK;
             }
             case 4: {
@@ -336,15 +416,12 @@ HRESULT MftRecordAttribute::GetStreams(
                             m_pHostRecord->GetSafeMFTSegmentNumber());
                     }
                 }
+
+                // small reads (hashing, yara blocks) are served from units decompressed ahead, concurrently
+                datastream->SetReadAhead(kCompressedReadAheadUnits);
+
                 dataStream = datastream;
                 rawStream = rawdata;
-                if (m_Details == nullptr)
-                    m_Details = std::make_unique<DataDetails>();
-                if (m_Details != nullptr)
-                {
-                    m_Details->SetDataStream(dataStream);
-                    m_Details->SetRawStream(rawStream);
-                }
                 return S_OK;
             }
         }
@@ -370,13 +447,6 @@ HRESULT MftRecordAttribute::GetStreams(
         }
 
         rawStream = dataStream = stream;
-        if (m_Details == nullptr)
-            m_Details = std::make_unique<DataDetails>();
-        if (m_Details != nullptr)
-        {
-            m_Details->SetDataStream(dataStream);
-            m_Details->SetRawStream(rawStream);
-        }
         return S_OK;
     }
     return E_FAIL;
@@ -660,6 +730,30 @@ HRESULT ReparsePointAttribute::Parse()
     return S_OK;
 }
 
+HRESULT WOFReparseAttribute::GetCompressionAlgorithm(PATTRIBUTE_RECORD_HEADER pHeader, WofAlgorithm& algorithm)
+{
+    if (pHeader->FormCode != RESIDENT_FORM)
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+    PREPARSE_POINT_ATTRIBUTE pReparse =
+        (PREPARSE_POINT_ATTRIBUTE)(((BYTE*)pHeader) + pHeader->Form.Resident.ValueOffset);
+
+    if (pReparse->DataLength < sizeof(WOF_REPARSE_POINT_DATA))
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+    PWOF_REPARSE_POINT_DATA pData = (PWOF_REPARSE_POINT_DATA)pReparse->Data;
+
+    // files backed by a WIM (WIMBoot) have no compressed data of their own
+    if (pData->WofProvider != 2)
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    algorithm = static_cast<WofAlgorithm>(pData->CompressionFormat);
+    if (wof_chunk_size(algorithm) == 0)
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    return S_OK;
+}
+
 HRESULT ReparsePointAttribute::CleanCachedData()
 {
     strSubstituteName.clear();
@@ -16,6 +16,7 @@
 #include "DataDetails.h"
 #include "MFTUtils.h"
 #include "CryptoHashStream.h"
+#include "WofCompression.h"
 
 #include <vector>
 #include <boost/dynamic_bitset/dynamic_bitset.hpp>
@@ -46,6 +47,12 @@ protected:
     bool m_bNonResidentInfoPresent;
     LONGLONG m_LowestVcn;
 
+    HRESULT OpenAttributeStreams(
+        const std::shared_ptr<VolumeReader>& pVolReader,
+        std::shared_ptr<ByteStream>& rawStream,
+        std::shared_ptr<ByteStream>& dataStream);
+    HRESULT OpenWofStream(const std::shared_ptr<VolumeReader>& pVolReader, std::shared_ptr<ByteStream>& dataStream);
+
 public:
     MftRecordAttribute(PATTRIBUTE_RECORD_HEADER pHeader, MFTRecord* pHostingRecord)
         : m_pHeader(pHeader)
@@ -148,6 +155,12 @@ public:
         std::shared_ptr<ByteStream>& dataStream);
     HRESULT GetStreams(const std::shared_ptr<VolumeReader>& pVolReader);
 
+    // New streams over the attribute's data, not cached in the details (they can be read by another thread)
+    HRESULT OpenStreams(
+        const std::shared_ptr<VolumeReader>& pVolReader,
+        std::shared_ptr<ByteStream>& rawStream,
+        std::shared_ptr<ByteStream>& dataStream);
+
     std::shared_ptr<ByteStream> GetDataStream(const std::shared_ptr<VolumeReader>& pVolReader);
     std::shared_ptr<ByteStream> GetRawStream(const std::shared_ptr<VolumeReader>& pVolReader);
 
@@ -331,6 +344,9 @@ class ORCLIB_API WOFReparseAttribute : public ReparsePointAttribute
 public:
     WOFReparseAttribute(PATTRIBUTE_RECORD_HEADER pHeader, MFTRecord* pRecord)
         : ReparsePointAttribute(pHeader, pRecord) {};
+
+    // Compression format of a file compressed by the WOF file provider (the data is in its WofCompressedData stream)
+    static HRESULT GetCompressionAlgorithm(PATTRIBUTE_RECORD_HEADER pHeader, WofAlgorithm& algorithm);
 };
 
 class ORCLIB_API ExtendedAttribute : public MftRecordAttribute
@@ -0,0 +1,552 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "MultiHash.h"
+
+#include <atomic>
+#include <utility>
+
+#include "CryptoUtilities.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#    include <intrin.h>
+#    include <immintrin.h>
+#    define ORC_SHA_EXTENSIONS
+#endif
+
+using namespace Orc;
+
+namespace {
+
+inline uint32_t Rotl(uint32_t x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+inline uint32_t Rotr(uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+inline uint32_t LoadLE32(const BYTE* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline uint32_t LoadBE32(const BYTE* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+inline void StoreLE32(BYTE* p, uint32_t x)
+{
+    p[0] = (BYTE)x;
+    p[1] = (BYTE)(x >> 8);
+    p[2] = (BYTE)(x >> 16);
+    p[3] = (BYTE)(x >> 24);
+}
+
+inline void StoreBE32(BYTE* p, uint32_t x)
+{
+    p[0] = (BYTE)(x >> 24);
+    p[1] = (BYTE)(x >> 16);
+    p[2] = (BYTE)(x >> 8);
+    p[3] = (BYTE)x;
+}
+
+constexpr std::array<uint32_t, 4> MD5Init = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+constexpr std::array<uint32_t, 5> Sha1Init = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+constexpr std::array<uint32_t, 8> Sha256Init = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+constexpr uint32_t MD5K[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+
+constexpr int MD5S[4][4] = {{7, 12, 17, 22}, {5, 9, 14, 20}, {4, 11, 16, 23}, {6, 10, 15, 21}};
+
+alignas(16) constexpr uint32_t Sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+// Rounds are unrolled at compile time: the round function, message word and rotation are constants in each step
+template <int i>
+__forceinline void MD5Step(uint32_t& a, uint32_t b, uint32_t c, uint32_t d, const uint32_t (&M)[16])
+{
+    constexpr int r = i >> 4;
+    constexpr int g = r == 0 ? i : r == 1 ? (5 * i + 1) & 15 : r == 2 ? (3 * i + 5) & 15 : (7 * i) & 15;
+
+    uint32_t f;
+    if constexpr (r == 0)
+        f = d ^ (b & (c ^ d));
+    else if constexpr (r == 1)
+        f = c ^ (d & (b ^ c));
+    else if constexpr (r == 2)
+        f = b ^ c ^ d;
+    else
+        f = c ^ (b | ~d);
+
+    a = b + Rotl(a + f + MD5K[i] + M[g], MD5S[r][i & 3]);
+}
+
+template <int... i>
+__forceinline void MD5Rounds(uint32_t (&v)[4], const uint32_t (&M)[16], std::integer_sequence<int, i...>)
+{
+    // the (a, b, c, d) roles rotate one register to the right at each step
+    (MD5Step<i>(v[(64 - i) & 3], v[(65 - i) & 3], v[(66 - i) & 3], v[(67 - i) & 3], M), ...);
+}
+
+void MD5Compress(uint32_t state[4], const BYTE* pChunks, size_t cChunks)
+{
+    for (; cChunks > 0; cChunks--, pChunks += 64)
+    {
+        uint32_t M[16];
+        for (int i = 0; i < 16; i++)
+            M[i] = LoadLE32(pChunks + i * 4);
+
+        uint32_t v[4] = {state[0], state[1], state[2], state[3]};
+        MD5Rounds(v, M, std::make_integer_sequence<int, 64>());
+
+        state[0] += v[0];
+        state[1] += v[1];
+        state[2] += v[2];
+        state[3] += v[3];
+    }
+}
+
+template <int i>
+__forceinline void Sha1Step(uint32_t a, uint32_t& b, uint32_t c, uint32_t d, uint32_t& e, uint32_t (&W)[16])
+{
+    uint32_t w;
+    if constexpr (i < 16)
+        w = W[i];
+    else
+        w = W[i & 15] = Rotl(W[(i - 3) & 15] ^ W[(i - 8) & 15] ^ W[(i - 14) & 15] ^ W[i & 15], 1);
+
+    uint32_t f;
+    if constexpr (i < 20)
+        f = (d ^ (b & (c ^ d))) + 0x5a827999;
+    else if constexpr (i < 40)
+        f = (b ^ c ^ d) + 0x6ed9eba1;
+    else if constexpr (i < 60)
+        f = ((b & c) | (d & (b | c))) + 0x8f1bbcdc;
+    else
+        f = (b ^ c ^ d) + 0xca62c1d6;
+
+    e += Rotl(a, 5) + f + w;
+    b = Rotl(b, 30);
+}
+
+template <int... i>
+__forceinline void Sha1Rounds(uint32_t (&v)[5], uint32_t (&W)[16], std::integer_sequence<int, i...>)
+{
+    // the (a, b, c, d, e) roles rotate one register to the right at each step
+    (Sha1Step<i>(v[(80 - i) % 5], v[(81 - i) % 5], v[(82 - i) % 5], v[(83 - i) % 5], v[(84 - i) % 5], W), ...);
+}
+
+void Sha1Compress(uint32_t state[5], const BYTE* pChunks, size_t cChunks)
+{
+    for (; cChunks > 0; cChunks--, pChunks += 64)
+    {
+        uint32_t W[16];
+        for (int i = 0; i < 16; i++)
+            W[i] = LoadBE32(pChunks + i * 4);
+
+        uint32_t v[5] = {state[0], state[1], state[2], state[3], state[4]};
+        Sha1Rounds(v, W, std::make_integer_sequence<int, 80>());
+
+        state[0] += v[0];
+        state[1] += v[1];
+        state[2] += v[2];
+        state[3] += v[3];
+        state[4] += v[4];
+    }
+}
+
+void Sha256Compress(uint32_t state[8], const BYTE* pChunks, size_t cChunks)
+{
+    for (; cChunks > 0; cChunks--, pChunks += 64)
+    {
+        uint32_t W[64];
+        for (int i = 0; i < 16; i++)
+            W[i] = LoadBE32(pChunks + i * 4);
+        for (int i = 16; i < 64; i++)
+        {
+            const uint32_t s0 = Rotr(W[i - 15], 7) ^ Rotr(W[i - 15], 18) ^ (W[i - 15] >> 3);
+            const uint32_t s1 = Rotr(W[i - 2], 17) ^ Rotr(W[i - 2], 19) ^ (W[i - 2] >> 10);
+            W[i] = W[i - 16] + s0 + W[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; i++)
+        {
+            const uint32_t S1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+            const uint32_t ch = g ^ (e & (f ^ g));
+            const uint32_t t1 = h + S1 + ch + Sha256K[i] + W[i];
+            const uint32_t S0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+            const uint32_t maj = (a & b) | (c & (a | b));
+            const uint32_t t2 = S0 + maj;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef ORC_SHA_EXTENSIONS
+
+bool DetectShaExtensions()
+{
+    int info[4] = {0};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    const bool bSSSE3 = (info[2] & (1 << 9)) != 0;
+    const bool bSSE41 = (info[2] & (1 << 19)) != 0;
+
+    __cpuidex(info, 7, 0);
+    const bool bSHA = (info[1] & (1 << 29)) != 0;
+
+    return bSSSE3 && bSSE41 && bSHA;
+}
+
+// Four rounds per sha1rnds4, the message schedule of the next rounds is computed by sha1msg1/sha1msg2 meanwhile
+template <int i>
+__forceinline void
+Sha1RoundsShaExtensions(__m128i& ABCD, __m128i& E0, __m128i& E1, __m128i (&MSG)[4], const BYTE* pChunk)
+{
+    const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i& current = MSG[i & 3];
+    if constexpr (i < 4)
+        current = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pChunk + i * 16)), MASK);
+
+    // E0 and E1 take turns
+    __m128i& E = (i & 1) ? E1 : E0;
+    if constexpr (i == 0)
+        E = _mm_add_epi32(E, current);
+    else
+        E = _mm_sha1nexte_epu32(E, current);
+    ((i & 1) ? E0 : E1) = ABCD;
+
+    if constexpr (i >= 3 && i <= 18)
+        MSG[(i + 1) & 3] = _mm_sha1msg2_epu32(MSG[(i + 1) & 3], current);
+
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E, i / 5);
+
+    if constexpr (i >= 1 && i <= 16)
+        MSG[(i + 3) & 3] = _mm_sha1msg1_epu32(MSG[(i + 3) & 3], current);
+    if constexpr (i >= 2 && i <= 17)
+        MSG[(i + 2) & 3] = _mm_xor_si128(MSG[(i + 2) & 3], current);
+}
+
+template <int... i>
+__forceinline void
+Sha1ChunkShaExtensions(__m128i& ABCD, __m128i& E0, __m128i& E1, const BYTE* pChunk, std::integer_sequence<int, i...>)
+{
+    __m128i MSG[4];
+    (Sha1RoundsShaExtensions<i>(ABCD, E0, E1, MSG, pChunk), ...);
+}
+
+void Sha1CompressShaExtensions(uint32_t state[5], const BYTE* pChunks, size_t cChunks)
+{
+    __m128i ABCD = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1B);
+    __m128i E0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+    __m128i E1;
+
+    for (; cChunks > 0; cChunks--, pChunks += 64)
+    {
+        const __m128i ABCD_SAVE = ABCD;
+        const __m128i E0_SAVE = E0;
+
+        Sha1ChunkShaExtensions(ABCD, E0, E1, pChunks, std::make_integer_sequence<int, 20>());
+
+        E0 = _mm_sha1nexte_epu32(E0, E0_SAVE);
+        ABCD = _mm_add_epi32(ABCD, ABCD_SAVE);
+    }
+
+    _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(ABCD, 0x1B));
+    state[4] = (uint32_t)_mm_extract_epi32(E0, 3);
+}
+
+// Two rounds per sha256rnds2 on the (ABEF, CDGH) register pair, schedule computed by sha256msg1/sha256msg2
+template <int i>
+__forceinline void Sha256RoundsShaExtensions(__m128i& STATE0, __m128i& STATE1, __m128i (&MSG)[4], const BYTE* pChunk)
+{
+    const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i& current = MSG[i & 3];
+    if constexpr (i < 4)
+        current = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pChunk + i * 16)), MASK);
+
+    __m128i K = _mm_add_epi32(current, _mm_load_si128((const __m128i*)&Sha256K[i * 4]));
+    STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, K);
+
+    if constexpr (i >= 3 && i <= 14)
+    {
+        __m128i& next = MSG[(i + 1) & 3];
+        next = _mm_add_epi32(next, _mm_alignr_epi8(current, MSG[(i + 3) & 3], 4));
+        next = _mm_sha256msg2_epu32(next, current);
+    }
+
+    K = _mm_shuffle_epi32(K, 0x0E);
+    STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, K);
+
+    if constexpr (i >= 1 && i <= 12)
+        MSG[(i + 3) & 3] = _mm_sha256msg1_epu32(MSG[(i + 3) & 3], current);
+}
+
+template <int... i>
+__forceinline void Sha256ChunkShaExtensions(
+    __m128i& STATE0,
+    __m128i& STATE1,
+    const BYTE* pChunk,
+    std::integer_sequence<int, i...>)
+{
+    __m128i MSG[4];
+    (Sha256RoundsShaExtensions<i>(STATE0, STATE1, MSG, pChunk), ...);
+}
+
+void Sha256CompressShaExtensions(uint32_t state[8], const BYTE* pChunks, size_t cChunks)
+{
+    __m128i TMP = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);  // CDAB
+    __m128i STATE1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);  // EFGH
+    __m128i STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);  // ABEF
+    STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);  // CDGH
+
+    for (; cChunks > 0; cChunks--, pChunks += 64)
+    {
+        const __m128i ABEF_SAVE = STATE0;
+        const __m128i CDGH_SAVE = STATE1;
+
+        Sha256ChunkShaExtensions(STATE0, STATE1, pChunks, std::make_integer_sequence<int, 16>());
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+    }
+
+    TMP = _mm_shuffle_epi32(STATE0, 0x1B);  // FEBA
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);  // DCHG
+    _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(TMP, STATE1, 0xF0));  // DCBA
+    _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(STATE1, TMP, 8));  // HGFE
+}
+
+#endif  // ORC_SHA_EXTENSIONS
+
+std::atomic<bool>& ShaExtensionsEnabled()
+{
+    static std::atomic<bool> bEnabled = MultiHash::HasShaExtensions();
+    return bEnabled;
+}
+
+}  // namespace
+
+bool MultiHash::HasShaExtensions()
+{
+#ifdef ORC_SHA_EXTENSIONS
+    static const bool bHasShaExtensions = DetectShaExtensions();
+    return bHasShaExtensions;
+#else
+    return false;
+#endif
+}
+
+void MultiHash::EnableShaExtensions(bool bEnable)
+{
+    ShaExtensionsEnabled().store(bEnable && HasShaExtensions());
+}
+
+bool MultiHash::UsesShaExtensions()
+{
+    return ShaExtensionsEnabled().load(std::memory_order_relaxed);
+}
+
+void MultiHash::Reset(Algorithm algs)
+{
+    m_Algorithms = algs;
+    m_ullLength = 0LL;
+    m_MD5 = MD5Init;
+    m_Sha1 = Sha1Init;
+    m_Sha256 = Sha256Init;
+    m_cbPending = 0;
+}
+
+void MultiHash::Compress(const BYTE* pChunks, size_t cChunks)
+{
+#ifdef ORC_SHA_EXTENSIONS
+    const bool bShaExtensions = UsesShaExtensions();
+#endif
+
+    if (HasFlag(m_Algorithms, Algorithm::MD5))
+        MD5Compress(m_MD5.data(), pChunks, cChunks);
+
+    if (HasFlag(m_Algorithms, Algorithm::SHA1))
+    {
+#ifdef ORC_SHA_EXTENSIONS
+        if (bShaExtensions)
+            Sha1CompressShaExtensions(m_Sha1.data(), pChunks, cChunks);
+        else
+#endif
+            Sha1Compress(m_Sha1.data(), pChunks, cChunks);
+    }
+
+    if (HasFlag(m_Algorithms, Algorithm::SHA256))
+    {
+#ifdef ORC_SHA_EXTENSIONS
+        if (bShaExtensions)
+            Sha256CompressShaExtensions(m_Sha256.data(), pChunks, cChunks);
+        else
+#endif
+            Sha256Compress(m_Sha256.data(), pChunks, cChunks);
+    }
+}
+
+void MultiHash::Update(const BYTE* pData, size_t cbData)
+{
+    if (m_Algorithms == Algorithm::Undefined || cbData == 0)
+        return;
+
+    m_ullLength += cbData;
+
+    if (m_cbPending > 0)
+    {
+        const size_t cbCopy = std::min(ChunkSize - m_cbPending, cbData);
+        memcpy(m_Pending.data() + m_cbPending, pData, cbCopy);
+        m_cbPending += cbCopy;
+        pData += cbCopy;
+        cbData -= cbCopy;
+
+        if (m_cbPending < ChunkSize)
+            return;
+
+        Compress(m_Pending.data(), 1);
+        m_cbPending = 0;
+    }
+
+    // Each block goes through all the algorithms while it is still in cache
+    while (cbData >= ChunkSize)
+    {
+        const size_t cChunks = std::min(cbData, BlockSize) / ChunkSize;
+        Compress(pData, cChunks);
+        pData += cChunks * ChunkSize;
+        cbData -= cChunks * ChunkSize;
+    }
+
+    if (cbData > 0)
+    {
+        memcpy(m_Pending.data(), pData, cbData);
+        m_cbPending = cbData;
+    }
+}
+
+HRESULT MultiHash::GetHash(Algorithm alg, CBinaryBuffer& Hash) const
+{
+    if (alg != Algorithm::MD5 && alg != Algorithm::SHA1 && alg != Algorithm::SHA256)
+        return E_INVALIDARG;
+
+    if (!HasFlag(m_Algorithms, alg))
+    {
+        Hash.RemoveAll();
+        return MK_E_UNAVAILABLE;
+    }
+
+    // Padding: 0x80, zeroes then the length in bits, in the byte order of the algorithm
+    BYTE tail[ChunkSize * 2] = {0};
+    memcpy(tail, m_Pending.data(), m_cbPending);
+    tail[m_cbPending] = 0x80;
+
+    const size_t cChunks = m_cbPending + 1 + sizeof(ULONGLONG) > ChunkSize ? 2 : 1;
+    BYTE* pLength = tail + cChunks * ChunkSize - sizeof(ULONGLONG);
+    const ULONGLONG ullBits = m_ullLength * 8;
+
+#ifdef ORC_SHA_EXTENSIONS
+    const bool bShaExtensions = UsesShaExtensions();
+#endif
+
+    switch (alg)
+    {
+        case Algorithm::MD5: {
+            auto state = m_MD5;
+            StoreLE32(pLength, (uint32_t)ullBits);
+            StoreLE32(pLength + 4, (uint32_t)(ullBits >> 32));
+            MD5Compress(state.data(), tail, cChunks);
+
+            if (!Hash.SetCount(BYTES_IN_MD5_HASH))
+                return E_OUTOFMEMORY;
+            for (size_t i = 0; i < state.size(); i++)
+                StoreLE32(Hash.GetData() + i * 4, state[i]);
+            break;
+        }
+        case Algorithm::SHA1: {
+            auto state = m_Sha1;
+            StoreBE32(pLength, (uint32_t)(ullBits >> 32));
+            StoreBE32(pLength + 4, (uint32_t)ullBits);
+#ifdef ORC_SHA_EXTENSIONS
+            if (bShaExtensions)
+                Sha1CompressShaExtensions(state.data(), tail, cChunks);
+            else
+#endif
+                Sha1Compress(state.data(), tail, cChunks);
+
+            if (!Hash.SetCount(BYTES_IN_SHA1_HASH))
+                return E_OUTOFMEMORY;
+            for (size_t i = 0; i < state.size(); i++)
+                StoreBE32(Hash.GetData() + i * 4, state[i]);
+            break;
+        }
+        default: {
+            auto state = m_Sha256;
+            StoreBE32(pLength, (uint32_t)(ullBits >> 32));
+            StoreBE32(pLength + 4, (uint32_t)ullBits);
+#ifdef ORC_SHA_EXTENSIONS
+            if (bShaExtensions)
+                Sha256CompressShaExtensions(state.data(), tail, cChunks);
+            else
+#endif
+                Sha256Compress(state.data(), tail, cChunks);
+
+            if (!Hash.SetCount(BYTES_IN_SHA256_HASH))
+                return E_OUTOFMEMORY;
+            for (size_t i = 0; i < state.size(); i++)
+                StoreBE32(Hash.GetData() + i * 4, state[i]);
+            break;
+        }
+    }
+    return S_OK;
+}
@@ -0,0 +1,67 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include <array>
+#include <cstdint>
+
+#include "BinaryBuffer.h"
+#include "CryptoHashStreamAlgorithm.h"
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// In process MD5, SHA1 and SHA256: the data is hashed block by block, each (cache sized) block going through every
+// requested algorithm before the next one is read. SHA1 and SHA256 use the SHA extensions when the CPU has them.
+class ORCLIB_API MultiHash
+{
+public:
+    using Algorithm = CryptoHashStreamAlgorithm;
+
+    // Bytes going through all the algorithms before moving on: fits in L1/L2 along with the hash states
+    static constexpr size_t BlockSize = 16 * 1024;
+
+    MultiHash(Algorithm algs = Algorithm::Undefined) { Reset(algs); }
+
+    void Reset(Algorithm algs);
+
+    void Update(const BYTE* pData, size_t cbData);
+
+    // Digest of the data hashed so far (more data can still be hashed afterwards)
+    HRESULT GetHash(Algorithm alg, CBinaryBuffer& Hash) const;
+
+    Algorithm GetAlgorithms() const { return m_Algorithms; }
+    ULONGLONG GetLength() const { return m_ullLength; }
+
+    // CPU support for the SHA extensions
+    static bool HasShaExtensions();
+
+    // Runtime selection of the SHA1/SHA256 implementation (the SHA extensions are used by default when available)
+    static void EnableShaExtensions(bool bEnable);
+    static bool UsesShaExtensions();
+
+private:
+    static constexpr size_t ChunkSize = 64;
+
+    void Compress(const BYTE* pChunks, size_t cChunks);
+
+    Algorithm m_Algorithms;
+    ULONGLONG m_ullLength;
+
+    std::array<uint32_t, 4> m_MD5;
+    std::array<uint32_t, 5> m_Sha1;
+    std::array<uint32_t, 8> m_Sha256;
+
+    std::array<BYTE, ChunkSize> m_Pending;
+    size_t m_cbPending;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -0,0 +1,303 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "MultiPatternMatcher.h"
+
+#include <deque>
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+namespace {
+
+constexpr size_t kCodeUnits = 0x10000;
+
+const std::vector<WCHAR>& FoldTable()
+{
+    // lower then upper case: a superset of the equivalences used by PathMatchSpec, _wcsicmp and std::regex icase
+    static const std::vector<WCHAR> table = []() {
+        std::vector<WCHAR> folded(kCodeUnits);
+        for (size_t i = 0; i < kCodeUnits; i++)
+            folded[i] = static_cast<WCHAR>(i);
+
+        CharLowerBuffW(folded.data(), static_cast<DWORD>(folded.size()));
+        CharUpperBuffW(folded.data(), static_cast<DWORD>(folded.size()));
+        return folded;
+    }();
+    return table;
+}
+
+void KeepLongest(std::wstring& longest, std::wstring& current)
+{
+    if (current.size() > longest.size())
+        longest = current;
+    current.clear();
+}
+
+}  // namespace
+
+WCHAR MultiPatternMatcher::Fold(WCHAR c)
+{
+    return FoldTable()[c];
+}
+
+ULONG MultiPatternMatcher::AddPattern(const std::wstring_view& pattern)
+{
+    if (pattern.empty())
+        return NoPattern;
+
+    std::wstring folded(pattern);
+    if (!m_bCaseSensitive)
+    {
+        for (auto& c : folded)
+            c = Fold(c);
+    }
+
+    if (auto it = m_PatternIds.find(folded); it != end(m_PatternIds))
+        return it->second;
+
+    const ULONG ulId = static_cast<ULONG>(m_Patterns.size());
+    m_PatternIds.emplace(folded, ulId);
+    m_Patterns.push_back(std::move(folded));
+
+    // patterns added after Compile() need a new one
+    m_Transitions.clear();
+    return ulId;
+}
+
+ULONG MultiPatternMatcher::AddPattern(const BYTE* pPattern, size_t cbPattern)
+{
+    if (pPattern == nullptr)
+        return NoPattern;
+
+    return AddPattern(std::wstring(pPattern, pPattern + cbPattern));
+}
+
+HRESULT MultiPatternMatcher::Compile()
+{
+    m_Transitions.clear();
+    m_OutputStart.clear();
+    m_Outputs.clear();
+
+    if (m_Patterns.empty())
+        return S_OK;
+
+    // Compact alphabet: one class per folded character used by a pattern, class 0 for all the others
+    std::vector<USHORT> foldedClass(kCodeUnits, 0);
+    m_ulClasses = 1L;
+    for (const auto& pattern : m_Patterns)
+    {
+        for (const auto c : pattern)
+        {
+            if (foldedClass[c] == 0)
+            {
+                if (m_ulClasses > MAXUSHORT)
+                    return E_UNEXPECTED;
+                foldedClass[c] = static_cast<USHORT>(m_ulClasses++);
+            }
+        }
+    }
+
+    m_CharClass.resize(kCodeUnits);
+    for (size_t i = 0; i < kCodeUnits; i++)
+        m_CharClass[i] = foldedClass[m_bCaseSensitive ? i : Fold(static_cast<WCHAR>(i))];
+
+    // Trie of the patterns, state 0 is the root (and no edge of the trie leads back to it)
+    std::vector<std::vector<ULONG>> outputs(1);
+    m_Transitions.assign(m_ulClasses, 0L);
+
+    for (ULONG ulId = 0; ulId < m_Patterns.size(); ulId++)
+    {
+        ULONG ulState = 0L;
+        for (const auto c : m_Patterns[ulId])
+        {
+            auto& next = m_Transitions[(static_cast<size_t>(ulState) * m_ulClasses) + foldedClass[c]];
+            if (next == 0L)
+            {
+                next = static_cast<ULONG>(outputs.size());
+                outputs.emplace_back();
+                m_Transitions.resize(m_Transitions.size() + m_ulClasses, 0L);
+            }
+            ulState = m_Transitions[(static_cast<size_t>(ulState) * m_ulClasses) + foldedClass[c]];
+        }
+        outputs[ulState].push_back(ulId);
+    }
+
+    // Breadth first: failure links turn the trie into a complete DFA, outputs of the failure state are inherited
+    std::vector<ULONG> failure(outputs.size(), 0L);
+    std::deque<ULONG> queue;
+
+    for (ULONG ulClass = 0; ulClass < m_ulClasses; ulClass++)
+    {
+        if (const auto ulNext = m_Transitions[ulClass]; ulNext != 0L)
+            queue.push_back(ulNext);
+    }
+
+    while (!queue.empty())
+    {
+        const ULONG ulState = queue.front();
+        queue.pop_front();
+
+        const size_t row = static_cast<size_t>(ulState) * m_ulClasses;
+        const size_t failureRow = static_cast<size_t>(failure[ulState]) * m_ulClasses;
+
+        for (ULONG ulClass = 0; ulClass < m_ulClasses; ulClass++)
+        {
+            const ULONG ulNext = m_Transitions[row + ulClass];
+            if (ulNext != 0L)
+            {
+                failure[ulNext] = m_Transitions[failureRow + ulClass];
+                const auto& inherited = outputs[failure[ulNext]];
+                outputs[ulNext].insert(end(outputs[ulNext]), begin(inherited), end(inherited));
+                queue.push_back(ulNext);
+            }
+            else
+            {
+                m_Transitions[row + ulClass] = m_Transitions[failureRow + ulClass];
+            }
+        }
+    }
+
+    m_OutputStart.reserve(outputs.size() + 1);
+    for (const auto& stateOutputs : outputs)
+    {
+        m_OutputStart.push_back(static_cast<ULONG>(m_Outputs.size()));
+        m_Outputs.insert(end(m_Outputs), begin(stateOutputs), end(stateOutputs));
+    }
+    m_OutputStart.push_back(static_cast<ULONG>(m_Outputs.size()));
+
+    Log::Debug(
+        "Compiled {} patterns: {} states, {} character classes", m_Patterns.size(), outputs.size(), m_ulClasses);
+    return S_OK;
+}
+
+void MultiPatternMatcher::Clear()
+{
+    m_Patterns.clear();
+    m_PatternIds.clear();
+    m_CharClass.clear();
+    m_ulClasses = 0L;
+    m_Transitions.clear();
+    m_OutputStart.clear();
+    m_Outputs.clear();
+}
+
+std::wstring MultiPatternMatcher::RequiredLiteralOfSpec(const std::wstring_view& spec)
+{
+    // PathMatchSpec accepts a list of specs separated by ';'
+    if (spec.find(L';') != std::wstring_view::npos)
+        return {};
+
+    // '.' and ' ' are not literals to PathMatchSpec ("*.*" matches names without a dot, spaces are trimmed)
+    std::wstring longest;
+    std::wstring current;
+    for (const auto c : spec)
+    {
+        if (c == L'*' || c == L'?' || c == L'.' || c == L' ')
+            KeepLongest(longest, current);
+        else
+            current.push_back(c);
+    }
+    KeepLongest(longest, current);
+    return longest;
+}
+
+std::wstring MultiPatternMatcher::RequiredLiteralOfRegex(const std::wstring_view& regex)
+{
+    std::wstring longest;
+    std::wstring current;
+
+    ULONG ulDepth = 0L;  // literals inside groups may be optional or alternatives, they are ignored
+
+    for (size_t i = 0; i < regex.size(); i++)
+    {
+        const WCHAR c = regex[i];
+        switch (c)
+        {
+            case L'|':
+                if (ulDepth == 0L)
+                    return {};  // top level alternation, nothing is required
+                break;
+            case L'(':
+                KeepLongest(longest, current);
+                ulDepth++;
+                break;
+            case L')':
+                KeepLongest(longest, current);
+                if (ulDepth > 0L)
+                    ulDepth--;
+                break;
+            case L'[':
+                // character class: skip it
+                KeepLongest(longest, current);
+                for (i++; i < regex.size() && regex[i] != L']'; i++)
+                {
+                    if (regex[i] == L'\\')
+                        i++;
+                }
+                break;
+            case L'*':
+            case L'?':
+            case L'{':
+                // the previous character may be absent
+                if (!current.empty())
+                    current.pop_back();
+                KeepLongest(longest, current);
+                if (c == L'{')
+                {
+                    while (i < regex.size() && regex[i] != L'}')
+                        i++;
+                }
+                break;
+            case L'+':
+                KeepLongest(longest, current);
+                break;
+            case L'.':
+            case L'^':
+            case L'$':
+                KeepLongest(longest, current);
+                break;
+            case L'\\':
+            {
+                const WCHAR e = i + 1 < regex.size() ? regex[i + 1] : L'\0';
+                if (e != L'\0' && wcschr(L".\\*+?()[]{}|^$/-", e) != nullptr)
+                {
+                    if (ulDepth == 0L)
+                        current.push_back(e);
+                    i++;
+                }
+                else if (e == L'x' || e == L'u' || e == L'c')
+                {
+                    // character code (\xhh, \uhhhh) or control character (\cX): the whole sequence is skipped
+                    KeepLongest(longest, current);
+                    i += e == L'x' ? 3 : (e == L'u' ? 5 : 2);
+                }
+                else if (e != L'\0' && (wcschr(L"dDwWsSbBfnrtv", e) != nullptr || iswdigit(e)))
+                {
+                    // character class (\d, \w...), assertion, control character or back reference
+                    KeepLongest(longest, current);
+                    for (i++; iswdigit(e) && i + 1 < regex.size() && iswdigit(regex[i + 1]); i++)
+                        ;
+                }
+                else
+                {
+                    // unknown escape, nothing can safely be required
+                    return {};
+                }
+                break;
+            }
+            default:
+                if (ulDepth == 0L)
+                    current.push_back(c);
+                break;
+        }
+    }
+    KeepLongest(longest, current);
+    return longest;
+}
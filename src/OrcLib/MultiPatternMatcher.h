@@ -0,0 +1,92 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Case insensitive Aho-Corasick automaton: a single pass over a text reports every pattern it contains, whatever the
+// number of patterns. Characters are folded and mapped to a compact alphabet once, when the automaton is compiled.
+//
+// A case sensitive automaton also matches binary patterns: bytes are searched as characters of the same value.
+class ORCLIB_API MultiPatternMatcher
+{
+public:
+    static constexpr ULONG NoPattern = (ULONG)-1;
+
+    MultiPatternMatcher(bool bCaseSensitive = false)
+        : m_bCaseSensitive(bCaseSensitive)
+    {
+    }
+
+    // Returns the pattern's id (identical patterns share it), NoPattern for an empty pattern
+    ULONG AddPattern(const std::wstring_view& pattern);
+    ULONG AddPattern(const BYTE* pPattern, size_t cbPattern);
+
+    HRESULT Compile();
+
+    size_t PatternCount() const { return m_Patterns.size(); }
+    bool empty() const { return m_Patterns.empty(); }
+    bool IsCompiled() const { return !m_Transitions.empty(); }
+    bool IsCaseSensitive() const { return m_bCaseSensitive; }
+
+    // Calls PatternCallback(ULONG id) for each occurrence of a pattern in the text, a text of CHAR or BYTE is read as
+    // UTF-16 code units of the same (unsigned) values
+    template <typename CharT, typename PatternCallback>
+    void Scan(const CharT* szText, size_t cchText, PatternCallback callback) const
+    {
+        static_assert(sizeof(CharT) <= sizeof(WCHAR), "Scan reads 8 or 16 bits characters");
+
+        if (!IsCompiled())
+            return;
+
+        ULONG ulState = 0L;
+        for (size_t i = 0; i < cchText; i++)
+        {
+            const auto c = static_cast<std::make_unsigned_t<CharT>>(szText[i]);
+            ulState = m_Transitions[(static_cast<size_t>(ulState) * m_ulClasses) + m_CharClass[c]];
+
+            for (ULONG j = m_OutputStart[ulState]; j < m_OutputStart[ulState + 1]; j++)
+                callback(m_Outputs[j]);
+        }
+    }
+
+    void Clear();
+
+    static WCHAR Fold(WCHAR c);
+
+    // Longest literal any name matching a PathMatchSpec wildcard specification must contain (empty if none)
+    static std::wstring RequiredLiteralOfSpec(const std::wstring_view& spec);
+
+    // Longest literal any text matching an (ECMAScript) regular expression must contain (empty if none)
+    static std::wstring RequiredLiteralOfRegex(const std::wstring_view& regex);
+
+private:
+    bool m_bCaseSensitive;
+
+    std::vector<std::wstring> m_Patterns;  // folded
+    std::unordered_map<std::wstring, ULONG> m_PatternIds;
+
+    std::vector<USHORT> m_CharClass;  // any UTF-16 code unit -> class of its folded value, 0 when in no pattern
+    ULONG m_ulClasses = 0L;
+
+    std::vector<ULONG> m_Transitions;  // complete DFA: state * classes + class -> state
+    std::vector<ULONG> m_OutputStart;  // patterns ending in a state: m_Outputs[m_OutputStart[s], m_OutputStart[s+1])
+    std::vector<ULONG> m_Outputs;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -466,3 +466,148 @@ return_overflow:
     Log::Error(L"Failed to decompress file");
     return E_FAIL;
 }
+
+namespace {
+
+inline uint16_t lznt1_le16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+/*
+ * Decompresses one LZNT1 chunk (4K of uncompressed data at most) into [dest, dest_end).
+ * Returns the end of the decompressed data, nullptr on error.
+ */
+uint8_t* lznt1_decompress_chunk(const uint8_t* in, const uint8_t* const in_end, uint8_t* const dest, uint8_t* const dest_end)
+{
+    uint8_t* out = dest;
+
+    /*
+     * The split of phrase tokens between offset and length depends on the position in the chunk: it is only updated
+     * when the position crosses the next power of two instead of being computed for each phrase.
+     */
+    unsigned lg = 0;
+    size_t lg_limit = 0x10;
+
+    while (in < in_end)
+    {
+        uint8_t tag = *in++;
+
+        /* eight symbols in a row (uncompressible data) are copied at once */
+        if (tag == 0 && in_end - in >= 8 && dest_end - out >= 8)
+        {
+            memcpy(out, in, 8);
+            out += 8;
+            in += 8;
+            continue;
+        }
+
+        for (int token = 0; token < NTFS_TOKEN_LENGTH && in < in_end; token++, tag >>= 1)
+        {
+            if ((tag & NTFS_TOKEN_MASK) == NTFS_SYMBOL_TOKEN)
+            {
+                if (out == dest_end)
+                    return nullptr;
+                *out++ = *in++;
+                continue;
+            }
+
+            if (in_end - in < 2)
+                return nullptr;
+
+            const size_t position = out - dest;
+            if (position == 0)
+                return nullptr;
+
+            while (position > lg_limit)
+            {
+                lg++;
+                lg_limit <<= 1;
+            }
+
+            const uint16_t pt = lznt1_le16(in);
+            in += 2;
+
+            const size_t offset = (pt >> (12 - lg)) + 1;
+            size_t length = (pt & (0xFFF >> lg)) + 3;
+
+            if (offset > position || length > static_cast<size_t>(dest_end - out))
+                return nullptr;
+
+            const uint8_t* from = out - offset;
+
+            if (offset >= 8 && static_cast<size_t>(dest_end - out) >= ((length + 7) & ~size_t(7)))
+            {
+                /* 8 bytes at a time, the bytes written past the phrase are overwritten by what follows */
+                for (size_t copied = 0; copied < length; copied += 8)
+                    memcpy(out + copied, from + copied, 8);
+                out += length;
+            }
+            else if (offset == 1)
+            {
+                memset(out, *from, length);
+                out += length;
+            }
+            else
+            {
+                while (length--)
+                    *out++ = *from++;
+            }
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+/**
+ * lznt1_decompress - decompress a compression unit
+ *
+ * The compression unit is a sequence of chunks, each holding up to 4K of uncompressed data after a 16 bits header
+ * giving its compressed size and whether it is compressed at all. A null header, or the end of the compressed data,
+ * ends the unit: the rest of it is sparse.
+ */
+HRESULT Orc::lznt1_decompress(const uint8_t* src, const size_t src_size, uint8_t* dest, const size_t dest_size)
+{
+    const uint8_t* in = src;
+    const uint8_t* const in_end = src + src_size;
+
+    uint8_t* out = dest;
+    uint8_t* const out_end = dest + dest_size;
+
+    while (in_end - in >= 2 && out < out_end)
+    {
+        const uint16_t header = lznt1_le16(in);
+        if (header == 0)
+            break;
+
+        const size_t chunk_size = (header & NTFS_SB_SIZE_MASK) + 3;
+        if (chunk_size > static_cast<size_t>(in_end - in))
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+        const uint8_t* const chunk_end = in + chunk_size;
+        uint8_t* const chunk_out_end = out + std::min<size_t>(NTFS_SB_SIZE, out_end - out);
+
+        if (header & NTFS_SB_IS_COMPRESSED)
+        {
+            uint8_t* end = lznt1_decompress_chunk(in + 2, chunk_end, out, chunk_out_end);
+            if (end == nullptr)
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+            /* a chunk which decompresses to less than 4K is followed by zeroes */
+            memset(end, 0, chunk_out_end - end);
+        }
+        else
+        {
+            const size_t cbData = std::min<size_t>(chunk_size - 2, chunk_out_end - out);
+            memcpy(out, in + 2, cbData);
+            memset(out + cbData, 0, (chunk_out_end - out) - cbData);
+        }
+
+        in = chunk_end;
+        out = chunk_out_end;
+    }
+
+    memset(out, 0, out_end - out);
+    return S_OK;
+}
@@ -35,6 +35,9 @@ HRESULT ntfs_uncompress_compunit(NTFS_COMP_INFO* comp);
 // NTFS-3G
 HRESULT ntfs_decompress(uint8_t* dest, const size_t dest_size, uint8_t* const cb_start, const size_t cb_size);
 
+// Decompresses a whole compression unit: 'dest' is always filled, with zeroes past the end of the compressed data
+HRESULT lznt1_decompress(const uint8_t* src, const size_t src_size, uint8_t* dest, const size_t dest_size);
+
 }  // namespace Orc
 
 #pragma managed(pop)
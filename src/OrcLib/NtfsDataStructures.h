@@ -443,4 +443,14 @@ struct REPARSE_POINT_DATA
     BYTE Data[1];
 };
 using PREPARSE_POINT_DATA = REPARSE_POINT_DATA*;
+
+// Data of IO_REPARSE_TAG_WOF reparse points (WOF_EXTERNAL_INFO followed by the provider's)
+struct WOF_REPARSE_POINT_DATA
+{
+    DWORD WofVersion;
+    DWORD WofProvider;  // WOF_PROVIDER_WIM (1) or WOF_PROVIDER_FILE (2)
+    DWORD ProviderVersion;
+    DWORD CompressionFormat;  // FILE_PROVIDER_COMPRESSION_* (WOF_PROVIDER_FILE only)
+};
+using PWOF_REPARSE_POINT_DATA = WOF_REPARSE_POINT_DATA*;
 #pragma pack(pop)
@@ -48,9 +48,11 @@ template <typename _T, size_t _DeclElts = 1>
 using Buffer = Detail::Buffer<_T, _DeclElts>;
 using ByteBuffer = Detail::Buffer<BYTE, 16>;
 
+class ArenaStorage;
 class CircularStorage;
 class HeapStorage;
 class ObjectStorage;
+class SlabStorage;
 
 // Utilities/Parameters
 class OutputSpec;
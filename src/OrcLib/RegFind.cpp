@@ -26,6 +26,8 @@
 #include <sstream>
 #include <iomanip>
 
+#include <ppl.h>
+
 #include "Log/Log.h"
 
 using namespace std;
@@ -82,6 +84,21 @@ void LogError(const std::wstring& configItemName, const std::regex_error& e)
     }
 }
 
+// Bytes of an ANSI string as UTF-16 code units of the same values, the way MultiPatternMatcher scans CHAR texts
+std::wstring Widen(const std::string& str)
+{
+    std::wstring retval;
+    retval.reserve(str.size());
+    for (const auto c : str)
+        retval.push_back(static_cast<unsigned char>(c));
+    return retval;
+}
+
+bool IsAscii(const std::wstring& str)
+{
+    return std::all_of(begin(str), end(str), [](WCHAR c) { return c < 0x80; });
+}
+
 }  // namespace
 
 RegFind::Match::KeyNameMatch::KeyNameMatch(const RegistryKey* const MatchingRegistryKey)
@@ -1553,7 +1570,168 @@ RegFind::SearchTerm::Criteria RegFind::LookupSpec(
     return RegFind::SearchTerm::Criteria::NONE;
 }
 
-const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const RegistryKey* const RegKey)
+HRESULT RegFind::CompileFilters()
+{
+    HRESULT hr = E_FAIL;
+
+    for (auto& filter : m_Filters)
+    {
+        filter.Matcher.Clear();
+        filter.TermPatterns.assign(m_Specs.size(), MultiPatternMatcher::NoPattern);
+    }
+
+    const auto AddLiteral = [this](Field field, size_t termIndex, const std::wstring& strLiteral) {
+        m_Filters[field].TermPatterns[termIndex] = m_Filters[field].Matcher.AddPattern(strLiteral);
+    };
+
+    for (size_t i = 0; i < m_Specs.size(); i++)
+    {
+        const auto& aTerm = m_Specs[i];
+
+        // any name matching a regex contains its literal
+        if (aTerm->m_criteriaRequired & SearchTerm::Criteria::KEY_NAME_REGEX)
+            AddLiteral(KeyNameField, i, MultiPatternMatcher::RequiredLiteralOfRegex(Widen(aTerm->m_strKeyName)));
+
+        if (aTerm->m_criteriaRequired & SearchTerm::Criteria::KEY_PATH_REGEX)
+            AddLiteral(KeyPathField, i, MultiPatternMatcher::RequiredLiteralOfRegex(Widen(aTerm->m_strPathName)));
+
+        if (aTerm->m_criteriaRequired & SearchTerm::Criteria::VALUE_NAME_REGEX)
+            AddLiteral(ValueNameField, i, MultiPatternMatcher::RequiredLiteralOfRegex(Widen(aTerm->m_strValueName)));
+
+        if (aTerm->m_criteriaRequired & SearchTerm::Criteria::DATA_CONTENT_REGEX)
+        {
+            // data is matched in its ANSI and UTF-16 forms: only ASCII literals are the same in both
+            const auto strLiteral =
+                MultiPatternMatcher::RequiredLiteralOfRegex(Widen(aTerm->m_strRegexDataContentPattern));
+            if (IsAscii(strLiteral))
+                AddLiteral(DataRegexField, i, strLiteral);
+        }
+
+        // contains patterns are found by the automaton exactly as they are by DatasContains
+        if (aTerm->m_criteriaRequired & SearchTerm::Criteria::DATA_CONTAINS)
+        {
+            m_Filters[DataContainsField].TermPatterns[i] = m_Filters[DataContainsField].Matcher.AddPattern(
+                aTerm->m_DataContentContains.GetData(), aTerm->m_DataContentContains.GetCount());
+            m_Filters[WDataContainsField].TermPatterns[i] = m_Filters[WDataContainsField].Matcher.AddPattern(
+                aTerm->m_WDataContentContains.GetData(), aTerm->m_WDataContentContains.GetCount());
+        }
+    }
+
+    size_t patterns = 0;
+    for (auto& filter : m_Filters)
+    {
+        if (FAILED(hr = filter.Matcher.Compile()))
+        {
+            Log::Warn(
+                "Failed to compile registry search patterns, terms will not be pre-filtered [{}]", SystemError(hr));
+            filter.Matcher.Clear();
+            filter.TermPatterns.assign(m_Specs.size(), MultiPatternMatcher::NoPattern);
+        }
+        patterns += filter.Matcher.PatternCount();
+    }
+
+    Log::Debug("{} registry search terms are pre-filtered on {} pattern(s)", m_Specs.size(), patterns);
+    return S_OK;
+}
+
+void RegFind::NewScan(Candidates& candidates) const
+{
+    if (++candidates.ulScan == 0L)
+    {
+        // wrapped around, hits of older scans must be forgotten
+        for (auto& hits : candidates.Hits)
+            std::fill(begin(hits), end(hits), 0L);
+        candidates.ulScan = 1L;
+    }
+    candidates.ContainsField = DataContainsField;
+}
+
+template <typename CharT>
+void RegFind::ScanField(Field field, const CharT* szText, size_t cchText, Candidates& candidates) const
+{
+    const auto& matcher = m_Filters[field].Matcher;
+    if (matcher.empty())
+        return;
+
+    auto& hits = candidates.Hits[field];
+    if (hits.size() != matcher.PatternCount())
+        hits.assign(matcher.PatternCount(), 0L);
+
+    const ULONG ulScan = candidates.ulScan;
+    matcher.Scan(szText, cchText, [&hits, ulScan](ULONG ulPattern) { hits[ulPattern] = ulScan; });
+}
+
+void RegFind::ScanKey(const RegistryKey* const RegKey, Candidates& candidates) const
+{
+    if (RegKey == nullptr)
+        return;
+
+    const std::string& name = RegKey->GetShortKeyName();
+    ScanField(KeyNameField, name.c_str(), name.size(), candidates);
+
+    const std::string& path = RegKey->GetKeyName();
+    ScanField(KeyPathField, path.c_str(), path.size(), candidates);
+}
+
+void RegFind::ScanValue(const RegistryValue* const RegValue, Candidates& candidates) const
+{
+    ScanKey(RegValue->GetParentKey(), candidates);
+
+    const std::string& name = RegValue->GetValueName();
+    ScanField(ValueNameField, name.c_str(), name.size(), candidates);
+
+    const BYTE* pDatas = nullptr;
+    const size_t DatasSize = RegValue->GetDatas(&pDatas);
+    if (pDatas == nullptr || DatasSize == 0)
+        return;
+
+    // same forms of the data as RegexDatas and DatasContains, values of other types cannot match these terms
+    const auto pWDatas = reinterpret_cast<const WCHAR*>(pDatas);
+    switch (RegValue->GetType())
+    {
+        case ValueType::RegSZ:
+        case ValueType::ExpandSZ:
+        case ValueType::RegMultiSZ:
+            ScanField(DataRegexField, pWDatas, DatasSize / sizeof(WCHAR), candidates);
+            ScanField(WDataContainsField, pDatas, DatasSize, candidates);
+            candidates.ContainsField = WDataContainsField;
+            break;
+        case ValueType::RegBin:
+            ScanField(DataRegexField, pDatas, DatasSize, candidates);
+            ScanField(DataRegexField, pWDatas, DatasSize / sizeof(WCHAR), candidates);
+            ScanField(DataContainsField, pDatas, DatasSize, candidates);
+            break;
+        case ValueType::RegDWORD:
+        case ValueType::RegDWORDBE:
+        case ValueType::RegQWORD:
+            break;
+        default:
+            ScanField(DataContainsField, pDatas, DatasSize, candidates);
+            break;
+    }
+}
+
+bool RegFind::IsCandidate(size_t termIndex, const Candidates& candidates) const
+{
+    for (size_t field = 0; field < FieldCount; field++)
+    {
+        // only one form of the contains pattern is searched in a value's data
+        if ((field == DataContainsField || field == WDataContainsField) && field != candidates.ContainsField)
+            continue;
+
+        const auto& patterns = m_Filters[field].TermPatterns;
+        if (termIndex >= patterns.size() || patterns[termIndex] == MultiPatternMatcher::NoPattern)
+            continue;
+
+        const auto& hits = candidates.Hits[field];
+        if (patterns[termIndex] >= hits.size() || hits[patterns[termIndex]] != candidates.ulScan)
+            return false;
+    }
+    return true;
+}
+
+const std::vector<std::shared_ptr<RegFind::Match>>
+RegFind::FindMatch(const RegistryKey* const RegKey, MatchesMap& Matches, Candidates& candidates)
 {
     std::vector<std::shared_ptr<RegFind::Match>> MatchVector;
     std::shared_ptr<RegFind::Match> retval;
@@ -1571,9 +1749,9 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
             }
 
             // check if term already matched
-            auto term = m_Matches.find(it->second);
+            auto term = Matches.find(it->second);
             retval = std::make_shared<RegFind::Match>(it->second);
-            if (term != m_Matches.end())
+            if (term != Matches.end())
             {
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::KEY_NAME, retval, RegKey);
                 if (matched != SearchTerm::Criteria::NONE)
@@ -1592,7 +1770,7 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 if (matched != SearchTerm::Criteria::NONE)
                 {
                     // Add into the global match vector
-                    m_Matches.insert(MatchesMap::value_type(it->second, retval));
+                    Matches.insert(MatchesMap::value_type(it->second, retval));
                     // Add into this specific key match vector (used by callback)
                     MatchVector.push_back(retval);
                 }
@@ -1613,9 +1791,9 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 continue;
             }
             // check if term already matched
-            auto term = m_Matches.find(it->second);
+            auto term = Matches.find(it->second);
             retval = std::make_shared<RegFind::Match>(it->second);
-            if (term != m_Matches.end())
+            if (term != Matches.end())
             {
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::KEY_PATH, retval, RegKey);
                 if (matched != SearchTerm::Criteria::NONE)
@@ -1634,7 +1812,7 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 if (matched != SearchTerm::Criteria::NONE)
                 {
                     // Add into the global match vector
-                    m_Matches.insert(MatchesMap::value_type(it->second, retval));
+                    Matches.insert(MatchesMap::value_type(it->second, retval));
                     // Add into this specific key match vector (used by callback)
                     MatchVector.push_back(retval);
                 }
@@ -1645,14 +1823,21 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
     else if (retval != nullptr)
         retval->Reset();
 
+    // the names of the key are scanned once for the literals of every term
+    NewScan(candidates);
+    ScanKey(RegKey, candidates);
+
     for (auto term_it = begin(m_Specs); term_it != end(m_Specs); ++term_it)
     {
+        if (!IsCandidate(std::distance(begin(m_Specs), term_it), candidates))
+            continue;
+
         if (!(*term_it)->DependsOnValueOrData())
         {
             // check if term already matched
-            auto term = m_Matches.find(*term_it);
+            auto term = Matches.find(*term_it);
             std::shared_ptr<RegFind::Match> retval = std::make_shared<RegFind::Match>(*term_it);
-            if (term != m_Matches.end())
+            if (term != Matches.end())
             {
                 auto matched = LookupSpec(*term_it, SearchTerm::Criteria::NONE, retval, RegKey);
                 if (matched == (*term_it)->m_criteriaRequired)
@@ -1671,7 +1856,7 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 if (matched == (*term_it)->m_criteriaRequired)
                 {
                     // Add into the global match vector
-                    m_Matches.insert(MatchesMap::value_type(*term_it, retval));
+                    Matches.insert(MatchesMap::value_type(*term_it, retval));
                     // Add into this specific key match vector (used by callback)
                     MatchVector.push_back(retval);
                 }
@@ -1682,7 +1867,8 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
     return MatchVector;
 }
 
-const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const RegistryValue* const RegValue)
+const std::vector<std::shared_ptr<RegFind::Match>>
+RegFind::FindMatch(const RegistryValue* const RegValue, MatchesMap& Matches, Candidates& candidates)
 {
     std::shared_ptr<RegFind::Match> retval;
     const RegistryKey* const pKey = RegValue->GetParentKey();
@@ -1702,8 +1888,8 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
             }
 
             // check if term already matched
-            auto term = m_Matches.find(it->second);
-            if (term != m_Matches.end())
+            auto term = Matches.find(it->second);
+            if (term != Matches.end())
             {
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::KEY_NAME, retval, RegValue);
                 if (matched != SearchTerm::Criteria::NONE)
@@ -1721,7 +1907,7 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::KEY_NAME, retval, RegValue);
                 if (matched != SearchTerm::Criteria::NONE)
                 {
-                    m_Matches.insert(MatchesMap::value_type(it->second, retval));
+                    Matches.insert(MatchesMap::value_type(it->second, retval));
                     MatchVector.push_back(retval);
                 }
             }
@@ -1741,8 +1927,8 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 continue;
             }
             // check if term already matched
-            auto term = m_Matches.find(it->second);
-            if (term != m_Matches.end())
+            auto term = Matches.find(it->second);
+            if (term != Matches.end())
             {
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::KEY_PATH, retval, RegValue);
                 if (matched != SearchTerm::Criteria::NONE)
@@ -1760,7 +1946,7 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::KEY_PATH, retval, RegValue);
                 if (matched != SearchTerm::Criteria::NONE)
                 {
-                    m_Matches.insert(MatchesMap::value_type(it->second, retval));
+                    Matches.insert(MatchesMap::value_type(it->second, retval));
                     MatchVector.push_back(retval);
                 }
             }
@@ -1781,8 +1967,8 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
             }
 
             // check if term already matched
-            auto term = m_Matches.find(it->second);
-            if (term != m_Matches.end())
+            auto term = Matches.find(it->second);
+            if (term != Matches.end())
             {
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::VALUE_NAME, retval, RegValue);
                 if (matched != SearchTerm::Criteria::NONE)
@@ -1800,7 +1986,7 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 auto matched = LookupSpec(it->second, SearchTerm::Criteria::VALUE_NAME, retval, RegValue);
                 if (matched != SearchTerm::Criteria::NONE)
                 {
-                    m_Matches.insert(MatchesMap::value_type(it->second, retval));
+                    Matches.insert(MatchesMap::value_type(it->second, retval));
                     MatchVector.push_back(retval);
                 }
             }
@@ -1808,18 +1994,26 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
         }
     }
 
+    // the names and the data of the value are scanned once for the literals of every term
+    NewScan(candidates);
+    ScanValue(RegValue, candidates);
+
     for (auto term_it = begin(m_Specs); term_it != end(m_Specs); ++term_it)
     {
         if (!(*term_it)->DependsOnValueOrData())
         {
             continue;
         }
+        else if (!IsCandidate(std::distance(begin(m_Specs), term_it), candidates))
+        {
+            continue;
+        }
 
         else
         {
             // check if term already matched
-            auto term = m_Matches.find(*term_it);
-            if (term != m_Matches.end())
+            auto term = Matches.find(*term_it);
+            if (term != Matches.end())
             {
                 auto matched = LookupSpec(*term_it, SearchTerm::Criteria::NONE, retval, RegValue);
                 if (matched == (*term_it)->m_criteriaRequired)
@@ -1837,7 +2031,7 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
                 auto matched = LookupSpec(*term_it, SearchTerm::Criteria::NONE, retval, RegValue);
                 if (matched == (*term_it)->m_criteriaRequired)
                 {
-                    m_Matches.insert(MatchesMap::value_type(*term_it, retval));
+                    Matches.insert(MatchesMap::value_type(*term_it, retval));
                     MatchVector.push_back(retval);
                 }
             }
@@ -1846,6 +2040,31 @@ const std::vector<std::shared_ptr<RegFind::Match>> RegFind::FindMatch(const Regi
     return MatchVector;
 }
 
+void RegFind::MergeMatches(const MatchesMap& Matches)
+{
+    for (const auto& [term, match] : Matches)
+    {
+        auto existing = m_Matches.find(term);
+        if (existing == m_Matches.end())
+        {
+            m_Matches.insert(MatchesMap::value_type(term, match));
+            continue;
+        }
+
+        auto& keys = existing->second->MatchingKeys;
+        keys.insert(
+            end(keys),
+            std::make_move_iterator(begin(match->MatchingKeys)),
+            std::make_move_iterator(end(match->MatchingKeys)));
+
+        auto& values = existing->second->MatchingValues;
+        values.insert(
+            end(values),
+            std::make_move_iterator(begin(match->MatchingValues)),
+            std::make_move_iterator(end(match->MatchingValues)));
+    }
+}
+
 HRESULT RegFind::Find(
     const std::shared_ptr<ByteStream>& location,
     FoundKeyMatchCallback aKeyCallback,
@@ -1866,25 +2085,43 @@ HRESULT RegFind::Find(
             return hr;
         }
 
-        std::function<void(const RegistryKey* const)> CallbackOnKey = [this,
-                                                                       aKeyCallback](const RegistryKey* const RegKey) {
-            std::vector<std::shared_ptr<RegFind::Match>> result = FindMatch(RegKey);
-            if ((aKeyCallback != nullptr) && (!result.empty()))
-                aKeyCallback(result);
-        };
+        if (FAILED(hr = CompileFilters()))
+            return hr;
+
+        // Matches are accumulated per thread and merged once the hive is walked
+        concurrency::combinable<MatchesMap> LocalMatches;
+        concurrency::combinable<Candidates> LocalCandidates;
+        concurrency::critical_section cs;
+
+        std::function<void(const RegistryKey* const)> CallbackOnKey =
+            [this, aKeyCallback, &LocalMatches, &LocalCandidates, &cs](const RegistryKey* const RegKey) {
+                std::vector<std::shared_ptr<RegFind::Match>> result =
+                    FindMatch(RegKey, LocalMatches.local(), LocalCandidates.local());
+                if ((aKeyCallback != nullptr) && (!result.empty()))
+                {
+                    concurrency::critical_section::scoped_lock sl(cs);
+                    aKeyCallback(result);
+                }
+            };
 
         std::function<void(const RegistryValue* const)> CallBackOnValue =
-            [this, aValueCallback](const RegistryValue* const RegValue) {
-                std::vector<std::shared_ptr<RegFind::Match>> result = FindMatch(RegValue);
+            [this, aValueCallback, &LocalMatches, &LocalCandidates, &cs](const RegistryValue* const RegValue) {
+                std::vector<std::shared_ptr<RegFind::Match>> result =
+                    FindMatch(RegValue, LocalMatches.local(), LocalCandidates.local());
                 if ((aValueCallback != nullptr) && (!result.empty()))
+                {
+                    concurrency::critical_section::scoped_lock sl(cs);
                     aValueCallback(result);
+                }
             };
 
-        if (FAILED(hr = Hive.Walk(CallbackOnKey, CallBackOnValue)))
+        if (FAILED(hr = Hive.ParallelWalk(CallbackOnKey, CallBackOnValue)))
         {
             Log::Error(L"Failed RegFind::Find: cannot walk hive [{}]", SystemError(hr));
             return hr;
         }
+
+        LocalMatches.combine_each([this](const MatchesMap& Matches) { MergeMatches(Matches); });
     }
     else
     {
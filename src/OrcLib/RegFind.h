@@ -9,6 +9,7 @@
 
 #include "OrcLib.h"
 
+#include <array>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -21,6 +22,7 @@
 #include "ByteStream.h"
 #include "CaseInsensitive.h"
 #include "FileFind.h"
+#include "MultiPatternMatcher.h"
 #include "Output/Text/Tree.h"
 
 #pragma managed(push, off)
@@ -420,6 +422,56 @@ private:
 
     MatchesMap m_Matches;
 
+    // Pre-filter of m_Specs: the literal each term requires in a field of a key or a value. The literals of all the
+    // terms are searched in one pass over each field, only the terms whose literals were all found are evaluated.
+    enum Field
+    {
+        KeyNameField = 0,
+        KeyPathField,
+        ValueNameField,
+        DataRegexField,
+        DataContainsField,  // ANSI or binary pattern, searched in the data of non string values
+        WDataContainsField,  // UTF-16 pattern, searched in the data of string values
+        FieldCount
+    };
+
+    class FieldFilter
+    {
+    public:
+        FieldFilter(bool bCaseSensitive = false)
+            : Matcher(bCaseSensitive)
+        {
+        }
+
+        MultiPatternMatcher Matcher;
+        std::vector<ULONG> TermPatterns;  // m_Specs index -> pattern id, NoPattern if the term is not filtered on it
+    };
+
+    std::array<FieldFilter, FieldCount> m_Filters = {
+        FieldFilter(),
+        FieldFilter(),
+        FieldFilter(),
+        FieldFilter(),
+        FieldFilter(true),
+        FieldFilter(true)};
+
+    // Patterns found in the fields of the key or value being matched (one per thread while the hive is walked)
+    class Candidates
+    {
+    public:
+        std::array<std::vector<ULONG>, FieldCount> Hits;  // pattern id -> last scan where it was found
+        ULONG ulScan = 0L;
+        Field ContainsField = DataContainsField;  // form of the contains patterns searched in the value's data
+    };
+
+    HRESULT CompileFilters();
+    void NewScan(Candidates& candidates) const;
+    template <typename CharT>
+    void ScanField(Field field, const CharT* szText, size_t cchText, Candidates& candidates) const;
+    void ScanKey(const RegistryKey* const RegKey, Candidates& candidates) const;
+    void ScanValue(const RegistryValue* const RegValue, Candidates& candidates) const;
+    bool IsCandidate(size_t termIndex, const Candidates& candidates) const;
+
     // Name specs: Only depend on KeyName (aka ShotKeyName)
     SearchTerm::Criteria ExactKeyName(const std::shared_ptr<SearchTerm>& aTerm, const RegistryKey* const Regkey) const;
     SearchTerm::Criteria RegexKeyName(const std::shared_ptr<SearchTerm>& aTerm, const RegistryKey* const Regkey) const;
@@ -483,8 +535,14 @@ private:
         std::shared_ptr<Match>& aMatch,
         const RegistryValue* const RegValue) const;
 
-    const std::vector<std::shared_ptr<Match>> FindMatch(const RegistryKey* const RegKey);
-    const std::vector<std::shared_ptr<Match>> FindMatch(const RegistryValue* const RegValue);
+    // Matches: where matches are accumulated (one per thread while the hive is walked)
+    const std::vector<std::shared_ptr<Match>>
+    FindMatch(const RegistryKey* const RegKey, MatchesMap& Matches, Candidates& candidates);
+    const std::vector<std::shared_ptr<Match>>
+    FindMatch(const RegistryValue* const RegValue, MatchesMap& Matches, Candidates& candidates);
+
+    // Moves the matches found by one thread into m_Matches
+    void MergeMatches(const MatchesMap& Matches);
 
     static ValueType GetRegistryValueType(LPCWSTR szValueType);
 
@@ -497,6 +555,7 @@ public:
     HRESULT AddRegFindFromTemplate(const std::vector<ConfigItem>& items);
     HRESULT AddSearchTerm(const std::shared_ptr<SearchTerm>& MatchSpec);
 
+    // The hive is walked by several threads: callbacks are serialized but matches come in no particular order
     HRESULT Find(
         const std::shared_ptr<ByteStream>& location,
         FoundKeyMatchCallback aKeyCallback,
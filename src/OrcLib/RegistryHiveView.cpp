@@ -0,0 +1,363 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "RegistryHiveView.h"
+
+#include "ByteStream.h"
+#include "FileStream.h"
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+namespace {
+
+// What out of range cells point to: its null size and signature fail every check
+const BYTE kEmptyCell[0x100] = {0};  // as large as the padding of the windows
+
+HRESULT ReadAt(ByteStream& stream, ULONGLONG ullOffset, LPBYTE pBuffer, ULONGLONG cbBytes)
+{
+    HRESULT hr = E_FAIL;
+
+    if (FAILED(hr = stream.SetFilePointer(ullOffset, FILE_BEGIN, nullptr)))
+        return hr;
+
+    ULONGLONG ullRead = 0LL;
+    while (ullRead < cbBytes)
+    {
+        ULONGLONG ullTmp = 0LL;
+        if (FAILED(hr = stream.Read(pBuffer + ullRead, cbBytes - ullRead, &ullTmp)))
+            return hr;
+        if (ullTmp == 0)
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+        ullRead += ullTmp;
+    }
+    return S_OK;
+}
+
+}  // namespace
+
+RegistryHiveView::RegistryHiveView(ULONGLONG ullCacheSize)
+    : m_ullCacheSize(ullCacheSize)
+{
+}
+
+HRESULT RegistryHiveView::Map(HANDLE hFile)
+{
+    HRESULT hr = E_FAIL;
+
+    m_hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0L, 0L, NULL);
+    if (m_hMapping == NULL)
+    {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+        Log::Debug("Failed CreateFileMapping on hive [{}]", SystemError(hr));
+        return hr;
+    }
+
+    m_pView = (BYTE*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0L, 0L, 0L);
+    if (m_pView == nullptr)
+    {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+        Log::Debug("Failed MapViewOfFile on hive [{}]", SystemError(hr));
+        CloseHandle(m_hMapping);
+        m_hMapping = NULL;
+        return hr;
+    }
+
+    m_ullTailStart = m_ullSize > kPageSize ? m_ullSize - kPageSize : 0LLU;
+    if (!m_Tail.SetCount(static_cast<size_t>(m_ullSize - m_ullTailStart) + kPadding))
+    {
+        Log::Error("Not enough memory to read hive");
+        UnmapViewOfFile(m_pView);
+        m_pView = nullptr;
+        CloseHandle(m_hMapping);
+        m_hMapping = NULL;
+        return E_OUTOFMEMORY;
+    }
+    CopyMemory(m_Tail.GetData(), m_pView + m_ullTailStart, static_cast<size_t>(m_ullSize - m_ullTailStart));
+    ZeroMemory(m_Tail.GetData() + (m_ullSize - m_ullTailStart), kPadding);
+
+    m_pData = m_pView;
+    m_pTail = m_Tail.GetData();
+    m_Mode = Mode::Mapped;
+    return S_OK;
+}
+
+HRESULT RegistryHiveView::Copy(ByteStream& stream)
+{
+    HRESULT hr = E_FAIL;
+
+    if (!m_Buffer.SetCount(static_cast<size_t>(m_ullSize) + kPadding))
+    {
+        Log::Error("Not enough memory to read hive");
+        return E_OUTOFMEMORY;
+    }
+    ZeroMemory(m_Buffer.GetData() + m_ullSize, kPadding);
+
+    ULONGLONG ullRead = 0LL;
+    while (ullRead < m_ullSize)
+    {
+        ULONGLONG ullTmp = 0LL;
+        hr = stream.Read(m_Buffer.GetData() + ullRead, m_ullSize - ullRead, &ullTmp);
+        if (ullTmp == 0)
+        {
+            Log::Error("Read error, aborting read operation");
+            m_Buffer.RemoveAll();
+            return FAILED(hr) ? hr : HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+        }
+        ullRead += ullTmp;
+    }
+
+    m_pData = m_Buffer.GetData();
+    m_Mode = Mode::Buffer;
+    return S_OK;
+}
+
+HRESULT RegistryHiveView::Open(ByteStream& stream)
+{
+    Close();
+
+    m_ullSize = stream.GetSize();
+    if (m_ullSize == 0)
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+    if (auto fileStream = dynamic_cast<FileStream*>(&stream); fileStream != nullptr)
+    {
+        if (SUCCEEDED(Map(fileStream->GetHandle())))
+            return S_OK;
+
+        Log::Debug("Hive file cannot be mapped, reading it on demand");
+    }
+
+    if (stream.CanSeek() == S_OK)
+    {
+        m_pStream = &stream;
+        m_StreamLock = std::make_shared<concurrency::critical_section>();
+        m_Mode = Mode::Paged;
+        return S_OK;
+    }
+
+    return Copy(stream);
+}
+
+HRESULT RegistryHiveView::Share(const RegistryHiveView& other)
+{
+    Close();
+
+    if (other.m_Mode == Mode::None)
+        return E_UNEXPECTED;
+
+    m_Mode = other.m_Mode;
+    m_ullSize = other.m_ullSize;
+    m_pData = other.m_pData;
+    m_pTail = other.m_pTail;
+    m_ullTailStart = other.m_ullTailStart;
+    m_pStream = other.m_pStream;
+    m_StreamLock = other.m_StreamLock;
+    return S_OK;
+}
+
+RegistryHiveView::Window* RegistryHiveView::Load(ULONGLONG ullOffset, ULONGLONG ullEnd)
+{
+    const ULONGLONG ullStart = ullOffset - (ullOffset % kPageSize);
+    const ULONGLONG ullStop = std::min(((ullEnd + kPageSize - 1) / kPageSize) * kPageSize, m_ullSize);
+
+    Window window;
+    window.ullStart = ullStart;
+    window.ullEnd = ullStop;
+    window.ullLastUse = ++m_ullTick;
+    if (!window.Data.SetCount(static_cast<size_t>(ullStop - ullStart) + kPadding))
+    {
+        Log::Error("Not enough memory to read hive");
+        return nullptr;
+    }
+    ZeroMemory(window.Data.GetData() + (ullStop - ullStart), kPadding);
+
+    HRESULT hr = E_FAIL;
+    {
+        concurrency::critical_section::scoped_lock sl(*m_StreamLock);
+        hr = ReadAt(*m_pStream, ullStart, window.Data.GetData(), ullStop - ullStart);
+    }
+    if (FAILED(hr))
+    {
+        Log::Error("Failed to read hive at offset {:#x} [{}]", ullStart, SystemError(hr));
+        return nullptr;
+    }
+
+    if (auto it = m_Windows.find(ullStart); it != end(m_Windows))
+    {
+        // A cell crosses the end of this window, pointers to it may still be in use
+        m_WindowsByAddress.erase(it->second.Data.GetData());
+        m_Retired.push_back(std::move(it->second));
+        m_Windows.erase(it);
+    }
+
+    m_ullBytes += window.Data.GetCount();
+
+    auto [it, inserted] = m_Windows.emplace(ullStart, std::move(window));
+    m_WindowsByAddress.emplace(it->second.Data.GetData(), ullStart);
+    return &it->second;
+}
+
+const BYTE* RegistryHiveView::Get(ULONGLONG ullOffset, ULONG cbBytes)
+{
+    if (ullOffset >= m_ullSize)
+        return nullptr;
+
+    switch (m_Mode)
+    {
+        case Mode::Mapped:
+            // Nothing is readable past the end of the mapping, the padded copy of the tail is used instead
+            if (ullOffset + std::max<ULONGLONG>(cbBytes, kPadding) <= m_ullSize)
+                return m_pData + ullOffset;
+            if (ullOffset >= m_ullTailStart)
+                return m_pTail + (ullOffset - m_ullTailStart);
+            return nullptr;
+        case Mode::Buffer:
+            return m_pData + ullOffset;
+        case Mode::Paged:
+            break;
+        default:
+            return nullptr;
+    }
+
+    const ULONGLONG ullEnd = std::min(ullOffset + cbBytes, m_ullSize);
+
+    auto it = m_Windows.upper_bound(ullOffset);
+    if (it != begin(m_Windows))
+    {
+        --it;
+        if (ullEnd <= it->second.ullEnd)
+        {
+            it->second.ullLastUse = ++m_ullTick;
+            return it->second.Data.GetData() + (ullOffset - it->first);
+        }
+    }
+
+    auto window = Load(ullOffset, ullEnd);
+    if (window == nullptr)
+        return nullptr;
+
+    return window->Data.GetData() + (ullOffset - window->ullStart);
+}
+
+const BYTE* RegistryHiveView::GetCell(DWORD dwOffset)
+{
+    const LONGLONG llOffset = (LONGLONG)(int)dwOffset + 0x1000;
+    if (llOffset < 0 || (ULONGLONG)llOffset + sizeof(DWORD) > m_ullSize)
+        return kEmptyCell;
+
+    const BYTE* pCell = Get(llOffset, sizeof(DWORD));
+    if (pCell == nullptr)
+        return kEmptyCell;
+
+    // Allocated cells have a negative size
+    const LONG lCellSize = -*reinterpret_cast<const LONG*>(pCell);
+    if (lCellSize > static_cast<LONG>(sizeof(DWORD)))
+    {
+        pCell = Get(llOffset, lCellSize);
+        if (pCell == nullptr)
+            return kEmptyCell;
+    }
+    return pCell;
+}
+
+ULONGLONG RegistryHiveView::OffsetOf(const void* pointer) const
+{
+    const auto p = reinterpret_cast<const BYTE*>(pointer);
+
+    switch (m_Mode)
+    {
+        case Mode::Mapped:
+            if (p >= m_pTail && p < m_pTail + (m_ullSize - m_ullTailStart))
+                return m_ullTailStart + (p - m_pTail);
+            if (p >= m_pData && p < m_pData + m_ullSize)
+                return p - m_pData;
+            return (ULONGLONG)-1;
+        case Mode::Buffer:
+            if (p >= m_pData && p < m_pData + m_ullSize)
+                return p - m_pData;
+            return (ULONGLONG)-1;
+        case Mode::Paged:
+            break;
+        default:
+            return (ULONGLONG)-1;
+    }
+
+    auto it = m_WindowsByAddress.upper_bound(p);
+    if (it != begin(m_WindowsByAddress))
+    {
+        --it;
+        const auto& window = m_Windows.at(it->second);
+        if (p < window.Data.GetData() + (window.ullEnd - window.ullStart))
+            return window.ullStart + (p - window.Data.GetData());
+    }
+
+    for (const auto& window : m_Retired)
+    {
+        if (p >= window.Data.GetData() && p < window.Data.GetData() + (window.ullEnd - window.ullStart))
+            return window.ullStart + (p - window.Data.GetData());
+    }
+    return (ULONGLONG)-1;
+}
+
+void RegistryHiveView::Trim()
+{
+    if (m_Mode != Mode::Paged)
+        return;
+
+    for (const auto& window : m_Retired)
+        m_ullBytes -= window.Data.GetCount();
+    m_Retired.clear();
+
+    while (m_ullBytes > m_ullCacheSize && m_Windows.size() > 1)
+    {
+        auto victim = std::min_element(begin(m_Windows), end(m_Windows), [](const auto& left, const auto& right) {
+            return left.second.ullLastUse < right.second.ullLastUse;
+        });
+
+        m_ullBytes -= victim->second.Data.GetCount();
+        m_WindowsByAddress.erase(victim->second.Data.GetData());
+        m_Windows.erase(victim);
+    }
+}
+
+void RegistryHiveView::Close()
+{
+    if (m_pView != nullptr)
+    {
+        UnmapViewOfFile(m_pView);
+        m_pView = nullptr;
+    }
+    if (m_hMapping != NULL)
+    {
+        CloseHandle(m_hMapping);
+        m_hMapping = NULL;
+    }
+
+    m_Tail.RemoveAll();
+    m_pTail = nullptr;
+    m_ullTailStart = 0LLU;
+
+    m_Buffer.RemoveAll();
+    m_pData = nullptr;
+
+    m_pStream = nullptr;
+    m_StreamLock.reset();
+    m_Windows.clear();
+    m_WindowsByAddress.clear();
+    m_Retired.clear();
+    m_ullBytes = 0LLU;
+
+    m_ullSize = 0LLU;
+    m_Mode = Mode::None;
+}
+
+RegistryHiveView::~RegistryHiveView()
+{
+    Close();
+}
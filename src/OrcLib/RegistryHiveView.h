@@ -0,0 +1,127 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include "BinaryBuffer.h"
+
+#include <concrt.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+class ByteStream;
+
+// Read only access to the bytes of a hive without a private copy of the whole file: hive files are mapped, other
+// seekable streams are read on demand, in windows of pages kept in a size bounded cache. Only streams that cannot
+// seek are still copied in memory.
+//
+// Pointers returned in paged mode stay valid until the next call to Trim(), the stream must stay open until then.
+// A view is not thread safe, threads use their own views (see Share()).
+class ORCLIB_API RegistryHiveView
+{
+public:
+    static constexpr ULONG kPageSize = 64 * 1024;
+    static constexpr ULONGLONG kDefaultCacheSize = 4 * 1024 * 1024;
+
+    enum class Mode
+    {
+        None,
+        Mapped,
+        Paged,
+        Buffer
+    };
+
+    RegistryHiveView(ULONGLONG ullCacheSize = kDefaultCacheSize);
+
+    RegistryHiveView(const RegistryHiveView&) = delete;
+    RegistryHiveView& operator=(const RegistryHiveView&) = delete;
+
+    HRESULT Open(ByteStream& stream);
+
+    // Opens this view on the hive of 'other', for another thread: a mapping or a buffer are shared, pages are cached
+    // again but reads of the stream are serialized. 'other' must stay open while this view is used.
+    HRESULT Share(const RegistryHiveView& other);
+
+    Mode GetMode() const { return m_Mode; }
+    ULONGLONG GetSize() const { return m_ullSize; }
+
+    // Pointer to (at least) cbBytes at ullOffset in the hive file, nullptr if they cannot be read. Fixed size headers
+    // can be read at the end of the hive: zeroes follow it
+    const BYTE* Get(ULONGLONG ullOffset, ULONG cbBytes);
+
+    // Pointer to the cell at dwOffset (relative to the first hbin): the whole cell, according to its size, is readable
+    // unless it ends past the end of the hive
+    const BYTE* GetCell(DWORD dwOffset);
+
+    // Offset in the hive file of a pointer returned by Get or GetCell, (ULONGLONG)-1 if it does not point in the hive
+    ULONGLONG OffsetOf(const void* pointer) const;
+
+    // Releases the least recently used windows above the cache size (paged mode only)
+    void Trim();
+
+    void Close();
+
+    ~RegistryHiveView();
+
+private:
+    // Bytes readable past any window (and past the buffer), so that fixed size headers at the end of the hive can be
+    // checked
+    static constexpr ULONG kPadding = 0x100;
+
+    class Window
+    {
+    public:
+        ULONGLONG ullStart = 0LLU;
+        ULONGLONG ullEnd = 0LLU;
+        ULONGLONG ullLastUse = 0LLU;
+        CBinaryBuffer Data;
+    };
+
+    Mode m_Mode = Mode::None;
+    ULONGLONG m_ullSize = 0LLU;
+    ULONGLONG m_ullCacheSize;
+
+    // Mapped or Buffer, owned by the view this one was shared from if m_pView and m_Buffer are empty
+    const BYTE* m_pData = nullptr;
+
+    // Mapped
+    HANDLE m_hMapping = NULL;
+    BYTE* m_pView = nullptr;
+
+    // Mapped: padded copy of the last page of the hive, for what crosses the end of the mapping (owned by the view
+    // this one was shared from if m_Tail is empty)
+    CBinaryBuffer m_Tail;
+    const BYTE* m_pTail = nullptr;
+    ULONGLONG m_ullTailStart = 0LLU;
+
+    // Buffer
+    CBinaryBuffer m_Buffer;
+
+    // Paged
+    ByteStream* m_pStream = nullptr;
+    std::shared_ptr<concurrency::critical_section> m_StreamLock;
+    std::map<ULONGLONG, Window> m_Windows;  // by offset in the hive file
+    std::map<const BYTE*, ULONGLONG> m_WindowsByAddress;
+    std::vector<Window> m_Retired;  // replaced by a larger window but maybe still referenced until Trim()
+    ULONGLONG m_ullBytes = 0LLU;
+    ULONGLONG m_ullTick = 0LLU;
+
+    HRESULT Map(HANDLE hFile);
+    HRESULT Copy(ByteStream& stream);
+
+    Window* Load(ULONGLONG ullOffset, ULONGLONG ullEnd);
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -9,6 +9,10 @@
 
 #include "RegistryWalker.h"
 
+#include <atomic>
+
+#include <ppl.h>
+
 using namespace Orc;
 
 RegistryValue::RegistryValue(
@@ -75,6 +79,7 @@ RegistryKey::RegistryKey(
     std::string&& ShortKeyName,
     std::string&& ClassName,
     const KeyHeader* const pRegKey,
+    DWORD dwKeyOffset,
     RegistryKey* const ParentKey,
     DWORD SubKeysCount,
     DWORD ValuesCount,
@@ -89,6 +94,7 @@ RegistryKey::RegistryKey(
     , m_dwValuesCount(ValuesCount)
     , m_Type(Type)
     , m_pRegKey(pRegKey)
+    , m_dwKeyOffset(dwKeyOffset)
     , m_bTreated(false)
     , m_dwSubKeysSeen(0)
     , m_bSubkeyListIsResident(bSukeyListIsResident)
@@ -200,7 +206,6 @@ RegistryHive::RegistryHive(const std::wstring& HiveName)
     : m_strHiveName(HiveName)
     , m_bIsComplete(true)
 {
-    m_pHiveBuffer = nullptr;
     m_ulHiveBufferSize = 0;
     m_pLastModificationTime = nullptr;
     m_dwDataBlockSize = 0;
@@ -210,7 +215,6 @@ RegistryHive::RegistryHive(const std::wstring& HiveName)
 RegistryHive::RegistryHive()
     : m_bIsComplete(true)
 {
-    m_pHiveBuffer = nullptr;
     m_ulHiveBufferSize = 0;
     m_pLastModificationTime = nullptr;
     m_dwDataBlockSize = 0;
@@ -250,35 +254,16 @@ HRESULT RegistryHive::LoadHive(ByteStream& HiveStream)
         return E_FAIL;
     }
 
-    m_pHiveBuffer = (BYTE*)malloc((size_t)ulSize);
-    if (m_pHiveBuffer == NULL)
+    if (FAILED(hr = m_View.Open(HiveStream)))
     {
-        Log::Error("Not enough memory to read hive");
-        return E_OUTOFMEMORY;
+        Log::Error("Failed to open hive [{}]", SystemError(hr));
+        return hr;
     }
-    m_ulHiveBufferSize = ulSize;
-
-    ULONG64 ulRead = 0LL;
-    ULONG64 ulTmp = 0LL;
-    while (ulRead != ulSize)
-    {
-
-        hr = HiveStream.Read((PVOID)(m_pHiveBuffer + ulRead), ulSize - ulRead, &ulTmp);
+    m_ulHiveBufferSize = m_View.GetSize();
 
-        if (ulTmp == 0)
-        {
-            Log::Error("Read error, aborting read operation");
-            free(m_pHiveBuffer);
-            m_pHiveBuffer = nullptr;
-            m_ulHiveBufferSize = 0LL;
-            return hr;
-        }
-        ulRead += ulTmp;
-    }
     if ((hr = ParseHiveHeader()) != S_OK)
     {
-        free(m_pHiveBuffer);
-        m_pHiveBuffer = nullptr;
+        m_View.Close();
         m_ulHiveBufferSize = 0L;
         Log::Error("Error during hive header parsing [{}]", SystemError(hr));
         return hr;
@@ -286,8 +271,7 @@ HRESULT RegistryHive::LoadHive(ByteStream& HiveStream)
 
     if ((hr = ParseHBinHeader()) != S_OK)
     {
-        free(m_pHiveBuffer);
-        m_pHiveBuffer = nullptr;
+        m_View.Close();
         m_ulHiveBufferSize = 0;
         Log::Error("Error during hive hbin header parsing [{}]", SystemError(hr));
         return hr;
@@ -310,8 +294,8 @@ HRESULT RegistryHive::CheckBlockHeader(const BlockHeader* const pBlockHeader) co
         return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
     }
 
-    if ((UINT_PTR)(pBlockHeader) + (size_t)(-(int)pBlockHeader->BlockSize)
-        > m_ulHiveBufferSize + (UINT_PTR)m_pHiveBuffer)
+    const ULONG64 ullOffset = m_View.OffsetOf(pBlockHeader);
+    if (ullOffset == (ULONG64)-1 || ullOffset + (size_t)(-(int)pBlockHeader->BlockSize) > m_ulHiveBufferSize)
     {
         Log::Error("Block end is outside of hive buffer boundary");
         return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
@@ -556,7 +540,8 @@ HRESULT RegistryHive::CheckDataHeader(const BlockHeader* const pHeader) const
         return HRESULT_FROM_WIN32(ERROR_INVALID_PARAMETER);
     }
 
-    if ((UINT_PTR)(pHeader) + (size_t)(-(int)pHeader->BlockSize) > (UINT_PTR)(m_pHiveBuffer) + m_ulHiveBufferSize)
+    const ULONG64 ullOffset = m_View.OffsetOf(pHeader);
+    if (ullOffset == (ULONG64)-1 || ullOffset + (size_t)(-(int)pHeader->BlockSize) > m_ulHiveBufferSize)
     {
         Log::Error("Data block end is outside of hive buffer boundary");
         return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
@@ -759,6 +744,7 @@ HRESULT RegistryHive::ParseLfLh(
                 std::move(ShortName),
                 std::move(ClassName),
                 pCurrentSubKeyHeader,
+                pCurrentHashRecord.OffsetToKeyHeader,
                 CurrentKey,
                 pCurrentSubKeyHeader->NumberOfSubKeys,
                 pCurrentSubKeyHeader->NumberOfValues,
@@ -881,6 +867,7 @@ HRESULT RegistryHive::ParseLiRi(
                 std::move(ShortName),
                 std::move(ClassName),
                 pCurrentSubKeyHeader,
+                pRiLiHeader->Records[i].OffsetToKeyHeader,
                 CurrentKey,
                 pCurrentSubKeyHeader->NumberOfSubKeys,
                 pCurrentSubKeyHeader->NumberOfValues,
@@ -965,8 +952,14 @@ HRESULT RegistryHive::ParseHiveHeader()
     }
 
     // Verify header
-    RegistryFile* pRegFile;
-    pRegFile = (RegistryFile*)m_pHiveBuffer;
+    const RegistryFile* pRegFile;
+    pRegFile = (const RegistryFile*)m_View.Get(0LL, 0x1000);
+    if (pRegFile == nullptr)
+    {
+        Log::Error("Hive header cannot be read");
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+    }
+
     if (strncmp(pRegFile->Signature, "regf", 4))
     {
         Log::Error("Hive signature 'regf' mismatch");
@@ -999,7 +992,9 @@ HRESULT RegistryHive::ParseHiveHeader()
         Log::Debug("Hive data block is bigger than hive. Either Hive is incomplete or some parts are not resident");
     }
 
-    m_pLastModificationTime = &pRegFile->LastModificationDate;
+    // the header is not kept in memory
+    m_LastModificationTime = pRegFile->LastModificationDate;
+    m_pLastModificationTime = &m_LastModificationTime;
 
     return S_OK;
 }
@@ -1015,8 +1010,8 @@ HRESULT RegistryHive::ParseHBinHeader()
         return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
     }
 
-    HBINHeader* pHBinHeader = (HBINHeader*)(m_pHiveBuffer + 0x1000);
-    if (strncmp(pHBinHeader->Signature, "hbin", 4))
+    const HBINHeader* pHBinHeader = (const HBINHeader*)m_View.Get(0x1000, sizeof(HBINHeader));
+    if (pHBinHeader == nullptr || strncmp(pHBinHeader->Signature, "hbin", 4))
     {
         Log::Error(L"Hive '{}': bad hbin header", m_strHiveName);
         return E_FAIL;
@@ -1026,12 +1021,24 @@ HRESULT RegistryHive::ParseHBinHeader()
     return S_OK;
 }
 
-HRESULT RegistryHive::Walk(
-    std::function<void(const RegistryKey* const)> RegistryKeyCallBack,
-    std::function<void(const RegistryValue* const)> RegistryValueCallback)
+HRESULT RegistryHive::ShareHive(const RegistryHive& Hive)
 {
     HRESULT hr = E_FAIL;
 
+    if (FAILED(hr = m_View.Share(Hive.m_View)))
+        return hr;
+
+    m_ulHiveBufferSize = Hive.m_ulHiveBufferSize;
+    m_LastModificationTime = Hive.m_LastModificationTime;
+    m_pLastModificationTime = &m_LastModificationTime;
+    m_dwRootKeyOffset = Hive.m_dwRootKeyOffset;
+    m_dwDataBlockSize = Hive.m_dwDataBlockSize;
+    m_bIsComplete = Hive.m_bIsComplete;
+    return S_OK;
+}
+
+HRESULT RegistryHive::MakeRootKey(RegistryKey*& pRootKey)
+{
     bool bSubkeyListIsResident;
     bool bValueListIsResident;
     bool bSkHeaderIsResident;
@@ -1077,11 +1084,12 @@ HRESULT RegistryHive::Walk(
     std::string ShortName(pRegKey->Name, pRegKey->NameLength);
 
     // Build rootkey
-    RegistryKey* const RootKeyRegistryKey = new RegistryKey(
+    pRootKey = new RegistryKey(
         std::move(Name),
         std::move(ShortName),
         std::move(ClassName),
         (const KeyHeader* const)FixOffset(m_dwRootKeyOffset),
+        m_dwRootKeyOffset,
         NULL,
         pRegKey->NumberOfSubKeys,
         pRegKey->NumberOfValues,
@@ -1091,9 +1099,57 @@ HRESULT RegistryHive::Walk(
         bValueListIsResident,
         bSkHeaderIsResident,
         bHasClassName);
+    return S_OK;
+}
 
-    std::vector<RegistryKey*> CurrentKeySet;
-    CurrentKeySet.push_back(RootKeyRegistryKey);
+void RegistryHive::CheckSubKeysCount(const RegistryKey* const Key)
+{
+    if (Key->GetSubKeysCount() != Key->GetSeenSubKeysCount())
+        Log::Debug(
+            "Key '{}': number of subkeys parsed is different from number of subkeys announced.({} announced, "
+            "{} parsed)",
+            Key->GetKeyName(),
+            Key->GetSubKeysCount(),
+            Key->GetSeenSubKeysCount());
+}
+
+HRESULT RegistryHive::ParseKey(
+    RegistryKey* const CurrentKey,
+    std::vector<RegistryKey*>& SubKeySet,
+    const std::function<void(const RegistryKey* const)>& RegistryKeyCallBack,
+    const std::function<void(const RegistryValue* const)>& RegistryValueCallback)
+{
+    HRESULT hr = E_FAIL;
+
+    // the header read when the key was found may have been released since
+    CurrentKey->m_pRegKey = (const KeyHeader*)FixOffset(CurrentKey->m_dwKeyOffset);
+
+    const auto KnownKeys = SubKeySet.size();
+    if ((hr = ParseNks(CurrentKey, SubKeySet)) != S_OK)
+    {
+        Log::Debug("Error during parsing of '{}' subkeys", CurrentKey->GetKeyName());
+    }
+    // every subkey found is walked
+    for (auto i = KnownKeys; i < SubKeySet.size(); i++)
+        CurrentKey->IncrementSubKeysSeenCount();
+
+    if ((hr = ParseValues(CurrentKey, RegistryValueCallback)) != S_OK)
+    {
+        Log::Debug("Error during parsing of '{}' values", CurrentKey->GetKeyName());
+    }
+    // Set key as treated!
+
+    CurrentKey->SetAsTreated();
+    // call key callback
+    RegistryKeyCallBack(CurrentKey);
+    return S_OK;
+}
+
+HRESULT RegistryHive::WalkKeys(
+    std::vector<RegistryKey*>& CurrentKeySet,
+    const std::function<void(const RegistryKey* const)>& RegistryKeyCallBack,
+    const std::function<void(const RegistryValue* const)>& RegistryValueCallback)
+{
     RegistryKey* CurrentKey;
     while (!CurrentKeySet.empty())
     {
@@ -1103,37 +1159,108 @@ HRESULT RegistryHive::Walk(
         if (CurrentKey->GetKeyStatus())
         {
             CurrentKeySet.pop_back();
-            if (CurrentKey->GetSubKeysCount() != CurrentKey->GetSeenSubKeysCount())
-                Log::Debug(
-                    "Key '{}': number of subkeys parsed is different from number of subkeys announced.({} announced, "
-                    "{} parsed)",
-                    CurrentKey->GetKeyName(),
-                    CurrentKey->GetSubKeysCount(),
-                    CurrentKey->GetSeenSubKeysCount());
+            CheckSubKeysCount(CurrentKey);
 
             delete CurrentKey;
             continue;
         }
 
-        RegistryKey* const pParentKey = CurrentKey->GetAlterableParentKey();
+        ParseKey(CurrentKey, CurrentKeySet, RegistryKeyCallBack, RegistryValueCallback);
+
+        // no cell of this key is used anymore
+        m_View.Trim();
+    }
+    return S_OK;
+}
+
+HRESULT RegistryHive::Walk(
+    std::function<void(const RegistryKey* const)> RegistryKeyCallBack,
+    std::function<void(const RegistryValue* const)> RegistryValueCallback)
+{
+    HRESULT hr = E_FAIL;
+
+    RegistryKey* RootKeyRegistryKey = nullptr;
+    if (FAILED(hr = MakeRootKey(RootKeyRegistryKey)))
+        return hr;
+
+    std::vector<RegistryKey*> CurrentKeySet;
+    CurrentKeySet.push_back(RootKeyRegistryKey);
+    return WalkKeys(CurrentKeySet, RegistryKeyCallBack, RegistryValueCallback);
+}
+
+HRESULT RegistryHive::ParallelWalk(
+    std::function<void(const RegistryKey* const)> RegistryKeyCallBack,
+    std::function<void(const RegistryValue* const)> RegistryValueCallback)
+{
+    HRESULT hr = E_FAIL;
+
+    // Each thread parses cells through its own view of the hive: if the view cannot be shared, walk it sequentially
+    if (FAILED(hr = std::make_shared<RegistryHive>(m_strHiveName)->ShareHive(*this)))
+    {
+        Log::Debug(
+            L"Failed to share the view of hive '{}', walking it sequentially [{}]", m_strHiveName, SystemError(hr));
+        return Walk(RegistryKeyCallBack, RegistryValueCallback);
+    }
+
+    RegistryKey* RootKeyRegistryKey = nullptr;
+    if (FAILED(hr = MakeRootKey(RootKeyRegistryKey)))
+        return hr;
+
+    // A worker without its view (null) fails the walk, the subtrees it was given are skipped
+    std::atomic<HRESULT> hrWorkers = S_OK;
+    concurrency::combinable<std::shared_ptr<RegistryHive>> Workers([this, &hrWorkers]() {
+        auto Worker = std::make_shared<RegistryHive>(m_strHiveName);
+        if (HRESULT hrShare = Worker->ShareHive(*this); FAILED(hrShare))
+        {
+            Log::Error(L"Failed to share the view of hive '{}' [{}]", m_strHiveName, SystemError(hrShare));
+            hrWorkers = hrShare;
+            return std::shared_ptr<RegistryHive>();
+        }
+        return Worker;
+    });
+
+    // Keys whose subkeys are walked by other tasks, released when all tasks are done
+    concurrency::critical_section cs;
+    std::vector<RegistryKey*> SplitKeys;
 
-        // Increment counter of treated subkeys
-        if (pParentKey != nullptr)
-            pParentKey->IncrementSubKeysSeenCount();
+    concurrency::task_group Tasks;
 
-        if ((hr = ParseNks(CurrentKey, CurrentKeySet)) != S_OK)
+    std::function<void(RegistryKey* const, DWORD)> WalkSubTree = [&](RegistryKey* const Key, DWORD dwDepth) {
+        if (Workers.local() == nullptr)
         {
-            Log::Debug("Error during parsing of '{}' subkeys", CurrentKey->GetKeyName());
+            delete Key;
+            return;
         }
-        if ((hr = ParseValues(CurrentKey, RegistryValueCallback)) != S_OK)
+        auto& Worker = *Workers.local();
+
+        if (dwDepth >= kParallelWalkDepth)
         {
-            Log::Debug("Error during parsing of '{}' values", CurrentKey->GetKeyName());
+            std::vector<RegistryKey*> KeySet;
+            KeySet.push_back(Key);
+            Worker.WalkKeys(KeySet, RegistryKeyCallBack, RegistryValueCallback);
+            return;
         }
-        // Set key as treated!
 
-        CurrentKey->SetAsTreated();
-        // call key callback
-        RegistryKeyCallBack(CurrentKey);
+        std::vector<RegistryKey*> SubKeySet;
+        Worker.ParseKey(Key, SubKeySet, RegistryKeyCallBack, RegistryValueCallback);
+        Worker.m_View.Trim();
+
+        {
+            concurrency::critical_section::scoped_lock sl(cs);
+            SplitKeys.push_back(Key);
+        }
+
+        for (auto SubKey : SubKeySet)
+            Tasks.run([&WalkSubTree, SubKey, dwDepth]() { WalkSubTree(SubKey, dwDepth + 1); });
+    };
+
+    WalkSubTree(RootKeyRegistryKey, 0);
+    Tasks.wait();
+
+    for (auto Key : SplitKeys)
+    {
+        CheckSubKeysCount(Key);
+        delete Key;
     }
-    return S_OK;
+    return hrWorkers;
 }
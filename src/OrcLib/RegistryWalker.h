@@ -14,6 +14,7 @@
 #include <algorithm>
 
 #include "ByteStream.h"
+#include "RegistryHiveView.h"
 
 #pragma managed(push, off)
 
@@ -268,9 +269,12 @@ public:
 class ORCLIB_API RegistryHive
 {
 private:
-    BYTE* m_pHiveBuffer;
+    // Cells are read through the view on demand, pointers to them are only valid until the view is trimmed (between
+    // two keys of the walk)
+    mutable RegistryHiveView m_View;
     ULONG64 m_ulHiveBufferSize;
 
+    FILETIME m_LastModificationTime;
     FILETIME* m_pLastModificationTime;
     DWORD m_dwRootKeyOffset;
     DWORD m_dwDataBlockSize;
@@ -281,7 +285,7 @@ private:
     std::function<void(const RegistryKey&)> m_RegistryKeyCallBack;
     std::function<void(const RegistryValue&)> m_RegistryValueCallback;
 
-    BYTE* FixOffset(DWORD offset) const { return (m_pHiveBuffer + (int)offset + 0x1000); };
+    const BYTE* FixOffset(DWORD offset) const { return m_View.GetCell(offset); };
 
     bool IsOffsetValid(DWORD dwOffset) const
     {
@@ -322,29 +326,48 @@ private:
 
     void SetHiveIsNotComplete();
 
+    // Keys above this depth are parsed by a task each, deeper subtrees are walked whole by one task
+    static constexpr DWORD kParallelWalkDepth = 2;
+
+    HRESULT ShareHive(const RegistryHive& Hive);
+
+    HRESULT MakeRootKey(RegistryKey*& pRootKey);
+    HRESULT ParseKey(
+        RegistryKey* const CurrentKey,
+        std::vector<RegistryKey*>& SubKeySet,
+        const std::function<void(const RegistryKey* const)>& RegistryKeyCallBack,
+        const std::function<void(const RegistryValue* const)>& RegistryValueCallback);
+    HRESULT WalkKeys(
+        std::vector<RegistryKey*>& CurrentKeySet,
+        const std::function<void(const RegistryKey* const)>& RegistryKeyCallBack,
+        const std::function<void(const RegistryValue* const)>& RegistryValueCallback);
+
+    static void CheckSubKeysCount(const RegistryKey* const Key);
+
 public:
     RegistryHive(const std::wstring& HiveName);
     RegistryHive();
 
+    // HiveStream must stay open until the hive is walked: only hives that cannot be mapped or read on demand are
+    // loaded in memory
     HRESULT LoadHive(ByteStream& HiveStream);
     HRESULT Walk(
         std::function<void(const RegistryKey* const)> RegistryKeyCallBack,
         std::function<void(const RegistryValue* const)> RegistryValueCallback);
-    bool IsHiveComplete() const;
 
-    ~RegistryHive()
-    {
-        if (m_pHiveBuffer != nullptr)
-            free(m_pHiveBuffer);
-    };
+    // Walks the subtrees of the first levels of keys concurrently: callbacks are called from several threads at once
+    // (keys and values of a key are still given to the callbacks by a single thread, parents before their subkeys)
+    HRESULT ParallelWalk(
+        std::function<void(const RegistryKey* const)> RegistryKeyCallBack,
+        std::function<void(const RegistryValue* const)> RegistryValueCallback);
+
+    bool IsHiveComplete() const;
 };
 
 class ORCLIB_API RegistryKey
 {
 
-    friend HRESULT RegistryHive::Walk(
-        std::function<void(const RegistryKey* const)> RegistryKeyCallBack,
-        std::function<void(const RegistryValue* const)> RegistryValueCallback);
+    friend class RegistryHive;
 
 private:
     RegistryKey* GetAlterableParentKey();
@@ -361,7 +384,8 @@ private:
 
     RegistryKey* const m_ParentKey;  // ptr needed, can be null (root key! lost keys?)
 
-    const KeyHeader* const m_pRegKey;
+    const KeyHeader* m_pRegKey;  // resolved again (from m_dwKeyOffset) when the key is walked
+    DWORD m_dwKeyOffset;
     bool m_bTreated;
 
     // Non resident/incomplete keys
@@ -406,6 +430,7 @@ public:
         std::string&& ShortKeyName,
         std::string&& ClassName,
         const KeyHeader* const m_pRegKey,
+        DWORD dwKeyOffset,
         RegistryKey* const Parent,
         DWORD SubKeysCount,
         DWORD ValuesCount,
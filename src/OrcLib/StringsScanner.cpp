@@ -0,0 +1,323 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "StringsScanner.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#if defined(_M_IX86) || defined(_M_X64)
+#    include <intrin.h>
+#    include <immintrin.h>
+#    define ORC_STRINGS_SIMD
+#endif
+
+using namespace Orc;
+
+namespace {
+
+constexpr size_t kWordBytes = 64;
+
+// tab, line feed, carriage return and 0x20-0x7E
+const std::array<bool, 0x100>& PrintableTable()
+{
+    static const std::array<bool, 0x100> table = []() {
+        std::array<bool, 0x100> printable {};
+        for (size_t c = 0x20; c < 0x7F; c++)
+            printable[c] = true;
+        printable['\t'] = printable['\n'] = printable['\r'] = true;
+        return printable;
+    }();
+    return table;
+}
+
+inline ULONG TrailingZeros(uint64_t bits)
+{
+    unsigned long index = 0;
+#if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    if (_BitScanForward(&index, static_cast<unsigned long>(bits)))
+        return index;
+    _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+    return 32 + index;
+#endif
+}
+
+struct WordMasks
+{
+    uint64_t printable;
+    uint64_t null;
+    uint64_t candidates;  // start bytes
+};
+
+// bits[i] &= bits[i + shift], bits past the end being cleared
+void AndShifted(std::vector<uint64_t>& bits, size_t shift)
+{
+    const size_t words = shift / kWordBytes;
+    const size_t remainder = shift % kWordBytes;
+
+    const auto Word = [&bits](size_t index) { return index < bits.size() ? bits[index] : 0ULL; };
+
+    for (size_t i = 0; i < bits.size(); i++)
+    {
+        const uint64_t low = Word(i + words);
+        const uint64_t shifted = remainder ? (low >> remainder) | (Word(i + words + 1) << (kWordBytes - remainder)) : low;
+        bits[i] &= shifted;
+    }
+}
+
+// Classifies up to 64 bytes, the bits of the missing bytes are cleared
+WordMasks ClassifyBytes(const BYTE* pData, size_t cbData, const std::vector<BYTE>& startBytes)
+{
+    const auto& printable = PrintableTable();
+
+    WordMasks masks {0, 0, 0};
+    for (size_t i = 0; i < cbData; i++)
+    {
+        const BYTE c = pData[i];
+        const bool bStart = std::find(std::cbegin(startBytes), std::cend(startBytes), c) != std::cend(startBytes);
+
+        masks.printable |= static_cast<uint64_t>(printable[c]) << i;
+        masks.null |= static_cast<uint64_t>(c == 0) << i;
+        masks.candidates |= static_cast<uint64_t>(bStart) << i;
+    }
+
+    return masks;
+}
+
+#ifdef ORC_STRINGS_SIMD
+
+bool DetectAvx2()
+{
+    int info[4] = {0};
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // the OS must save the AVX registers
+    __cpuid(info, 1);
+    const bool bOSXSAVE = (info[2] & (1 << 27)) != 0;
+    const bool bAVX = (info[2] & (1 << 28)) != 0;
+    if (!bOSXSAVE || !bAVX || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+
+// Bytes are compared as signed values: 0x20 <= c < 0x7F is (c > 0x1F) && (0x7F > c), bytes above 0x7F are negative
+inline __m128i Printable(__m128i chars)
+{
+    const __m128i range = _mm_and_si128(
+        _mm_cmpgt_epi8(chars, _mm_set1_epi8(0x1F)), _mm_cmpgt_epi8(_mm_set1_epi8(0x7F), chars));
+    const __m128i controls = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n'))),
+        _mm_cmpeq_epi8(chars, _mm_set1_epi8('\r')));
+    return _mm_or_si128(range, controls);
+}
+
+WordMasks ClassifyWordSse2(const BYTE* pData, const std::vector<BYTE>& startBytes)
+{
+    WordMasks masks {0, 0, 0};
+
+    for (size_t i = 0; i < kWordBytes; i += 16)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i));
+        const __m128i printable = Printable(chars);
+
+        __m128i candidates = _mm_setzero_si128();
+        for (const BYTE b : startBytes)
+            candidates = _mm_or_si128(candidates, _mm_cmpeq_epi8(chars, _mm_set1_epi8(static_cast<char>(b))));
+
+        const auto Bits = [i](__m128i mask) {
+            return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(mask))) << i;
+        };
+
+        masks.printable |= Bits(printable);
+        masks.null |= Bits(_mm_cmpeq_epi8(chars, _mm_setzero_si128()));
+        masks.candidates |= Bits(candidates);
+    }
+
+    return masks;
+}
+
+inline __m256i Printable(__m256i chars)
+{
+    const __m256i range = _mm256_and_si256(
+        _mm256_cmpgt_epi8(chars, _mm256_set1_epi8(0x1F)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7F), chars));
+    const __m256i controls = _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n'))),
+        _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r')));
+    return _mm256_or_si256(range, controls);
+}
+
+WordMasks ClassifyWordAvx2(const BYTE* pData, const std::vector<BYTE>& startBytes)
+{
+    WordMasks masks {0, 0, 0};
+
+    for (size_t i = 0; i < kWordBytes; i += 32)
+    {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData + i));
+        const __m256i printable = Printable(chars);
+
+        __m256i candidates = _mm256_setzero_si256();
+        for (const BYTE b : startBytes)
+            candidates =
+                _mm256_or_si256(candidates, _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(static_cast<char>(b))));
+
+        const auto Bits = [i](__m256i mask) {
+            return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(mask))) << i;
+        };
+
+        masks.printable |= Bits(printable);
+        masks.null |= Bits(_mm256_cmpeq_epi8(chars, _mm256_setzero_si256()));
+        masks.candidates |= Bits(candidates);
+    }
+
+    return masks;
+}
+
+#endif
+
+std::atomic<bool>& Avx2Enabled()
+{
+    static std::atomic<bool> bEnabled = StringsScanner::HasAvx2();
+    return bEnabled;
+}
+
+}  // namespace
+
+StringsScanner::StringsScanner(std::vector<BYTE> startBytes)
+    : m_StartBytes(std::move(startBytes))
+{
+}
+
+bool StringsScanner::IsPrintable(BYTE c)
+{
+    return PrintableTable()[c];
+}
+
+bool StringsScanner::HasAvx2()
+{
+#ifdef ORC_STRINGS_SIMD
+    static const bool bHasAvx2 = DetectAvx2();
+    return bHasAvx2;
+#else
+    return false;
+#endif
+}
+
+void StringsScanner::EnableAvx2(bool bEnable)
+{
+    Avx2Enabled().store(bEnable && HasAvx2());
+}
+
+bool StringsScanner::UsesAvx2()
+{
+    return Avx2Enabled().load(std::memory_order_relaxed);
+}
+
+void StringsScanner::Load(const BYTE* pData, size_t cbData, size_t minChars)
+{
+    m_pData = pData;
+    m_cbData = cbData;
+    m_minChars = std::max<size_t>(minChars, 1);
+
+    const size_t words = (cbData + kWordBytes - 1) / kWordBytes;
+    m_Printable.assign(words + 1, 0);
+    m_Null.assign(words + 1, 0);
+    m_Candidates.assign(words + 1, 0);
+
+    const auto Store = [this](size_t index, const WordMasks& masks) {
+        m_Printable[index] = masks.printable;
+        m_Null[index] = masks.null;
+        m_Candidates[index] = masks.candidates;
+    };
+
+    size_t index = 0;
+#ifdef ORC_STRINGS_SIMD
+    const auto ClassifyWord = UsesAvx2() ? ClassifyWordAvx2 : ClassifyWordSse2;
+    for (; (index + 1) * kWordBytes <= cbData; index++)
+        Store(index, ClassifyWord(pData + index * kWordBytes, m_StartBytes));
+#endif
+
+    for (; index * kWordBytes < cbData; index++)
+    {
+        const size_t offset = index * kWordBytes;
+        Store(index, ClassifyBytes(pData + offset, std::min(kWordBytes, cbData - offset), m_StartBytes));
+    }
+
+    m_Utf16.assign(words + 1, 0);
+    for (index = 0; index < words; index++)
+        m_Utf16[index] = m_Printable[index] & ((m_Null[index] >> 1) | (m_Null[index + 1] << 63));
+
+    AddRuns(m_Printable, 1);
+    AddRuns(m_Utf16, 2);
+}
+
+void StringsScanner::AddRuns(const std::vector<uint64_t>& bits, size_t step)
+{
+    // bits set where 'count' bits are set every 'step' bits, 'count' is doubled up to 'minChars'
+    m_Runs = bits;
+    for (size_t count = 1; count < m_minChars;)
+    {
+        const size_t shift = std::min(count, m_minChars - count);
+        AndShifted(m_Runs, shift * step);
+        count += shift;
+    }
+
+    for (size_t i = 0; i < m_Candidates.size(); i++)
+        m_Candidates[i] |= m_Runs[i];
+}
+
+template <typename WordFn>
+size_t StringsScanner::FindFirst(size_t offset, WordFn word) const
+{
+    if (offset >= m_cbData)
+        return m_cbData;
+
+    const size_t words = (m_cbData + kWordBytes - 1) / kWordBytes;
+    size_t index = offset / kWordBytes;
+
+    uint64_t bits = word(index) & (~0ULL << (offset % kWordBytes));
+    while (bits == 0)
+    {
+        if (++index >= words)
+            return m_cbData;
+        bits = word(index);
+    }
+
+    return std::min(index * kWordBytes + TrailingZeros(bits), m_cbData);
+}
+
+size_t StringsScanner::NextCandidate(size_t offset) const
+{
+    return FindFirst(offset, [this](size_t index) { return m_Candidates[index]; });
+}
+
+StringsScanner::Span StringsScanner::SpanAt(size_t offset) const
+{
+    if (offset >= m_cbData || !IsPrintable(m_pData[offset]))
+        return {offset, 0, Encoding::Ascii};
+
+    if (offset + 1 < m_cbData && m_pData[offset + 1] == 0)
+    {
+        // characters of the string are every other byte from its start: the other bytes are ignored
+        const uint64_t otherBytes = (offset % 2) ? 0x5555555555555555ULL : 0xAAAAAAAAAAAAAAAAULL;
+        const size_t end =
+            FindFirst(offset, [this, otherBytes](size_t index) { return ~(m_Utf16[index] | otherBytes); });
+
+        return {offset, (end - offset) / 2, Encoding::Utf16};
+    }
+
+    const size_t end = FindFirst(offset, [this](size_t index) { return ~m_Printable[index]; });
+    return {offset, end - offset, Encoding::Ascii};
+}
@@ -0,0 +1,118 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include <cstdint>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Finds the printable strings of a buffer, ASCII and UTF-16LE at once. Bytes are classified into bit masks 64 at a
+// time (32 bytes per instruction with AVX2, 16 with SSE2), the offsets starting a long enough string are then
+// computed with shifts of the masks and strings are delimited with bit scans: no byte is looked at individually.
+//
+// Strings are those StringsStream always extracted: a printable byte followed by a null byte starts a UTF-16 string,
+// any other printable byte an ASCII string, and the scan resumes after each extracted string.
+class ORCLIB_API StringsScanner
+{
+public:
+    enum class Encoding
+    {
+        Ascii,
+        Utf16
+    };
+
+    struct Span
+    {
+        size_t Offset;  // in bytes, from the start of the buffer
+        size_t Length;  // in characters
+        Encoding Type;
+
+        bool operator==(const Span& other) const
+        {
+            return Offset == other.Offset && Length == other.Length && Type == other.Type;
+        }
+    };
+
+    // 'startBytes' are non printable bytes also reported as candidates by NextCandidate
+    explicit StringsScanner(std::vector<BYTE> startBytes = {});
+
+    // Classifies the bytes of a buffer, which must stay valid while the scanner is used
+    void Load(const BYTE* pData, size_t cbData, size_t minChars);
+
+    // First offset from 'offset' starting a string of at least 'minChars' characters or holding a start byte, the
+    // buffer size if none
+    size_t NextCandidate(size_t offset) const;
+
+    // String starting at 'offset', its length is zero if the byte there is not printable
+    Span SpanAt(size_t offset) const;
+
+    // Offset following a string
+    static size_t End(const Span& span)
+    {
+        return span.Offset + (span.Type == Encoding::Utf16 ? 2 * span.Length : span.Length);
+    }
+
+    // Calls SpanCallback(const Span&) for each string of at least 'minChars' characters, in order
+    template <typename SpanCallback>
+    void Scan(SpanCallback callback) const
+    {
+        size_t offset = NextCandidate(0);
+        while (offset + m_minChars < m_cbData)
+        {
+            const Span span = SpanAt(offset);
+
+            if (span.Length > 0 && span.Length >= m_minChars)
+            {
+                callback(span);
+                offset = NextCandidate(End(span));
+            }
+            else
+            {
+                // a start byte
+                offset = NextCandidate(offset + 1);
+            }
+        }
+    }
+
+    static bool IsPrintable(BYTE c);
+
+    // CPU support for AVX2
+    static bool HasAvx2();
+
+    // Runtime selection of the classification (AVX2 is used by default when available)
+    static void EnableAvx2(bool bEnable);
+    static bool UsesAvx2();
+
+private:
+    // First offset from 'offset' whose bit is set in the words returned by 'word', the buffer size if none
+    template <typename WordFn>
+    size_t FindFirst(size_t offset, WordFn word) const;
+
+    // Adds to m_Candidates the offsets of 'minChars' bits of 'bits' set every 'step' bits
+    void AddRuns(const std::vector<uint64_t>& bits, size_t step);
+
+    std::vector<BYTE> m_StartBytes;
+
+    const BYTE* m_pData = nullptr;
+    size_t m_cbData = 0;
+    size_t m_minChars = 1;
+
+    // one bit per byte, with an extra null word so that a word may be shifted with its successor
+    std::vector<uint64_t> m_Printable;
+    std::vector<uint64_t> m_Null;
+    std::vector<uint64_t> m_Utf16;  // printable bytes followed by a null one
+    std::vector<uint64_t> m_Candidates;
+    std::vector<uint64_t> m_Runs;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
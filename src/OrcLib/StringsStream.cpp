@@ -280,13 +280,15 @@ static bool isAscii[0x100] =
         false,
         false};
 
-HRESULT StringsStream::OpenForStrings(const shared_ptr<ByteStream>& pChained, size_t minChars, size_t maxChars)
+HRESULT
+StringsStream::OpenForStrings(const shared_ptr<ByteStream>& pChained, size_t minChars, size_t maxChars, bool bOffsets)
 {
     if (pChained == NULL)
         return E_POINTER;
 
     m_minChars = minChars;
     m_maxChars = maxChars;
+    m_bOffsets = bOffsets;
 
     if (pChained->IsOpen() != S_OK)
     {
@@ -360,11 +362,8 @@ size_t StringsStream::extractString(
     ExtractType& extractType,
     UTF16Type& stringType)
 {
-    // Process the string as either:
-    // 1. ascii
-    // 2. unicode
-    // 3. x86 ASM stack pushes
-    // TODO: 4. x64 ASM stack pushes
+    // Process the string as x86 ASM stack pushes (ascii and unicode strings are found by m_Scanner)
+    // TODO: x64 ASM stack pushes
     //
     // To improve performance:
     //	Assumes MAX_STRING_SIZE > 1
@@ -551,82 +550,136 @@ size_t StringsStream::extractString(
             break;
 
         default:
-            // Try to parse as ascii or unicode
-            if (isAscii[aBuffer.Get<UCHAR>(offset)])
-            {
-                // Consider unicode case
-                if (aBuffer.Get<UCHAR>(offset + 1) == 0)  // No null dereference by assumptions
-                {
-                    // Parse as unicode
-                    size_t i = 0;
-                    while (offset + i + 1 < aBuffer.GetCount() && i / 2 < m_Strings.GetCount()
-                           && isAscii[aBuffer.Get<UCHAR>(offset + i)] && aBuffer.Get<UCHAR>(offset + i + 1) == 0
-                           && i / 2 + 1 < m_Strings.GetCount())
-                    {
-                        // Copy this character
-                        m_Strings.CheckCount(m_cchExtracted + 1);
-                        m_Strings.Get<UCHAR>(m_cchExtracted) = aBuffer.Get<UCHAR>(offset + i);
-                        i += 2;
-                        m_cchExtracted++;
-                    }
-                    stringType = TYPE_UNICODE;
-                    return i;
-                }
-                else
-                {
-                    // Parse as ascii
-                    size_t i = offset;
-                    while (i < aBuffer.GetCount() && isAscii[aBuffer.Get<UCHAR>(i)])
-                        i++;
-
-                    m_Strings.CheckCount((m_cchExtracted + (i - offset)) * sizeof(UCHAR));
-
-                    // Copy this string to the output
-                    memcpy(
-                        (LPBYTE)m_Strings.GetData() + (m_cchExtracted * sizeof(UCHAR)),
-                        aBuffer.GetData() + offset,
-                        (i - offset) * sizeof(UCHAR));
-                    m_cchExtracted += i - offset;
-                    stringType = TYPE_ASCII;
-                    return i - offset;
-                }
-            }
+            break;
     }
 
     return 0;
 }
 
+bool StringsStream::checkCapacity(size_t cchRequired)
+{
+    if (cchRequired * sizeof(UCHAR) <= m_Strings.GetCount())
+        return true;
+
+    // grow geometrically, strings are appended one at a time
+    return m_Strings.CheckCount(std::max(cchRequired * sizeof(UCHAR), m_Strings.GetCount() * 2));
+}
+
+void StringsStream::appendOffset(ULONGLONG ullOffset)
+{
+    CHAR szOffset[32];
+    const auto result = fmt::format_to_n(szOffset, sizeof(szOffset), "{:08X} ", ullOffset);
+
+    if (!checkCapacity(m_cchExtracted + result.size))
+        return;
+
+    memcpy((LPBYTE)m_Strings.GetData() + (m_cchExtracted * sizeof(UCHAR)), szOffset, result.size * sizeof(UCHAR));
+    m_cchExtracted += result.size;
+}
+
+void StringsStream::appendSpan(const CBinaryBuffer& aBuffer, const StringsScanner::Span& span)
+{
+    if (!checkCapacity(m_cchExtracted + span.Length))
+        return;
+
+    LPBYTE pOut = (LPBYTE)m_Strings.GetData() + (m_cchExtracted * sizeof(UCHAR));
+    const BYTE* pIn = aBuffer.GetData() + span.Offset;
+
+    if (span.Type == StringsScanner::Encoding::Ascii)
+    {
+        memcpy(pOut, pIn, span.Length * sizeof(UCHAR));
+    }
+    else
+    {
+        // keep the low byte of each character, the high one is null
+        for (size_t i = 0; i < span.Length; i++)
+            pOut[i] = pIn[2 * i];
+    }
+
+    m_cchExtracted += span.Length;
+}
+
+void StringsStream::appendNewLine()
+{
+    if (!checkCapacity(m_cchExtracted + 2))
+        return;
+
+    m_Strings.Get<UCHAR>(m_cchExtracted) = '\r';
+    m_Strings.Get<UCHAR>(m_cchExtracted + 1) = '\n';
+    m_cchExtracted += 2;
+}
+
+// Opcodes handled by extractString
+bool StringsStream::isStackString(const CBinaryBuffer& aBuffer, size_t offset)
+{
+    if (offset + 3 >= aBuffer.GetCount())
+        return false;
+
+    const UCHAR b0 = aBuffer.Get<UCHAR>(offset);
+    const UCHAR b1 = aBuffer.Get<UCHAR>(offset + 1);
+
+    if (b0 == 0xC6 || b0 == 0xC7)
+        return b1 == 0x45 || b1 == 0x85;
+
+    return b0 == 0x66 && b1 == 0xC7;
+}
+
 HRESULT StringsStream::processBuffer(const CBinaryBuffer& aBuffer, CBinaryBuffer& strings)
 {
     // Process the contents of the specified file, and build the list of strings
     strings.CheckCount(MAX_STRING_SIZE + 1);
     m_cchExtracted = 0;
 
-    size_t offset = 0;
-    ExtractType extractType;
+    // Only offsets starting a long enough string and those of the stack string opcodes are candidates
+    m_Scanner.Load(aBuffer.GetData(), aBuffer.GetCount(), m_minChars);
+
+    size_t offset = m_Scanner.NextCandidate(0);
     while (offset + m_minChars < aBuffer.GetCount())
     {
-        // Process this offset
-        UTF16Type stringType = TYPE_UNDETERMINED;
         size_t cchPreviouslyExtracted = m_cchExtracted;
-        size_t cbProcessed = extractString(aBuffer, offset, extractType, stringType);
 
-        if ((m_cchExtracted - cchPreviouslyExtracted) >= m_minChars)
+        if (isStackString(aBuffer, offset))
         {
-            // Do something
-            m_Strings.CheckCount(m_cchExtracted + 2);
-            m_Strings.Get<UCHAR>(m_cchExtracted) = '\r';
-            m_Strings.Get<UCHAR>(m_cchExtracted + 1) = '\n';
-            m_cchExtracted += 2;
-            // Advance the offset
-            offset += cbProcessed;
+            // Stack strings are rare, the offset is written upfront and discarded with a short string
+            if (m_bOffsets)
+                appendOffset(m_ullOffset + offset);
+
+            size_t cchPrefix = m_cchExtracted;
+            ExtractType extractType;
+            UTF16Type stringType = TYPE_UNDETERMINED;
+            size_t cbProcessed = extractString(aBuffer, offset, extractType, stringType);
+
+            if (cbProcessed > 0 && (m_cchExtracted - cchPrefix) >= m_minChars)
+            {
+                appendNewLine();
+                offset += cbProcessed;
+            }
+            else
+            {
+                m_cchExtracted = cchPreviouslyExtracted;
+                offset += 1;
+            }
         }
         else
         {
-            // Advance the offset by 1
-            m_cchExtracted = cchPreviouslyExtracted;
-            offset += 1;
+            const auto span = m_Scanner.SpanAt(offset);
+
+            if (span.Length > 0 && span.Length >= m_minChars)
+            {
+                if (m_bOffsets)
+                    appendOffset(m_ullOffset + offset);
+
+                appendSpan(aBuffer, span);
+                appendNewLine();
+                offset = StringsScanner::End(span);
+            }
+            else
+            {
+                offset += 1;
+            }
         }
+
+        offset = m_Scanner.NextCandidate(offset);
     }
 
     return true;
@@ -658,6 +711,9 @@ HRESULT StringsStream::Read(
     CBinaryBuffer buffer;
     buffer.SetCount(static_cast<size_t>(cbBytes) + m_maxChars);
 
+    if (m_bOffsets && FAILED(hr = m_pChainedStream->SetFilePointer(0LL, FILE_CURRENT, &m_ullOffset)))
+        return hr;
+
     if (FAILED(hr = m_pChainedStream->Read(pReadBuffer, cbBytes, &cbBytesRead)))
         return hr;
 
@@ -11,6 +11,7 @@
 
 #include "ChainingStream.h"
 #include "BinaryBuffer.h"
+#include "StringsScanner.h"
 
 #pragma managed(push, off)
 
@@ -44,6 +45,19 @@ private:
     size_t m_minChars;
     size_t m_maxChars;
 
+    bool m_bOffsets = false;
+    ULONGLONG m_ullOffset = 0LL;
+
+    // candidates also include the first bytes of the stack string opcodes (66 C7, C6 and C7)
+    StringsScanner m_Scanner;
+
+    bool checkCapacity(size_t cchRequired);
+    void appendOffset(ULONGLONG ullOffset);
+    void appendSpan(const CBinaryBuffer& aBuffer, const StringsScanner::Span& span);
+    void appendNewLine();
+
+    static bool isStackString(const CBinaryBuffer& aBuffer, size_t offset);
+
     size_t extractImmediate(const CBinaryBuffer& aBuffer, UTF16Type& stringType);
     size_t extractString(const CBinaryBuffer& aBuffer, size_t offset, ExtractType& extractType, UTF16Type& stringType);
 
@@ -51,7 +65,8 @@ private:
 
 public:
     StringsStream()
-        : ChainingStream() {};
+        : ChainingStream()
+        , m_Scanner({0x66, 0xC6, 0xC7}) {};
 
     STDMETHOD(IsOpen)()
     {
@@ -81,8 +96,9 @@ public:
     //
     // CByteStream implementation
     //
+    // With 'bOffsets', each string is prefixed with its offset in the chained stream
     STDMETHOD(OpenForStrings)
-    (const std::shared_ptr<ByteStream>& pChainedStream, size_t minChars, size_t maxChars);
+    (const std::shared_ptr<ByteStream>& pChainedStream, size_t minChars, size_t maxChars, bool bOffsets = false);
 
     STDMETHOD(Read)
     (__out_bcount_part(cbBytes, *pcbBytesRead) PVOID pReadBuffer,
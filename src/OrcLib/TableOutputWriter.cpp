@@ -58,6 +58,7 @@ std::shared_ptr<IWriter> Orc::TableOutput::GetWriter(const OutputSpec& out)
             options->bBOM = true;
             options->Delimiter = out.szSeparator;
             options->StringDelimiter = out.szQuote;
+            options->bDirectUtf8 = true;
 
             auto retval = CSV::Writer::MakeNew(std::move(options));
 
@@ -280,6 +281,7 @@ std::shared_ptr<IWriter> Orc::TableOutput::GetWriter(LPCWSTR szFileName, const O
 
     auto options = std::make_unique<TableOutput::CSV::Options>();
     options->Encoding = out.OutputEncoding;
+    options->bDirectUtf8 = true;
 
     auto retval = TableOutput::CSV::Writer::MakeNew(std::move(options));
 
@@ -71,6 +71,7 @@ struct Options : Orc::TableOutput::Options
     std::wstring StringDelimiter = L"\""s;
     std::wstring EndOfLine = L"\r\n"s;
     std::wstring BoolChars = L"YN"s;
+    bool bDirectUtf8 = false;  // UTF8 only: columns are formatted as UTF-8, without an intermediate UTF-16 buffer
 };
 }  // namespace CSV
 
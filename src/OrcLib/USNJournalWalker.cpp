@@ -86,13 +86,7 @@ HRESULT USNJournalWalker::Initialize(const std::shared_ptr<Location>& loc)
     wcscpy_s(szVolName, mountedVolReader->ShortVolumeName());
     wcscat_s(szVolName, L"\\");
 
-    if (GetVolumeInformation(szVolName, NULL, NULL, NULL, &m_cchMaxComponentLength, NULL, szFSName, MAX_PATH))
-    {
-        m_dwRecordMaxSize = (m_cchMaxComponentLength * sizeof(WCHAR) + sizeof(USN_RECORD) - sizeof(WCHAR))
-            + sizeof(DWORD);  // We are adding 4 bytes because of testing results contradicting
-                              // https://msdn.microsoft.com/en-us/library/windows/desktop/aa365722(v=vs.85).aspx
-    }
-    else
+    if (!GetVolumeInformation(szVolName, NULL, NULL, NULL, &m_cchMaxComponentLength, NULL, szFSName, MAX_PATH))
     {
         return HRESULT_FROM_WIN32(GetLastError());
     }
@@ -166,10 +160,6 @@ HRESULT USNJournalWalker::Initialize(const std::shared_ptr<Location>& loc)
         });
     }
 
-    if (FAILED(hr = m_RecordStore.InitializeStore(USN_MAX_NUMBER, m_dwRecordMaxSize)))
-    {
-        return hr;
-    }
     return S_OK;
 }
 
@@ -177,17 +167,19 @@ HRESULT USNJournalWalker::WalkRecords(const Callbacks& pCallbacks, bool bWalkDir
 {
     if (pCallbacks.RecordCallback != NULL)
     {
-        // Walk through the files
-        auto iter = m_USNMap.begin();
-        do
+        std::vector<BYTE> record;
+
+        // Walk through the files, in the order of the enumeration
+        for (DWORD dwRow = 0L; dwRow < m_RecordStore.GetRowCount(); dwRow++)
         {
-            USN_RECORD* pValue = iter->second;
+            if (m_RecordStore.IsRemoved(dwRow))
+                continue;
 
-            if (pValue->FileAttributes & FILE_ATTRIBUTE_DIRECTORY && !bWalkDirs)
-            {
-                ++iter;
+            const bool bIsDirectory = (m_RecordStore.FileAttributes(dwRow) & FILE_ATTRIBUTE_DIRECTORY) != 0;
+            if (bIsDirectory && !bWalkDirs)
                 continue;
-            }
+
+            USN_RECORD* pValue = m_RecordStore.GetRecord(dwRow, record);
 
             bool bInSpecificLocation = false;
             WCHAR* pFullName = GetFullNameAndIfInLocation(pValue, NULL, &bInSpecificLocation);
@@ -198,16 +190,11 @@ HRESULT USNJournalWalker::WalkRecords(const Callbacks& pCallbacks, bool bWalkDir
                 m_dwWalkedItems++;
             }
 
-            if (!(pValue->FileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-            {
-                m_USNMap.erase(iter++);
-                m_RecordStore.FreeCell(pValue);
-            }
-            else
-            {
-                ++iter;
-            }
-        } while (iter != m_USNMap.end());
+            if (!bIsDirectory)
+                m_RecordStore.Remove(pValue->FileReferenceNumber);
+        }
+
+        m_RecordStore.Compact();
     }
     return S_OK;
 }
@@ -258,26 +245,8 @@ HRESULT USNJournalWalker::EnumJournal(const IUSNJournalWalker::Callbacks& pCallb
             // parse all of the entries we just got
             while ((__int64)nextUSNRecord < (__int64)((PUCHAR)pOutBuffer + numBytesReturned))
             {
-                LPBYTE pElt = (LPBYTE)m_RecordStore.GetNewCell();
-
-                if (pElt == NULL)
-                {
-                    // We walk through FILES for our alerady recorded nodes with hope this will free some space
-                    WalkRecords(pCallbacks, false);
-                    pElt = (LPBYTE)m_RecordStore.GetNewCell();
-                    if (pElt == NULL)
-                    {
-                        /// We are still unable to move forward...
-                        return E_OUTOFMEMORY;
-                    }
-                }
-
-                memset(pElt, 0, m_dwRecordMaxSize);
-                memcpy_s(pElt, m_dwRecordMaxSize, nextUSNRecord, nextUSNRecord->RecordLength);
-
-                _ASSERT(m_USNMap.find(nextUSNRecord->FileReferenceNumber) == m_USNMap.end());
-                m_USNMap.insert(
-                    std::pair<DWORDLONG, USN_RECORD*>(nextUSNRecord->FileReferenceNumber, (USN_RECORD*)pElt));
+                _ASSERT(m_RecordStore.Find(nextUSNRecord->FileReferenceNumber) == USNRecordStore::kNoRow);
+                m_RecordStore.Add(*nextUSNRecord);
 
                 nextUSNRecord = (USN_RECORD*)((BYTE*)nextUSNRecord + nextUSNRecord->RecordLength);
             }
@@ -365,7 +334,7 @@ HRESULT USNJournalWalker::ReadJournal(const IUSNJournalWalker::Callbacks& pCallb
 
                         if (!(nextUSNRecord->FileAttributes & FILE_ATTRIBUTE_DIRECTORY))
                         {
-                            m_USNMap.erase(nextUSNRecord->FileReferenceNumber);
+                            m_RecordStore.Remove(nextUSNRecord->FileReferenceNumber);
                         }
                         m_dwWalkedItems++;
                     }
@@ -13,236 +13,93 @@
 using namespace Orc;
 
 USNJournalWalkerBase::USNJournalWalkerBase()
-    : m_RecordStore(L"USNRecordStore")
 {
     m_dwlRootUSN = 0;
     m_cchMaxComponentLength = 0;
-    m_dwRecordMaxSize = 0;
 
     m_dwWalkedItems = 0;
-
-    m_pFullNameBuffer = NULL;
-    m_cbFullNameBufferLen = 0L;
-}
-
-USNJournalWalkerBase::~USNJournalWalkerBase()
-{
-    if (m_pFullNameBuffer)
-        HeapFree(GetProcessHeap(), 0L, m_pFullNameBuffer);
 }
 
-const USNJournalWalkerBase::USN_MAP& USNJournalWalkerBase::GetUSNMap()
-{
-    return m_USNMap;
-}
-
-HRESULT USNJournalWalkerBase::ExtendNameBuffer(WCHAR** pCurrent)
-{
-    WCHAR* pNewBuf = NULL;
-
-    pNewBuf =
-        (WCHAR*)HeapAlloc(GetProcessHeap(), 0L, m_cbFullNameBufferLen + (m_cchMaxComponentLength * sizeof(WCHAR)));
-    if (!pNewBuf)
-        return E_OUTOFMEMORY;
-
-    if (m_pFullNameBuffer)
-    {
-#ifdef DEBUG
-        wmemset(pNewBuf, L'#', (m_cbFullNameBufferLen + (m_cchMaxComponentLength * sizeof(WCHAR))) / sizeof(WCHAR));
-        pNewBuf[(m_cbFullNameBufferLen + (m_cchMaxComponentLength * sizeof(WCHAR))) / sizeof(WCHAR) - 1] = 0;
-#endif
-        wmemcpy_s(
-            pNewBuf + m_cchMaxComponentLength - 1,
-            m_cbFullNameBufferLen / sizeof(WCHAR) + m_cchMaxComponentLength,
-            m_pFullNameBuffer,
-            m_cbFullNameBufferLen / sizeof(WCHAR));
-    }
-
-    if (pCurrent)
-    {
-        DWORD dwIndex = (DWORD)(*pCurrent - m_pFullNameBuffer);
-
-        *pCurrent = pNewBuf + (m_cchMaxComponentLength)-1;
-        *pCurrent += dwIndex;
-        _ASSERT(
-            *pCurrent
-            <= (pNewBuf + (m_cbFullNameBufferLen + (m_cchMaxComponentLength * sizeof(WCHAR))) / sizeof(WCHAR)));
-    }
-
-    if (m_pFullNameBuffer)
-        HeapFree(GetProcessHeap(), 0L, m_pFullNameBuffer);
-
-    m_pFullNameBuffer = pNewBuf;
-    m_cbFullNameBufferLen += m_cchMaxComponentLength * sizeof(WCHAR);
-
-    return S_OK;
-}
+USNJournalWalkerBase::~USNJournalWalkerBase() {}
 
-WCHAR* USNJournalWalkerBase::GetFullNameAndIfInLocation(USN_RECORD* pElt, DWORD* pdwLen, bool* pbInSpecificLocation)
+std::wstring_view USNJournalWalkerBase::GetParentPath(DWORDLONG dwlParentFileReferenceNumber, bool& bInSpecificLocation)
 {
-    using namespace msl::utilities;
+    // Walk up to the first parent with a memoized path, or not in the store (or already walked, in a loop)
+    m_Unresolved.clear();
 
-    WCHAR* pCurrent = NULL;
+    std::wstring_view path;
+    bool bMemoized = false;
 
-    if (pbInSpecificLocation)
+    DWORDLONG dwlRefNumber = dwlParentFileReferenceNumber;
+    for (;;)
     {
-        *pbInSpecificLocation = false;
+        const DWORD dwRow = m_RecordStore.Find(dwlRefNumber);
+        if (dwRow == USNRecordStore::kNoRow
+            || std::find(begin(m_Unresolved), end(m_Unresolved), dwRow) != end(m_Unresolved))
+            break;
 
-        if (m_LocationsRefNum.empty())
-            *pbInSpecificLocation = true;
-    }
+        if (m_RecordStore.GetPath(dwRow, path, bInSpecificLocation))
+        {
+            bMemoized = true;
+            break;
+        }
 
-    if (m_pFullNameBuffer == NULL)
-    {
-        if (m_cbFullNameBufferLen == 0)
-            m_cbFullNameBufferLen = m_cchMaxComponentLength * 2;
-        m_pFullNameBuffer = (WCHAR*)HeapAlloc(GetProcessHeap(), 0L, SafeInt<USHORT>(m_cchMaxComponentLength) * 2);
-        if (!m_pFullNameBuffer)
-            return NULL;
+        m_Unresolved.push_back(dwRow);
+        dwlRefNumber = m_RecordStore.ParentFileReferenceNumber(dwRow);
     }
-#ifdef DEBUG
-    wmemset(m_pFullNameBuffer, L'_', m_cchMaxComponentLength / sizeof(WCHAR));
-    m_pFullNameBuffer[m_cchMaxComponentLength / sizeof(WCHAR) - 1] = 0;
-#endif
-
-    DWORD dwCount = 0;
-    auto pParentPair = m_USNMap.find(pElt->ParentFileReferenceNumber);
 
-    DWORDLONG dwlLastParentRefNumber = 0;
-
-    if (dwCount > m_cbFullNameBufferLen)
+    if (bMemoized)
     {
-        if (FAILED(ExtendNameBuffer(&pCurrent)))
-            return NULL;
+        if (m_Unresolved.empty())
+            return path;
+        m_ParentPath.assign(path);
     }
-
+    else
     {
-        dwCount += sizeof(WCHAR);
-        if (dwCount > m_cbFullNameBufferLen)
+        if (dwlRefNumber == m_dwlRootUSN)
         {
-            if (FAILED(ExtendNameBuffer(&pCurrent)))
-                return NULL;
+            m_ParentPath.assign(m_VolReader->ShortVolumeName());
         }
-        pCurrent = m_pFullNameBuffer + (m_cbFullNameBufferLen / sizeof(WCHAR)) - 1;
-        *pCurrent = 0;
-    }
-    {
-        dwCount += pElt->FileNameLength;
-        if (dwCount > m_cbFullNameBufferLen)
+        else
         {
-            if (FAILED(ExtendNameBuffer(&pCurrent)))
-                return NULL;
+            // Parent folder was _not_ found, inserting "place holder"
+            m_ParentPath.assign(fmt::format(L"\\__{:016X}__\\", dwlRefNumber));
         }
-        pCurrent -= pElt->FileNameLength / sizeof(WCHAR);
-        memcpy_s(pCurrent, dwCount, pElt->FileName, pElt->FileNameLength);
+        bInSpecificLocation = IsLocation(dwlRefNumber);
     }
 
-    if (pbInSpecificLocation)
-        if (!*pbInSpecificLocation)
-        {
-            *pbInSpecificLocation =
-                (m_LocationsRefNum.find(pElt->FileReferenceNumber) != m_LocationsRefNum.end()) ? true : false;
-            if (!*pbInSpecificLocation)
-                *pbInSpecificLocation =
-                    (m_LocationsRefNum.find(pElt->ParentFileReferenceNumber) != m_LocationsRefNum.end()) ? true : false;
-        }
-
-    dwlLastParentRefNumber = pElt->ParentFileReferenceNumber;
-    while (pParentPair != m_USNMap.end())
+    for (auto it = rbegin(m_Unresolved); it != rend(m_Unresolved); ++it)
     {
-        {
-            dwCount += sizeof(WCHAR);
-            if (dwCount > m_cbFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            pCurrent--;
-            *pCurrent = L'\\';
-        }
-        {
-            dwCount += pParentPair->second->FileNameLength;
-            if (dwCount > m_cbFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            pCurrent -= pParentPair->second->FileNameLength / sizeof(WCHAR);
-            memcpy_s(pCurrent, dwCount, pParentPair->second->FileName, pParentPair->second->FileNameLength);
-        }
-        dwlLastParentRefNumber = pParentPair->second->ParentFileReferenceNumber;
-        pParentPair = m_USNMap.find(pParentPair->second->ParentFileReferenceNumber);
+        const DWORD dwRow = *it;
 
-        if (pbInSpecificLocation)
-            if (!*pbInSpecificLocation)
-                *pbInSpecificLocation =
-                    (m_LocationsRefNum.find(dwlLastParentRefNumber) != m_LocationsRefNum.end()) ? true : false;
-    }
-    if (dwlLastParentRefNumber == m_dwlRootUSN)
-    {
-        DWORD dwVolLen = (DWORD)wcslen(m_VolReader->ShortVolumeName());
-        dwCount += dwVolLen * sizeof(WCHAR);
-        if (dwCount > m_cbFullNameBufferLen)
-        {
-            if (FAILED(ExtendNameBuffer(&pCurrent)))
-                return NULL;
-        }
-        pCurrent -= dwVolLen;
-        memcpy_s(pCurrent, dwCount, m_VolReader->ShortVolumeName(), dwVolLen * sizeof(WCHAR));
+        m_ParentPath.append(m_RecordStore.FileName(dwRow));
+        m_ParentPath.push_back(L'\\');
+        bInSpecificLocation = bInSpecificLocation || IsLocation(m_RecordStore.FileReferenceNumber(dwRow));
 
-        if (pdwLen)
-            *pdwLen = dwCount;
-        return pCurrent;
+        m_RecordStore.SetPath(dwRow, m_ParentPath, bInSpecificLocation);
     }
-    else
-    {
-        // Parent folder was _not_ found, inserting "place holder"
-        // Adding \\ (i.e. one backslash)
 
-        {
-            dwCount += sizeof(WCHAR);
-            if (dwCount > m_cbFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            _ASSERT(dwCount <= m_cbFullNameBufferLen);
-
-            pCurrent--;
-            _ASSERT(pCurrent >= m_pFullNameBuffer);
-            *pCurrent = L'\\';
-        }
+    return m_ParentPath;
+}
 
-        {
-            dwCount += sizeof(WCHAR) * 20;
-            if (dwCount > m_cbFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            _ASSERT(dwCount <= m_cbFullNameBufferLen);
-
-            pCurrent -= 20;
-            swprintf_s(pCurrent, 21, L"__%.16I64X__", dwlLastParentRefNumber);
-            pCurrent[20] = L'\\';
-        }
+WCHAR* USNJournalWalkerBase::GetFullNameAndIfInLocation(USN_RECORD* pElt, DWORD* pdwLen, bool* pbInSpecificLocation)
+{
+    bool bParentInLocation = false;
+    const auto parentPath = GetParentPath(pElt->ParentFileReferenceNumber, bParentInLocation);
+    const std::wstring_view fileName(pElt->FileName, pElt->FileNameLength / sizeof(WCHAR));
 
-        {
-            dwCount += sizeof(WCHAR);
-            if (dwCount > m_cbFullNameBufferLen)
-            {
-                if (FAILED(ExtendNameBuffer(&pCurrent)))
-                    return NULL;
-            }
-            _ASSERT(dwCount <= m_cbFullNameBufferLen);
-
-            pCurrent--;
-            _ASSERT(pCurrent >= m_pFullNameBuffer);
-            *pCurrent = L'\\';
-        }
+    m_FullName.assign(begin(parentPath), end(parentPath));
+    m_FullName.insert(end(m_FullName), begin(fileName), end(fileName));
+    m_FullName.push_back(L'\0');
 
-        if (pdwLen)
-            *pdwLen = dwCount;
-        return pCurrent;
+    if (pbInSpecificLocation)
+    {
+        *pbInSpecificLocation =
+            m_LocationsRefNum.empty() || bParentInLocation || IsLocation(pElt->FileReferenceNumber);
     }
+
+    if (pdwLen)
+        *pdwLen = static_cast<DWORD>(m_FullName.size() * sizeof(WCHAR));
+
+    return m_FullName.data();
 }
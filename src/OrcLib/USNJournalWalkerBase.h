@@ -9,23 +9,22 @@
 #pragma once
 
 #include "LocationSet.h"
-#include "HeapStorage.h"
+#include "USNRecordStore.h"
 
 #include "IUSNJournalWalker.h"
 
 #include "Windows.h"
 
 #include <memory>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #pragma managed(push, off)
 
 namespace Orc {
 class MountedVolumeReader;
 
-// Number of items in the VirtualStore
-constexpr auto USN_MAX_NUMBER = (0x80000);
-
 class ORCLIB_API USNJournalWalkerBase
 {
 public:
@@ -70,29 +69,38 @@ public:
     };
     using PUSN_RECORD_V3 = USN_RECORD_V3*;
 
-    using USN_MAP = std::map<DWORDLONG, USN_RECORD*>;
-    const USN_MAP& GetUSNMap();
+    const USNRecordStore& GetRecordStore() const { return m_RecordStore; }
 
-    HRESULT ExtendNameBuffer(WCHAR** pCurrent);
+    // Full name of the record, valid until the next call (pdwLen receives its size in bytes, with the terminating null)
     WCHAR* GetFullNameAndIfInLocation(USN_RECORD* pElt, DWORD* pdwLen, bool* pbInSpecificLocation);
 
 protected:
-    HeapStorage m_RecordStore;
-    USN_MAP m_USNMap;
+    // Directories (and, online, the records enumerated from the MFT) to resolve the parents of the journal records
+    USNRecordStore m_RecordStore;
 
     std::unordered_set<DWORDLONG> m_LocationsRefNum;
 
     DWORDLONG m_dwlRootUSN;
 
     DWORD m_cchMaxComponentLength;
-    DWORD m_dwRecordMaxSize;
 
     std::shared_ptr<VolumeReader> m_VolReader;
 
     DWORD m_dwWalkedItems;
 
-    WCHAR* m_pFullNameBuffer;
-    DWORD m_cbFullNameBufferLen;
+private:
+    std::vector<WCHAR> m_FullName;
+    std::wstring m_ParentPath;
+    std::vector<DWORD> m_Unresolved;
+
+    bool IsLocation(DWORDLONG dwlFileReferenceNumber) const
+    {
+        return m_LocationsRefNum.find(dwlFileReferenceNumber) != m_LocationsRefNum.end();
+    }
+
+    // Path of the children of a directory (with the trailing backslash) and if it is in a location, valid until the
+    // next call. Paths of the directories found in the store are memoized there.
+    std::wstring_view GetParentPath(DWORDLONG dwlParentFileReferenceNumber, bool& bInSpecificLocation);
 
 };  // USNJournalWalkerBase
 }  // namespace Orc
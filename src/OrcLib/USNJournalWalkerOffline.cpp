@@ -12,9 +12,12 @@
 #include "MountedVolumeReader.h"
 
 #include "MFTWalker.h"
+#include "NTFSStream.h"
 
 #include <cmath>
 
+#include <ppl.h>
+
 #include <boost/scope_exit.hpp>
 
 using namespace Orc;
@@ -23,12 +26,155 @@ static const auto ROOT_USN = 0x0005000000000005LL;
 
 DWORD USNJournalWalkerOffline::m_BufferSize = 0x10000;
 
+namespace {
+
+using USN_RECORD_V2 = USNJournalWalkerBase::USN_RECORD_V2;
+using USN_RECORD_V3 = USNJournalWalkerBase::USN_RECORD_V3;
+
+constexpr ULONG kRecordAlignment = 8;
+constexpr ULONG kV2NameOffset = offsetof(USN_RECORD_V2, FileName);
+constexpr ULONG kV3NameOffset = offsetof(USN_RECORD_V3, FileName);
+
+// Largest record: a V3 header and a 255 characters name
+constexpr ULONG kMaxRecordSize = (kV3NameOffset + 255 * sizeof(WCHAR) + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+
+ULONG AlignRecord(ULONG ulSize)
+{
+    return (ulSize + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+// Strict enough to resynchronize on: a record is 8 bytes aligned and its size is that of its header and name
+bool IsUSNRecord(const BYTE* pRecord, size_t cbAvailable)
+{
+    if (cbAvailable < kV2NameOffset)
+        return false;
+
+    const auto pV2 = reinterpret_cast<const USN_RECORD_V2*>(pRecord);
+    if (pV2->RecordLength > cbAvailable || pV2->MinorVersion != 0 || pV2->FileNameLength == 0
+        || pV2->FileNameLength % sizeof(WCHAR) != 0)
+        return false;
+
+    switch (pV2->MajorVersion)
+    {
+        case 2:
+            return pV2->FileNameOffset == kV2NameOffset
+                && pV2->RecordLength == AlignRecord(kV2NameOffset + pV2->FileNameLength);
+        case 3: {
+            if (cbAvailable < kV3NameOffset)
+                return false;
+            const auto pV3 = reinterpret_cast<const USN_RECORD_V3*>(pRecord);
+            return pV3->FileNameOffset == kV3NameOffset
+                && pV3->RecordLength == AlignRecord(kV3NameOffset + pV3->FileNameLength);
+        }
+        default:
+            return false;
+    }
+}
+
+// NTFS file references fit in 64 bits: V3 records are handed to the callbacks as the V2 records they expect
+bool ConvertToV2(const USN_RECORD_V3& v3, CBinaryBuffer& buffer)
+{
+    const auto IsNarrow = [](const BYTE reference[16]) {
+        return std::all_of(reference + sizeof(DWORDLONG), reference + 16, [](BYTE b) { return b == 0; });
+    };
+    if (!IsNarrow(v3.FileReferenceNumber) || !IsNarrow(v3.ParentFileReferenceNumber))
+        return false;
+
+    const ULONG cbRecord = AlignRecord(kV2NameOffset + v3.FileNameLength);
+    if (!buffer.SetCount(cbRecord))
+        return false;
+    ZeroMemory(buffer.GetData(), cbRecord);
+
+    auto pV2 = reinterpret_cast<USN_RECORD_V2*>(buffer.GetData());
+    pV2->RecordLength = cbRecord;
+    pV2->MajorVersion = 2;
+    pV2->MinorVersion = 0;
+    CopyMemory(&pV2->FileReferenceNumber, v3.FileReferenceNumber, sizeof(DWORDLONG));
+    CopyMemory(&pV2->ParentFileReferenceNumber, v3.ParentFileReferenceNumber, sizeof(DWORDLONG));
+    pV2->Usn = v3.Usn;
+    pV2->TimeStamp = v3.TimeStamp;
+    pV2->Reason = v3.Reason;
+    pV2->SourceInfo = v3.SourceInfo;
+    pV2->SecurityId = v3.SecurityId;
+    pV2->FileAttributes = v3.FileAttributes;
+    pV2->FileNameLength = v3.FileNameLength;
+    pV2->FileNameOffset = static_cast<WORD>(kV2NameOffset);
+    CopyMemory(pV2->FileName, reinterpret_cast<const BYTE*>(&v3) + v3.FileNameOffset, v3.FileNameLength);
+    return true;
+}
+
+// Allocated ranges of the journal: the sparse ranges of $J (most of it) are only zeroes
+std::vector<std::pair<ULONGLONG, ULONGLONG>> AllocatedRanges(const std::shared_ptr<ByteStream>& journal)
+{
+    const ULONGLONG ullSize = journal->GetSize();
+
+    std::vector<std::pair<ULONGLONG, ULONGLONG>> ranges;
+
+    const auto ntfsStream = std::dynamic_pointer_cast<NTFSStream>(journal);
+    if (ntfsStream == nullptr)
+    {
+        if (ullSize > 0)
+            ranges.emplace_back(0LL, ullSize);
+        return ranges;
+    }
+
+    for (const auto& segment : ntfsStream->DataSegments())
+    {
+        if (segment.bUnallocated || !segment.bValidData || segment.ullFileBasedOffset >= ullSize)
+            continue;
+
+        const ULONGLONG ullEnd = std::min(segment.ullFileBasedOffset + segment.ullSize, ullSize);
+        if (!ranges.empty() && ranges.back().second == segment.ullFileBasedOffset)
+            ranges.back().second = ullEnd;
+        else
+            ranges.emplace_back(segment.ullFileBasedOffset, ullEnd);
+    }
+    return ranges;
+}
+
+class JournalChunk
+{
+public:
+    ULONGLONG ullOffset = 0LL;  // in the journal
+    ULONG cbParse = 0L;  // records starting in the chunk, the data completes the last one
+    bool bContinued = false;  // follows the previous chunk in an allocated range
+    ULONG cbToRead = 0L;
+    CBinaryBuffer Data;
+    ULONG cbData = 0L;
+    std::vector<ULONG> Records;
+    ULONG ulNext = 0L;
+};
+
+HRESULT ReadChunk(ByteStream& journal, JournalChunk& chunk)
+{
+    HRESULT hr = E_FAIL;
+
+    if (!chunk.Data.SetCount(chunk.cbToRead))
+        return E_OUTOFMEMORY;
+
+    if (FAILED(hr = journal.SetFilePointer(chunk.ullOffset, FILE_BEGIN, NULL)))
+        return hr;
+
+    chunk.cbData = 0L;
+    while (chunk.cbData < chunk.cbToRead)
+    {
+        ULONGLONG ullRead = 0LL;
+        if (FAILED(hr = journal.Read(chunk.Data.GetData() + chunk.cbData, chunk.cbToRead - chunk.cbData, &ullRead)))
+            return hr;
+        if (ullRead == 0LL)
+            break;
+        chunk.cbData += static_cast<ULONG>(ullRead);
+    }
+    return S_OK;
+}
+
+}  // namespace
+
 USNJournalWalkerOffline::USNJournalWalkerOffline()
     : m_Locations()
 {
     m_dwlRootUSN = ROOT_USN;
     m_cchMaxComponentLength = 255;
-    m_dwRecordMaxSize = (m_cchMaxComponentLength * sizeof(WCHAR) + sizeof(USN_RECORD) - sizeof(WCHAR)) + sizeof(DWORD);
 }
 
 USNJournalWalkerOffline::~USNJournalWalkerOffline() {}
@@ -90,11 +236,6 @@ HRESULT USNJournalWalkerOffline::Initialize(const std::shared_ptr<Location>& loc
         Log::Error("Failed to parse location while searching for USN journal");
     }
 
-    if (FAILED(hr = m_RecordStore.InitializeStore(USN_MAX_NUMBER, m_dwRecordMaxSize)))
-    {
-        return hr;
-    }
-
     return S_OK;
 }
 
@@ -122,34 +263,16 @@ HRESULT USNJournalWalkerOffline::EnumJournal(const IUSNJournalWalker::Callbacks&
                                       MFTRecord* pElt,
                                       const PFILE_NAME pFileName,
                                       const std::shared_ptr<IndexAllocationAttribute>& pAttr) {
-        LPBYTE pUSNRecord = (LPBYTE)m_RecordStore.GetNewCell();
+        LARGE_INTEGER* pLI = (LARGE_INTEGER*)&pElt->GetFileReferenceNumber();
+        DWORDLONG frn = (DWORDLONG)pLI->QuadPart;
 
-        if (pUSNRecord != nullptr)
+        // we don't add the root folder and the records with filenames that use the 8.3 format only
+        if (frn != ROOT_USN && pFileName->Flags != FILE_NAME_DOS83)
         {
-            LARGE_INTEGER* pLI = (LARGE_INTEGER*)&pElt->GetFileReferenceNumber();
-            DWORDLONG frn = (DWORDLONG)pLI->QuadPart;
-
-            // we don't add the root folder and the records with filenames that use the 8.3 format only
-            if (frn != ROOT_USN && pFileName->Flags != FILE_NAME_DOS83)
-            {
-                WCHAR* fileName = (WCHAR*)&(pFileName->FileName);
-                DWORD fileNameLength = (DWORD)pFileName->FileNameLength * sizeof(WCHAR);
-
-                USN_RECORD record;
-                FillUSNRecord(record, pElt, pFileName);
+            USN_RECORD record;
+            FillUSNRecord(record, pElt, pFileName);
 
-                memset(pUSNRecord, 0, m_dwRecordMaxSize);
-                memcpy_s(pUSNRecord, m_dwRecordMaxSize, &record, record.RecordLength - fileNameLength);
-                memcpy_s(
-                    pUSNRecord + ((__int64)&record.FileName - (__int64)&record),
-                    m_dwRecordMaxSize,
-                    fileName,
-                    fileNameLength);
-
-                m_USNMap.insert(std::pair<DWORDLONG, USN_RECORD*>(record.FileReferenceNumber, (USN_RECORD*)pUSNRecord));
-            }
-            else
-                m_RecordStore.FreeCell(pUSNRecord);
+            m_RecordStore.Add(record, std::wstring_view(pFileName->FileName, pFileName->FileNameLength));
         }
     };
 
@@ -166,6 +289,10 @@ HRESULT USNJournalWalkerOffline::EnumJournal(const IUSNJournalWalker::Callbacks&
         return hr;
     }
 
+    Log::Debug(
+        L"Stored {} directories for USN records ({} bytes)",
+        m_RecordStore.GetRowCount(),
+        m_RecordStore.GetMemoryUsage());
     return S_OK;
 }
 
@@ -173,6 +300,9 @@ HRESULT USNJournalWalkerOffline::ReadJournal(const IUSNJournalWalker::Callbacks&
 {
     HRESULT hr = E_FAIL;
 
+    if (m_USNJournal && m_dwChunkSize > 0)
+        return ReadJournalChunks(pCallbacks);
+
     if (m_USNJournal)
     {
         ULONGLONG numBytesReturned = 0;
@@ -264,6 +394,147 @@ HRESULT USNJournalWalkerOffline::ReadJournal(const IUSNJournalWalker::Callbacks&
     return hr;
 }
 
+HRESULT USNJournalWalkerOffline::ReadJournalChunks(const IUSNJournalWalker::Callbacks& pCallbacks)
+{
+    HRESULT hr = E_FAIL;
+
+    if (S_OK != m_USNJournal->CanRead())
+        return S_OK;
+
+    const auto ranges = AllocatedRanges(m_USNJournal);
+
+    // a batch of chunks is read, parsed in parallel then its records are handed to the callbacks in order
+    const size_t batchSize = std::max<size_t>(2 * concurrency::GetProcessorCount(), 2);
+    std::vector<JournalChunk> batch(batchSize);
+    size_t chunks = 0;
+
+    CBinaryBuffer converted;
+    ULONGLONG ullExpected = 0LL;  // where the records following the previous chunk start
+
+    const auto ProcessBatch = [&]() -> HRESULT {
+        for (size_t i = 0; i < chunks; i++)
+        {
+            if (FAILED(hr = ReadChunk(*m_USNJournal, batch[i])))
+            {
+                Log::Error(L"Failed to read USN journal at offset {:#x} [{}]", batch[i].ullOffset, SystemError(hr));
+                return hr;
+            }
+        }
+
+        concurrency::parallel_for(size_t(0), chunks, [&batch](size_t i) {
+            auto& chunk = batch[i];
+            chunk.Records.clear();
+            chunk.ulNext = ParseUSNRecords(chunk.Data.GetData(), chunk.cbData, chunk.cbParse, 0L, chunk.Records);
+        });
+
+        for (size_t i = 0; i < chunks; i++)
+        {
+            auto& chunk = batch[i];
+
+            if (chunk.bContinued && ullExpected > chunk.ullOffset)
+            {
+                // a record of the previous chunk ends in this one: records found before its end were false headers
+                const ULONG ulFrom =
+                    static_cast<ULONG>(std::min<ULONGLONG>(ullExpected - chunk.ullOffset, chunk.cbParse));
+                auto first = std::lower_bound(begin(chunk.Records), end(chunk.Records), ulFrom);
+                if (first != end(chunk.Records) && *first == ulFrom)
+                {
+                    chunk.Records.erase(begin(chunk.Records), first);
+                }
+                else
+                {
+                    chunk.Records.clear();
+                    chunk.ulNext =
+                        ParseUSNRecords(chunk.Data.GetData(), chunk.cbData, chunk.cbParse, ulFrom, chunk.Records);
+                }
+            }
+
+            for (const auto ulRecord : chunk.Records)
+            {
+                auto pRecord = reinterpret_cast<USN_RECORD*>(chunk.Data.GetData() + ulRecord);
+                if (pRecord->MajorVersion == 3)
+                {
+                    if (!ConvertToV2(*reinterpret_cast<const USN_RECORD_V3*>(pRecord), converted))
+                    {
+                        Log::Debug(
+                            L"Skipping USN record with 128 bits file references at {:#x}",
+                            chunk.ullOffset + ulRecord);
+                        continue;
+                    }
+                    pRecord = reinterpret_cast<USN_RECORD*>(converted.GetData());
+                }
+
+                bool bInSpecificLocation = false;
+                WCHAR* pFullName = GetFullNameAndIfInLocation(pRecord, NULL, &bInSpecificLocation);
+
+                if (pFullName && bInSpecificLocation)
+                {
+                    pCallbacks.RecordCallback(m_VolReader, pFullName, pRecord);
+                    m_dwWalkedItems++;
+                }
+            }
+
+            ullExpected = chunk.ullOffset + chunk.ulNext;
+        }
+
+        chunks = 0;
+        return S_OK;
+    };
+
+    for (const auto& [ullStart, ullEnd] : ranges)
+    {
+        for (ULONGLONG ullOffset = ullStart; ullOffset < ullEnd; ullOffset += m_dwChunkSize)
+        {
+            auto& chunk = batch[chunks++];
+            chunk.ullOffset = ullOffset;
+            chunk.cbParse = static_cast<ULONG>(std::min<ULONGLONG>(m_dwChunkSize, ullEnd - ullOffset));
+            chunk.bContinued = ullOffset != ullStart;
+            // records do not cross into a sparse range
+            chunk.cbToRead =
+                static_cast<ULONG>(std::min<ULONGLONG>(chunk.cbParse + kMaxRecordSize, ullEnd - ullOffset));
+
+            if (chunks == batch.size())
+            {
+                if (FAILED(hr = ProcessBatch()))
+                    return hr;
+            }
+        }
+    }
+
+    if (FAILED(hr = ProcessBatch()))
+        return hr;
+
+    return S_OK;
+}
+
+ULONG USNJournalWalkerOffline::ParseUSNRecords(
+    const BYTE* pChunk,
+    ULONG cbChunk,
+    ULONG cbParse,
+    ULONG ulFrom,
+    std::vector<ULONG>& records)
+{
+    // ulFrom may come from a corrupted record length: it is kept within the chunk before aligning it
+    ULONG ulOffset = AlignRecord(std::min(ulFrom, cbChunk));
+
+    while (ulOffset < cbParse && ulOffset + sizeof(DWORD) <= cbChunk)
+    {
+        const DWORD dwRecordLength = *reinterpret_cast<const DWORD*>(pChunk + ulOffset);
+
+        if (dwRecordLength != 0 && IsUSNRecord(pChunk + ulOffset, cbChunk - ulOffset))
+        {
+            records.push_back(ulOffset);
+            ulOffset += dwRecordLength;
+        }
+        else
+        {
+            // zeroes up to the next page, the end of a record cut by the start of the chunk or invalid data
+            ulOffset += kRecordAlignment;
+        }
+    }
+    return ulOffset;
+}
+
 void USNJournalWalkerOffline::FillUSNRecord(USN_RECORD& record, MFTRecord* pElt, const PFILE_NAME pFileName)
 {
     DWORD fileNameLength = (DWORD)pFileName->FileNameLength * sizeof(WCHAR);
@@ -365,3 +636,11 @@ void USNJournalWalkerOffline::SetBufferSize(DWORD size)
 {
     m_BufferSize = size;
 }
+
+void USNJournalWalkerOffline::SetChunkSize(DWORD dwChunkSize)
+{
+    if (dwChunkSize == 0L)
+        m_dwChunkSize = 0L;
+    else
+        m_dwChunkSize = AlignRecord(std::max(dwChunkSize, kMinChunkSize));
+}
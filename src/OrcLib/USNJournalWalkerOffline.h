@@ -14,6 +14,8 @@
 
 #include "winioctl.h"
 
+#include <vector>
+
 #pragma managed(push, off)
 
 namespace Orc {
@@ -48,15 +50,32 @@ public:
         ULONG64& adjustmentOffset,
         bool& shouldStop);
 
+    // Offsets of the records (V2 or V3) starting before cbParse in a chunk of cbChunk bytes of the journal (the bytes
+    // past cbParse complete the last record). Parsing starts at ulFrom and resynchronizes on the next valid header
+    // after zeroes or invalid data. Returns the offset where the records of the next chunk start.
+    static ULONG
+    ParseUSNRecords(const BYTE* pChunk, ULONG cbChunk, ULONG cbParse, ULONG ulFrom, std::vector<ULONG>& records);
+
     static DWORD GetBufferSize();
     static void SetBufferSize(DWORD size);
 
+    static constexpr DWORD kMinChunkSize = 0x10000;
+    static constexpr DWORD kDefaultChunkSize = 0x100000;
+
+    // Size of the chunks of the allocated ranges of the journal parsed in parallel by ReadJournal, 0 (the default)
+    // reads the whole journal sequentially
+    DWORD GetChunkSize() const { return m_dwChunkSize; }
+    void SetChunkSize(DWORD dwChunkSize);
+
 private:
     LocationSet m_Locations;
 
     std::shared_ptr<ByteStream> m_USNJournal;
+    DWORD m_dwChunkSize = 0L;
 
     static DWORD m_BufferSize;
+
+    HRESULT ReadJournalChunks(const IUSNJournalWalker::Callbacks& pCallbacks);
 };  // USNJournalWalkerOffline
 
 }  // namespace Orc
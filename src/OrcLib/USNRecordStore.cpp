@@ -0,0 +1,235 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "USNRecordStore.h"
+
+#include <functional>
+
+using namespace Orc;
+
+namespace {
+
+constexpr size_t kMinNameTableSize = 0x1000;
+
+}  // namespace
+
+DWORD& USNRecordStore::IndexOf(DWORDLONG dwlSegment)
+{
+    if (dwlSegment >= kMaxDenseSegment)
+        return m_SparseIndex.try_emplace(dwlSegment, kNoRow).first->second;
+
+    if (dwlSegment >= m_Index.size())
+        m_Index.resize(std::max(static_cast<size_t>(dwlSegment) + 1, m_Index.size() * 2), kNoRow);
+
+    return m_Index[static_cast<size_t>(dwlSegment)];
+}
+
+void USNRecordStore::GrowNameTable()
+{
+    std::vector<DWORD> table(std::max(m_NameTable.size() * 2, kMinNameTableSize), kNoName);
+    const size_t mask = table.size() - 1;
+
+    for (const auto dwOffset : m_NameTable)
+    {
+        if (dwOffset == kNoName)
+            continue;
+
+        const std::wstring_view name(m_Names.data() + dwOffset + 1, m_Names[dwOffset]);
+
+        size_t slot = std::hash<std::wstring_view>()(name) & mask;
+        while (table[slot] != kNoName)
+            slot = (slot + 1) & mask;
+        table[slot] = dwOffset;
+    }
+
+    m_NameTable = std::move(table);
+}
+
+DWORD USNRecordStore::InternName(std::wstring_view name)
+{
+    if ((m_NameCount + 1) * 2 > m_NameTable.size())
+        GrowNameTable();
+
+    const size_t mask = m_NameTable.size() - 1;
+    size_t slot = std::hash<std::wstring_view>()(name) & mask;
+
+    while (m_NameTable[slot] != kNoName)
+    {
+        const DWORD dwOffset = m_NameTable[slot];
+        if (std::wstring_view(m_Names.data() + dwOffset + 1, m_Names[dwOffset]) == name)
+            return dwOffset;
+        slot = (slot + 1) & mask;
+    }
+
+    const DWORD dwOffset = static_cast<DWORD>(m_Names.size());
+    m_Names.push_back(static_cast<WCHAR>(name.size()));
+    m_Names.insert(end(m_Names), begin(name), end(name));
+
+    m_NameTable[slot] = dwOffset;
+    m_NameCount++;
+    return dwOffset;
+}
+
+HRESULT USNRecordStore::Add(const USN_RECORD& record, std::wstring_view fileName)
+{
+    DWORD& dwRow = IndexOf(Segment(record.FileReferenceNumber));
+    if (dwRow != kNoRow)
+        return S_FALSE;
+
+    dwRow = GetRowCount();
+
+    m_FileReferenceNumbers.push_back(record.FileReferenceNumber);
+    m_ParentFileReferenceNumbers.push_back(record.ParentFileReferenceNumber);
+    m_Usns.push_back(record.Usn);
+    m_TimeStamps.push_back(record.TimeStamp.QuadPart);
+    m_Reasons.push_back(record.Reason);
+    m_FileAttributes.push_back(record.FileAttributes);
+    m_SecurityIds.push_back(record.SecurityId);
+    m_NameOffsets.push_back(InternName(fileName));
+    m_PathOffsets.push_back(kNoPath);
+    m_PathLengths.push_back(0L);
+    return S_OK;
+}
+
+DWORD USNRecordStore::Find(DWORDLONG dwlFileReferenceNumber) const
+{
+    const DWORDLONG dwlSegment = Segment(dwlFileReferenceNumber);
+
+    DWORD dwRow = kNoRow;
+    if (dwlSegment < m_Index.size())
+    {
+        dwRow = m_Index[static_cast<size_t>(dwlSegment)];
+    }
+    else if (dwlSegment >= kMaxDenseSegment)
+    {
+        if (auto it = m_SparseIndex.find(dwlSegment); it != end(m_SparseIndex))
+            dwRow = it->second;
+    }
+
+    if (dwRow == kNoRow || m_FileReferenceNumbers[dwRow] != dwlFileReferenceNumber)
+        return kNoRow;
+    return dwRow;
+}
+
+void USNRecordStore::Remove(DWORDLONG dwlFileReferenceNumber)
+{
+    if (Find(dwlFileReferenceNumber) == kNoRow)
+        return;
+
+    IndexOf(Segment(dwlFileReferenceNumber)) = kNoRow;
+}
+
+bool USNRecordStore::IsRemoved(DWORD dwRow) const
+{
+    return Find(m_FileReferenceNumbers[dwRow]) != dwRow;
+}
+
+void USNRecordStore::Compact()
+{
+    DWORD dwKept = 0L;
+    for (DWORD dwRow = 0L; dwRow < GetRowCount(); dwRow++)
+    {
+        if (IsRemoved(dwRow))
+            continue;
+
+        if (dwKept != dwRow)
+        {
+            m_FileReferenceNumbers[dwKept] = m_FileReferenceNumbers[dwRow];
+            m_ParentFileReferenceNumbers[dwKept] = m_ParentFileReferenceNumbers[dwRow];
+            m_Usns[dwKept] = m_Usns[dwRow];
+            m_TimeStamps[dwKept] = m_TimeStamps[dwRow];
+            m_Reasons[dwKept] = m_Reasons[dwRow];
+            m_FileAttributes[dwKept] = m_FileAttributes[dwRow];
+            m_SecurityIds[dwKept] = m_SecurityIds[dwRow];
+            m_NameOffsets[dwKept] = m_NameOffsets[dwRow];
+            m_PathOffsets[dwKept] = m_PathOffsets[dwRow];
+            m_PathLengths[dwKept] = m_PathLengths[dwRow];
+
+            IndexOf(Segment(m_FileReferenceNumbers[dwKept])) = dwKept;
+        }
+        dwKept++;
+    }
+
+    const auto Shrink = [dwKept](auto& column) {
+        column.resize(dwKept);
+        column.shrink_to_fit();
+    };
+
+    Shrink(m_FileReferenceNumbers);
+    Shrink(m_ParentFileReferenceNumbers);
+    Shrink(m_Usns);
+    Shrink(m_TimeStamps);
+    Shrink(m_Reasons);
+    Shrink(m_FileAttributes);
+    Shrink(m_SecurityIds);
+    Shrink(m_NameOffsets);
+    Shrink(m_PathOffsets);
+    Shrink(m_PathLengths);
+}
+
+void USNRecordStore::Clear()
+{
+    *this = USNRecordStore();
+}
+
+size_t USNRecordStore::GetMemoryUsage() const
+{
+    const auto Size = [](const auto& column) { return column.capacity() * sizeof(column[0]); };
+
+    return Size(m_FileReferenceNumbers) + Size(m_ParentFileReferenceNumbers) + Size(m_Usns) + Size(m_TimeStamps)
+        + Size(m_Reasons) + Size(m_FileAttributes) + Size(m_SecurityIds) + Size(m_NameOffsets) + Size(m_PathOffsets)
+        + Size(m_PathLengths) + Size(m_PathPool) + Size(m_Names) + Size(m_NameTable) + Size(m_Index)
+        + m_SparseIndex.size() * (sizeof(DWORDLONG) + sizeof(DWORD) + 2 * sizeof(void*));
+}
+
+std::wstring_view USNRecordStore::FileName(DWORD dwRow) const
+{
+    const DWORD dwOffset = m_NameOffsets[dwRow];
+    return std::wstring_view(m_Names.data() + dwOffset + 1, m_Names[dwOffset]);
+}
+
+USN_RECORD* USNRecordStore::GetRecord(DWORD dwRow, std::vector<BYTE>& buffer) const
+{
+    const auto name = FileName(dwRow);
+    const size_t cbName = name.size() * sizeof(WCHAR);
+    const size_t cbRecord = (offsetof(USN_RECORD, FileName) + cbName + sizeof(WCHAR) + 7) & ~(size_t)7;
+
+    buffer.assign(cbRecord, 0);
+
+    auto pRecord = reinterpret_cast<USN_RECORD*>(buffer.data());
+    pRecord->RecordLength = static_cast<DWORD>(cbRecord);
+    pRecord->MajorVersion = 2;
+    pRecord->MinorVersion = 0;
+    pRecord->FileReferenceNumber = m_FileReferenceNumbers[dwRow];
+    pRecord->ParentFileReferenceNumber = m_ParentFileReferenceNumbers[dwRow];
+    pRecord->Usn = m_Usns[dwRow];
+    pRecord->TimeStamp.QuadPart = m_TimeStamps[dwRow];
+    pRecord->Reason = m_Reasons[dwRow];
+    pRecord->FileAttributes = m_FileAttributes[dwRow];
+    pRecord->SecurityId = m_SecurityIds[dwRow];
+    pRecord->FileNameLength = static_cast<WORD>(cbName);
+    pRecord->FileNameOffset = static_cast<WORD>(offsetof(USN_RECORD, FileName));
+    std::copy(begin(name), end(name), pRecord->FileName);
+    return pRecord;
+}
+
+bool USNRecordStore::GetPath(DWORD dwRow, std::wstring_view& path, bool& bFlag) const
+{
+    if (m_PathOffsets[dwRow] == kNoPath)
+        return false;
+
+    path = std::wstring_view(m_PathPool.data() + m_PathOffsets[dwRow], m_PathLengths[dwRow] & ~kPathFlag);
+    bFlag = (m_PathLengths[dwRow] & kPathFlag) != 0;
+    return true;
+}
+
+void USNRecordStore::SetPath(DWORD dwRow, std::wstring_view path, bool bFlag)
+{
+    m_PathOffsets[dwRow] = static_cast<DWORD>(m_PathPool.size());
+    m_PathLengths[dwRow] = static_cast<DWORD>(path.size()) | (bFlag ? kPathFlag : 0L);
+    m_PathPool.insert(end(m_PathPool), begin(path), end(path));
+}
@@ -0,0 +1,104 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include "winioctl.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// In memory store of the USN records needed to resolve full names: one row per record, each field in its own column,
+// names interned in a single pool. Rows are indexed by the segment number of their file reference (one record per MFT
+// segment), the path of a row can be memoized once its parents are known.
+class ORCLIB_API USNRecordStore
+{
+public:
+    static constexpr DWORD kNoRow = (DWORD)-1;
+
+    USNRecordStore() = default;
+
+    // Adds a (V2) record, S_FALSE if a record is already stored for its segment
+    HRESULT Add(const USN_RECORD& record, std::wstring_view fileName);
+    HRESULT Add(const USN_RECORD& record)
+    {
+        return Add(record, std::wstring_view(record.FileName, record.FileNameLength / sizeof(WCHAR)));
+    }
+
+    // Row of the record with this file reference, kNoRow if none (or if the segment was reused)
+    DWORD Find(DWORDLONG dwlFileReferenceNumber) const;
+
+    // Row is not found anymore, its memory is released by Compact()
+    void Remove(DWORDLONG dwlFileReferenceNumber);
+    bool IsRemoved(DWORD dwRow) const;
+
+    // Drops the removed rows (memoized paths are kept)
+    void Compact();
+
+    void Clear();
+
+    DWORD GetRowCount() const { return static_cast<DWORD>(m_FileReferenceNumbers.size()); }
+    size_t GetMemoryUsage() const;
+
+    DWORDLONG FileReferenceNumber(DWORD dwRow) const { return m_FileReferenceNumbers[dwRow]; }
+    DWORDLONG ParentFileReferenceNumber(DWORD dwRow) const { return m_ParentFileReferenceNumbers[dwRow]; }
+    DWORD Reason(DWORD dwRow) const { return m_Reasons[dwRow]; }
+    LONGLONG TimeStamp(DWORD dwRow) const { return m_TimeStamps[dwRow]; }
+    DWORD FileAttributes(DWORD dwRow) const { return m_FileAttributes[dwRow]; }
+    std::wstring_view FileName(DWORD dwRow) const;
+
+    // Rebuilds the record of a row in 'buffer' (SourceInfo is not stored), valid until the next call with 'buffer'
+    USN_RECORD* GetRecord(DWORD dwRow, std::vector<BYTE>& buffer) const;
+
+    // Memoized path of a row (which stays valid until the next SetPath()), false if not memoized yet
+    bool GetPath(DWORD dwRow, std::wstring_view& path, bool& bFlag) const;
+    void SetPath(DWORD dwRow, std::wstring_view path, bool bFlag);
+
+private:
+    // Rows of segments beyond this are indexed in a map, not to size the index after a corrupted reference
+    static constexpr DWORDLONG kMaxDenseSegment = 0x4000000;
+    static constexpr DWORD kNoName = (DWORD)-1;
+    static constexpr DWORD kNoPath = (DWORD)-1;
+    static constexpr DWORD kPathFlag = 0x80000000;
+
+    static DWORDLONG Segment(DWORDLONG dwlFileReferenceNumber) { return dwlFileReferenceNumber & 0x0000FFFFFFFFFFFF; }
+
+    DWORD& IndexOf(DWORDLONG dwlSegment);
+    DWORD InternName(std::wstring_view name);
+    void GrowNameTable();
+
+    std::vector<DWORDLONG> m_FileReferenceNumbers;
+    std::vector<DWORDLONG> m_ParentFileReferenceNumbers;
+    std::vector<USN> m_Usns;
+    std::vector<LONGLONG> m_TimeStamps;
+    std::vector<DWORD> m_Reasons;
+    std::vector<DWORD> m_FileAttributes;
+    std::vector<DWORD> m_SecurityIds;
+    std::vector<DWORD> m_NameOffsets;  // in m_Names
+
+    // Memoized paths: offset in m_PathPool and length (with the flag in its high bit)
+    std::vector<DWORD> m_PathOffsets;
+    std::vector<DWORD> m_PathLengths;
+    std::vector<WCHAR> m_PathPool;
+
+    // Names are stored once, prefixed with their length (FileNameLength is a WORD, it fits in a WCHAR)
+    std::vector<WCHAR> m_Names;
+    std::vector<DWORD> m_NameTable;  // open addressing, offsets in m_Names
+    size_t m_NameCount = 0;
+
+    std::vector<DWORD> m_Index;  // rows by segment number
+    std::unordered_map<DWORDLONG, DWORD> m_SparseIndex;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
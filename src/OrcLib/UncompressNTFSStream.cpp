@@ -15,11 +15,16 @@
 #include "NTFSStream.h"
 #include "VolumeReader.h"
 
+#include <ppl.h>
+
 using namespace Orc;
 
 UncompressNTFSStream::UncompressNTFSStream()
     : ChainingStream()
     , m_ullPosition(0L)
+    , m_dwReadAhead(0L)
+    , m_ullReadAheadOffset(0LL)
+    , m_ullReadAheadSize(0LL)
 {
     m_dwCompressionUnit = 0L;
     m_dwMaxCompressionUnit = 0L;
@@ -29,6 +34,9 @@ UncompressNTFSStream::~UncompressNTFSStream(void) {}
 
 HRESULT UncompressNTFSStream::Close()
 {
+    m_ullReadAheadOffset = m_ullReadAheadSize = 0LL;
+    m_ReadAheadData.RemoveAll();
+
     if (m_pChainedStream == nullptr)
         return S_OK;
     return m_pChainedStream->Close();
@@ -204,7 +212,7 @@ HRESULT UncompressNTFSStream::ReadCompressionUnit(
     if (!buffer.SetCount(static_cast<size_t>(ullToRead)))
         return E_OUTOFMEMORY;
 
-    while (ullRead < (m_dwCompressionUnit * static_cast<ULONGLONG>(dwNbCU)) && ullRead < ullToRead)
+    while (ullRead < ullToRead)
     {
         ULONGLONG ullThisRead = 0LL;
         if (FAILED(hr = m_pChainedStream->Read(buffer.GetData() + ullRead, buffer.GetCount() - ullRead, &ullThisRead)))
@@ -224,166 +232,72 @@ HRESULT UncompressNTFSStream::ReadCompressionUnit(
         return S_OK;
     }
 
-    size_t uncomp_processed = 0;
+    const size_t firstUnit = static_cast<size_t>(m_ullPosition / m_dwCompressionUnit);
+    const size_t units = static_cast<size_t>((ullRead + m_dwCompressionUnit - 1) / m_dwCompressionUnit);
 
-    for (unsigned int i = 0; i < dwNbCU; i++)
-    {
-        size_t unitIndex = ((size_t)m_ullPosition / m_dwCompressionUnit) + i;
+    // compression units are compressed independently: they are decompressed concurrently
+    std::vector<HRESULT> results(units, S_OK);
+
+    auto uncompress = [&](size_t i) {
+        const size_t offset = i * m_dwCompressionUnit;
+        const size_t cbUnit = static_cast<size_t>(std::min<ULONGLONG>(m_dwCompressionUnit, ullRead - offset));
+        const size_t unitIndex = firstUnit + i;
+
+        const LPBYTE pCompressed = buffer.GetData() + offset;
+        const LPBYTE pUncompressed = uncompressedData.GetData() + offset;
 
-        if (ullRead - uncomp_processed >= m_dwCompressionUnit)
+        // without the unit's allocation (data and sparse runs), decompression is attempted on every unit
+        bool bCompressed = true;
+        if (!m_IsBlockCompressed.empty())
+            bCompressed = unitIndex < m_IsBlockCompressed.size() && m_IsBlockCompressed[unitIndex];
+
+        if (bCompressed)
         {
-            if (!m_IsBlockCompressed.empty())
+            // a unit is always decompressed to its full size, the last one may not fit in the output
+            if (uncompressedData.GetCount() >= offset + m_dwCompressionUnit)
             {
-                if (m_IsBlockCompressed[unitIndex])
-                {
-                    // compression unit is compressed: proceed with decompression
-                    NTFS_COMP_INFO info;
-                    info.buf_size_b = m_dwCompressionUnit;
-                    info.comp_buf = (char*)buffer.GetData() + uncomp_processed;
-                    info.comp_len = m_dwCompressionUnit;
-                    info.uncomp_buf = (char*)uncompressedData.GetData() + uncomp_processed;
-                    info.uncomp_idx = 0L;
-
-                    if (FAILED(hr = ntfs_uncompress_compunit(&info)))
-                    {
-                        Log::Warn(
-                            L"Failed to uncompress {} bytes from compressed unit, copying as raw/uncompressed data "
-                            L"[{}]",
-                            info.comp_len,
-                            SystemError(hr));
-                        CopyMemory(
-                            (LPBYTE)uncompressedData.GetData() + uncomp_processed,
-                            (char*)buffer.GetData() + uncomp_processed,
-                            m_dwCompressionUnit);
-                        uncomp_processed += m_dwCompressionUnit;
-                    }
-                    else
-                    {
-                        uncomp_processed += info.comp_len;
-                    }
-                }
-                else
-                {
-                    CopyMemory(
-                        (LPBYTE)uncompressedData.GetData() + uncomp_processed,
-                        (char*)buffer.GetData() + uncomp_processed,
-                        m_dwCompressionUnit);
-                    uncomp_processed += m_dwCompressionUnit;
-                }
+                results[i] = lznt1_decompress(pCompressed, cbUnit, pUncompressed, m_dwCompressionUnit);
             }
             else
             {
-                // compression unit is compressed: proceed with decompression
-                NTFS_COMP_INFO info;
-                info.buf_size_b = m_dwCompressionUnit;
-                info.comp_buf = (char*)buffer.GetData() + uncomp_processed;
-                info.comp_len = m_dwCompressionUnit;
-                info.uncomp_buf = (char*)uncompressedData.GetCount() + uncomp_processed;
-                info.uncomp_idx = 0L;
-
-                if (FAILED(hr = ntfs_uncompress_compunit(&info)))
-                {
-                    // If decompression failed and CUs not compressed information is not available, we assume the CU was
-                    // not compressed
-                    Log::Warn(
-                        "Failed to uncompress {} bytes from compressed unit, copying as raw/uncompressed data [{}]",
-                        info.comp_len,
-                        SystemError(hr));
-                    CopyMemory(
-                        (LPBYTE)uncompressedData.GetData() + uncomp_processed,
-                        (char*)buffer.GetData() + uncomp_processed,
-                        m_dwCompressionUnit);
-                    uncomp_processed += m_dwCompressionUnit;
-                }
-                else
-                {
-                    uncomp_processed += info.comp_len;
-                }
+                CBinaryBuffer uncomp;
+                if (!uncomp.SetCount(m_dwCompressionUnit))
+                    results[i] = E_OUTOFMEMORY;
+                else if (SUCCEEDED(
+                             results[i] =
+                                 lznt1_decompress(pCompressed, cbUnit, uncomp.GetData(), m_dwCompressionUnit)))
+                    CopyMemory(pUncompressed, uncomp.GetData(), cbUnit);
             }
-        }
-        else
-        {
-            if (!m_IsBlockCompressed.empty())
-            {
-                // the last uncompression has to take place in a buffer of at least CU size
-                if (m_IsBlockCompressed[unitIndex])
-                {
-                    CBinaryBuffer uncomp(true);
-                    uncomp.SetCount(m_dwCompressionUnit);
 
-                    NTFS_COMP_INFO info;
-                    info.buf_size_b = m_dwCompressionUnit;
-                    info.comp_buf = (char*)buffer.GetData() + uncomp_processed;
-                    info.comp_len = m_dwCompressionUnit;
-                    info.uncomp_buf = (char*)uncomp.GetData();
-                    info.uncomp_idx = 0L;
+            if (SUCCEEDED(results[i]))
+                return;
+        }
 
-                    if (FAILED(hr = ntfs_uncompress_compunit(&info)))
-                    {
-                        Log::Warn(
-                            L"Failed to uncompress {} bytes from compressed unit, copying as raw/uncompressed data "
-                            L"[{}]",
-                            info.comp_len,
-                            SystemError(hr));
-                        CopyMemory(
-                            (LPBYTE)uncompressedData.GetData() + uncomp_processed,
-                            (char*)buffer.GetData() + uncomp_processed,
-                            m_dwCompressionUnit);
-                        uncomp_processed += m_dwCompressionUnit;
-                    }
-                    else
-                    {
-                        CopyMemory(
-                            uncompressedData.GetData() + uncomp_processed,
-                            uncomp.GetData(),
-                            static_cast<size_t>(ullRead - uncomp_processed));
-                        uncomp_processed += static_cast<size_t>(ullRead - uncomp_processed);
-                    }
-                }
-                else
-                {
-                    CopyMemory(
-                        uncompressedData.GetData() + uncomp_processed,
-                        (char*)buffer.GetData() + uncomp_processed,
-                        static_cast<size_t>(ullRead - uncomp_processed));
-                    uncomp_processed += static_cast<size_t>(ullRead - uncomp_processed);
-                }
-            }
-            else
-            {
-                CBinaryBuffer uncomp(true);
-                uncomp.SetCount(m_dwCompressionUnit);
+        CopyMemory(pUncompressed, pCompressed, cbUnit);
+    };
 
-                NTFS_COMP_INFO info;
-                info.buf_size_b = m_dwCompressionUnit;
-                info.comp_buf = (char*)buffer.GetData() + uncomp_processed;
-                info.comp_len = m_dwCompressionUnit;
-                info.uncomp_buf = (char*)uncomp.GetData();
-                info.uncomp_idx = 0L;
+    if (units > 1)
+        concurrency::parallel_for(size_t(0), units, uncompress);
+    else
+        uncompress(0);
 
-                if (FAILED(hr = ntfs_uncompress_compunit(&info)))
-                {
-                    // If decompression failed and CUs not compressed information is not available, we assume the CU was
-                    // not compressed
-                    CopyMemory(
-                        (LPBYTE)uncompressedData.GetData() + uncomp_processed,
-                        (char*)buffer.GetData() + uncomp_processed,
-                        static_cast<size_t>(ullRead - uncomp_processed));
-                    uncomp_processed += m_dwCompressionUnit;
-                }
-                else
-                {
-                    CopyMemory(
-                        uncompressedData.GetData() + uncomp_processed,
-                        uncomp.GetData(),
-                        static_cast<size_t>(ullRead - uncomp_processed));
-                    uncomp_processed += static_cast<size_t>(ullRead - uncomp_processed);
-                }
+    for (size_t i = 0; i < units; i++)
+    {
+        if (FAILED(results[i]))
+        {
+            // if the unit was not known to be compressed, it is assumed it was not
+            if (!m_IsBlockCompressed.empty())
+            {
+                Log::Warn(
+                    L"Failed to uncompress compression unit #{}, copying as raw/uncompressed data [{}]",
+                    firstUnit + i,
+                    SystemError(results[i]));
             }
         }
     }
+
     if (pcbBytesRead)
-        *pcbBytesRead = uncomp_processed;
+        *pcbBytesRead = ullRead;
     return S_OK;
 }
 
@@ -413,6 +327,10 @@ HRESULT UncompressNTFSStream::Read(
     ULONGLONG ullBytesToRead = (m_ullPosition % m_dwCompressionUnit) + cbBytesToRead;
     DWORD dwCUsToRead =
         static_cast<DWORD>(ullBytesToRead / m_dwCompressionUnit + (ullBytesToRead % m_dwCompressionUnit > 0 ? 1 : 0));
+
+    if (dwCUsToRead < m_dwReadAhead)
+        return ReadAhead(pBuffer, cbBytesToRead, pcbBytesRead);
+
     ULONGLONG ullToRead = 0LLU;
 
     if (!msl::utilities::SafeMultiply((ULONGLONG)dwCUsToRead, m_dwCompressionUnit, ullToRead))
@@ -466,6 +384,57 @@ HRESULT UncompressNTFSStream::Read(
     return S_OK;
 }
 
+HRESULT UncompressNTFSStream::ReadAhead(
+    __out_bcount_part(cbBytesToRead, *pcbBytesRead) PVOID pBuffer,
+    __in ULONGLONG cbBytesToRead,
+    __out_opt PULONGLONG pcbBytesRead)
+{
+    HRESULT hr = E_FAIL;
+
+    ULONGLONG ullRead = 0LL;
+    while (ullRead < cbBytesToRead)
+    {
+        if (m_ullPosition < m_ullReadAheadOffset || m_ullPosition >= m_ullReadAheadOffset + m_ullReadAheadSize)
+        {
+            // the window starts with the compression unit of the current position
+            const ULONGLONG ullWindowOffset = (m_ullPosition / m_dwCompressionUnit) * m_dwCompressionUnit;
+            const DWORD dwWindowCUs = std::min(m_dwReadAhead, m_dwMaxCompressionUnit);
+
+            if (FAILED(hr = m_pChainedStream->SetFilePointer(ullWindowOffset, FILE_BEGIN, nullptr)))
+                return hr;
+
+            if (!m_ReadAheadData.SetCount(static_cast<size_t>(dwWindowCUs) * m_dwCompressionUnit))
+                return E_OUTOFMEMORY;
+
+            m_ullReadAheadSize = 0LL;
+            if (FAILED(hr = ReadCompressionUnit(dwWindowCUs, m_ReadAheadData, &m_ullReadAheadSize)))
+                return hr;
+            m_ullReadAheadOffset = ullWindowOffset;
+
+            if (m_ullPosition >= m_ullReadAheadOffset + m_ullReadAheadSize)
+                break;
+        }
+
+        const ULONGLONG ullInWindow = m_ullPosition - m_ullReadAheadOffset;
+        const ULONGLONG ullThisRead = std::min(cbBytesToRead - ullRead, m_ullReadAheadSize - ullInWindow);
+
+        CopyMemory(
+            reinterpret_cast<LPBYTE>(pBuffer) + ullRead,
+            m_ReadAheadData.GetData() + ullInWindow,
+            static_cast<size_t>(ullThisRead));
+
+        ullRead += ullThisRead;
+        m_ullPosition += ullThisRead;
+    }
+
+    if (pcbBytesRead != nullptr)
+        *pcbBytesRead = ullRead;
+
+    // keeps the chained stream where Read expects it: at the compression unit of the current position
+    return m_pChainedStream->SetFilePointer(
+        (m_ullPosition / m_dwCompressionUnit) * m_dwCompressionUnit, FILE_BEGIN, nullptr);
+}
+
 HRESULT UncompressNTFSStream::Write(
     __in_bcount(cbBytes) const PVOID pBuffer,
     __in ULONGLONG cbBytes,
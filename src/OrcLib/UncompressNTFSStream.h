@@ -10,6 +10,7 @@
 #include "OrcLib.h"
 
 #include "ChainingStream.h"
+#include "BinaryBuffer.h"
 
 #include "boost/logic/tribool.hpp"
 
@@ -43,6 +44,10 @@ public:
 
     STDMETHOD(Open)(const std::shared_ptr<NTFSStream>& pChainedStream, DWORD dwCompressionUnit);
 
+    // Reads of less than dwCompressionUnits units are served from a window of that many units, decompressed
+    // concurrently (0 disables it: each read only decompresses the units it covers)
+    void SetReadAhead(DWORD dwCompressionUnits) { m_dwReadAhead = dwCompressionUnits; }
+
     STDMETHOD(Read)
     (__out_bcount_part(cbBytes, *pcbBytesRead) PVOID pReadBuffer,
      __in ULONGLONG cbBytes,
@@ -68,7 +73,16 @@ private:
 
     std::vector<boost::logic::tribool> m_IsBlockCompressed;
 
+    DWORD m_dwReadAhead;
+    ULONGLONG m_ullReadAheadOffset;
+    ULONGLONG m_ullReadAheadSize;
+    CBinaryBuffer m_ReadAheadData;
+
     HRESULT ReadCompressionUnit(DWORD dwNbCU, CBinaryBuffer& uncompressedData, __out_opt PULONGLONG pcbBytesRead);
+    HRESULT ReadAhead(
+        __out_bcount_part(cbBytesToRead, *pcbBytesRead) PVOID pBuffer,
+        __in ULONGLONG cbBytesToRead,
+        __out_opt PULONGLONG pcbBytesRead);
 };
 }  // namespace Orc
 
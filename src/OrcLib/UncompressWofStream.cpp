@@ -0,0 +1,362 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "UncompressWofStream.h"
+
+#include "Log/Log.h"
+
+#include <ppl.h>
+
+using namespace Orc;
+
+namespace {
+
+constexpr auto kNoCachedChunk = static_cast<ULONGLONG>(-1);
+
+// each read decompresses at most this many chunks at once (8MB with LZX)
+constexpr DWORD kMaxChunksPerRead = 256;
+
+HRESULT ReadAt(ByteStream& stream, ULONGLONG ullOffset, LPBYTE pBuffer, ULONGLONG cbBytes)
+{
+    HRESULT hr = E_FAIL;
+
+    if (FAILED(hr = stream.SetFilePointer(static_cast<LONGLONG>(ullOffset), FILE_BEGIN, nullptr)))
+        return hr;
+
+    ULONGLONG ullRead = 0LL;
+    while (ullRead < cbBytes)
+    {
+        ULONGLONG ullThisRead = 0LL;
+        if (FAILED(hr = stream.Read(pBuffer + ullRead, cbBytes - ullRead, &ullThisRead)))
+            return hr;
+        if (ullThisRead == 0LL)
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+        ullRead += ullThisRead;
+    }
+    return S_OK;
+}
+
+}  // namespace
+
+UncompressWofStream::UncompressWofStream()
+    : ChainingStream()
+    , m_Algorithm(WofAlgorithm::Xpress4K)
+    , m_dwChunkSize(0L)
+    , m_ullSize(0LL)
+    , m_ullPosition(0LL)
+    , m_ullCachedChunk(kNoCachedChunk)
+{
+}
+
+UncompressWofStream::~UncompressWofStream(void) {}
+
+HRESULT UncompressWofStream::Close()
+{
+    m_ChunkOffsets.clear();
+    m_ullCachedChunk = kNoCachedChunk;
+    m_CachedChunk.RemoveAll();
+
+    if (m_pChainedStream == nullptr)
+        return S_OK;
+    return m_pChainedStream->Close();
+}
+
+HRESULT UncompressWofStream::Open(
+    const std::shared_ptr<ByteStream>& pChained,
+    WofAlgorithm algorithm,
+    ULONGLONG ullUncompressedSize)
+{
+    HRESULT hr = E_FAIL;
+
+    if (pChained == nullptr)
+        return E_POINTER;
+
+    if (pChained->IsOpen() != S_OK)
+    {
+        Log::Error(L"Chained stream must be opened");
+        return E_FAIL;
+    }
+
+    m_dwChunkSize = wof_chunk_size(algorithm);
+    if (m_dwChunkSize == 0L)
+    {
+        Log::Error("Invalid WOF compression format specified {}", static_cast<uint32_t>(algorithm));
+        return E_INVALIDARG;
+    }
+
+    m_pChainedStream = pChained;
+    m_Algorithm = algorithm;
+    m_ullSize = ullUncompressedSize;
+    m_ullPosition = 0LL;
+    m_ullCachedChunk = kNoCachedChunk;
+
+    if (FAILED(hr = ReadChunkTable()))
+    {
+        Log::Error("Failed to read WOF chunk table [{}]", SystemError(hr));
+        return hr;
+    }
+    return S_OK;
+}
+
+DWORD UncompressWofStream::ChunkSize(DWORD dwChunk) const
+{
+    if (dwChunk + 1 < ChunkCount())
+        return m_dwChunkSize;
+    return static_cast<DWORD>(m_ullSize - static_cast<ULONGLONG>(dwChunk) * m_dwChunkSize);
+}
+
+HRESULT UncompressWofStream::ReadChunkTable()
+{
+    HRESULT hr = E_FAIL;
+
+    const ULONGLONG ullChunks = (m_ullSize + m_dwChunkSize - 1) / m_dwChunkSize;
+    if (ullChunks > MAXDWORD)
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+    // entries are the end offsets of each chunk but the last, relative to the end of the table
+    const DWORD dwEntrySize = m_ullSize > MAXDWORD ? sizeof(ULONGLONG) : sizeof(DWORD);
+    const ULONGLONG ullTableSize = ullChunks ? (ullChunks - 1) * dwEntrySize : 0LL;
+    const ULONGLONG ullCompressedSize = m_pChainedStream->GetSize();
+
+    if (ullTableSize > ullCompressedSize)
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+    CBinaryBuffer table;
+    if (!table.SetCount(static_cast<size_t>(ullTableSize)))
+        return E_OUTOFMEMORY;
+
+    if (ullTableSize > 0 && FAILED(hr = ReadAt(*m_pChainedStream, 0LL, table.GetData(), ullTableSize)))
+        return hr;
+
+    std::vector<ULONGLONG> offsets;
+    offsets.reserve(static_cast<size_t>(ullChunks) + 1);
+    offsets.push_back(ullTableSize);
+
+    for (ULONGLONG i = 0; i + 1 < ullChunks; i++)
+    {
+        const auto pEntry = table.GetData() + i * dwEntrySize;
+        const ULONGLONG ullEnd = dwEntrySize == sizeof(DWORD) ? *reinterpret_cast<const DWORD*>(pEntry)
+                                                              : *reinterpret_cast<const ULONGLONG*>(pEntry);
+        offsets.push_back(ullTableSize + ullEnd);
+    }
+    offsets.push_back(ullCompressedSize);
+
+    for (size_t i = 0; i + 1 < offsets.size(); i++)
+    {
+        if (offsets[i + 1] < offsets[i] || offsets[i + 1] > ullCompressedSize)
+        {
+            Log::Debug("Invalid WOF chunk #{} offsets ({:#x} - {:#x})", i, offsets[i], offsets[i + 1]);
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+    }
+
+    std::swap(m_ChunkOffsets, offsets);
+    return S_OK;
+}
+
+HRESULT UncompressWofStream::ReadChunks(
+    DWORD dwFirstChunk,
+    DWORD dwChunks,
+    ULONGLONG ullOffset,
+    ULONGLONG cbBytes,
+    LPBYTE pBuffer)
+{
+    HRESULT hr = E_FAIL;
+
+    const ULONGLONG ullCompressedStart = m_ChunkOffsets[dwFirstChunk];
+    const ULONGLONG ullCompressedEnd = m_ChunkOffsets[dwFirstChunk + dwChunks];
+
+    // the chunks are contiguous: one read for all of them
+    CBinaryBuffer compressed;
+    if (!compressed.SetCount(static_cast<size_t>(ullCompressedEnd - ullCompressedStart)))
+        return E_OUTOFMEMORY;
+
+    if (compressed.GetCount() > 0
+        && FAILED(hr = ReadAt(*m_pChainedStream, ullCompressedStart, compressed.GetData(), compressed.GetCount())))
+    {
+        Log::Error("Failed to read {} bytes of WOF compressed data [{}]", compressed.GetCount(), SystemError(hr));
+        return hr;
+    }
+
+    const ULONGLONG ullReadStart = static_cast<ULONGLONG>(dwFirstChunk) * m_dwChunkSize + ullOffset;
+    const ULONGLONG ullReadEnd = ullReadStart + cbBytes;
+
+    // chunks only partially read are decompressed aside, the others straight into the caller's buffer
+    std::vector<CBinaryBuffer> partialChunks(dwChunks);
+    std::vector<HRESULT> results(dwChunks, E_FAIL);
+
+    auto decompress = [&](size_t i) {
+        const DWORD dwChunk = dwFirstChunk + static_cast<DWORD>(i);
+        const DWORD dwChunkSize = ChunkSize(dwChunk);
+        const ULONGLONG ullChunkStart = static_cast<ULONGLONG>(dwChunk) * m_dwChunkSize;
+        const ULONGLONG ullCopyStart = std::max(ullChunkStart, ullReadStart);
+        const ULONGLONG ullCopyEnd = std::min(ullChunkStart + dwChunkSize, ullReadEnd);
+
+        const bool bPartial = ullCopyStart != ullChunkStart || ullCopyEnd != ullChunkStart + dwChunkSize;
+
+        LPBYTE pDest = nullptr;
+        if (bPartial)
+        {
+            if (!partialChunks[i].SetCount(dwChunkSize))
+            {
+                results[i] = E_OUTOFMEMORY;
+                return;
+            }
+            pDest = partialChunks[i].GetData();
+        }
+        else
+            pDest = pBuffer + (ullChunkStart - ullReadStart);
+
+        const auto pSource = compressed.GetData() + (m_ChunkOffsets[dwChunk] - ullCompressedStart);
+        const auto cbSource = static_cast<size_t>(m_ChunkOffsets[dwChunk + 1] - m_ChunkOffsets[dwChunk]);
+
+        // a chunk which did not compress is stored as is
+        if (cbSource == dwChunkSize)
+        {
+            CopyMemory(pDest, pSource, dwChunkSize);
+            results[i] = S_OK;
+        }
+        else if (cbSource > dwChunkSize)
+            results[i] = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        else
+            results[i] = wof_decompress_chunk(m_Algorithm, pSource, cbSource, pDest, dwChunkSize);
+
+        if (bPartial && SUCCEEDED(results[i]))
+            CopyMemory(
+                pBuffer + (ullCopyStart - ullReadStart),
+                pDest + (ullCopyStart - ullChunkStart),
+                static_cast<size_t>(ullCopyEnd - ullCopyStart));
+    };
+
+    if (dwChunks > 1)
+        concurrency::parallel_for(size_t(0), static_cast<size_t>(dwChunks), decompress);
+    else
+        decompress(0);
+
+    for (DWORD i = 0; i < dwChunks; i++)
+    {
+        if (FAILED(results[i]))
+        {
+            Log::Error("Failed to decompress WOF chunk #{} [{}]", dwFirstChunk + i, SystemError(results[i]));
+            return results[i];
+        }
+    }
+
+    if (partialChunks.back().GetCount() > 0)
+    {
+        m_ullCachedChunk = dwFirstChunk + dwChunks - 1;
+        m_CachedChunk = std::move(partialChunks.back());
+    }
+    return S_OK;
+}
+
+HRESULT UncompressWofStream::Read(
+    __out_bcount_part(cbBytesToRead, *pcbBytesRead) PVOID pBuffer,
+    __in ULONGLONG cbBytesToRead,
+    __out_opt PULONGLONG pcbBytesRead)
+{
+    HRESULT hr = E_FAIL;
+
+    if (pcbBytesRead != nullptr)
+        *pcbBytesRead = 0LL;
+
+    if (m_pChainedStream == nullptr)
+        return E_POINTER;
+
+    if (m_ullPosition >= m_ullSize)
+        return S_OK;
+
+    if (cbBytesToRead > m_ullSize - m_ullPosition)
+        cbBytesToRead = m_ullSize - m_ullPosition;
+
+    LPBYTE pOutput = reinterpret_cast<LPBYTE>(pBuffer);
+    ULONGLONG ullRead = 0LL;
+
+    while (ullRead < cbBytesToRead)
+    {
+        const DWORD dwChunk = static_cast<DWORD>(m_ullPosition / m_dwChunkSize);
+        const ULONGLONG ullInChunk = m_ullPosition % m_dwChunkSize;
+
+        ULONGLONG ullThisRead = 0LL;
+
+        if (dwChunk == m_ullCachedChunk)
+        {
+            ullThisRead = std::min(m_CachedChunk.GetCount() - ullInChunk, cbBytesToRead - ullRead);
+            CopyMemory(pOutput + ullRead, m_CachedChunk.GetData() + ullInChunk, static_cast<size_t>(ullThisRead));
+        }
+        else
+        {
+            ullThisRead =
+                std::min(cbBytesToRead - ullRead, static_cast<ULONGLONG>(kMaxChunksPerRead) * m_dwChunkSize - ullInChunk);
+            const DWORD dwChunks = static_cast<DWORD>((ullInChunk + ullThisRead + m_dwChunkSize - 1) / m_dwChunkSize);
+
+            if (FAILED(hr = ReadChunks(dwChunk, dwChunks, ullInChunk, ullThisRead, pOutput + ullRead)))
+                return hr;
+        }
+
+        ullRead += ullThisRead;
+        m_ullPosition += ullThisRead;
+    }
+
+    if (pcbBytesRead != nullptr)
+        *pcbBytesRead = ullRead;
+    return S_OK;
+}
+
+HRESULT UncompressWofStream::Write(
+    __in_bcount(cbBytes) const PVOID pBuffer,
+    __in ULONGLONG cbBytes,
+    __out_opt PULONGLONG pcbBytesWritten)
+{
+    DBG_UNREFERENCED_PARAMETER(pBuffer);
+    DBG_UNREFERENCED_PARAMETER(cbBytes);
+    DBG_UNREFERENCED_PARAMETER(pcbBytesWritten);
+
+    return E_NOTIMPL;
+}
+
+HRESULT UncompressWofStream::SetFilePointer(
+    __in LONGLONG lDistanceToMove,
+    __in DWORD dwMoveMethod,
+    __out_opt PULONG64 pqwCurrPointer)
+{
+    if (!m_pChainedStream)
+        return E_FAIL;
+
+    switch (dwMoveMethod)
+    {
+        case FILE_BEGIN:
+            m_ullPosition = lDistanceToMove;
+            break;
+        case FILE_CURRENT:
+            m_ullPosition += lDistanceToMove;
+            break;
+        case FILE_END:
+            m_ullPosition = m_ullSize + lDistanceToMove;
+            break;
+    }
+
+    if (m_ullPosition > m_ullSize)
+        m_ullPosition = m_ullSize;
+
+    if (pqwCurrPointer != nullptr)
+        *pqwCurrPointer = m_ullPosition;
+    return S_OK;
+}
+
+ULONG64 UncompressWofStream::GetSize()
+{
+    return m_ullSize;
+}
+
+HRESULT UncompressWofStream::SetSize(ULONG64 ullNewSize)
+{
+    DBG_UNREFERENCED_PARAMETER(ullNewSize);
+
+    return S_OK;
+}
@@ -0,0 +1,86 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include "ChainingStream.h"
+#include "WofCompression.h"
+
+#include "BinaryBuffer.h"
+
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Uncompressed view of a file compressed by WOF (system compression): the chained stream is its WofCompressedData
+// stream, a table of chunk offsets followed by independently compressed chunks, which are decompressed in parallel.
+class ORCLIB_API UncompressWofStream : public ChainingStream
+{
+
+public:
+    UncompressWofStream();
+    virtual ~UncompressWofStream(void);
+
+    STDMETHOD(IsOpen)()
+    {
+        if (m_pChainedStream == NULL)
+            return S_FALSE;
+        return m_pChainedStream->IsOpen();
+    };
+    STDMETHOD(CanRead)() { return S_OK; };
+    STDMETHOD(CanWrite)() { return S_FALSE; };
+    STDMETHOD(CanSeek)() { return S_OK; };
+
+    //
+    // ByteStream implementation
+    //
+    // ullUncompressedSize is the size of the file (that of its unnamed, sparse, data stream)
+    STDMETHOD(Open)
+    (const std::shared_ptr<ByteStream>& pChainedStream, WofAlgorithm algorithm, ULONGLONG ullUncompressedSize);
+
+    STDMETHOD(Read)
+    (__out_bcount_part(cbBytes, *pcbBytesRead) PVOID pReadBuffer,
+     __in ULONGLONG cbBytes,
+     __out_opt PULONGLONG pcbBytesRead);
+
+    STDMETHOD(Write)
+    (__in_bcount(cbBytesToWrite) const PVOID pWriteBuffer,
+     __in ULONGLONG cbBytesToWrite,
+     __out_opt PULONGLONG pcbBytesWritten);
+
+    STDMETHOD(SetFilePointer)
+    (__in LONGLONG DistanceToMove, __in DWORD dwMoveMethod, __out_opt PULONG64 pCurrPointer);
+
+    STDMETHOD_(ULONG64, GetSize)();
+    STDMETHOD(SetSize)(ULONG64 ullSize);
+
+    STDMETHOD(Close)();
+
+private:
+    WofAlgorithm m_Algorithm;
+    DWORD m_dwChunkSize;
+    ULONGLONG m_ullSize;
+    ULONGLONG m_ullPosition;
+
+    // offsets of the chunks in the chained stream, followed by the end of the last one
+    std::vector<ULONGLONG> m_ChunkOffsets;
+
+    // last chunk only partially read, the next (sequential) read usually starts with it
+    ULONGLONG m_ullCachedChunk;
+    CBinaryBuffer m_CachedChunk;
+
+    DWORD ChunkCount() const { return static_cast<DWORD>(m_ChunkOffsets.size() - 1); }
+    DWORD ChunkSize(DWORD dwChunk) const;
+
+    HRESULT ReadChunkTable();
+    HRESULT ReadChunks(DWORD dwFirstChunk, DWORD dwChunks, ULONGLONG ullOffset, ULONGLONG cbBytes, LPBYTE pBuffer);
+};
+}  // namespace Orc
+
+#pragma managed(pop)
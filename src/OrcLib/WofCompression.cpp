@@ -0,0 +1,634 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "WofCompression.h"
+
+#include <array>
+#include <cstring>
+#include <memory>
+
+using namespace Orc;
+
+namespace {
+
+constexpr auto kInvalidData = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+inline uint16_t get_le16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t get_le32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16)
+        | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline void put_le32(uint8_t* p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// Both formats store their bits in 16 bits little endian words, most significant bit first.
+// Like the MS-XCA reference decoder, at least 16 bits are kept buffered after each consumption: Xpress interleaves
+// raw bytes with the bits, those are read from the position right after the buffered words.
+class BitReader
+{
+public:
+    BitReader(const uint8_t* src, const uint8_t* end)
+        : m_Next(src)
+        , m_End(end)
+    {
+        Load();
+        Load();
+    }
+
+    uint32_t Peek(unsigned bits) const { return m_Buffer >> (32 - bits); }
+
+    void Consume(unsigned bits)
+    {
+        m_Buffer <<= bits;
+        m_Bits -= bits;
+        if (m_Bits < 16)
+            Load();
+    }
+
+    uint32_t Read(unsigned bits)
+    {
+        if (bits == 0)
+            return 0;
+        const auto value = Peek(bits);
+        Consume(bits);
+        return value;
+    }
+
+    // Reads a raw byte, or word, from the input (Xpress match lengths)
+    bool ReadByte(uint32_t& value)
+    {
+        if (m_End - m_Next < 1)
+            return false;
+        value = *m_Next++;
+        return true;
+    }
+
+    bool ReadWord(uint32_t& value)
+    {
+        if (m_End - m_Next < 2)
+            return false;
+        value = get_le16(m_Next);
+        m_Next += 2;
+        return true;
+    }
+
+    // Skips to the next 16 bits boundary (16 bits if already aligned) and gives back the position of the first
+    // whole word still buffered: the raw data of LZX uncompressed blocks starts there
+    const uint8_t* Align()
+    {
+        Consume(m_Bits % 16 ? m_Bits % 16 : 16);
+
+        // the words loaded past the end of the input are the last ones buffered and did not move the position
+        const ptrdiff_t buffered = 2 * (m_Bits / 16);
+        return buffered > m_Overrun ? m_Next - (buffered - m_Overrun) : m_Next;
+    }
+
+    // Restarts the bit stream after raw data
+    void Reset(const uint8_t* src)
+    {
+        m_Next = src;
+        m_Buffer = 0;
+        m_Bits = 0;
+        m_Overrun = 0;
+        Load();
+        Load();
+    }
+
+    // Bits consumed past the end of the input (zeroes)
+    bool Overrun() const { return m_Overrun * 8 > static_cast<ptrdiff_t>(m_Bits); }
+
+private:
+    void Load()
+    {
+        uint32_t word = 0;
+        if (m_End - m_Next >= 2)
+        {
+            word = get_le16(m_Next);
+            m_Next += 2;
+        }
+        else
+            m_Overrun += 2;
+        m_Buffer |= word << (16 - m_Bits);
+        m_Bits += 16;
+    }
+
+    const uint8_t* m_Next;
+    const uint8_t* m_End;
+    uint32_t m_Buffer = 0;
+    unsigned m_Bits = 0;
+    ptrdiff_t m_Overrun = 0;
+};
+
+// Canonical Huffman decoder: codes up to 'TableBits' long are resolved with one table lookup, the (rare) longer ones
+// with the first code of each length
+template <size_t NumSymbols, unsigned TableBits, unsigned MaxCodeLength>
+class HuffmanDecoder
+{
+    static_assert(MaxCodeLength <= 16 && TableBits <= MaxCodeLength);
+
+public:
+    bool Build(const uint8_t* lengths)
+    {
+        m_Count.fill(0);
+        for (size_t symbol = 0; symbol < NumSymbols; symbol++)
+        {
+            if (lengths[symbol] > MaxCodeLength)
+                return false;
+            m_Count[lengths[symbol]]++;
+        }
+        m_Count[0] = 0;
+
+        // over subscribed code lengths cannot be decoded, incomplete ones can (as long as unused codes are not met)
+        int32_t left = 1;
+        for (unsigned length = 1; length <= MaxCodeLength; length++)
+        {
+            left = (left << 1) - m_Count[length];
+            if (left < 0)
+                return false;
+        }
+
+        uint32_t code = 0;
+        uint16_t index = 0;
+        for (unsigned length = 1; length <= MaxCodeLength; length++)
+        {
+            code = (code + m_Count[length - 1]) << 1;
+            m_FirstCode[length] = code;
+            m_FirstIndex[length] = index;
+            index += m_Count[length];
+        }
+
+        auto next = m_FirstIndex;
+        for (size_t symbol = 0; symbol < NumSymbols; symbol++)
+        {
+            if (lengths[symbol])
+                m_Sorted[next[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+        }
+
+        m_Table.fill(0);
+        for (unsigned length = 1; length <= TableBits; length++)
+        {
+            for (uint16_t i = 0; i < m_Count[length]; i++)
+            {
+                const auto symbol = m_Sorted[m_FirstIndex[length] + i];
+                const auto first = (m_FirstCode[length] + i) << (TableBits - length);
+                const auto entry = static_cast<uint16_t>((symbol << 5) | length);
+                std::fill_n(m_Table.begin() + first, size_t(1) << (TableBits - length), entry);
+            }
+        }
+        return true;
+    }
+
+    // Returns the decoded symbol, -1 for an unassigned code
+    int Decode(BitReader& reader) const
+    {
+        const auto bits = reader.Peek(MaxCodeLength);
+
+        if (const auto entry = m_Table[bits >> (MaxCodeLength - TableBits)]; entry != 0)
+        {
+            reader.Consume(entry & 0x1F);
+            return entry >> 5;
+        }
+
+        for (unsigned length = TableBits + 1; length <= MaxCodeLength; length++)
+        {
+            const auto offset = (bits >> (MaxCodeLength - length)) - m_FirstCode[length];
+            if (offset < m_Count[length])
+            {
+                reader.Consume(length);
+                return m_Sorted[m_FirstIndex[length] + offset];
+            }
+        }
+        return -1;
+    }
+
+private:
+    std::array<uint16_t, size_t(1) << TableBits> m_Table;  // (symbol << 5) | length, 0 when the code is longer
+    std::array<uint16_t, MaxCodeLength + 1> m_Count;
+    std::array<uint32_t, MaxCodeLength + 1> m_FirstCode;
+    std::array<uint16_t, MaxCodeLength + 1> m_FirstIndex;
+    std::array<uint16_t, NumSymbols> m_Sorted;
+};
+
+// Copies a match, overlapping or not: fails if it references data before the output or goes past 'end'
+inline bool copy_match(uint8_t* begin, uint8_t*& next, uint8_t* end, uint32_t offset, uint32_t length)
+{
+    if (offset == 0 || offset > static_cast<size_t>(next - begin) || length > static_cast<size_t>(end - next))
+        return false;
+
+    const uint8_t* from = next - offset;
+    if (offset >= length)
+        std::memcpy(next, from, length);
+    else
+    {
+        for (uint32_t i = 0; i < length; i++)
+            next[i] = from[i];
+    }
+    next += length;
+    return true;
+}
+
+//
+// Xpress Huffman
+//
+constexpr unsigned kXpressSymbols = 512;
+constexpr unsigned kXpressMaxCodeLength = 15;
+constexpr unsigned kXpressMinMatch = 3;
+constexpr size_t kXpressBlockSize = 0x10000;
+
+using XpressDecoder = HuffmanDecoder<kXpressSymbols, 11, kXpressMaxCodeLength>;
+
+//
+// LZX (32K window)
+//
+constexpr int kLzxChars = 256;
+constexpr unsigned kLzxOffsetSlots = 30;
+constexpr unsigned kLzxLengthHeaders = 8;
+constexpr unsigned kLzxMainSymbols = kLzxChars + kLzxOffsetSlots * kLzxLengthHeaders;
+constexpr unsigned kLzxLengthSymbols = 249;
+constexpr unsigned kLzxPreSymbols = 20;
+constexpr unsigned kLzxAlignedSymbols = 8;
+constexpr unsigned kLzxMinMatch = 2;
+constexpr unsigned kLzxOffsetAdjustment = 2;
+constexpr unsigned kLzxRecentOffsets = 3;
+constexpr uint32_t kLzxDefaultBlockSize = 0x8000;
+constexpr int32_t kLzxE8FileSize = 12000000;
+
+constexpr uint32_t kLzxOffsetSlotBase[kLzxOffsetSlots] = {
+    0,    1,    2,    3,    4,    6,    8,    12,   16,    24,    32,    48,    64,    96,    128,
+    192,  256,  384,  512,  768,  1024, 1536, 2048, 3072,  4096,  6144,  8192,  12288, 16384, 24576};
+
+constexpr uint8_t kLzxExtraOffsetBits[kLzxOffsetSlots] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                          6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+enum LzxBlockType : uint32_t
+{
+    Verbatim = 1,
+    Aligned = 2,
+    Uncompressed = 3
+};
+
+struct LzxDecoder
+{
+    HuffmanDecoder<kLzxMainSymbols, 11, 16> Main;
+    HuffmanDecoder<kLzxLengthSymbols, 10, 16> Length;
+    HuffmanDecoder<kLzxAlignedSymbols, 7, 7> Aligned;
+    HuffmanDecoder<kLzxPreSymbols, 6, 15> Pre;
+
+    // code lengths are delta coded with those of the previous block
+    std::array<uint8_t, kLzxMainSymbols> MainLengths = {};
+    std::array<uint8_t, kLzxLengthSymbols> LengthLengths = {};
+
+    // the "pretree" code gives the code lengths of the main and length codes
+    bool ReadCodeLengths(BitReader& reader, uint8_t* lengths, unsigned count)
+    {
+        std::array<uint8_t, kLzxPreSymbols> preLengths;
+        for (auto& length : preLengths)
+            length = static_cast<uint8_t>(reader.Read(4));
+        if (!Pre.Build(preLengths.data()))
+            return false;
+
+        for (unsigned i = 0; i < count;)
+        {
+            auto symbol = Pre.Decode(reader);
+            if (symbol < 0)
+                return false;
+
+            if (symbol < 17)
+            {
+                lengths[i] = static_cast<uint8_t>((lengths[i] + 17 - symbol) % 17);
+                i++;
+                continue;
+            }
+
+            unsigned run = 0;
+            uint8_t length = 0;
+            if (symbol == 17)
+                run = 4 + reader.Read(4);
+            else if (symbol == 18)
+                run = 20 + reader.Read(5);
+            else
+            {
+                run = 4 + reader.Read(1);
+                symbol = Pre.Decode(reader);
+                if (symbol < 0 || symbol > 16)
+                    return false;
+                length = static_cast<uint8_t>((lengths[i] + 17 - symbol) % 17);
+            }
+
+            if (run > count - i)
+                return false;
+            std::fill_n(lengths + i, run, length);
+            i += run;
+        }
+        return true;
+    }
+
+    bool ReadCodes(BitReader& reader, bool bAligned)
+    {
+        if (bAligned)
+        {
+            std::array<uint8_t, kLzxAlignedSymbols> alignedLengths;
+            for (auto& length : alignedLengths)
+                length = static_cast<uint8_t>(reader.Read(3));
+            if (!Aligned.Build(alignedLengths.data()))
+                return false;
+        }
+
+        if (!ReadCodeLengths(reader, MainLengths.data(), kLzxChars)
+            || !ReadCodeLengths(reader, MainLengths.data() + kLzxChars, kLzxMainSymbols - kLzxChars)
+            || !Main.Build(MainLengths.data()))
+            return false;
+
+        return ReadCodeLengths(reader, LengthLengths.data(), kLzxLengthSymbols) && Length.Build(LengthLengths.data());
+    }
+
+    bool DecodeBlock(
+        BitReader& reader,
+        bool bAligned,
+        uint8_t* begin,
+        uint8_t*& next,
+        uint8_t* blockEnd,
+        std::array<uint32_t, kLzxRecentOffsets>& recent) const
+    {
+        while (next < blockEnd)
+        {
+            const auto decoded = Main.Decode(reader);
+            if (decoded < 0)
+                return false;
+
+            if (decoded < kLzxChars)
+            {
+                *next++ = static_cast<uint8_t>(decoded);
+                continue;
+            }
+
+            const unsigned symbol = decoded - kLzxChars;
+            const unsigned lengthHeader = symbol % kLzxLengthHeaders;
+            const unsigned offsetSlot = symbol / kLzxLengthHeaders;
+
+            uint32_t length = lengthHeader + kLzxMinMatch;
+            if (lengthHeader == kLzxLengthHeaders - 1)
+            {
+                const auto lengthSymbol = Length.Decode(reader);
+                if (lengthSymbol < 0)
+                    return false;
+                length += lengthSymbol;
+            }
+
+            uint32_t offset = 0;
+            if (offsetSlot < kLzxRecentOffsets)
+            {
+                offset = recent[offsetSlot];
+                recent[offsetSlot] = recent[0];
+                recent[0] = offset;
+            }
+            else
+            {
+                const unsigned extraBits = kLzxExtraOffsetBits[offsetSlot];
+                offset = kLzxOffsetSlotBase[offsetSlot];
+
+                if (bAligned && extraBits >= 3)
+                {
+                    offset += reader.Read(extraBits - 3) << 3;
+                    const auto alignedSymbol = Aligned.Decode(reader);
+                    if (alignedSymbol < 0)
+                        return false;
+                    offset += alignedSymbol;
+                }
+                else
+                    offset += reader.Read(extraBits);
+
+                offset -= kLzxOffsetAdjustment;
+                recent[2] = recent[1];
+                recent[1] = recent[0];
+                recent[0] = offset;
+            }
+
+            if (!copy_match(begin, next, blockEnd, offset, length))
+                return false;
+        }
+        return true;
+    }
+};
+
+// The compressor replaced the relative targets of x86 CALL instructions (E8) with absolute ones
+void lzx_undo_e8_translation(uint8_t* data, size_t size)
+{
+    if (size <= 10)
+        return;
+
+    for (size_t i = 0; i < size - 10;)
+    {
+        if (data[i] != 0xE8)
+        {
+            i++;
+            continue;
+        }
+
+        const auto position = static_cast<int32_t>(i);
+        const auto absolute = static_cast<int32_t>(get_le32(data + i + 1));
+        if (absolute >= 0)
+        {
+            if (absolute < kLzxE8FileSize)
+                put_le32(data + i + 1, static_cast<uint32_t>(absolute - position));
+        }
+        else if (absolute >= -position)
+            put_le32(data + i + 1, static_cast<uint32_t>(absolute + kLzxE8FileSize));
+
+        i += 5;
+    }
+}
+
+}  // namespace
+
+uint32_t Orc::wof_chunk_size(WofAlgorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case WofAlgorithm::Xpress4K:
+            return 0x1000;
+        case WofAlgorithm::Xpress8K:
+            return 0x2000;
+        case WofAlgorithm::Xpress16K:
+            return 0x4000;
+        case WofAlgorithm::LZX:
+            return 0x8000;
+        default:
+            return 0;
+    }
+}
+
+HRESULT Orc::wof_decompress_chunk(
+    WofAlgorithm algorithm,
+    const uint8_t* src,
+    const size_t src_size,
+    uint8_t* dest,
+    const size_t dest_size)
+{
+    switch (algorithm)
+    {
+        case WofAlgorithm::Xpress4K:
+        case WofAlgorithm::Xpress8K:
+        case WofAlgorithm::Xpress16K:
+            return xpress_huffman_decompress(src, src_size, dest, dest_size);
+        case WofAlgorithm::LZX:
+            return lzx_decompress(src, src_size, dest, dest_size);
+        default:
+            return E_INVALIDARG;
+    }
+}
+
+HRESULT Orc::xpress_huffman_decompress(const uint8_t* src, const size_t src_size, uint8_t* dest, const size_t dest_size)
+{
+    // one Huffman table for each 64K of output: WOF chunks only have one
+    if (dest_size > kXpressBlockSize)
+        return E_INVALIDARG;
+
+    if (src_size < kXpressSymbols / 2)
+        return kInvalidData;
+
+    // 4 bits code length per symbol, low nibble first
+    std::array<uint8_t, kXpressSymbols> lengths;
+    for (unsigned i = 0; i < kXpressSymbols / 2; i++)
+    {
+        lengths[2 * i] = src[i] & 0x0F;
+        lengths[2 * i + 1] = src[i] >> 4;
+    }
+
+    auto decoder = std::make_unique<XpressDecoder>();
+    if (!decoder->Build(lengths.data()))
+        return kInvalidData;
+
+    BitReader reader(src + kXpressSymbols / 2, src + src_size);
+
+    uint8_t* next = dest;
+    uint8_t* const end = dest + dest_size;
+
+    while (next < end)
+    {
+        const auto decoded = decoder->Decode(reader);
+        if (decoded < 0)
+            return kInvalidData;
+
+        if (decoded < 256)
+        {
+            *next++ = static_cast<uint8_t>(decoded);
+            continue;
+        }
+
+        const unsigned symbol = decoded - 256;
+        uint32_t length = symbol & 0x0F;
+        const unsigned offsetBits = symbol >> 4;
+
+        if (length == 0x0F)
+        {
+            if (!reader.ReadByte(length))
+                return kInvalidData;
+
+            if (length == 0xFF)
+            {
+                if (!reader.ReadWord(length) || length < 0x0F)
+                    return kInvalidData;
+                length -= 0x0F;
+            }
+            length += 0x0F;
+        }
+        length += kXpressMinMatch;
+
+        const uint32_t offset = reader.Read(offsetBits) + (1 << offsetBits);
+
+        if (!copy_match(dest, next, end, offset, length))
+            return kInvalidData;
+    }
+
+    if (reader.Overrun())
+        return kInvalidData;
+
+    return S_OK;
+}
+
+HRESULT Orc::lzx_decompress(const uint8_t* src, const size_t src_size, uint8_t* dest, const size_t dest_size)
+{
+    if (dest_size > kLzxDefaultBlockSize)
+        return E_INVALIDARG;
+
+    auto decoder = std::make_unique<LzxDecoder>();
+
+    BitReader reader(src, src + src_size);
+    std::array<uint32_t, kLzxRecentOffsets> recent = {1, 1, 1};
+
+    uint8_t* next = dest;
+    uint8_t* const end = dest + dest_size;
+
+    while (next < end)
+    {
+        const auto blockType = reader.Read(3);
+
+        uint32_t blockSize = kLzxDefaultBlockSize;
+        if (!reader.Read(1))
+            blockSize = reader.Read(16);
+
+        if (blockSize == 0 || blockSize > static_cast<size_t>(end - next))
+            return kInvalidData;
+
+        switch (blockType)
+        {
+            case LzxBlockType::Verbatim:
+            case LzxBlockType::Aligned: {
+                const bool bAligned = blockType == LzxBlockType::Aligned;
+                if (!decoder->ReadCodes(reader, bAligned)
+                    || !decoder->DecodeBlock(reader, bAligned, dest, next, next + blockSize, recent))
+                    return kInvalidData;
+                break;
+            }
+            case LzxBlockType::Uncompressed: {
+                const uint8_t* raw = reader.Align();
+                const uint8_t* const srcEnd = src + src_size;
+
+                if (static_cast<size_t>(srcEnd - raw) < sizeof(uint32_t) * kLzxRecentOffsets + blockSize)
+                    return kInvalidData;
+
+                for (auto& offset : recent)
+                {
+                    offset = get_le32(raw);
+                    raw += sizeof(uint32_t);
+                }
+
+                std::memcpy(next, raw, blockSize);
+                next += blockSize;
+                raw += blockSize;
+
+                // the bit stream resumes on a 16 bits boundary
+                if (blockSize % 2 && raw < srcEnd)
+                    raw++;
+
+                reader.Reset(raw);
+                break;
+            }
+            default:
+                return kInvalidData;
+        }
+
+        if (reader.Overrun())
+            return kInvalidData;
+    }
+
+    lzx_undo_e8_translation(dest, dest_size);
+    return S_OK;
+}
@@ -0,0 +1,44 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Compression formats of the WOF "system compression" provider (FILE_PROVIDER_COMPRESSION_*)
+enum class WofAlgorithm : uint32_t
+{
+    Xpress4K = 0,
+    LZX = 1,
+    Xpress8K = 2,
+    Xpress16K = 3
+};
+
+// Size of the (independently compressed) chunks for the algorithm, 0 if unknown
+uint32_t wof_chunk_size(WofAlgorithm algorithm);
+
+// Decompresses one chunk of a WofCompressedData stream into exactly 'dest_size' bytes.
+// A chunk stored with its uncompressed size is not compressed and must be copied instead.
+HRESULT wof_decompress_chunk(
+    WofAlgorithm algorithm,
+    const uint8_t* src,
+    const size_t src_size,
+    uint8_t* dest,
+    const size_t dest_size);
+
+// Xpress with Huffman coding (MS-XCA)
+HRESULT xpress_huffman_decompress(const uint8_t* src, const size_t src_size, uint8_t* dest, const size_t dest_size);
+
+// LZX with a 32K window and the WIM conventions (no intel header, E8 translation always on)
+HRESULT lzx_decompress(const uint8_t* src, const size_t src_size, uint8_t* dest, const size_t dest_size);
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -0,0 +1,87 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+
+#include "stdafx.h"
+
+#include "YaraScanService.h"
+
+#include "ByteStream.h"
+
+#include "Log/Log.h"
+
+using namespace Orc;
+
+HRESULT YaraScanJob::Run(YaraScanner& scanner)
+{
+    return Complete([this, &scanner]() -> HRESULT {
+        if (m_Stream == nullptr)
+            return E_POINTER;
+
+        if (HRESULT hr = m_Stream->SetFilePointer(0LL, FILE_BEGIN, nullptr); FAILED(hr))
+        {
+            Log::Debug("Failed to seek pointer to 0 for yara scan [{}]", SystemError(hr));
+            return hr;
+        }
+        return scanner.Scan(m_Stream, m_MatchingRules);
+    });
+}
+
+YaraScanService::YaraScanService(YaraScanner& scanner, const Options& options)
+{
+    DWORD dwWorkers = options.dwWorkers;
+    if (dwWorkers == 0L)
+        dwWorkers = JobPool<Job>::DefaultWorkers();
+
+    // the scanners are created here, the compiled rules are only read by the workers
+    for (DWORD i = 0; i < dwWorkers; i++)
+    {
+        auto workerScanner = std::make_unique<YaraScanner>();
+        if (HRESULT hr = workerScanner->InitializeFrom(scanner); FAILED(hr))
+        {
+            Log::Error("Failed to create yara scanner for worker #{} [{}]", i, SystemError(hr));
+            break;
+        }
+        m_Scanners.push_back(std::move(workerScanner));
+    }
+
+    // each worker scans with its own scanner
+    m_Pool.Start(static_cast<DWORD>(m_Scanners.size()), [this](Job& job, DWORD dwWorker) {
+        if (FAILED(job.Run(*m_Scanners[dwWorker])))
+            m_ullFailedJobs++;
+        else if (!job.MatchingRules().empty())
+            m_ullMatchingJobs++;
+    });
+
+    Log::Debug("Yara scan service started with {} workers", m_Pool.GetWorkers());
+}
+
+YaraScanService::~YaraScanService()
+{
+    // the jobs queued before are still run
+    m_Pool.Stop();
+
+    Log::Debug(
+        "Yara scan service: {} jobs ({} failed, {} matching)",
+        m_Pool.GetSubmittedJobs(),
+        m_ullFailedJobs.load(),
+        m_ullMatchingJobs.load());
+}
+
+std::shared_ptr<YaraScanJob> YaraScanService::Submit(std::shared_ptr<ByteStream> stream)
+{
+    auto job = std::make_shared<Job>(std::move(stream));
+    m_Pool.Submit(job);
+    return job;
+}
+
+YaraScanService::Statistics YaraScanService::GetStatistics() const
+{
+    Statistics statistics;
+    statistics.ullJobs = m_Pool.GetSubmittedJobs();
+    statistics.ullFailedJobs = m_ullFailedJobs;
+    statistics.ullMatchingJobs = m_ullMatchingJobs;
+    return statistics;
+}
@@ -0,0 +1,81 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#pragma once
+
+#include "OrcLib.h"
+
+#include "JobPool.h"
+#include "YaraScanner.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#pragma managed(push, off)
+
+namespace Orc {
+
+// Yara scan of one data stream, run by a worker of a YaraScanService
+class ORCLIB_API YaraScanJob : public StreamJob
+{
+public:
+    YaraScanJob(std::shared_ptr<ByteStream> stream)
+        : StreamJob(std::move(stream))
+    {
+    }
+
+    // Valid once the job is done
+    const MatchingRuleCollection& MatchingRules() const { return m_MatchingRules; }
+
+    // Scans the stream on the calling thread
+    HRESULT Run(YaraScanner& scanner);
+
+private:
+    MatchingRuleCollection m_MatchingRules;
+};
+
+// Scans data streams with the rules of one YaraScanner on a bounded pool of workers, each with its own yara scanner.
+// The caller keeps the jobs it submits and collects their matching rules once they are done.
+class ORCLIB_API YaraScanService
+{
+public:
+    using Job = YaraScanJob;
+
+    struct Options
+    {
+        DWORD dwWorkers = 0L;  // 0: one per logical processor, the caller's excepted
+    };
+
+    struct Statistics
+    {
+        ULONGLONG ullJobs = 0LL;
+        ULONGLONG ullFailedJobs = 0LL;
+        ULONGLONG ullMatchingJobs = 0LL;
+    };
+
+    // 'scanner' holds the compiled rules, its enabled rules must no longer change
+    YaraScanService(YaraScanner& scanner, const Options& options = Options());
+    ~YaraScanService();
+
+    // Queues the scan of 'stream' (which must not be used by any other thread until the job is done)
+    std::shared_ptr<Job> Submit(std::shared_ptr<ByteStream> stream);
+
+    // Number of workers actually started (0 if no yara scanner could be created)
+    DWORD GetWorkers() const { return m_Pool.GetWorkers(); }
+    Statistics GetStatistics() const;
+
+private:
+    std::vector<std::unique_ptr<YaraScanner>> m_Scanners;
+
+    JobPool<Job> m_Pool;
+
+    std::atomic<ULONGLONG> m_ullFailedJobs = 0LL;
+    std::atomic<ULONGLONG> m_ullMatchingJobs = 0LL;
+};
+
+}  // namespace Orc
+
+#pragma managed(pop)
@@ -23,8 +23,265 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <array>
+
+#include <ppl.h>
+
 using namespace Orc;
 
+namespace {
+
+HRESULT ScanResult(int result)
+{
+    switch (result)
+    {
+        case ERROR_SUCCESS:
+            return S_OK;
+        case ERROR_INSUFFICIENT_MEMORY:
+            return E_OUTOFMEMORY;
+        case ERROR_TOO_MANY_SCAN_THREADS:
+            Log::Error(L"Too many scan threads");
+            return E_FAIL;
+        case ERROR_SCAN_TIMEOUT:
+            Log::Error(L"Yara scan timeout");
+            return HRESULT_FROM_WIN32(ERROR_TIMEOUT);
+        case ERROR_CALLBACK_ERROR:
+            Log::Error(L"Yara callback return an error");
+            return E_FAIL;
+        case ERROR_TOO_MANY_MATCHES:
+            Log::Error(L"Too many matches in yara scan");
+            return S_OK;
+        default:
+            Log::Error(L"Undefined error code");
+            return E_FAIL;
+    }
+}
+
+//
+// Memory blocks of a stream for yr_rules_scan_mem_blocks: block N is the Nth chunk of 'blockSize' bytes followed by
+// the first 'overlapSize' bytes of the next chunk, so that matches across chunks are not missed.
+//
+// Chunks are read once, in order, directly into a pool of three buffers: the chunk of the block being scanned, the
+// next one (for the overlap) and the one after, read ahead while yara scans. Blocks fetched again once they have left
+// the pool (offset reads from conditions) are read back from the stream.
+//
+class YaraStreamBlocks
+{
+public:
+    YaraStreamBlocks(std::shared_ptr<ByteStream> stream, ULONG blockSize, ULONG overlapSize)
+        : m_Stream(std::move(stream))
+        , m_ullSize(m_Stream->GetSize())
+        , m_BlockSize(blockSize)
+        , m_OverlapSize(std::min(overlapSize, blockSize))
+        , m_ullChunks((m_ullSize + blockSize - 1) / blockSize)
+    {
+        m_Iterator.context = this;
+        m_Iterator.first = First;
+        m_Iterator.next = Next;
+#if YR_MAJOR_VERSION > 4 || (YR_MAJOR_VERSION == 4 && YR_MINOR_VERSION >= 1)
+        m_Iterator.file_size = FileSize;
+#endif
+    }
+
+    ~YaraStreamBlocks() { m_ReadAhead.wait(); }
+
+    YR_MEMORY_BLOCK_ITERATOR* Iterator() { return &m_Iterator; }
+
+    HRESULT GetResult() const { return m_hr; }
+    ULONGLONG GetBytesRead() const { return m_ullBytesRead; }
+
+private:
+    struct Chunk
+    {
+        ULONGLONG ullIndex = MAXULONGLONG;
+        ULONG cbData = 0L;
+        bool bOverlap = false;
+        CBinaryBuffer buffer {true};
+    };
+
+    static YR_MEMORY_BLOCK* First(YR_MEMORY_BLOCK_ITERATOR* iterator)
+    {
+        auto pThis = static_cast<YaraStreamBlocks*>(iterator->context);
+        pThis->m_ullCurrent = 0LL;
+        return pThis->Block(pThis->m_ullCurrent);
+    }
+
+    static YR_MEMORY_BLOCK* Next(YR_MEMORY_BLOCK_ITERATOR* iterator)
+    {
+        auto pThis = static_cast<YaraStreamBlocks*>(iterator->context);
+        return pThis->Block(++pThis->m_ullCurrent);
+    }
+
+    static uint64_t FileSize(YR_MEMORY_BLOCK_ITERATOR* iterator)
+    {
+        return static_cast<YaraStreamBlocks*>(iterator->context)->m_ullSize;
+    }
+
+    static const uint8_t* FetchData(YR_MEMORY_BLOCK* block)
+    {
+        auto pThis = static_cast<YaraStreamBlocks*>(block->context);
+        return pThis->Fetch(block->base / pThis->m_BlockSize);
+    }
+
+    YR_MEMORY_BLOCK* Block(ULONGLONG ullIndex)
+    {
+        if (ullIndex >= m_ullChunks)
+            return nullptr;
+
+        m_Block.base = ullIndex * m_BlockSize;
+        m_Block.size = static_cast<size_t>(std::min<ULONGLONG>(m_BlockSize + m_OverlapSize, m_ullSize - m_Block.base));
+        m_Block.context = this;
+        m_Block.fetch_data = FetchData;
+        return &m_Block;
+    }
+
+    ULONG BlockSize(ULONGLONG ullIndex) const
+    {
+        return static_cast<ULONG>(
+            std::min<ULONGLONG>(m_BlockSize + m_OverlapSize, m_ullSize - ullIndex * m_BlockSize));
+    }
+
+    HRESULT Read(ULONGLONG ullOffset, ULONG cbToRead, Chunk& chunk)
+    {
+        HRESULT hr = E_FAIL;
+
+        if (chunk.buffer.GetCount() < m_BlockSize + m_OverlapSize)
+        {
+            if (!chunk.buffer.SetCount(m_BlockSize + m_OverlapSize))
+                return E_OUTOFMEMORY;
+        }
+
+        if (FAILED(hr = m_Stream->SetFilePointer(ullOffset, FILE_BEGIN, NULL)))
+        {
+            Log::Error("Failed to move inside stream for yara scan [{}]", SystemError(hr));
+            return hr;
+        }
+
+        ULONG cbRead = 0L;
+        while (cbRead < cbToRead)
+        {
+            ULONGLONG ullBytesRead = 0LL;
+            if (FAILED(hr = m_Stream->Read(chunk.buffer.GetP<BYTE>(cbRead), cbToRead - cbRead, &ullBytesRead)))
+            {
+                Log::Error("Failed to read {} bytes from stream for yara scan [{}]", cbToRead, SystemError(hr));
+                return hr;
+            }
+            if (ullBytesRead == 0)
+                break;
+            cbRead += static_cast<ULONG>(ullBytesRead);
+        }
+
+        if (cbRead < cbToRead)
+        {
+            // (potentially unexpected) end of stream: yara is told about blocks of the size announced by the stream
+            Log::Debug("Stream ended {} bytes short of its size during yara scan", cbToRead - cbRead);
+            ZeroMemory(chunk.buffer.GetP<BYTE>(cbRead), cbToRead - cbRead);
+        }
+
+        m_ullBytesRead += cbRead;
+        chunk.cbData = cbToRead;
+        return S_OK;
+    }
+
+    // Reads the next chunk in order into the buffer of the chunk three places before
+    HRESULT ReadNextChunk()
+    {
+        const auto ullIndex = m_ullChunksRead;
+        auto& chunk = m_Pool[ullIndex % m_Pool.size()];
+
+        chunk.ullIndex = MAXULONGLONG;
+        chunk.bOverlap = false;
+
+        const auto cbChunk = static_cast<ULONG>(std::min<ULONGLONG>(m_BlockSize, m_ullSize - ullIndex * m_BlockSize));
+        if (HRESULT hr = Read(ullIndex * m_BlockSize, cbChunk, chunk); FAILED(hr))
+            return hr;
+
+        chunk.ullIndex = ullIndex;
+        m_ullChunksRead++;
+        return S_OK;
+    }
+
+    void WaitReadAhead()
+    {
+        if (m_bReadingAhead)
+        {
+            m_ReadAhead.wait();
+            m_bReadingAhead = false;
+        }
+    }
+
+    const uint8_t* Fetch(ULONGLONG ullIndex)
+    {
+        if (ullIndex >= m_ullChunks)
+            return nullptr;
+
+        WaitReadAhead();
+        if (FAILED(m_hr))
+            return nullptr;
+
+        if (ullIndex + m_Pool.size() <= m_ullChunksRead)
+        {
+            // This block already left the pool
+            if (m_Fetched.ullIndex != ullIndex)
+            {
+                m_Fetched.ullIndex = MAXULONGLONG;
+                if (FAILED(m_hr = Read(ullIndex * m_BlockSize, BlockSize(ullIndex), m_Fetched)))
+                    return nullptr;
+                m_Fetched.ullIndex = ullIndex;
+            }
+            return m_Fetched.buffer.GetP<uint8_t>();
+        }
+
+        const auto ullLast = std::min(ullIndex + 1, m_ullChunks - 1);
+        while (m_ullChunksRead <= ullLast)
+        {
+            if (FAILED(m_hr = ReadNextChunk()))
+                return nullptr;
+        }
+
+        auto& chunk = m_Pool[ullIndex % m_Pool.size()];
+        if (!chunk.bOverlap && ullLast > ullIndex)
+        {
+            const auto& next = m_Pool[ullLast % m_Pool.size()];
+            const auto cbOverlap = std::min(m_OverlapSize, next.cbData);
+            CopyMemory(chunk.buffer.GetP<BYTE>(chunk.cbData), next.buffer.GetP<BYTE>(), cbOverlap);
+            chunk.cbData += cbOverlap;
+        }
+        chunk.bOverlap = true;
+
+        // The chunk after next goes where the previous block was: yara is done with it
+        if (m_ullChunksRead == ullIndex + 2 && m_ullChunksRead < m_ullChunks)
+        {
+            m_bReadingAhead = true;
+            m_ReadAhead.run([this]() { m_hr = ReadNextChunk(); });
+        }
+
+        return chunk.buffer.GetP<uint8_t>();
+    }
+
+    std::shared_ptr<ByteStream> m_Stream;
+    const ULONGLONG m_ullSize;
+    const ULONG m_BlockSize;
+    const ULONG m_OverlapSize;
+    const ULONGLONG m_ullChunks;
+
+    YR_MEMORY_BLOCK_ITERATOR m_Iterator = {};
+    YR_MEMORY_BLOCK m_Block = {};
+    ULONGLONG m_ullCurrent = 0LL;
+
+    std::array<Chunk, 3> m_Pool;
+    ULONGLONG m_ullChunksRead = 0LL;
+    Chunk m_Fetched;
+
+    concurrency::task_group m_ReadAhead;
+    bool m_bReadingAhead = false;
+
+    HRESULT m_hr = S_OK;
+    ULONGLONG m_ullBytesRead = 0LL;
+};
+
+}  // namespace
+
 Orc::YaraConfig Orc::YaraConfig::Get(const ConfigItem& item)
 {
     HRESULT hr = E_FAIL;
@@ -93,6 +350,15 @@ Orc::YaraConfig Orc::YaraConfig::Get(const ConfigItem& item)
         }
     }
 
+    if (item[CONFIG_YARA_SCAN_WORKERS])
+    {
+        DWORD workers = 0L;
+        if (SUCCEEDED(GetIntegerFromArg(item[CONFIG_YARA_SCAN_WORKERS].c_str(), workers)))
+        {
+            retval.SetScanWorkers(workers);
+        }
+    }
+
     retval._isValid = true;
     return retval;
 }
@@ -103,6 +369,8 @@ HRESULT Orc::YaraConfig::SetScanMethod(const std::wstring& strMethod)
         _scanMethod = YaraScanMethod::Blocks;
     else if (!_wcsicmp(strMethod.c_str(), L"filemapping"))
         _scanMethod = YaraScanMethod::FileMapping;
+    else if (!_wcsicmp(strMethod.c_str(), L"stream"))
+        _scanMethod = YaraScanMethod::Stream;
     else
         return E_INVALIDARG;
     return S_OK;
@@ -136,6 +404,33 @@ HRESULT Orc::YaraScanner::Initialize(bool bWithCompiler)
     return S_OK;
 }
 
+HRESULT Orc::YaraScanner::InitializeFrom(YaraScanner& compiled)
+{
+    if (!compiled.m_yara)
+        return E_POINTER;
+
+    YR_RULES* pRules = compiled.GetRules();
+    if (!pRules)
+    {
+        Log::Error(L"No compiled rules to scan with");
+        return E_FAIL;
+    }
+
+    m_yara = compiled.m_yara;
+    m_config = compiled.m_config;
+    m_pRules = pRules;
+    m_bOwnsRules = false;
+
+    if (auto err = m_yara->yr_scanner_create(m_pRules, &m_pScanner); err != ERROR_SUCCESS)
+    {
+        Log::Error(L"Failed to create yara scanner (error: {})", err);
+        return ScanResult(err);
+    }
+
+    m_yara->yr_scanner_set_timeout(m_pScanner, (int)std::chrono::seconds(m_config.timeOut()).count());
+    return S_OK;
+}
+
 HRESULT Orc::YaraScanner::Configure(std::unique_ptr<YaraConfig>& config)
 {
     if (config && config->isValid())
@@ -238,6 +533,28 @@ HRESULT Orc::YaraScanner::AddRules(CBinaryBuffer& buffer)
     m_ErrorCount = 0;
     m_WarningCount = 0;
 
+    if (IsCompiledRules(buffer))
+    {
+        if (m_pRules || m_ulCompiledSources > 0)
+        {
+            Log::Error("Compiled yara rules cannot be combined with other rules");
+            return E_INVALIDARG;
+        }
+
+        auto memstream = std::make_shared<MemoryStream>();
+        HRESULT hr = memstream->OpenForReadOnly(buffer.GetData(), buffer.GetCount());
+        if (FAILED(hr))
+            return hr;
+
+        return LoadRules(*memstream);
+    }
+
+    if (m_pRules)
+    {
+        Log::Error("Yara rules cannot be added to compiled rules");
+        return E_INVALIDARG;
+    }
+
     // we need to make sure that buffer is null terminated because libyara heavily relies on this
     if (buffer.Get<UCHAR>(buffer.GetCount<UCHAR>() - sizeof(UCHAR)) != '\0')
     {
@@ -253,6 +570,47 @@ HRESULT Orc::YaraScanner::AddRules(CBinaryBuffer& buffer)
         return E_INVALIDARG;
     }
 
+    m_ulCompiledSources++;
+    return S_OK;
+}
+
+bool Orc::YaraScanner::IsCompiledRules(const CBinaryBuffer& buffer)
+{
+    // compiled rules start with the yara arena's magic
+    return buffer.GetCount() > 4 && !memcmp(buffer.GetData(), "YARA", 4);
+}
+
+HRESULT Orc::YaraScanner::LoadRules(ByteStream& stream)
+{
+    auto yrStream = GetYaraStream(stream);
+
+    YR_RULES* pRules = nullptr;
+    if (auto err = m_yara->yr_rules_load_stream(&yrStream, &pRules); err != ERROR_SUCCESS)
+    {
+        Log::Error("Failed to load compiled yara rules (error: {})", err);
+        return err == ERROR_INSUFFICIENT_MEMORY ? E_OUTOFMEMORY : HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+    }
+
+    m_pRules = pRules;
+    m_bOwnsRules = true;
+    return S_OK;
+}
+
+HRESULT Orc::YaraScanner::SaveRules(const std::shared_ptr<ByteStream>& stream)
+{
+    YR_RULES* pRules = GetRules();
+    if (!pRules)
+    {
+        Log::Error("No compiled rules to save");
+        return E_FAIL;
+    }
+
+    auto yrStream = GetYaraStream(*stream);
+    if (auto err = m_yara->yr_rules_save_stream(pRules, &yrStream); err != ERROR_SUCCESS)
+    {
+        Log::Error("Failed to save compiled yara rules (error: {})", err);
+        return E_FAIL;
+    }
     return S_OK;
 }
 
@@ -294,7 +652,11 @@ YR_RULES* Orc::YaraScanner::GetRules()
     if (m_pRules)
         return m_pRules;
 
-    m_yara->yr_compiler_get_rules(m_pCompiler, &m_pRules);
+    if (!m_pCompiler)
+        return nullptr;
+
+    if (m_yara->yr_compiler_get_rules(m_pCompiler, &m_pRules) == ERROR_SUCCESS)
+        m_bOwnsRules = true;
 
     return m_pRules;
 }
@@ -426,39 +788,54 @@ HRESULT Orc::YaraScanner::Scan(const CBinaryBuffer& buffer, ULONG bytesToScan, M
     if (bytesToScan == 0)
         return S_OK;
 
-    YR_RULES* pRules = GetRules();
+    return ScanMem(buffer.GetP<const uint8_t>(), bytesToScan, matchingRules);
+}
 
+HRESULT Orc::YaraScanner::ScanMem(const uint8_t* buffer, size_t bufferSize, MatchingRuleCollection& matchingRules)
+{
     auto scan_details = std::make_pair(this, &matchingRules);
 
-    switch (m_yara->yr_rules_scan_mem(
+    if (m_pScanner)
+    {
+        m_yara->yr_scanner_set_callback(m_pScanner, scan_callback, &scan_details);
+        return ScanResult(m_yara->yr_scanner_scan_mem(m_pScanner, buffer, bufferSize));
+    }
+
+    YR_RULES* pRules = GetRules();
+    if (!pRules)
+        return E_FAIL;
+
+    return ScanResult(m_yara->yr_rules_scan_mem(
         pRules,
-        buffer.GetP<const uint8_t>(),
-        bytesToScan,
+        buffer,
+        bufferSize,
         0,
         scan_callback,
         &scan_details,
-        (int)std::chrono::seconds(m_config.timeOut()).count()))
+        (int)std::chrono::seconds(m_config.timeOut()).count()));
+}
+
+HRESULT Orc::YaraScanner::ScanMemBlocks(YR_MEMORY_BLOCK_ITERATOR* iterator, MatchingRuleCollection& matchingRules)
+{
+    auto scan_details = std::make_pair(this, &matchingRules);
+
+    if (m_pScanner)
     {
-        case ERROR_SUCCESS:
-            return S_OK;
-        case ERROR_INSUFFICIENT_MEMORY:
-            return E_OUTOFMEMORY;
-        case ERROR_TOO_MANY_SCAN_THREADS:
-            Log::Error(L"Too many scan threads");
-            return E_FAIL;
-        case ERROR_SCAN_TIMEOUT:
-            Log::Error(L"Yara scan timeout");
-            return HRESULT_FROM_WIN32(ERROR_TIMEOUT);
-        case ERROR_CALLBACK_ERROR:
-            Log::Error(L"Yara callback return an error");
-            return E_FAIL;
-        case ERROR_TOO_MANY_MATCHES:
-            Log::Error(L"Too many matches in yara scan");
-            return S_OK;
-        default:
-            Log::Error(L"Undefined error code");
-            return E_FAIL;
+        m_yara->yr_scanner_set_callback(m_pScanner, scan_callback, &scan_details);
+        return ScanResult(m_yara->yr_scanner_scan_mem_blocks(m_pScanner, iterator));
     }
+
+    YR_RULES* pRules = GetRules();
+    if (!pRules)
+        return E_FAIL;
+
+    return ScanResult(m_yara->yr_rules_scan_mem_blocks(
+        pRules,
+        iterator,
+        0,
+        scan_callback,
+        &scan_details,
+        (int)std::chrono::seconds(m_config.timeOut()).count()));
 }
 
 HRESULT Orc::YaraScanner::Scan(const std::shared_ptr<ByteStream>& stream, MatchingRuleCollection& matchingRules)
@@ -488,6 +865,8 @@ HRESULT Orc::YaraScanner::Scan(const std::shared_ptr<ByteStream>& stream, Matchi
                 ULONG ulBytesScanned = 0;
                 return ScanFileMapping(stream, matchingRules, ulBytesScanned);
             }
+            case YaraScanMethod::Stream:
+                return ScanStream(stream, matchingRules);
             default:
                 return E_UNEXPECTED;
         }
@@ -596,6 +975,27 @@ HRESULT Orc::YaraScanner::ScanFileMapping(
     return S_OK;
 }
 
+HRESULT Orc::YaraScanner::ScanStream(const std::shared_ptr<ByteStream>& stream, MatchingRuleCollection& matchingRules)
+{
+    HRESULT hr = E_FAIL;
+
+    YaraStreamBlocks blocks(stream, m_config.blockSize(), m_config.overlapSize());
+
+    if (FAILED(hr = ScanMemBlocks(blocks.Iterator(), matchingRules)))
+    {
+        Log::Error("Stream yara scan failed [{}]", SystemError(hr));
+        return hr;
+    }
+
+    if (FAILED(hr = blocks.GetResult()))
+    {
+        Log::Error("Failed to read stream for yara scan (read: {}) [{}]", blocks.GetBytesRead(), SystemError(hr));
+        return hr;
+    }
+
+    return S_OK;
+}
+
 HRESULT Orc::YaraScanner::Scan(
     const std::shared_ptr<ByteStream>& stream,
     ULONG blockSize,
@@ -703,6 +1103,16 @@ HRESULT Orc::YaraScanner::PrintConfiguration()
 
 Orc::YaraScanner::~YaraScanner()
 {
+    if (m_pScanner)
+    {
+        m_yara->yr_scanner_destroy(m_pScanner);
+        m_pScanner = nullptr;
+    }
+    if (m_pRules && m_bOwnsRules)
+    {
+        m_yara->yr_rules_destroy(m_pRules);
+    }
+    m_pRules = nullptr;
     if (m_pCompiler)
     {
         m_yara->yr_compiler_destroy(m_pCompiler);
@@ -768,7 +1178,7 @@ size_t Orc::YaraScanner::read(void* ptr, size_t size, size_t count, void* user_d
 {
     auto pStream = (ByteStream*)user_data;
 
-    if (!pStream || !pStream->IsOpen() || !pStream->CanRead() == S_OK)
+    if (!pStream || pStream->IsOpen() != S_OK || pStream->CanRead() != S_OK || size == 0)
         return 0;
 
     ULONGLONG cbBytesRead = 0LL;
@@ -777,14 +1187,15 @@ size_t Orc::YaraScanner::read(void* ptr, size_t size, size_t count, void* user_d
     {
         return 0;
     }
-    return (size_t)cbBytesRead;
+    // like fread, the count of complete items read
+    return (size_t)(cbBytesRead / size);
 }
 
 size_t Orc::YaraScanner::write(const void* ptr, size_t size, size_t count, void* user_data)
 {
     auto pStream = (ByteStream*)user_data;
 
-    if (!pStream || !pStream->IsOpen() || !pStream->CanWrite() == S_OK)
+    if (!pStream || pStream->IsOpen() != S_OK || pStream->CanWrite() != S_OK || size == 0)
         return 0;
 
     ULONGLONG cbBytesWritten = 0LL;
@@ -793,14 +1204,10 @@ size_t Orc::YaraScanner::write(const void* ptr, size_t size, size_t count, void*
     {
         return 0;
     }
-    return (size_t)cbBytesWritten;
+    // like fwrite, the count of complete items written
+    return (size_t)(cbBytesWritten / size);
 }
 
-struct YaraStream : YR_STREAM
-{
-    std::shared_ptr<ByteStream> byteStream;
-};
-
 std::pair<HRESULT, std::shared_ptr<MemoryStream>>
 Orc::YaraScanner::GetMemoryStream(const std::shared_ptr<ByteStream>& byteStream)
 {
@@ -838,14 +1245,13 @@ Orc::YaraScanner::GetMemoryStream(const std::shared_ptr<ByteStream>& byteStream)
     return std::make_pair(S_OK, memstream);
 }
 
-std::unique_ptr<YR_STREAM> Orc::YaraScanner::GetYaraStream(const std::shared_ptr<ByteStream>& byteStream)
+YR_STREAM Orc::YaraScanner::GetYaraStream(ByteStream& byteStream)
 {
-    auto retval = std::unique_ptr<YaraStream>();
+    YR_STREAM retval = {};
 
-    retval->read = YaraScanner::read;
-    retval->write = YaraScanner::write;
-    retval->byteStream = byteStream;
-    retval->user_data = retval->byteStream.operator->();
+    retval.read = YaraScanner::read;
+    retval.write = YaraScanner::write;
+    retval.user_data = &byteStream;
 
     return retval;
 }
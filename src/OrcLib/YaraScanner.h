@@ -29,7 +29,8 @@ class YaraScanner;
 enum class YaraScanMethod
 {
     Blocks,
-    FileMapping
+    FileMapping,
+    Stream  // one sequential pass over the stream, read ahead in a bounded pool of blocks
 };
 
 class YaraConfig
@@ -79,6 +80,16 @@ public:
 
     YaraScanMethod ScanMethod() const { return _scanMethod.value_or(YaraScanMethod::Blocks); }
 
+    HRESULT SetScanWorkers(DWORD dwWorkers)
+    {
+        _scanWorkers.emplace(dwWorkers);
+        return S_OK;
+    }
+    DWORD scanWorkers() const
+    {
+        return _scanWorkers.value_or(0L);  // Default to scanning on the caller's thread
+    }
+
     bool isValid() const
     {
         if (!_isValid)
@@ -108,6 +119,7 @@ private:
     std::optional<ULONG> _overlapSize;
     std::vector<std::wstring> _Sources;
     std::optional<YaraScanMethod> _scanMethod;
+    std::optional<DWORD> _scanWorkers;
 };
 
 class YaraScanner
@@ -116,12 +128,21 @@ public:
     YaraScanner() {}
 
     HRESULT Initialize(bool bWithCompiler = true);
+
+    // Scans with the rules compiled (and enabled) in 'compiled' through its own yara scanner: one such scanner per
+    // thread lets several threads scan at once. 'compiled' must outlive it and its rules must no longer change.
+    HRESULT InitializeFrom(YaraScanner& compiled);
     HRESULT Configure(std::unique_ptr<YaraConfig>& config);
+    const YaraConfig& Config() const { return m_config; }
 
     HRESULT AddRules(const std::wstring& yara_content_spec);
     HRESULT AddRules(const std::shared_ptr<ByteStream>& stream);
     HRESULT AddRules(CBinaryBuffer& buffer);
 
+    // Compiled rules, as yarac saves them: they can be given back to AddRules (alone, from a file or a resource)
+    HRESULT SaveRules(const std::shared_ptr<ByteStream>& stream);
+    static bool IsCompiledRules(const CBinaryBuffer& buffer);
+
     HRESULT EnableRule(LPCSTR strRule);
     HRESULT DisableRule(LPCSTR strRule);
 
@@ -210,9 +231,15 @@ private:
         const std::shared_ptr<ByteStream>& stream,
         MatchingRuleCollection& matchingRules,
         ULONG& bytesScanned);
+    HRESULT ScanStream(const std::shared_ptr<ByteStream>& stream, MatchingRuleCollection& matchingRules);
+
+    HRESULT ScanMem(const uint8_t* buffer, size_t bufferSize, MatchingRuleCollection& matchingRules);
+    HRESULT ScanMemBlocks(YR_MEMORY_BLOCK_ITERATOR* iterator, MatchingRuleCollection& matchingRules);
 
     std::pair<HRESULT, std::shared_ptr<MemoryStream>> GetMemoryStream(const std::shared_ptr<ByteStream>& byteStream);
-    std::unique_ptr<YR_STREAM> GetYaraStream(const std::shared_ptr<ByteStream>& byteStream);
+    static YR_STREAM GetYaraStream(ByteStream& byteStream);
+
+    HRESULT LoadRules(ByteStream& stream);
 
     YR_RULES* GetRules();
 
@@ -222,6 +249,10 @@ private:
 
     YR_COMPILER* m_pCompiler = nullptr;
     YR_RULES* m_pRules = nullptr;
+    bool m_bOwnsRules = false;
+    YR_SCANNER* m_pScanner = nullptr;  // only for scanners initialized from compiled ones
+
+    ULONG m_ulCompiledSources = 0L;
     ULONG m_ErrorCount = 0;
     ULONG m_WarningCount = 0;
 };
@@ -49,6 +49,21 @@ int YaraStaticExtension::yr_compiler_get_rules(YR_COMPILER* compiler, YR_RULES**
     return ::yr_compiler_get_rules(compiler, rules);
 }
 
+int YaraStaticExtension::yr_rules_save_stream(YR_RULES* rules, YR_STREAM* stream)
+{
+    return ::yr_rules_save_stream(rules, stream);
+}
+
+int YaraStaticExtension::yr_rules_load_stream(YR_STREAM* stream, YR_RULES** rules)
+{
+    return ::yr_rules_load_stream(stream, rules);
+}
+
+int YaraStaticExtension::yr_rules_destroy(YR_RULES* rules)
+{
+    return ::yr_rules_destroy(rules);
+}
+
 void YaraStaticExtension::yr_compiler_destroy(YR_COMPILER* compiler)
 {
     ::yr_compiler_destroy(compiler);
@@ -76,6 +91,47 @@ int YaraStaticExtension::yr_rules_scan_mem(
     return ::yr_rules_scan_mem(rules, buffer, buffer_size, flags, callback, user_data, timeout);
 }
 
+int YaraStaticExtension::yr_rules_scan_mem_blocks(
+    YR_RULES* rules,
+    YR_MEMORY_BLOCK_ITERATOR* iterator,
+    int flags,
+    YR_CALLBACK_FUNC callback,
+    void* user_data,
+    int timeout)
+{
+    return ::yr_rules_scan_mem_blocks(rules, iterator, flags, callback, user_data, timeout);
+}
+
+int YaraStaticExtension::yr_scanner_create(YR_RULES* rules, YR_SCANNER** scanner)
+{
+    return ::yr_scanner_create(rules, scanner);
+}
+
+void YaraStaticExtension::yr_scanner_set_callback(YR_SCANNER* scanner, YR_CALLBACK_FUNC callback, void* user_data)
+{
+    ::yr_scanner_set_callback(scanner, callback, user_data);
+}
+
+void YaraStaticExtension::yr_scanner_set_timeout(YR_SCANNER* scanner, int timeout)
+{
+    ::yr_scanner_set_timeout(scanner, timeout);
+}
+
+int YaraStaticExtension::yr_scanner_scan_mem(YR_SCANNER* scanner, const uint8_t* buffer, size_t buffer_size)
+{
+    return ::yr_scanner_scan_mem(scanner, buffer, buffer_size);
+}
+
+int YaraStaticExtension::yr_scanner_scan_mem_blocks(YR_SCANNER* scanner, YR_MEMORY_BLOCK_ITERATOR* iterator)
+{
+    return ::yr_scanner_scan_mem_blocks(scanner, iterator);
+}
+
+void YaraStaticExtension::yr_scanner_destroy(YR_SCANNER* scanner)
+{
+    ::yr_scanner_destroy(scanner);
+}
+
 int YaraStaticExtension::yr_finalize()
 {
     return ::yr_finalize();
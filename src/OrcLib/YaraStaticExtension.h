@@ -32,6 +32,10 @@ public:
 
     int yr_compiler_get_rules(YR_COMPILER* compiler, YR_RULES** rules);
 
+    int yr_rules_save_stream(YR_RULES* rules, YR_STREAM* stream);
+    int yr_rules_load_stream(YR_STREAM* stream, YR_RULES** rules);
+    int yr_rules_destroy(YR_RULES* rules);
+
     void yr_compiler_destroy(YR_COMPILER* compiler);
 
     void yr_rule_enable(YR_RULE* rule);
@@ -46,6 +50,21 @@ public:
         void* user_data,
         int timeout);
 
+    int yr_rules_scan_mem_blocks(
+        YR_RULES* rules,
+        YR_MEMORY_BLOCK_ITERATOR* iterator,
+        int flags,
+        YR_CALLBACK_FUNC callback,
+        void* user_data,
+        int timeout);
+
+    int yr_scanner_create(YR_RULES* rules, YR_SCANNER** scanner);
+    void yr_scanner_set_callback(YR_SCANNER* scanner, YR_CALLBACK_FUNC callback, void* user_data);
+    void yr_scanner_set_timeout(YR_SCANNER* scanner, int timeout);
+    int yr_scanner_scan_mem(YR_SCANNER* scanner, const uint8_t* buffer, size_t buffer_size);
+    int yr_scanner_scan_mem_blocks(YR_SCANNER* scanner, YR_MEMORY_BLOCK_ITERATOR* iterator);
+    void yr_scanner_destroy(YR_SCANNER* scanner);
+
     int yr_finalize(void);
 };
 
@@ -106,11 +106,16 @@ ZipCreate::CompressionLevel ZipCreate::GetCompressionLevel(const std::wstring& s
     return ZipCreate::CompressionLevel::Fast;
 }
 
-HRESULT ZipCreate::SetCompressionLevel(const CComPtr<IOutArchive>& pArchiver, CompressionLevel level)
+HRESULT ZipCreate::SetArchiverProperties(const CComPtr<IOutArchive>& pArchiver)
 {
     HRESULT hr = E_FAIL;
 
-    Log::Debug(L"ZipCreate: {}: set compression level to {}", m_ArchiveName, level);
+    Log::Debug(
+        L"ZipCreate: {}: set compression level to {} (threads: {}, block size: {})",
+        m_ArchiveName,
+        m_CompressionLevel,
+        m_dwCompressionThreads,
+        m_ullBlockSize);
 
     if (!pArchiver)
     {
@@ -118,9 +123,21 @@ HRESULT ZipCreate::SetCompressionLevel(const CComPtr<IOutArchive>& pArchiver, Co
         return E_POINTER;
     }
 
-    const size_t numProps = 1;
-    const wchar_t* names[numProps] = {L"x"};
-    CPropVariant values[numProps] = {static_cast<UInt32>(level)};  // test with
+    std::vector<const wchar_t*> names = {L"x"};
+    std::vector<CPropVariant> values = {static_cast<UInt32>(m_CompressionLevel)};
+
+    if (m_dwCompressionThreads != 0L)
+    {
+        names.push_back(L"mt");
+        values.push_back(static_cast<UInt32>(m_dwCompressionThreads));
+    }
+
+    // LZMA2 compresses blocks of this size in parallel (32 bits for older lib7z), deflate has no such setting
+    if (m_ullBlockSize != 0LL && m_FormatGUID == CLSID_CFormat7z)
+    {
+        names.push_back(L"c");
+        values.push_back(static_cast<UInt32>(std::min<ULONGLONG>(m_ullBlockSize, UINT32_MAX)));
+    }
 
     CComPtr<ISetProperties> setter;
     if (FAILED(hr = pArchiver->QueryInterface(IID_ISetProperties, reinterpret_cast<void**>(&setter))))
@@ -129,7 +146,7 @@ HRESULT ZipCreate::SetCompressionLevel(const CComPtr<IOutArchive>& pArchiver, Co
         return hr;
     }
 
-    if (FAILED(hr = setter->SetProperties(names, values, numProps)))
+    if (FAILED(hr = setter->SetProperties(names.data(), values.data(), static_cast<UInt32>(names.size()))))
     {
         Log::Error("Failed to set properties [{}]", SystemError(hr));
         return hr;
@@ -225,7 +242,7 @@ STDMETHODIMP ZipCreate::Internal_FlushQueue(bool bFinal)
             return hr;
         }
 
-        if (FAILED(hr = SetCompressionLevel(pArchiver, m_CompressionLevel)))
+        if (FAILED(hr = SetArchiverProperties(pArchiver)))
         {
             Log::Error(L"Failed to set compression level to {} [{}]", m_CompressionLevel, SystemError(hr));
             return hr;
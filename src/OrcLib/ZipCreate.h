@@ -64,7 +64,7 @@ private:
 
     ZipCreate(bool bComputeHash = false);
 
-    STDMETHOD(SetCompressionLevel)(const CComPtr<IOutArchive>& pArchiver, CompressionLevel level);
+    STDMETHOD(SetArchiverProperties)(const CComPtr<IOutArchive>& pArchiver);
 
     STDMETHOD(Internal_FlushQueue)(bool bFinal);
 };
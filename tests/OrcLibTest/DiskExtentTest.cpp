@@ -33,6 +33,24 @@ HRESULT DiskExtentTest::Read(PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead)
     return S_OK;
 }
 
+HRESULT DiskExtentTest::ReadAt(ULONGLONG ullOffset, PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) const
+{
+    if (m_SeekCallBack != nullptr)
+    {
+        LARGE_INTEGER liOffset;
+        liOffset.QuadPart = ullOffset;
+
+        HRESULT hr = (*m_SeekCallBack)(liOffset);
+        if (FAILED(hr))
+            return hr;
+    }
+
+    if (m_ReadCallBack != nullptr)
+        return (*m_ReadCallBack)(lpBuf, dwCount);
+
+    return S_OK;
+}
+
 HRESULT DiskExtentTest::Seek(LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER pliNewFilePointer, DWORD dwFrom)
 {
     if (m_SeekCallBack != nullptr)
@@ -26,6 +26,7 @@ public:
     virtual HRESULT Open(DWORD dwShareMode, DWORD dwCreationDisposition, DWORD dwFlags);
     virtual HRESULT Seek(LARGE_INTEGER liDistanceToMove, PLARGE_INTEGER pliNewFilePointer, DWORD dwFrom);
     virtual HRESULT Read(PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead);
+    virtual HRESULT ReadAt(ULONGLONG ullOffset, PVOID lpBuf, DWORD dwCount, PDWORD pdwBytesRead) const;
     virtual void Close();
 
     virtual const std::wstring& GetName() const { return m_Name; }
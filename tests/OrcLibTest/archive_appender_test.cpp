@@ -0,0 +1,300 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "Archive/Appender.h"
+#include "Archive/7z/Archive7z.h"
+#include "ArchiveExtract.h"
+#include "FileStream.h"
+#include "MemoryStream.h"
+#include "Temporary.h"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace {
+
+std::shared_ptr<ByteStream> MakeStream(const std::string& content)
+{
+    auto stream = std::make_shared<MemoryStream>();
+    Assert::IsTrue(S_OK == stream->OpenForReadWrite(4096));
+    Assert::IsTrue(S_OK == stream->Write((const PVOID)content.data(), content.size(), nullptr));
+    Assert::IsTrue(S_OK == stream->SetFilePointer(0, FILE_BEGIN, nullptr));
+    return stream;
+}
+
+std::string Content(size_t i)
+{
+    return fmt::format("item #{} {}", i, std::string(i % 100, 'a' + i % 26));
+}
+
+// Compressible but not trivially: lines of pseudo random words
+std::string LargeContent(size_t i, size_t size)
+{
+    std::string content;
+    content.reserve(size);
+
+    uint32_t seed = static_cast<uint32_t>(i) * 2654435761U + 1;
+    while (content.size() < size)
+    {
+        seed = seed * 1103515245U + 12345U;
+        content += fmt::format("{:08x} {} ", seed >> 8, (seed >> 16) % 1000);
+        if (seed % 7 == 0)
+            content += "\r\n";
+    }
+    content.resize(size);
+    return content;
+}
+
+std::wstring TempArchivePath()
+{
+    WCHAR szTempDir[MAX_PATH];
+    Assert::IsTrue(SUCCEEDED(UtilGetTempDirPath(szTempDir, MAX_PATH)));
+
+    std::wstring path;
+    Assert::IsTrue(SUCCEEDED(UtilGetUniquePath(szTempDir, L"appender.7z", path)));
+    return path;
+}
+
+}  // namespace
+
+namespace Orc::Test {
+TEST_CLASS(ArchiveAppenderTest)
+{
+private:
+    UnitTestHelper helper;
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(ArchiveAppenderFlushTest)
+    {
+        const auto path = TempArchivePath();
+
+        std::error_code ec;
+        auto appender = Archive::Appender<Archive::Archive7z>::Create(
+            Archive::Archive7z(Archive::Format::k7z, Archive::CompressionLevel::kFast, L""), path, 1024 * 1024, ec);
+        Assert::IsTrue(!ec);
+
+        // flushes appends to the first flushed archive, and the last one is done by Close
+        const size_t kItemCount = 100;
+        for (size_t i = 0; i < kItemCount; ++i)
+        {
+            appender->Add(std::make_unique<Archive::Item>(MakeStream(Content(i)), fmt::format(L"item_{}.txt", i)));
+            if (i % 30 == 29)
+            {
+                appender->Flush(ec);
+                Assert::IsTrue(!ec);
+            }
+        }
+
+        appender->Close(ec);
+        Assert::IsTrue(!ec);
+
+        std::map<std::wstring, std::shared_ptr<MemoryStream>> extracted;
+        HRESULT hr = Extract(path, extracted);
+        DeleteFile(path.c_str());
+        Assert::IsTrue(S_OK == hr);
+
+        Assert::IsTrue(extracted.size() == kItemCount);
+        for (size_t i = 0; i < kItemCount; ++i)
+        {
+            const auto it = extracted.find(fmt::format(L"item_{}.txt", i));
+            Assert::IsTrue(it != std::cend(extracted));
+
+            const auto expected = Content(i);
+            const auto buffer = it->second->GetConstBuffer();
+            Assert::IsTrue(buffer.GetCount() == expected.size());
+            Assert::IsTrue(memcmp(buffer.GetData(), expected.data(), expected.size()) == 0);
+        }
+    }
+
+    TEST_METHOD(ArchiveAppenderThreadsTest)
+    {
+        const auto path = TempArchivePath();
+
+        // Items larger than the block size, so that blocks are compressed in parallel
+        Archive::Archive7z archiver(Archive::Format::k7z, Archive::CompressionLevel::kNormal, L"");
+        archiver.SetThreadCount(4);
+        archiver.SetBlockSize(1024 * 1024);
+
+        std::error_code ec;
+        auto appender = Archive::Appender<Archive::Archive7z>::Create(std::move(archiver), path, 1024 * 1024, ec);
+        Assert::IsTrue(!ec);
+
+        const size_t kItemCount = 4;
+        const size_t kItemSize = 3 * 1024 * 1024 + 17;
+        for (size_t i = 0; i < kItemCount; ++i)
+        {
+            auto item = std::make_unique<Archive::Item>(
+                MakeStream(LargeContent(i, kItemSize)), fmt::format(L"large_{}.txt", i));
+            appender->Add(std::move(item));
+            appender->Flush(ec);
+            Assert::IsTrue(!ec);
+        }
+
+        appender->Close(ec);
+        Assert::IsTrue(!ec);
+
+        std::map<std::wstring, std::shared_ptr<MemoryStream>> extracted;
+        HRESULT hr = Extract(path, extracted);
+        DeleteFile(path.c_str());
+        Assert::IsTrue(S_OK == hr);
+
+        Assert::IsTrue(extracted.size() == kItemCount);
+        for (size_t i = 0; i < kItemCount; ++i)
+        {
+            const auto it = extracted.find(fmt::format(L"large_{}.txt", i));
+            Assert::IsTrue(it != std::cend(extracted));
+
+            const auto expected = LargeContent(i, kItemSize);
+            const auto buffer = it->second->GetConstBuffer();
+            Assert::IsTrue(buffer.GetCount() == expected.size());
+            Assert::IsTrue(memcmp(buffer.GetData(), expected.data(), expected.size()) == 0);
+        }
+    }
+
+    // Not a functional test: time to compress large items with one thread, then with one thread per processor
+    BEGIN_TEST_METHOD_ATTRIBUTE(ArchiveThreadsBenchmark)
+    TEST_IGNORE()
+    END_TEST_METHOD_ATTRIBUTE()
+    TEST_METHOD(ArchiveThreadsBenchmark)
+    {
+        const size_t kItemCount = 8;
+        const size_t kItemSize = 16 * 1024 * 1024;
+
+        std::vector<std::string> contents;
+        for (size_t i = 0; i < kItemCount; ++i)
+            contents.push_back(LargeContent(i, kItemSize));
+
+        for (uint32_t threadCount : {1U, 0U})
+        {
+            const auto path = TempArchivePath();
+
+            Archive::Archive7z archiver(Archive::Format::k7z, Archive::CompressionLevel::kMaximum, L"");
+            archiver.SetThreadCount(threadCount);
+
+            std::error_code ec;
+            auto appender =
+                Archive::Appender<Archive::Archive7z>::Create(std::move(archiver), path, 1024 * 1024 * 50, ec);
+            Assert::IsTrue(!ec);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < kItemCount; ++i)
+            {
+                auto item = std::make_unique<Archive::Item>(MakeStream(contents[i]), fmt::format(L"large_{}.txt", i));
+                appender->Add(std::move(item));
+            }
+
+            appender->Close(ec);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            DeleteFile(path.c_str());
+            Assert::IsTrue(!ec);
+
+            Logger::WriteMessage(fmt::format(
+                                     L"Archive7z: {} threads, {} items of {} bytes in {}ms\r\n",
+                                     threadCount,
+                                     kItemCount,
+                                     kItemSize,
+                                     std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count())
+                                     .c_str());
+        }
+    }
+
+    // Not a functional test: flushes of a growing archive should not get slower with its size
+    BEGIN_TEST_METHOD_ATTRIBUTE(ArchiveAppenderFlushBenchmark)
+    TEST_IGNORE()
+    END_TEST_METHOD_ATTRIBUTE()
+    TEST_METHOD(ArchiveAppenderFlushBenchmark)
+    {
+        const auto path = TempArchivePath();
+
+        std::error_code ec;
+        auto appender = Archive::Appender<Archive::Archive7z>::Create(
+            Archive::Archive7z(Archive::Format::k7z, Archive::CompressionLevel::kFast, L""),
+            path,
+            1024 * 1024 * 50,
+            ec);
+        Assert::IsTrue(!ec);
+
+        const size_t kItemCount = 50000;
+        const size_t kItemsPerFlush = 1000;
+
+        std::chrono::steady_clock::duration first {};
+        std::chrono::steady_clock::duration last {};
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < kItemCount; ++i)
+        {
+            appender->Add(std::make_unique<Archive::Item>(MakeStream(Content(i)), fmt::format(L"item_{}.txt", i)));
+            if (i % kItemsPerFlush == kItemsPerFlush - 1)
+            {
+                const auto flushStart = std::chrono::steady_clock::now();
+                appender->Flush(ec);
+                Assert::IsTrue(!ec);
+
+                last = std::chrono::steady_clock::now() - flushStart;
+                if (i < kItemsPerFlush)
+                {
+                    first = last;
+                }
+            }
+        }
+
+        appender->Close(ec);
+        DeleteFile(path.c_str());
+        Assert::IsTrue(!ec);
+
+        const auto ms = [](auto duration) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+        };
+
+        Logger::WriteMessage(fmt::format(
+                                 L"Appender: {} items in {}ms, first flush: {}ms, last flush: {}ms\r\n",
+                                 kItemCount,
+                                 ms(std::chrono::steady_clock::now() - start),
+                                 ms(first),
+                                 ms(last))
+                                 .c_str());
+    }
+
+private:
+    HRESULT Extract(const std::wstring& path, std::map<std::wstring, std::shared_ptr<MemoryStream>>& extracted)
+    {
+        auto MakeArchiveStream = [&path](std::shared_ptr<ByteStream>& stream) -> HRESULT {
+            auto fs = std::make_shared<FileStream>();
+            if (FAILED(fs->ReadFrom(path.c_str())))
+                return E_FAIL;
+
+            stream = fs;
+            return S_OK;
+        };
+
+        auto ShouldItemBeExtracted = [](const std::wstring& strNameInArchive) -> bool { return true; };
+
+        auto MakeWriteStream = [&extracted](OrcArchive::ArchiveItem& item) -> std::shared_ptr<ByteStream> {
+            auto stream = std::make_shared<MemoryStream>();
+            if (FAILED(stream->OpenForReadWrite(4096)))
+                return nullptr;
+
+            extracted[item.NameInArchive] = stream;
+            return stream;
+        };
+
+        auto ArchiveCallback = [](const OrcArchive::ArchiveItem& item) {};
+
+        return helper.ExtractArchive(
+            ArchiveFormat::SevenZip, MakeArchiveStream, ShouldItemBeExtracted, MakeWriteStream, ArchiveCallback);
+    }
+};
+}  // namespace Orc::Test
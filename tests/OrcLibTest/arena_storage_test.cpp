@@ -0,0 +1,97 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "ArenaStorage.h"
+
+#include <set>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace Orc::Test {
+TEST_CLASS(ArenaStorageTest)
+{
+private:
+    UnitTestHelper helper;
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(ArenaStorageBasicTest)
+    {
+        ArenaStorage arena(4096);
+
+        std::vector<LPBYTE> allocations;
+        for (size_t i = 1; i < 200; i++)
+        {
+            auto p = (LPBYTE)arena.Allocate(i);
+            Assert::IsTrue(p != nullptr);
+            Assert::IsTrue(reinterpret_cast<size_t>(p) % MEMORY_ALLOCATION_ALIGNMENT == 0);
+            memset(p, static_cast<int>(i), i);
+            allocations.push_back(p);
+        }
+
+        for (size_t i = 1; i < 200; i++)
+        {
+            Assert::IsTrue(allocations[i - 1][0] == static_cast<BYTE>(i));
+            Assert::IsTrue(allocations[i - 1][i - 1] == static_cast<BYTE>(i));
+        }
+
+        // larger than a chunk
+        Assert::IsTrue(arena.Allocate(3 * 4096) != nullptr);
+
+        const auto& stats = arena.GetStatistics();
+        Assert::IsTrue(stats.Allocations == 200);
+        Assert::IsTrue(stats.Chunks > 1);
+
+        arena.Release();
+        Assert::IsTrue(arena.GetStatistics().Chunks == 0);
+    }
+
+    TEST_METHOD(SlabStorageBasicTest)
+    {
+        SlabStorage store(L"Test");
+        Assert::IsTrue(S_OK == store.InitializeStore(16, 100));
+
+        std::vector<LPVOID> cells;
+        for (int i = 0; i < 40; i++)
+        {
+            auto p = (LPBYTE)store.GetNewCell();
+            Assert::IsTrue(p != nullptr);
+            for (int j = 0; j < 100; j++)
+                Assert::IsTrue(p[j] == 0);
+            memset(p, 0xFF, 100);
+            cells.push_back(p);
+        }
+        Assert::IsTrue(store.AllocatedCells() == 40);
+        Assert::IsTrue(store.GetStatistics().Slabs == 3);
+
+        for (int i = 0; i < 40; i += 2)
+            store.FreeCell(cells[i]);
+        Assert::IsTrue(store.AllocatedCells() == 20);
+
+        size_t enumerated = 0;
+        Assert::IsTrue(S_OK == store.EnumCells([&enumerated](void*) { enumerated++; }));
+        Assert::IsTrue(enumerated == 20);
+
+        // freed cells are recycled, zeroed
+        std::set<LPVOID> freed(begin(cells), end(cells));
+        for (int i = 0; i < 20; i++)
+        {
+            auto p = (LPBYTE)store.GetNewCell();
+            Assert::IsTrue(freed.find(p) != end(freed));
+            for (int j = 0; j < 100; j++)
+                Assert::IsTrue(p[j] == 0);
+        }
+        Assert::IsTrue(store.GetStatistics().Slabs == 3);
+        Assert::IsTrue(store.GetStatistics().PeakCells == 40);
+    }
+};
+}  // namespace Orc::Test
@@ -0,0 +1,173 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "BlockCache.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace Orc::Test {
+TEST_CLASS(BlockCacheTest)
+{
+private:
+    UnitTestHelper helper;
+
+    static constexpr ULONG kVolumeSize = 1024 * 1024 + 100;
+
+    // Each byte of the fake volume is its offset modulo 251
+    static BYTE VolumeByte(ULONGLONG ullOffset) { return static_cast<BYTE>(ullOffset % 251); }
+
+    ULONG m_ulReads = 0L;
+
+    BlockCache::BlockReadCall FakeVolume()
+    {
+        return [this](ULONGLONG ullOffset, LPBYTE pBuffer, ULONG ulBytesToRead, ULONG& ulBytesRead) -> HRESULT {
+            m_ulReads++;
+            ulBytesRead = 0L;
+            while (ulBytesRead < ulBytesToRead && ullOffset + ulBytesRead < kVolumeSize)
+            {
+                pBuffer[ulBytesRead] = VolumeByte(ullOffset + ulBytesRead);
+                ulBytesRead++;
+            }
+            return S_OK;
+        };
+    }
+
+    // Like a volume handle, reads running past the end of the volume fail as a whole
+    BlockCache::BlockReadCall StrictVolume()
+    {
+        return [this](ULONGLONG ullOffset, LPBYTE pBuffer, ULONG ulBytesToRead, ULONG& ulBytesRead) -> HRESULT {
+            ulBytesRead = 0L;
+            if (ullOffset + ulBytesToRead > kVolumeSize)
+                return HRESULT_FROM_WIN32(ERROR_SECTOR_NOT_FOUND);
+            return FakeVolume()(ullOffset, pBuffer, ulBytesToRead, ulBytesRead);
+        };
+    }
+
+    bool CheckData(ULONGLONG ullOffset, const BYTE* pData, ULONG ulBytes)
+    {
+        for (ULONG i = 0; i < ulBytes; i++)
+        {
+            if (pData[i] != VolumeByte(ullOffset + i))
+                return false;
+        }
+        return true;
+    }
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) { m_ulReads = 0L; }
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(BlockCacheHitMissTest)
+    {
+        BlockCache::Options options;
+        options.ulBlockSize = 4096;
+        options.ullMaxBytes = 64 * 1024;
+        options.ulShards = 4;
+        options.ulReadAheadBlocks = 4;
+
+        BlockCache cache(options);
+        BYTE buffer[1024];
+        ULONG ulRead = 0L;
+
+        // unaligned read spanning two blocks
+        Assert::IsTrue(S_OK == cache.Read(4000, buffer, 200, ulRead, FakeVolume()));
+        Assert::IsTrue(ulRead == 200);
+        Assert::IsTrue(CheckData(4000, buffer, ulRead));
+
+        auto stats = cache.GetStatistics();
+        Assert::IsTrue(stats.ullMisses == 2);
+        Assert::IsTrue(stats.ullHits == 0);
+
+        // same range is now served from the cache
+        const auto ulReads = m_ulReads;
+        Assert::IsTrue(S_OK == cache.Read(4010, buffer, 100, ulRead, FakeVolume()));
+        Assert::IsTrue(ulRead == 100);
+        Assert::IsTrue(CheckData(4010, buffer, ulRead));
+        Assert::IsTrue(m_ulReads == ulReads);
+        Assert::IsTrue(cache.GetStatistics().ullHits == 2);
+
+        // reads are truncated at the end of the volume
+        Assert::IsTrue(S_OK == cache.Read(kVolumeSize - 50, buffer, 200, ulRead, FakeVolume()));
+        Assert::IsTrue(ulRead == 50);
+        Assert::IsTrue(CheckData(kVolumeSize - 50, buffer, ulRead));
+    }
+
+    TEST_METHOD(BlockCacheReadAheadTest)
+    {
+        BlockCache::Options options;
+        options.ulBlockSize = 4096;
+        options.ullMaxBytes = 64 * 1024;
+        options.ulShards = 2;
+        options.ulReadAheadBlocks = 8;
+
+        BlockCache cache(options);
+        BYTE buffer[512];
+        ULONG ulRead = 0L;
+
+        // a sequential scan with small reads is turned into a few large reads
+        for (ULONGLONG ullOffset = 0; ullOffset < 32 * 4096; ullOffset += sizeof(buffer))
+        {
+            Assert::IsTrue(S_OK == cache.Read(ullOffset, buffer, sizeof(buffer), ulRead, FakeVolume()));
+            Assert::IsTrue(ulRead == sizeof(buffer));
+            Assert::IsTrue(CheckData(ullOffset, buffer, ulRead));
+        }
+
+        auto stats = cache.GetStatistics();
+        Assert::IsTrue(stats.ullReadAheads > 0);
+        Assert::IsTrue(m_ulReads < 32);
+        Assert::IsTrue(stats.ullEvictions > 0);  // 128KiB scanned through a 64KiB cache
+    }
+
+    TEST_METHOD(BlockCacheEndOfVolumeTest)
+    {
+        BlockCache::Options options;
+        options.ulBlockSize = 4096;
+        options.ullMaxBytes = 64 * 1024;
+        options.ulShards = 2;
+        options.ulReadAheadBlocks = 8;
+
+        BYTE buffer[4096];
+        ULONG ulRead = 0L;
+        const ULONGLONG ullStart = (kVolumeSize / options.ulBlockSize - 4) * options.ulBlockSize;
+
+        // with a known length, read aheads stop at the end of the volume
+        {
+            options.ullLength = kVolumeSize;
+            BlockCache cache(options);
+
+            ULONGLONG ullOffset = ullStart;
+            for (; ullOffset < kVolumeSize; ullOffset += ulRead)
+            {
+                Assert::IsTrue(S_OK == cache.Read(ullOffset, buffer, sizeof(buffer), ulRead, StrictVolume()));
+                Assert::IsTrue(ulRead > 0);
+                Assert::IsTrue(CheckData(ullOffset, buffer, ulRead));
+            }
+            Assert::IsTrue(ullOffset == kVolumeSize);
+            Assert::IsTrue(cache.GetStatistics().ullReadAheads > 0);
+
+            Assert::IsTrue(S_OK == cache.Read(kVolumeSize, buffer, sizeof(buffer), ulRead, StrictVolume()));
+            Assert::IsTrue(ulRead == 0);
+        }
+
+        // with an unknown length, a failed read ahead is retried with the requested block only
+        {
+            options.ullLength = 0LLU;
+            BlockCache cache(options);
+
+            for (ULONGLONG ullOffset = ullStart; ullOffset + sizeof(buffer) <= kVolumeSize; ullOffset += sizeof(buffer))
+            {
+                Assert::IsTrue(S_OK == cache.Read(ullOffset, buffer, sizeof(buffer), ulRead, StrictVolume()));
+                Assert::IsTrue(ulRead == sizeof(buffer));
+                Assert::IsTrue(CheckData(ullOffset, buffer, ulRead));
+            }
+        }
+    }
+};
+}  // namespace Orc::Test
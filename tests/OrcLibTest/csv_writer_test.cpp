@@ -0,0 +1,187 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "TableOutputWriter.h"
+
+#include "DevNullStream.h"
+#include "MemoryStream.h"
+
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace Orc::Test {
+TEST_CLASS(CsvWriterTest)
+{
+private:
+    UnitTestHelper helper;
+
+    // Names of all sorts: ASCII, accented, CJK, surrogate pairs, an unpaired surrogate, quotes...
+    static const std::vector<std::wstring>& Names()
+    {
+        static const std::vector<std::wstring> names = {
+            L"ntoskrnl.exe",
+            L"$MFT",
+            L"desktop.ini",
+            L"Résumé - copie (2).docx",
+            L"中文文件名.txt",
+            L"\U0001F600 smile.png",
+            L"say \"hello\".txt",
+            L"\"quoted\"",
+            L"trailing quote\"",
+            L"lone \xD800 surrogate",
+            L"Microsoft.Windows.Common-Controls_6595b64144ccf1df_6.0.19041.1110_none_60b5254171f9507e",
+            L"a"};
+        return names;
+    }
+
+    static std::shared_ptr<TableOutput::IStreamWriter> CsvOutput(bool bDirectUtf8, std::shared_ptr<ByteStream> stream)
+    {
+        using namespace Orc::TableOutput;
+
+        auto options = std::make_unique<CSV::Options>();
+        options->bDirectUtf8 = bDirectUtf8;
+
+        auto writer = GetCSVWriter(std::move(options));
+        Assert::IsTrue((bool)writer);
+        writer->WriteToStream(stream, false);
+
+        Schema schema {
+            {ColumnType::UTF16Type, L"ComputerName"},
+            {ColumnType::UInt64Type, L"VolumeID"},
+            {ColumnType::UTF16Type, L"File"},
+            {ColumnType::UTF16Type, L"ParentName"},
+            {ColumnType::UTF16Type, L"FullName"},
+            {ColumnType::UTF16Type, L"Extension"},
+            {ColumnType::UInt64Type, L"SizeInBytes"},
+            {ColumnType::UTF16Type, L"Attributes"},
+            {ColumnType::TimeStampType, L"CreationDate"},
+            {ColumnType::TimeStampType, L"LastModificationDate"},
+            {ColumnType::TimeStampType, L"LastAccessDate"},
+            {ColumnType::TimeStampType, L"LastAttrChangeDate"},
+            {ColumnType::UInt64Type, L"FRN"},
+            {ColumnType::UInt64Type, L"ParentFRN"},
+            {ColumnType::BoolType, L"RecordInUse"},
+            {ColumnType::UInt32Type, L"SecDescrID"},
+            {ColumnType::BinaryType, L"MD5"},
+            {ColumnType::BinaryType, L"SHA1"},
+            {ColumnType::UTF8Type, L"Version"},
+            {ColumnType::GUIDType, L"SnapshotID"}};
+        writer->SetSchema(schema);
+
+        return writer;
+    }
+
+    static void WriteRow(ITableOutput& output, UINT i)
+    {
+        const auto& names = Names();
+        const auto& name = names[i % names.size()];
+        const auto& parent = names[(i / 7) % names.size()];
+
+        const BYTE digest[20] = {0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                                 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+        const GUID snapshot = {0x3808876B, 0xC176, 0x4E48, {0xB7, 0xAE, 0x04, 0x04, 0x6E, 0x6C, 0xC7, 0x52}};
+        const LONGLONG time = 132000000000000000LL + static_cast<LONGLONG>(i) * 10000019LL;
+
+        output.WriteString(L"WORKSTATION");
+        output.WriteInteger(static_cast<ULONGLONG>(0x3A2B1C0D00000000ULL + i % 4));
+        output.WriteString(name);
+        output.WriteString(parent);
+        output.WriteFormated(L"\\Windows\\{}\\{}", parent, name);
+        if (auto dot = name.find_last_of(L'.'); dot != std::wstring::npos)
+            output.WriteString(std::wstring_view(name).substr(dot));
+        else
+            output.WriteNothing();
+        output.WriteFileSize(static_cast<ULONGLONG>(i) * 4099);
+        output.WriteAttributes(FILE_ATTRIBUTE_ARCHIVE | (i % 3 == 0 ? FILE_ATTRIBUTE_HIDDEN : 0));
+        output.WriteFileTime(time);
+        output.WriteFileTime(time + 1);
+        output.WriteFileTime(time + 2);
+        output.WriteFileTime(time + 3);
+        output.WriteInteger(static_cast<ULONGLONG>(0x0001000000000000ULL + i));
+        output.WriteInteger(static_cast<ULONGLONG>(0x0001000000000000ULL + i / 7));
+        output.WriteBool(i % 5 != 0);
+        output.WriteInteger(static_cast<DWORD>(i % 1024));
+        if (i % 4 == 0)
+            output.WriteNothing();
+        else
+            output.WriteBytes(digest, 16);
+        output.WriteBytes(digest, 20);
+        output.WriteString(i % 2 ? "10.0.19041.1" : "R\xC3\xA9vision \"2\"");
+        output.WriteGUID(snapshot);
+        output.WriteEndOfLine();
+    }
+
+    static std::string Contents(TableOutput::IStreamWriter& writer, MemoryStream& stream)
+    {
+        Assert::IsTrue(SUCCEEDED(writer.Flush()));
+        const auto buffer = stream.GetConstBuffer();
+        return std::string(buffer.GetP<CHAR>(), buffer.GetCount());
+    }
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    // Direct UTF-8 mode must produce the very same bytes as formatting to UTF-16 and converting on flush
+    TEST_METHOD(CsvDirectUtf8Test)
+    {
+        const UINT kRows = 20000;
+
+        auto Write = [](bool bDirectUtf8) {
+            auto stream = std::make_shared<MemoryStream>();
+            Assert::IsTrue(S_OK == stream->OpenForReadWrite());
+
+            auto writer = CsvOutput(bDirectUtf8, stream);
+            for (UINT i = 0; i < kRows; i++)
+                WriteRow(*writer, i);
+
+            return Contents(*writer, *stream);
+        };
+
+        const auto expected = Write(false);
+        const auto direct = Write(true);
+
+        Assert::IsTrue(expected.size() > kRows * 100);
+        Assert::IsTrue(expected == direct);
+    }
+
+    // Not a functional test: rows per second in each mode
+    BEGIN_TEST_METHOD_ATTRIBUTE(CsvDirectUtf8Benchmark)
+    TEST_IGNORE()
+    END_TEST_METHOD_ATTRIBUTE()
+    TEST_METHOD(CsvDirectUtf8Benchmark)
+    {
+        const UINT kRows = 10000000;
+
+        auto Throughput = [](bool bDirectUtf8) {
+            auto stream = std::make_shared<DevNullStream>();
+            auto writer = CsvOutput(bDirectUtf8, stream);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (UINT i = 0; i < kRows; i++)
+                WriteRow(*writer, i);
+            Assert::IsTrue(SUCCEEDED(writer->Flush()));
+
+            const auto duration = std::chrono::steady_clock::now() - start;
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+            return static_cast<long long>(kRows) * 1000 / std::max<long long>(ms, 1);
+        };
+
+        const auto utf16 = Throughput(false);
+        const auto direct = Throughput(true);
+
+        Logger::WriteMessage(
+            fmt::format(
+                L"CSV of {} NTFSInfo rows: {} rows/s through UTF-16, {} rows/s direct UTF-8\n", kRows, utf16, direct)
+                .c_str());
+    }
+};
+}  // namespace Orc::Test
@@ -0,0 +1,105 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "DirectoryNameTable.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace Orc::Test {
+TEST_CLASS(DirectoryNameTableTest)
+{
+private:
+    UnitTestHelper helper;
+
+    static MFT_SEGMENT_REFERENCE Reference(ULONG ulSegment, USHORT usSequence = 1)
+    {
+        MFT_SEGMENT_REFERENCE reference = {0};
+        reference.SegmentNumberLowPart = ulSegment;
+        reference.SequenceNumber = usSequence;
+        return reference;
+    }
+
+    static ULONGLONG FRN(ULONG ulSegment, USHORT usSequence = 1)
+    {
+        auto reference = Reference(ulSegment, usSequence);
+        return NtfsFullSegmentNumber(&reference);
+    }
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(DirectoryNameTablePathTest)
+    {
+        DirectoryNameTable table;
+        const auto ullRoot = FRN(5, 5);
+
+        Assert::IsTrue(table.Insert(Reference(5, 5), Reference(5, 5), L"."));
+        Assert::IsTrue(table.Insert(Reference(40), Reference(5, 5), L"Windows"));
+        Assert::IsTrue(table.Insert(Reference(41), Reference(40), L"System32"));
+        Assert::IsTrue(table.Insert(Reference(42), Reference(41), L"drivers"));
+        Assert::IsTrue(table.Insert(Reference(50), Reference(5, 5), L"drivers"));
+        Assert::IsFalse(table.Insert(Reference(41), Reference(5, 5), L"Other"));
+
+        // same segment, other sequence number
+        Assert::IsTrue(table.Find(FRN(41, 2)) == nullptr);
+
+        std::wstring_view path;
+        ULONGLONG ullMissing = 0LL;
+
+        Assert::IsTrue(table.GetPath(ullRoot, ullRoot, path, ullMissing));
+        Assert::IsTrue(path.empty());
+
+        Assert::IsTrue(table.GetPath(FRN(42), ullRoot, path, ullMissing));
+        Assert::IsTrue(path == L"\\Windows\\System32\\drivers");
+        Assert::IsTrue(table.GetStatistics().PathBuilds == 1);
+
+        // the whole chain was memoized
+        Assert::IsTrue(table.Find(FRN(40))->HasPath());
+        Assert::IsTrue(table.GetPath(FRN(41), ullRoot, path, ullMissing));
+        Assert::IsTrue(path == L"\\Windows\\System32");
+        Assert::IsTrue(table.GetStatistics().PathBuilds == 1);
+
+        Assert::IsTrue(table.GetPath(FRN(50), ullRoot, path, ullMissing));
+        Assert::IsTrue(path == L"\\drivers");
+
+        // names are interned
+        Assert::IsTrue(table.Find(FRN(42))->szName == table.Find(FRN(50))->szName);
+        Assert::IsTrue(table.GetStatistics().UniqueNames == 4);
+    }
+
+    TEST_METHOD(DirectoryNameTableMissingParentTest)
+    {
+        DirectoryNameTable table;
+        const auto ullRoot = FRN(5, 5);
+
+        Assert::IsTrue(table.Insert(Reference(60), Reference(70), L"Users"));
+        Assert::IsTrue(table.Insert(Reference(61), Reference(60), L"Public"));
+
+        std::wstring_view path;
+        ULONGLONG ullMissing = 0LL;
+
+        Assert::IsFalse(table.GetPath(FRN(61), ullRoot, path, ullMissing));
+        Assert::IsTrue(path == L"\\Users\\Public");
+        Assert::IsTrue(ullMissing == FRN(70));
+        Assert::IsFalse(table.Find(FRN(61))->HasPath());
+
+        // once the parent is known, the path is complete
+        Assert::IsTrue(table.Insert(Reference(70), Reference(5, 5), L"Documents and Settings"));
+        Assert::IsTrue(table.GetPath(FRN(61), ullRoot, path, ullMissing));
+        Assert::IsTrue(path == L"\\Documents and Settings\\Users\\Public");
+
+        // a loop in parent references does not hang
+        Assert::IsTrue(table.Insert(Reference(80), Reference(81), L"a"));
+        Assert::IsTrue(table.Insert(Reference(81), Reference(80), L"b"));
+        Assert::IsFalse(table.GetPath(FRN(80), ullRoot, path, ullMissing));
+    }
+};
+}  // namespace Orc::Test
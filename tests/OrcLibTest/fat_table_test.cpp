@@ -83,5 +83,53 @@ public:
             Assert::IsTrue(true == entry.IsFree());
         }
     }
+
+    TEST_METHOD(Fat32TableChainIndexTest)
+    {
+        // 2: root, 3->4->5->9->10: fragmented file, 7: single cluster file, 11: chain looping on itself
+        unsigned char data[48] = {0xF8, 0xFF, 0xFF, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F,
+                                  0x04, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00,
+                                  0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x0F, 0x00, 0x00, 0x00, 0x00,
+                                  0x0A, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x0F, 0x0B, 0x00, 0x00, 0x00};
+
+        FatTable fatTable(FatTable::FAT32);
+        CBinaryBuffer buffer(data, sizeof(data));
+        fatTable.AddChunk(std::make_shared<CBinaryBuffer>(buffer));
+        Assert::IsTrue(12 == fatTable.GetEntryCount());
+
+        // runs computed from the cluster chain
+        FatTable::ClusterRuns expected;
+        Assert::IsTrue(S_OK == fatTable.FillClusterRuns(3, expected));
+        Assert::IsTrue(2 == expected.size());
+        Assert::IsTrue(3 == expected[0].m_FirstCluster && 3 == expected[0].m_Count);
+        Assert::IsTrue(9 == expected[1].m_FirstCluster && 2 == expected[1].m_Count);
+
+        // runs resolved with the index
+        Assert::IsTrue(S_OK == fatTable.BuildChainIndex());
+
+        FatTable::ClusterRuns clusterRuns;
+        Assert::IsTrue(S_OK == fatTable.FillClusterRuns(3, clusterRuns));
+        Assert::IsTrue(expected.size() == clusterRuns.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            Assert::IsTrue(expected[i].m_FirstCluster == clusterRuns[i].m_FirstCluster);
+            Assert::IsTrue(expected[i].m_Count == clusterRuns[i].m_Count);
+        }
+
+        // a chain can start in the middle of a run
+        Assert::IsTrue(S_OK == fatTable.FillClusterRuns(4, clusterRuns));
+        Assert::IsTrue(2 == clusterRuns.size());
+        Assert::IsTrue(4 == clusterRuns[0].m_FirstCluster && 2 == clusterRuns[0].m_Count);
+
+        Assert::IsTrue(S_OK == fatTable.FillClusterRuns(7, clusterRuns));
+        Assert::IsTrue(1 == clusterRuns.size());
+        Assert::IsTrue(7 == clusterRuns[0].m_FirstCluster && 1 == clusterRuns[0].m_Count);
+
+        Assert::IsTrue(S_OK == fatTable.FillClusterRuns(0, clusterRuns));
+        Assert::IsTrue(clusterRuns.empty());
+
+        Assert::IsTrue(FAILED(fatTable.FillClusterRuns(11, clusterRuns)));
+        Assert::IsTrue(FAILED(fatTable.FillClusterRuns(0x100, clusterRuns)));
+    }
 };
 }  // namespace Orc::Test
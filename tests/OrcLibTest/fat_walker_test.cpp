@@ -16,6 +16,8 @@
 #include "Location.h"
 #include "VolumeReader.h"
 
+#include <set>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace Orc;
 using namespace Orc::Test;
@@ -69,9 +71,25 @@ public:
         DeleteFile(m_ArchiveItem.Path.c_str());
     }
 
+    TEST_METHOD(Fat16WalkerFullNamesTest)
+    {
+        m_NbFiles = 0;
+        m_NbFolders = 0;
+        m_FullNames.clear();
+        ProcessArchive(helper.GetDirectoryName(__WFILE__) + L"\\fat_images\\fat16.7z");
+
+        // subfolders are parsed in parallel: each entry must still be reported once, under its own parent
+        const std::set<std::wstring> fullNames(std::cbegin(m_FullNames), std::cend(m_FullNames));
+        Assert::IsTrue(m_FullNames.size() == m_NbFiles + m_NbFolders);
+        Assert::IsTrue(fullNames.size() == m_FullNames.size());
+
+        DeleteFile(m_ArchiveItem.Path.c_str());
+    }
+
 private:
     DWORD64 m_NbFiles;
     DWORD64 m_NbFolders;
+    std::vector<std::wstring> m_FullNames;
     OrcArchive::ArchiveItem m_ArchiveItem;
 
     void ProcessArchive(const std::wstring& archive)
@@ -108,6 +126,8 @@ private:
                 m_NbFolders++;
             else
                 m_NbFiles++;
+
+            m_FullNames.push_back(szFullName);
         };
 
         FatWalker walker;
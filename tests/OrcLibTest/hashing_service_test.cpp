@@ -0,0 +1,150 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "HashingService.h"
+
+#include "MemoryStream.h"
+#include "TableOutputWriter.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace Orc::Test {
+TEST_CLASS(HashingServiceTest)
+{
+private:
+    UnitTestHelper helper;
+
+    static constexpr auto CryptoAlgs = CryptoHashStream::Algorithm::MD5 | CryptoHashStream::Algorithm::SHA256;
+
+    static std::shared_ptr<MemoryStream> DataStream(size_t cbData, BYTE seed)
+    {
+        auto stream = std::make_shared<MemoryStream>();
+        Assert::IsTrue(S_OK == stream->OpenForReadWrite());
+
+        std::vector<BYTE> data(cbData);
+        for (size_t i = 0; i < cbData; i++)
+            data[i] = static_cast<BYTE>(seed + i * 7);
+
+        ULONGLONG ullWritten = 0LL;
+        if (cbData > 0)
+            Assert::IsTrue(S_OK == stream->Write(data.data(), data.size(), &ullWritten));
+        return stream;
+    }
+
+    static size_t DataSize(UINT i) { return (i % 5 == 0) ? 0 : (i * 4099) % (1024 * 1024); }
+
+    static std::pair<std::shared_ptr<TableOutput::IStreamWriter>, std::shared_ptr<MemoryStream>> CsvOutput()
+    {
+        using namespace Orc::TableOutput;
+
+        auto writer = GetCSVWriter(std::make_unique<CSV::Options>());
+        Assert::IsTrue((bool)writer);
+
+        auto stream = std::make_shared<MemoryStream>();
+        Assert::IsTrue(S_OK == stream->OpenForReadWrite());
+        writer->WriteToStream(stream, false);
+
+        Schema schema {
+            {ColumnType::UInt32Type, L"Index"},
+            {ColumnType::UInt64Type, L"Size"},
+            {ColumnType::BinaryType, L"MD5"},
+            {ColumnType::BinaryType, L"SHA256"}};
+        writer->SetSchema(schema);
+
+        return {writer, stream};
+    }
+
+    static std::string Contents(TableOutput::IStreamWriter& writer, MemoryStream& stream)
+    {
+        Assert::IsTrue(SUCCEEDED(writer.Flush()));
+        const auto buffer = stream.GetConstBuffer();
+        return std::string(buffer.GetP<CHAR>(), buffer.GetCount());
+    }
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    // Rows go through the service in order, some with hashes, some without: the output must be the one written inline
+    TEST_METHOD(HashingServiceOrderTest)
+    {
+        const UINT kRows = 200;
+
+        auto [expectedWriter, expectedStream] = CsvOutput();
+        for (UINT i = 0; i < kRows; i++)
+        {
+            auto& output = *expectedWriter;
+            output.WriteInteger(static_cast<DWORD>(i));
+            output.WriteFileSize(static_cast<ULONGLONG>(DataSize(i)));
+            if (i % 3 == 0)
+            {
+                output.WriteNothing();
+                output.WriteNothing();
+            }
+            else
+            {
+                auto data = DataStream(DataSize(i), static_cast<BYTE>(i));
+                auto job = std::make_shared<HashJob>(data, CryptoAlgs, FuzzyHashStream::Algorithm::Undefined);
+                Assert::IsTrue(S_OK == job->Run());
+                job->MD5().GetCount() > 0 ? output.WriteBytes(job->MD5()) : output.WriteNothing();
+                job->SHA256().GetCount() > 0 ? output.WriteBytes(job->SHA256()) : output.WriteNothing();
+            }
+            output.WriteEndOfLine();
+        }
+
+        auto [serviceWriter, serviceStream] = CsvOutput();
+        {
+            HashingService::Options options;
+            options.dwWorkers = 4;
+            options.dwMaxPendingRows = 16;
+
+            HashingService service(*serviceWriter, options);
+
+            for (UINT i = 0; i < kRows; i++)
+            {
+                auto row = service.NewRow();
+                row->WriteInteger(static_cast<DWORD>(i));
+                row->WriteFileSize(static_cast<ULONGLONG>(DataSize(i)));
+                if (i % 3 == 0)
+                {
+                    row->WriteNothing();
+                    row->WriteNothing();
+                }
+                else
+                {
+                    auto job = service.Submit(
+                        DataStream(DataSize(i), static_cast<BYTE>(i)),
+                        CryptoAlgs,
+                        FuzzyHashStream::Algorithm::Undefined);
+                    row->Defer(job, [job](ITableOutput& output) {
+                        return job->MD5().GetCount() > 0 ? output.WriteBytes(job->MD5()) : output.WriteNothing();
+                    });
+                    row->Defer(job, [job](ITableOutput& output) {
+                        return job->SHA256().GetCount() > 0 ? output.WriteBytes(job->SHA256())
+                                                            : output.WriteNothing();
+                    });
+                }
+                Assert::IsTrue(row->GetCurrentColumnID() == 4);
+                row->WriteEndOfLine();
+                Assert::IsTrue(SUCCEEDED(service.Push(std::move(row))));
+            }
+
+            Assert::IsTrue(SUCCEEDED(service.Flush()));
+            Assert::IsFalse(service.HasPendingRows());
+
+            const auto statistics = service.GetStatistics();
+            Assert::IsTrue(statistics.ullDeferredRows == kRows);
+            Assert::IsTrue(statistics.ullFailedJobs == 0);
+        }
+
+        Assert::IsTrue(Contents(*expectedWriter, *expectedStream) == Contents(*serviceWriter, *serviceStream));
+    }
+};
+}  // namespace Orc::Test
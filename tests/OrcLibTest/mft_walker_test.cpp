@@ -11,16 +11,77 @@
 #include "Partition.h"
 #include "Location.h"
 #include "MFTWalker.h"
+#include "MFTOnline.h"
 #include "FileStream.h"
 #include "TemporaryStream.h"
 #include "Temporary.h"
 #include "MFTRecordFileInfo.h"
 #include "BinaryBuffer.h"
 
+#include <set>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace Orc;
 using namespace Orc::Test;
 
+namespace {
+
+// Forwards to a volume reader, returning at most 'ulMaxRead' bytes per read like a reader capped at DEFAULT_READ_SIZE
+class CappedVolumeReader : public VolumeReader
+{
+public:
+    CappedVolumeReader(std::shared_ptr<VolumeReader> reader, ULONG ulMaxRead)
+        : VolumeReader(reader->GetLocation())
+        , m_Reader(std::move(reader))
+        , m_ulMaxRead(ulMaxRead)
+    {
+        if (m_Reader->GetBootSector().GetCount() > 0)
+            ParseBootSector(m_Reader->GetBootSector());
+    }
+
+    const WCHAR* ShortVolumeName() override { return m_Reader->ShortVolumeName(); }
+
+    HRESULT LoadDiskProperties() override
+    {
+        HRESULT hr = E_FAIL;
+        if (FAILED(hr = m_Reader->LoadDiskProperties()))
+            return hr;
+        return ParseBootSector(m_Reader->GetBootSector());
+    }
+
+    HANDLE GetDevice() override { return m_Reader->GetDevice(); }
+
+    HRESULT Seek(ULONGLONG offset) override { return m_Reader->Seek(offset); }
+
+    HRESULT Read(ULONGLONG offset, CBinaryBuffer& data, ULONGLONG ullBytesToRead, ULONGLONG& ullBytesRead) override
+    {
+        return m_Reader->Read(offset, data, std::min<ULONGLONG>(ullBytesToRead, m_ulMaxRead), ullBytesRead);
+    }
+
+    HRESULT Read(CBinaryBuffer& data, ULONGLONG ullBytesToRead, ULONGLONG& ullBytesRead) override
+    {
+        return m_Reader->Read(data, std::min<ULONGLONG>(ullBytesToRead, m_ulMaxRead), ullBytesRead);
+    }
+
+    std::shared_ptr<VolumeReader> ReOpen(DWORD dwDesiredAccess, DWORD dwShareMode, DWORD dwFlags) override
+    {
+        return std::make_shared<CappedVolumeReader>(
+            m_Reader->ReOpen(dwDesiredAccess, dwShareMode, dwFlags), m_ulMaxRead);
+    }
+
+protected:
+    std::shared_ptr<VolumeReader> DuplicateReader() override
+    {
+        return std::make_shared<CappedVolumeReader>(m_Reader, m_ulMaxRead);
+    }
+
+private:
+    std::shared_ptr<VolumeReader> m_Reader;
+    ULONG m_ulMaxRead;
+};
+
+}  // namespace
+
 namespace Orc::Test {
 TEST_CLASS(MFTWalkerTest)
 {
@@ -44,12 +105,133 @@ public:
         DeleteFile(m_ArchiveItem.Path.c_str());
     };
 
+    TEST_METHOD(MFTWalkerPipelineTest)
+    {
+        const auto archive = helper.GetDirectoryName(__WFILE__) + L"\\ntfs_images\\ntfs.7z";
+
+        m_NbFiles = 0;
+        m_NbFolders = 0;
+        m_Records.clear();
+        ProcessArchive(archive);
+        DeleteFile(m_ArchiveItem.Path.c_str());
+
+        const auto sequential = std::move(m_Records);
+        Assert::IsTrue(sequential.size() > 0);
+
+        m_NbFiles = 0;
+        m_NbFolders = 0;
+        m_Records.clear();
+
+        MFTWalker::PipelineOptions options;
+        options.bEnabled = true;
+        options.ulBytesPerBlock = 16 * 1024;  // small blocks to exercise the hand-off between stages
+        options.ulBlocksInFlight = 2;
+        ProcessArchive(archive, options);
+
+        Assert::IsTrue(m_NbFiles == 0x16);
+        Assert::IsTrue(m_NbFolders == 0x9);
+
+        // same records, names and attributes as the sequential walk
+        Assert::IsTrue(m_Records == sequential);
+
+        DeleteFile(m_ArchiveItem.Path.c_str());
+    };
+
+    TEST_METHOD(MFTOnlineFetchTest)
+    {
+        auto volReader = OpenImage(helper.GetDirectoryName(__WFILE__) + L"\\ntfs_images\\ntfs.7z");
+        const ULONG ulBytesPerFRS = volReader->GetBytesPerFRS();
+
+        // every record in use in the MFT, with its sequence number
+        std::vector<MFT_SEGMENT_REFERENCE> all;
+        {
+            MFTOnline mft(volReader);
+            Assert::IsTrue(S_OK == mft.Initialize());
+            Assert::IsTrue(
+                S_OK
+                == mft.EnumMFTRecord([&all](MFTUtils::SafeMFTSegmentNumber& ulRecordIndex, CBinaryBuffer& data) {
+                       auto pHeader = reinterpret_cast<PFILE_RECORD_SEGMENT_HEADER>(data.GetData());
+                       if (memcmp(pHeader->MultiSectorHeader.Signature, "FILE", 4))
+                           return S_OK;
+
+                       MFT_SEGMENT_REFERENCE frn = {0};
+                       frn.SegmentNumberHighPart = pHeader->SegmentNumberHighPart;
+                       frn.SegmentNumberLowPart = pHeader->SegmentNumberLowPart;
+                       frn.SequenceNumber = pHeader->SequenceNumber;
+                       if (NtfsSegmentNumber(&frn) == ulRecordIndex)
+                           all.push_back(frn);
+                       return S_OK;
+                   }));
+        }
+        Assert::IsTrue(all.size() > 16);
+
+        // scattered records, with gaps small enough for most of them to be fetched in groups
+        std::vector<MFT_SEGMENT_REFERENCE> scattered;
+        std::set<ULONGLONG> expected;
+        for (size_t i = 0; i < all.size(); i++)
+        {
+            if (i % 5 == 1 || i % 7 == 3)
+                continue;
+            scattered.push_back(all[i]);
+            expected.insert(NtfsSegmentNumber(&all[i]));
+        }
+
+        const auto Fetch = [&](const std::shared_ptr<VolumeReader>& reader) {
+            MFTOnline mft(reader);
+            Assert::IsTrue(S_OK == mft.Initialize());
+            mft.SetFetchGapTolerance(16);
+
+            std::set<ULONGLONG> fetched;
+            auto frns = scattered;
+            Assert::IsTrue(
+                S_OK
+                == mft.FetchMFTRecord(
+                    frns, [&fetched](MFTUtils::SafeMFTSegmentNumber& ulRecordIndex, CBinaryBuffer& data) {
+                        fetched.insert(ulRecordIndex);
+                        return S_OK;
+                    }));
+
+            Assert::IsTrue(fetched == expected);
+            return mft.GetFetchStatistics();
+        };
+
+        const auto coalesced = Fetch(volReader);
+        Assert::IsTrue(coalesced.ullRecords == expected.size());
+        Assert::IsTrue(coalesced.ullReads < expected.size());
+
+        // a group larger than what the reader returns at once, as a group beyond DEFAULT_READ_SIZE would be
+        const auto capped = Fetch(std::make_shared<CappedVolumeReader>(volReader, 4 * ulBytesPerFRS));
+        Assert::IsTrue(capped.ullRecords == expected.size());
+        Assert::IsTrue(capped.ullReads > coalesced.ullReads);
+
+        volReader.reset();
+        m_ArchiveItem.Stream->Close();
+        DeleteFile(m_ArchiveItem.Path.c_str());
+    };
+
 private:
     DWORD64 m_NbFiles;
     DWORD64 m_NbFolders;
+    std::multiset<std::wstring> m_Records;  // FRN, names and attributes reported by the walk
     OrcArchive::ArchiveItem m_ArchiveItem;
 
-    void ProcessArchive(const std::wstring& archive)
+    std::shared_ptr<VolumeReader> OpenImage(const std::wstring& archive)
+    {
+        Assert::IsTrue(S_OK == ExtractArchive(archive.c_str()));
+
+        LPCWSTR ntfsImage = m_ArchiveItem.Path.c_str();
+
+        PartitionTable pt;
+        Assert::IsTrue(S_OK == pt.LoadPartitionTable(ntfsImage));
+        Assert::IsTrue(1 == pt.Table().size());
+
+        auto loc = std::make_shared<Location>(std::wstring(ntfsImage) + L",part=1", Location::Type::ImageFileDisk);
+        std::shared_ptr<VolumeReader> volReader = loc->GetReader();
+        Assert::IsTrue(S_OK == volReader->LoadDiskProperties());
+        return volReader;
+    }
+
+    void ProcessArchive(const std::wstring& archive, const MFTWalker::PipelineOptions& options = {})
     {
         // first extract archive
         LPCWSTR archiveStr = archive.c_str();
@@ -117,6 +299,25 @@ private:
                                           const PFILE_NAME pFileName,
                                           const std::shared_ptr<IndexAllocationAttribute>& pAttr) { m_NbFolders++; };
 
+        callBacks.FileNameCallback =
+            [this](const std::shared_ptr<VolumeReader>& volreader, MFTRecord* pElt, const PFILE_NAME pFileName) {
+                std::wstringstream record;
+                record << L"name " << std::hex << pElt->GetSafeMFTSegmentNumber() << L" "
+                       << NtfsFullSegmentNumber(&pFileName->ParentDirectory) << L" "
+                       << std::wstring_view(pFileName->FileName, pFileName->FileNameLength);
+                m_Records.insert(record.str());
+            };
+
+        callBacks.AttributeCallback =
+            [this](const std::shared_ptr<VolumeReader>& volreader, MFTRecord* pElt, const AttributeListEntry& attr) {
+                std::wstringstream record;
+                record << L"attribute " << std::hex << pElt->GetSafeMFTSegmentNumber() << L" " << attr.TypeCode()
+                       << L" " << attr.Instance() << L" "
+                       << std::wstring_view(attr.AttributeName(), attr.AttributeNameLength());
+                m_Records.insert(record.str());
+            };
+
+        walker.SetPipelineOptions(options);
         Assert::IsTrue(S_OK == walker.Initialize(loc, false));
         Assert::IsTrue(S_OK == walker.Walk(callBacks));
 
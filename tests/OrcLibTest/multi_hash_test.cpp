@@ -0,0 +1,174 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "CryptoHashStream.h"
+#include "MultiHash.h"
+
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace Orc::Test {
+TEST_CLASS(MultiHashTest)
+{
+private:
+    UnitTestHelper helper;
+
+    using Algorithm = CryptoHashStreamAlgorithm;
+
+    static constexpr auto AllAlgorithms = Algorithm::MD5 | Algorithm::SHA1 | Algorithm::SHA256;
+
+    static std::wstring ToHex(const CBinaryBuffer& buffer)
+    {
+        std::wstring hex;
+        for (size_t i = 0; i < buffer.GetCount(); i++)
+            hex.append(fmt::format(L"{:02X}", buffer.Get<BYTE>(i)));
+        return hex;
+    }
+
+    static std::vector<BYTE> Data(size_t cbData)
+    {
+        std::vector<BYTE> data(cbData);
+        DWORD dwSeed = 0x4f52431DL;
+        for (auto& b : data)
+        {
+            dwSeed = dwSeed * 1103515245 + 12345;
+            b = static_cast<BYTE>(dwSeed >> 16);
+        }
+        return data;
+    }
+
+    // Hashes data through a CryptoHashStream, in writes of various sizes
+    static std::vector<std::wstring> StreamHashes(CryptoHashStream::Provider provider, const std::vector<BYTE>& data)
+    {
+        auto hashstream = std::make_shared<CryptoHashStream>(provider);
+        Assert::IsTrue(S_OK == hashstream->OpenToWrite(AllAlgorithms, nullptr));
+
+        size_t offset = 0;
+        size_t cbWrite = 1;
+        while (offset < data.size())
+        {
+            cbWrite = std::min((cbWrite * 7) % 100000 + 1, data.size() - offset);
+
+            ULONGLONG ullWritten = 0LL;
+            Assert::IsTrue(S_OK == hashstream->Write((LPVOID)(data.data() + offset), cbWrite, &ullWritten));
+            offset += cbWrite;
+        }
+
+        std::vector<std::wstring> hashes(3);
+        Assert::IsTrue(S_OK == hashstream->GetHash(Algorithm::MD5, hashes[0]));
+        Assert::IsTrue(S_OK == hashstream->GetHash(Algorithm::SHA1, hashes[1]));
+        Assert::IsTrue(S_OK == hashstream->GetHash(Algorithm::SHA256, hashes[2]));
+        return hashes;
+    }
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) { MultiHash::EnableShaExtensions(true); }
+
+    TEST_METHOD(MultiHashVectorsTest)
+    {
+        const BYTE abc[] = {'a', 'b', 'c'};
+
+        for (const bool bShaExtensions : {false, true})
+        {
+            MultiHash::EnableShaExtensions(bShaExtensions);
+
+            MultiHash hash(AllAlgorithms);
+            hash.Update(abc, 1);
+            hash.Update(abc + 1, 2);
+
+            CBinaryBuffer digest;
+            Assert::IsTrue(S_OK == hash.GetHash(Algorithm::MD5, digest));
+            Assert::IsTrue(ToHex(digest) == L"900150983CD24FB0D6963F7D28E17F72");
+            Assert::IsTrue(S_OK == hash.GetHash(Algorithm::SHA1, digest));
+            Assert::IsTrue(ToHex(digest) == L"A9993E364706816ABA3E25717850C26C9CD0D89D");
+            Assert::IsTrue(S_OK == hash.GetHash(Algorithm::SHA256, digest));
+            Assert::IsTrue(ToHex(digest) == L"BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD");
+
+            // one million 'a': several blocks, padding in a chunk of its own
+            const std::vector<BYTE> a(1000000, 'a');
+            hash.Reset(Algorithm::SHA1 | Algorithm::SHA256);
+            hash.Update(a.data(), a.size());
+
+            Assert::IsTrue(S_OK == hash.GetHash(Algorithm::SHA1, digest));
+            Assert::IsTrue(ToHex(digest) == L"34AA973CD4C4DAA4F61EEB2BDBAD27316534016F");
+            Assert::IsTrue(S_OK == hash.GetHash(Algorithm::SHA256, digest));
+            Assert::IsTrue(ToHex(digest) == L"CDC76E5C9914FB9281A1C7E284D73E67F1809A48A497200E046D39CCC7112CD0");
+
+            Assert::IsTrue(MK_E_UNAVAILABLE == hash.GetHash(Algorithm::MD5, digest));
+            Assert::IsTrue(digest.GetCount() == 0);
+        }
+    }
+
+    TEST_METHOD(MultiHashProviderTest)
+    {
+        for (const size_t cbData : {0, 55, 56, 64, 65, 1 << 20, (1 << 20) + 13})
+        {
+            const auto data = Data(cbData);
+            const auto reference = StreamHashes(CryptoHashStream::Provider::CryptoAPI, data);
+
+            MultiHash::EnableShaExtensions(false);
+            Assert::IsTrue(StreamHashes(CryptoHashStream::Provider::Native, data) == reference);
+
+            MultiHash::EnableShaExtensions(true);
+            Assert::IsTrue(StreamHashes(CryptoHashStream::Provider::Native, data) == reference);
+        }
+    }
+
+    // Not a functional test: MD5, SHA1 and SHA256 throughput of each provider
+    BEGIN_TEST_METHOD_ATTRIBUTE(MultiHashBenchmark)
+    TEST_IGNORE()
+    END_TEST_METHOD_ATTRIBUTE()
+    TEST_METHOD(MultiHashBenchmark)
+    {
+        const size_t cbData = 256 * 1024 * 1024;
+        const size_t cbWrite = 1024 * 1024;
+        const auto data = Data(cbData);
+
+        const auto Throughput = [&](CryptoHashStream::Provider provider) {
+            auto hashstream = std::make_shared<CryptoHashStream>(provider);
+            Assert::IsTrue(S_OK == hashstream->OpenToWrite(AllAlgorithms, nullptr));
+
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t offset = 0; offset < data.size(); offset += cbWrite)
+            {
+                ULONGLONG ullWritten = 0LL;
+                Assert::IsTrue(S_OK == hashstream->Write((LPVOID)(data.data() + offset), cbWrite, &ullWritten));
+            }
+
+            std::wstring sha256;
+            Assert::IsTrue(S_OK == hashstream->GetHash(Algorithm::SHA256, sha256));
+
+            const auto duration = std::chrono::steady_clock::now() - start;
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+            return (cbData / (1024 * 1024)) * 1000 / std::max<long long>(ms, 1);
+        };
+
+        const auto cryptoAPI = Throughput(CryptoHashStream::Provider::CryptoAPI);
+
+        MultiHash::EnableShaExtensions(false);
+        const auto portable = Throughput(CryptoHashStream::Provider::Native);
+
+        MultiHash::EnableShaExtensions(true);
+        const auto native = Throughput(CryptoHashStream::Provider::Native);
+
+        Logger::WriteMessage(
+            fmt::format(
+                L"MD5+SHA1+SHA256 of {}MB: CryptoAPI {}MB/s, native {}MB/s, native with SHA extensions ({}) {}MB/s\n",
+                cbData / (1024 * 1024),
+                cryptoAPI,
+                portable,
+                MultiHash::HasShaExtensions() ? L"available" : L"not available",
+                native)
+                .c_str());
+    }
+};
+}  // namespace Orc::Test
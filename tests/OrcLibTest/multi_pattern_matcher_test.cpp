@@ -0,0 +1,208 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "MultiPatternMatcher.h"
+
+#include <chrono>
+#include <regex>
+#include <set>
+
+#include <Shlwapi.h>
+
+#pragma comment(lib, "Shlwapi.lib")
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace Orc::Test {
+TEST_CLASS(MultiPatternMatcherTest)
+{
+private:
+    UnitTestHelper helper;
+
+    static std::set<ULONG> Scan(const MultiPatternMatcher& matcher, const std::wstring& text)
+    {
+        std::set<ULONG> found;
+        matcher.Scan(text.c_str(), text.size(), [&found](ULONG ulId) { found.insert(ulId); });
+        return found;
+    }
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(MultiPatternMatcherBasicTest)
+    {
+        MultiPatternMatcher matcher;
+
+        const auto he = matcher.AddPattern(L"he");
+        const auto she = matcher.AddPattern(L"she");
+        const auto his = matcher.AddPattern(L"his");
+        const auto hers = matcher.AddPattern(L"hers");
+        const auto exe = matcher.AddPattern(L".EXE");
+
+        Assert::IsTrue(matcher.AddPattern(L"HE") == he);
+        Assert::IsTrue(matcher.AddPattern(L"") == MultiPatternMatcher::NoPattern);
+        Assert::IsTrue(S_OK == matcher.Compile());
+
+        Assert::IsTrue(Scan(matcher, L"ushers") == std::set<ULONG> {he, she, hers});
+        Assert::IsTrue(Scan(matcher, L"THIS.exe") == std::set<ULONG> {his, exe});
+        Assert::IsTrue(Scan(matcher, L"nothing").empty());
+        Assert::IsTrue(Scan(matcher, L"").empty());
+    }
+
+    TEST_METHOD(MultiPatternMatcherBinaryTest)
+    {
+        MultiPatternMatcher matcher(true);
+
+        const BYTE mz[] = {'M', 'Z', 0x90, 0x00};
+        const auto binary = matcher.AddPattern(mz, sizeof(mz));
+        const auto wide = matcher.AddPattern(reinterpret_cast<const BYTE*>(L"Run"), 3 * sizeof(WCHAR));
+        const auto exe = matcher.AddPattern(L".exe");
+
+        Assert::IsTrue(matcher.AddPattern(L".EXE") != exe);
+        Assert::IsTrue(matcher.AddPattern(nullptr, 0) == MultiPatternMatcher::NoPattern);
+        Assert::IsTrue(S_OK == matcher.Compile());
+
+        const auto ScanBytes = [&matcher](const BYTE* pData, size_t cbData) {
+            std::set<ULONG> found;
+            matcher.Scan(pData, cbData, [&found](ULONG ulId) { found.insert(ulId); });
+            return found;
+        };
+
+        const BYTE data[] = {0xFF, 'M', 'Z', 0x90, 0x00, 0x03, 'R', 0x00, 'u', 0x00, 'n', 0x00};
+        Assert::IsTrue(ScanBytes(data, sizeof(data)) == std::set<ULONG> {binary, wide});
+
+        const auto name = std::string("setup.exe");
+        std::set<ULONG> found;
+        matcher.Scan(name.c_str(), name.size(), [&found](ULONG ulId) { found.insert(ulId); });
+        Assert::IsTrue(found == std::set<ULONG> {exe});
+
+        Assert::IsTrue(Scan(matcher, L"SETUP.EXE").size() == 1);
+        Assert::IsTrue(Scan(matcher, L"setup.Exe").empty());
+    }
+
+    TEST_METHOD(MultiPatternMatcherLiteralTest)
+    {
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfSpec(L"*.docx") == L"docx");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfSpec(L"abc*def?ghij") == L"ghij");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfSpec(L"*.*").empty());
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfSpec(L"*.exe;*.dll").empty());
+
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"^abc.*\\.exe$") == L".exe");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"ab?cd") == L"cd");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"(abc)+defg") == L"defg");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"[a-z]+tmp\\d{2,3}") == L"tmp");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"foo|bar").empty());
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"(foo|bar)x") == L"x");
+
+        // character codes and control characters are not literal text
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"\\x41BC") == L"BC");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"\\u00e9t\\u00e9") == L"t");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"\\cJabc") == L"abc");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"(a)\\1xyz") == L"xyz");
+        Assert::IsTrue(MultiPatternMatcher::RequiredLiteralOfRegex(L"abc\\qdef").empty());
+
+        // the names matched by the regex contain the literal
+        const std::pair<std::wstring, std::wstring> matches[] = {
+            {L"\\x41BC", L"ABC"}, {L"\\u00e9t\\u00e9", L"\u00e9t\u00e9"}};
+        for (const auto& [regex, name] : matches)
+        {
+            Assert::IsTrue(std::regex_match(name, std::wregex(regex)));
+            Assert::IsTrue(name.find(MultiPatternMatcher::RequiredLiteralOfRegex(regex)) != std::wstring::npos);
+        }
+    }
+
+    // Not a functional test: compares PathMatchSpec against every spec with the pre-filtered evaluation
+    BEGIN_TEST_METHOD_ATTRIBUTE(MultiPatternMatcherBenchmark)
+    TEST_IGNORE()
+    END_TEST_METHOD_ATTRIBUTE()
+    TEST_METHOD(MultiPatternMatcherBenchmark)
+    {
+        const size_t kNames = 1000000;
+        const size_t kNaiveNames = 50000;
+        const size_t kSpecs = 200;
+
+        std::vector<std::wstring> specs;
+        for (size_t i = 0; i < kSpecs; i++)
+            specs.push_back(fmt::format(L"*report{}*.doc?", i));
+
+        const WCHAR* extensions[] = {L"dll", L"exe", L"docx", L"txt", L"log"};
+        std::vector<std::wstring> names;
+        names.reserve(kNames);
+        for (size_t i = 0; i < kNames; i++)
+            names.push_back(fmt::format(L"file_{}_report{}.{}", i, (i * 7919) % (kSpecs * 50), extensions[i % 5]));
+
+        MultiPatternMatcher matcher;
+        std::vector<ULONG> specPatterns;
+        for (const auto& spec : specs)
+            specPatterns.push_back(matcher.AddPattern(MultiPatternMatcher::RequiredLiteralOfSpec(spec)));
+        Assert::IsTrue(S_OK == matcher.Compile());
+
+        std::vector<ULONG> hits(matcher.PatternCount(), 0L);
+        ULONG ulScan = 0L;
+
+        const auto FilteredMatches = [&](const std::wstring& name) {
+            size_t matches = 0;
+            ulScan++;
+            matcher.Scan(name.c_str(), name.size(), [&](ULONG ulId) { hits[ulId] = ulScan; });
+            for (size_t i = 0; i < specs.size(); i++)
+            {
+                if (specPatterns[i] != MultiPatternMatcher::NoPattern && hits[specPatterns[i]] != ulScan)
+                    continue;
+                if (PathMatchSpec(name.c_str(), specs[i].c_str()))
+                    matches++;
+            }
+            return matches;
+        };
+
+        const auto NaiveMatches = [&](const std::wstring& name) {
+            size_t matches = 0;
+            for (const auto& spec : specs)
+            {
+                if (PathMatchSpec(name.c_str(), spec.c_str()))
+                    matches++;
+            }
+            return matches;
+        };
+
+        // same results
+        for (size_t i = 0; i < kNaiveNames; i++)
+            Assert::IsTrue(NaiveMatches(names[i]) == FilteredMatches(names[i]));
+
+        auto start = std::chrono::steady_clock::now();
+        size_t naive = 0;
+        for (size_t i = 0; i < kNaiveNames; i++)
+            naive += NaiveMatches(names[i]);
+        const auto naiveDuration = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        size_t filtered = 0;
+        for (const auto& name : names)
+            filtered += FilteredMatches(name);
+        const auto filteredDuration = std::chrono::steady_clock::now() - start;
+
+        const auto naiveNs = std::chrono::duration_cast<std::chrono::nanoseconds>(naiveDuration).count() / kNaiveNames;
+        const auto filteredNs = std::chrono::duration_cast<std::chrono::nanoseconds>(filteredDuration).count() / kNames;
+
+        Logger::WriteMessage(
+            fmt::format(
+                L"{} specs: PathMatchSpec on each spec {}ns/name ({} matches in {} names), pre-filtered {}ns/name ({} "
+                L"matches in {} names)\n",
+                kSpecs,
+                naiveNs,
+                naive,
+                kNaiveNames,
+                filteredNs,
+                filtered,
+                kNames)
+                .c_str());
+    }
+};
+}  // namespace Orc::Test
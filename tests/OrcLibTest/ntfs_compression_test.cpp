@@ -0,0 +1,238 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "NTFSCompression.h"
+#include "UncompressNTFSStream.h"
+#include "MemoryStream.h"
+
+#include <chrono>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace {
+
+constexpr DWORD kCompressionUnit = 0x10000;
+
+using RtlGetCompressionWorkSpaceSizeFn = NTSTATUS(WINAPI*)(USHORT, PULONG, PULONG);
+using RtlCompressBufferFn = NTSTATUS(WINAPI*)(USHORT, PUCHAR, ULONG, PUCHAR, ULONG, ULONG, PULONG, PVOID);
+
+// Compressible data, like text with some binary
+std::vector<BYTE> Data(size_t cbData)
+{
+    const char* words[] = {"alpha ", "beta ", "gamma ", "delta ", "epsilon ", "0123456789", "\r\n"};
+
+    std::mt19937 generator(42);
+    std::vector<BYTE> data;
+    data.reserve(cbData);
+
+    while (data.size() < cbData)
+    {
+        if (generator() % 10 == 0)
+        {
+            for (auto i = generator() % 64; i > 0; i--)
+                data.push_back(static_cast<BYTE>(generator()));
+        }
+        else
+        {
+            const auto word = words[generator() % std::size(words)];
+            data.insert(data.end(), word, word + strlen(word));
+        }
+    }
+    data.resize(cbData);
+    return data;
+}
+
+// LZNT1 compression of each unit by ntdll, padded with zeroes (the sparse tail of the unit on disk)
+std::vector<BYTE> CompressUnits(const std::vector<BYTE>& data)
+{
+    const auto ntdll = GetModuleHandleW(L"ntdll.dll");
+    const auto getWorkSpaceSize =
+        reinterpret_cast<RtlGetCompressionWorkSpaceSizeFn>(GetProcAddress(ntdll, "RtlGetCompressionWorkSpaceSize"));
+    const auto compressBuffer = reinterpret_cast<RtlCompressBufferFn>(GetProcAddress(ntdll, "RtlCompressBuffer"));
+    Assert::IsTrue(getWorkSpaceSize != nullptr && compressBuffer != nullptr);
+
+    ULONG cbWorkSpace = 0L, cbFragmentWorkSpace = 0L;
+    Assert::AreEqual(0L, getWorkSpaceSize(COMPRESSION_FORMAT_LZNT1, &cbWorkSpace, &cbFragmentWorkSpace));
+    std::vector<BYTE> workSpace(cbWorkSpace);
+
+    std::vector<BYTE> compressed(data.size(), 0);
+    for (size_t offset = 0; offset < data.size(); offset += kCompressionUnit)
+    {
+        ULONG cbCompressed = 0L;
+        Assert::AreEqual(
+            0L,
+            compressBuffer(
+                COMPRESSION_FORMAT_LZNT1,
+                const_cast<PUCHAR>(data.data() + offset),
+                kCompressionUnit,
+                compressed.data() + offset,
+                kCompressionUnit,
+                4096,
+                &cbCompressed,
+                workSpace.data()));
+        Assert::IsTrue(cbCompressed < kCompressionUnit);
+    }
+    return compressed;
+}
+
+std::shared_ptr<UncompressNTFSStream> OpenStream(std::vector<BYTE>& compressed, DWORD dwReadAhead)
+{
+    auto chained = std::make_shared<MemoryStream>();
+    Assert::IsTrue(SUCCEEDED(chained->OpenForReadOnly(compressed.data(), compressed.size())));
+
+    auto stream = std::make_shared<UncompressNTFSStream>();
+    Assert::IsTrue(SUCCEEDED(stream->Open(std::static_pointer_cast<ByteStream>(chained), kCompressionUnit)));
+    stream->SetReadAhead(dwReadAhead);
+    return stream;
+}
+
+}  // namespace
+
+namespace Orc::Test {
+TEST_CLASS(NTFSCompression)
+{
+private:
+    UnitTestHelper helper;
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(Lznt1Decompress)
+    {
+        const auto data = Data(16 * kCompressionUnit);
+        auto compressed = CompressUnits(data);
+
+        std::vector<BYTE> expanded(kCompressionUnit);
+        std::vector<BYTE> reference(kCompressionUnit);
+
+        for (size_t offset = 0; offset < data.size(); offset += kCompressionUnit)
+        {
+            Assert::IsTrue(SUCCEEDED(
+                lznt1_decompress(compressed.data() + offset, kCompressionUnit, expanded.data(), expanded.size())));
+            Assert::IsTrue(memcmp(expanded.data(), data.data() + offset, kCompressionUnit) == 0);
+
+            Assert::IsTrue(SUCCEEDED(
+                ntfs_decompress(reference.data(), reference.size(), compressed.data() + offset, kCompressionUnit)));
+            Assert::IsTrue(reference == expanded);
+        }
+
+        // a truncated unit is an error, not an overflow
+        Assert::IsTrue(FAILED(lznt1_decompress(compressed.data(), 100, expanded.data(), expanded.size())));
+    }
+
+    TEST_METHOD(UncompressStreamReadAhead)
+    {
+        const auto data = Data(40 * kCompressionUnit);
+        auto compressed = CompressUnits(data);
+
+        for (DWORD dwReadAhead : {0L, 8L})
+        {
+            auto stream = OpenStream(compressed, dwReadAhead);
+
+            // small, unaligned, reads
+            std::vector<BYTE> read;
+            std::vector<BYTE> block(3000);
+            for (;;)
+            {
+                ULONGLONG ullRead = 0LL;
+                Assert::IsTrue(SUCCEEDED(stream->Read(block.data(), block.size(), &ullRead)));
+                if (ullRead == 0LL)
+                    break;
+                read.insert(read.end(), block.begin(), block.begin() + static_cast<size_t>(ullRead));
+            }
+            Assert::IsTrue(read == data);
+
+            // a read larger than the window, after a seek in the middle of a unit
+            ULONG64 ullPosition = 0LL;
+            Assert::IsTrue(SUCCEEDED(stream->SetFilePointer(kCompressionUnit + 10, FILE_BEGIN, &ullPosition)));
+
+            std::vector<BYTE> large(20 * kCompressionUnit);
+            ULONGLONG ullRead = 0LL;
+            Assert::IsTrue(SUCCEEDED(stream->Read(large.data(), large.size(), &ullRead)));
+            Assert::AreEqual(large.size(), static_cast<size_t>(ullRead));
+            Assert::IsTrue(memcmp(large.data(), data.data() + ullPosition, large.size()) == 0);
+        }
+    }
+
+    // Not a functional test: decompression throughput of each decoder, and of the stream with small reads
+    BEGIN_TEST_METHOD_ATTRIBUTE(Lznt1Benchmark)
+    TEST_IGNORE()
+    END_TEST_METHOD_ATTRIBUTE()
+    TEST_METHOD(Lznt1Benchmark)
+    {
+        const auto data = Data(1024 * kCompressionUnit);
+        auto compressed = CompressUnits(data);
+
+        const auto Throughput = [&](const std::function<void()>& decompress) {
+            const auto start = std::chrono::steady_clock::now();
+            decompress();
+            const auto duration = std::chrono::steady_clock::now() - start;
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+            return (data.size() / (1024 * 1024)) * 1000 / std::max<long long>(ms, 1);
+        };
+
+        std::vector<BYTE> expanded(kCompressionUnit);
+
+        const auto sleuthkit = Throughput([&]() {
+            for (size_t offset = 0; offset < data.size(); offset += kCompressionUnit)
+            {
+                NTFS_COMP_INFO info;
+                info.buf_size_b = kCompressionUnit;
+                info.comp_buf = reinterpret_cast<char*>(compressed.data() + offset);
+                info.comp_len = kCompressionUnit;
+                info.uncomp_buf = reinterpret_cast<char*>(expanded.data());
+                info.uncomp_idx = 0L;
+                Assert::IsTrue(SUCCEEDED(ntfs_uncompress_compunit(&info)));
+            }
+        });
+
+        const auto ntfs3g = Throughput([&]() {
+            for (size_t offset = 0; offset < data.size(); offset += kCompressionUnit)
+                Assert::IsTrue(SUCCEEDED(
+                    ntfs_decompress(expanded.data(), expanded.size(), compressed.data() + offset, kCompressionUnit)));
+        });
+
+        const auto lznt1 = Throughput([&]() {
+            for (size_t offset = 0; offset < data.size(); offset += kCompressionUnit)
+                Assert::IsTrue(SUCCEEDED(
+                    lznt1_decompress(compressed.data() + offset, kCompressionUnit, expanded.data(), expanded.size())));
+        });
+
+        const auto StreamThroughput = [&](DWORD dwReadAhead) {
+            auto stream = OpenStream(compressed, dwReadAhead);
+            std::vector<BYTE> block(4096);
+            return Throughput([&]() {
+                ULONGLONG ullRead = 0LL;
+                do
+                {
+                    Assert::IsTrue(SUCCEEDED(stream->Read(block.data(), block.size(), &ullRead)));
+                } while (ullRead > 0LL);
+            });
+        };
+
+        const auto stream = StreamThroughput(0L);
+        const auto readAhead = StreamThroughput(16L);
+
+        Logger::WriteMessage(
+            fmt::format(
+                L"LZNT1 of {}MB: SleuthKit {}MB/s, NTFS-3G {}MB/s, lznt1_decompress {}MB/s, stream (4K reads) {}MB/s, "
+                L"with read ahead {}MB/s\n",
+                data.size() / (1024 * 1024),
+                sleuthkit,
+                ntfs3g,
+                lznt1,
+                stream,
+                readAhead)
+                .c_str());
+    }
+};
+}  // namespace Orc::Test
@@ -0,0 +1,380 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "RegistryWalker.h"
+#include "RegistryHiveView.h"
+#include "RegFind.h"
+#include "MemoryStream.h"
+#include "FileStream.h"
+#include "Temporary.h"
+
+#include <map>
+
+#include <concrt.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace {
+
+// Offsets of the cells relative to the first hbin
+constexpr DWORD kRootKey = 0x20;
+constexpr DWORD kRootSubKeys = 0x100;
+constexpr DWORD kRootValues = 0x180;
+constexpr DWORD kRootValue = 0x1A0;
+constexpr DWORD kAlpha = 0x200;
+constexpr DWORD kAlphaValues = 0x300;
+constexpr DWORD kAlphaValue = 0x320;
+constexpr DWORD kAlphaData = 0x18000;
+constexpr DWORD kBeta = 0xEFE0;  // crosses the end of the first 64K page of the file
+
+constexpr DWORD kHBinSize = 0x20000;
+
+template <typename T>
+T* Cell(std::vector<BYTE>& hive, DWORD dwOffset, DWORD dwCellSize)
+{
+    auto pCell = reinterpret_cast<T*>(hive.data() + 0x1000 + dwOffset);
+    reinterpret_cast<BlockHeader*>(pCell)->BlockSize = static_cast<DWORD>(-static_cast<LONG>(dwCellSize));
+    return pCell;
+}
+
+void Key(
+    std::vector<BYTE>& hive,
+    DWORD dwOffset,
+    KeyType type,
+    const char* szName,
+    DWORD dwParent,
+    DWORD dwSubKeys,
+    DWORD dwSubKeyList,
+    DWORD dwValues,
+    DWORD dwValueList)
+{
+    auto pKey = Cell<KeyHeader>(hive, dwOffset, 0x80);
+    memcpy(pKey->Signature, "nk", 2);
+    pKey->Type = type;
+    pKey->OffsetToParent = dwParent;
+    pKey->NumberOfSubKeys = dwSubKeys;
+    pKey->OffsetToLFHeader = dwSubKeyList;
+    pKey->NumberOfValues = dwValues;
+    pKey->OffsetToValueList = dwValueList;
+    pKey->OffsetToSKHeader = 0xFFFFFFFF;
+    pKey->OffsetToClassName = 0xFFFFFFFF;
+    pKey->NameLength = static_cast<WORD>(strlen(szName));
+    memcpy(pKey->Name, szName, strlen(szName));
+}
+
+void Value(std::vector<BYTE>& hive, DWORD dwOffset, const char* szName, ValueType type, DWORD dwLength, DWORD dwData)
+{
+    auto pValue = Cell<ValueHeader>(hive, dwOffset, 0x30);
+    memcpy(pValue->Signature, "vk", 2);
+    pValue->NameLength = static_cast<WORD>(strlen(szName));
+    pValue->DataLength = dwLength;
+    pValue->OffsetToData = dwData;
+    pValue->Type = type;
+    memcpy(pValue->Name, szName, strlen(szName));
+}
+
+// \Alpha (with a binary value stored in its own cell), \Beta and a resident DWORD value in the root key
+std::vector<BYTE> MakeHive()
+{
+    std::vector<BYTE> hive(0x1000 + kHBinSize, 0);
+
+    auto pRegFile = reinterpret_cast<RegistryFile*>(hive.data());
+    memcpy(pRegFile->Signature, "regf", 4);
+    pRegFile->Reserved1 = pRegFile->Reserved2 = 1;
+    pRegFile->OffsetToKeyRecord = kRootKey;
+    pRegFile->DataBlockSize = kHBinSize;
+
+    auto pHBin = reinterpret_cast<HBINHeader*>(hive.data() + 0x1000);
+    memcpy(pHBin->Signature, "hbin", 4);
+    pHBin->OffsetToNext = kHBinSize;
+
+    Key(hive, kRootKey, KeyType::rootkey, "ROOT", 0xFFFFFFFF, 2, kRootSubKeys, 1, kRootValues);
+
+    auto pSubKeys = Cell<LF_LH_Header>(hive, kRootSubKeys, 0x18);
+    memcpy(pSubKeys->Signature, "lf", 2);
+    pSubKeys->NumberOfKeys = 2;
+    pSubKeys->Records[0].OffsetToKeyHeader = kAlpha;
+    pSubKeys->Records[1].OffsetToKeyHeader = kBeta;
+
+    Cell<ValuesArray>(hive, kRootValues, 0x10)->ValueOffsets[0] = kRootValue;
+    Value(hive, kRootValue, "Version", ValueType::RegDWORD, 0x80000004, 42);
+
+    Key(hive, kAlpha, KeyType::key, "Alpha", kRootKey, 0, 0xFFFFFFFF, 1, kAlphaValues);
+    Cell<ValuesArray>(hive, kAlphaValues, 0x10)->ValueOffsets[0] = kAlphaValue;
+    Value(hive, kAlphaValue, "Data", ValueType::RegBin, 16, kAlphaData);
+    auto pData = Cell<DataHeader>(hive, kAlphaData, 0x18);
+    for (BYTE i = 0; i < 16; i++)
+        pData->Data[i] = i;
+
+    Key(hive, kBeta, KeyType::key, "Beta", kRootKey, 0, 0xFFFFFFFF, 0, 0xFFFFFFFF);
+    return hive;
+}
+
+// Key names and values (with their data) met while walking the hive
+std::map<std::string, std::vector<BYTE>> Walk(ByteStream& stream, bool bParallel = false)
+{
+    RegistryHive hive;
+    Assert::IsTrue(SUCCEEDED(hive.LoadHive(stream)));
+
+    concurrency::critical_section cs;
+    std::map<std::string, std::vector<BYTE>> result;
+
+    auto onKey = [&result, &cs](const RegistryKey* const pKey) {
+        concurrency::critical_section::scoped_lock sl(cs);
+        result[pKey->GetKeyName()];
+    };
+    auto onValue = [&result, &cs](const RegistryValue* const pValue) {
+        const BYTE* pData = nullptr;
+        const auto cbData = pValue->GetDatas(&pData);
+
+        concurrency::critical_section::scoped_lock sl(cs);
+        result[pValue->GetParentKey()->GetKeyName() + ":" + pValue->GetValueName()].assign(pData, pData + cbData);
+    };
+
+    if (bParallel)
+        Assert::IsTrue(SUCCEEDED(hive.ParallelWalk(onKey, onValue)));
+    else
+        Assert::IsTrue(SUCCEEDED(hive.Walk(onKey, onValue)));
+    return result;
+}
+
+void CheckWalk(const std::map<std::string, std::vector<BYTE>>& result)
+{
+    Assert::AreEqual(static_cast<size_t>(5), result.size());
+    Assert::IsTrue(result.count("") == 1);
+    Assert::IsTrue(result.count("\\Alpha") == 1);
+    Assert::IsTrue(result.count("\\Beta") == 1);
+
+    const std::vector<BYTE> version = {42, 0, 0, 0};
+    Assert::IsTrue(result.at(":Version") == version);
+
+    const auto& data = result.at("\\Alpha:Data");
+    Assert::AreEqual(static_cast<size_t>(16), data.size());
+    for (BYTE i = 0; i < 16; i++)
+        Assert::IsTrue(data[i] == i);
+}
+
+}  // namespace
+
+namespace Orc::Test {
+TEST_CLASS(RegistryHiveTest)
+{
+private:
+    UnitTestHelper helper;
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(PagedView)
+    {
+        auto hive = MakeHive();
+
+        MemoryStream stream;
+        Assert::IsTrue(SUCCEEDED(stream.OpenForReadOnly(hive.data(), hive.size())));
+
+        RegistryHiveView view(RegistryHiveView::kPageSize);
+        Assert::IsTrue(SUCCEEDED(view.Open(stream)));
+        Assert::IsTrue(view.GetMode() == RegistryHiveView::Mode::Paged);
+
+        // a cell across two pages is read whole
+        auto pBeta = reinterpret_cast<const KeyHeader*>(view.GetCell(kBeta));
+        Assert::IsTrue(memcmp(pBeta, hive.data() + 0x1000 + kBeta, 0x80) == 0);
+        Assert::AreEqual(static_cast<ULONGLONG>(0x1000 + kBeta), view.OffsetOf(pBeta));
+
+        auto pData = view.GetCell(kAlphaData);
+        Assert::IsTrue(memcmp(pData, hive.data() + 0x1000 + kAlphaData, 0x18) == 0);
+
+        // out of the hive
+        auto pNowhere = reinterpret_cast<const BlockHeader*>(view.GetCell(0x100000));
+        Assert::AreEqual(0UL, pNowhere->BlockSize);
+        Assert::AreEqual(static_cast<ULONGLONG>(-1), view.OffsetOf(pNowhere));
+
+        view.Trim();
+        pData = view.GetCell(kAlphaData);
+        Assert::IsTrue(memcmp(pData, hive.data() + 0x1000 + kAlphaData, 0x18) == 0);
+
+        CheckWalk(Walk(stream));
+    }
+
+    TEST_METHOD(ParallelWalk)
+    {
+        auto hive = MakeHive();
+
+        MemoryStream stream;
+        Assert::IsTrue(SUCCEEDED(stream.OpenForReadOnly(hive.data(), hive.size())));
+
+        const auto result = Walk(stream, true);
+        CheckWalk(result);
+        Assert::IsTrue(result == Walk(stream));
+    }
+
+    TEST_METHOD(ParallelWalkWithoutView)
+    {
+        // the view of a hive that is not loaded cannot be shared: the walk fails like a sequential one
+        RegistryHive hive;
+
+        ULONG ulKeys = 0L;
+        auto onKey = [&ulKeys](const RegistryKey* const) { ulKeys++; };
+        auto onValue = [](const RegistryValue* const) {};
+
+        const HRESULT hr = hive.ParallelWalk(onKey, onValue);
+        Assert::IsTrue(FAILED(hr));
+        Assert::IsTrue(hr == hive.Walk(onKey, onValue));
+        Assert::AreEqual(0UL, ulKeys);
+    }
+
+    TEST_METHOD(RegFindFilters)
+    {
+        auto hive = MakeHive();
+
+        auto stream = std::make_shared<MemoryStream>();
+        Assert::IsTrue(SUCCEEDED(stream->OpenForReadOnly(hive.data(), hive.size())));
+
+        const auto Term = [](RegFind::SearchTerm::Criteria criteria) {
+            auto term = std::make_shared<RegFind::SearchTerm>();
+            term->m_criteriaRequired = criteria;
+            return term;
+        };
+        const auto Contains = [](RegFind::SearchTerm& term, std::initializer_list<BYTE> bytes) {
+            term.m_DataContentContains.SetData(bytes.begin(), bytes.size());
+            term.m_WDataContentContains.SetData(bytes.begin(), bytes.size());
+        };
+
+        const auto valueAndData = static_cast<RegFind::SearchTerm::Criteria>(
+            RegFind::SearchTerm::Criteria::VALUE_NAME_REGEX | RegFind::SearchTerm::Criteria::DATA_CONTAINS);
+
+        auto data = Term(valueAndData);
+        data->m_strValueName = "Dat.*";
+        data->m_regexValueName.assign(data->m_strValueName, std::regex::ECMAScript | std::regex::icase);
+        Contains(*data, {3, 4, 5});
+
+        auto notInData = Term(valueAndData);
+        notInData->m_strValueName = "Data";
+        notInData->m_regexValueName.assign(notInData->m_strValueName, std::regex::ECMAScript | std::regex::icase);
+        Contains(*notInData, {5, 3});
+
+        auto alpha = Term(RegFind::SearchTerm::Criteria::KEY_NAME_REGEX);
+        alpha->m_strKeyName = "ALPH.";
+        alpha->m_regexKeyName.assign(alpha->m_strKeyName, std::regex::ECMAScript | std::regex::icase);
+
+        auto gamma = Term(RegFind::SearchTerm::Criteria::KEY_NAME_REGEX);
+        gamma->m_strKeyName = "Gamm.";
+        gamma->m_regexKeyName.assign(gamma->m_strKeyName, std::regex::ECMAScript | std::regex::icase);
+
+        RegFind regfind;
+        for (const auto& term : {data, notInData, alpha, gamma})
+            Assert::IsTrue(SUCCEEDED(regfind.AddSearchTerm(term)));
+
+        std::map<const RegFind::SearchTerm*, std::vector<std::string>> found;
+        const auto onMatch = [&found](const std::vector<std::shared_ptr<RegFind::Match>>& matches) {
+            for (const auto& match : matches)
+            {
+                for (const auto& key : match->MatchingKeys)
+                    found[match->Term.get()].push_back(key.KeyName);
+                for (const auto& value : match->MatchingValues)
+                    found[match->Term.get()].push_back(value.KeyName + ":" + value.ValueName);
+            }
+        };
+        Assert::IsTrue(SUCCEEDED(regfind.Find(stream, onMatch, onMatch)));
+
+        Assert::AreEqual(static_cast<size_t>(2), found.size());
+        Assert::IsTrue(found[data.get()] == std::vector<std::string> {"\\Alpha:Data"});
+        Assert::IsTrue(found[alpha.get()] == std::vector<std::string> {"\\Alpha"});
+    }
+
+    TEST_METHOD(RegFindEscapedRegexFilters)
+    {
+        auto hive = MakeHive();
+
+        auto stream = std::make_shared<MemoryStream>();
+        Assert::IsTrue(SUCCEEDED(stream->OpenForReadOnly(hive.data(), hive.size())));
+
+        // character codes in the regex are not literal text for the pre-filter
+        const auto KeyTerm = [](const std::string& regex) {
+            auto term = std::make_shared<RegFind::SearchTerm>();
+            term->m_criteriaRequired = RegFind::SearchTerm::Criteria::KEY_NAME_REGEX;
+            term->m_strKeyName = regex;
+            term->m_regexKeyName.assign(regex, std::regex::ECMAScript | std::regex::icase);
+            return term;
+        };
+
+        auto alpha = KeyTerm("\\x41lph.");
+        auto beta = KeyTerm("B\\u0065ta");
+
+        auto data = std::make_shared<RegFind::SearchTerm>();
+        data->m_criteriaRequired = RegFind::SearchTerm::Criteria::VALUE_NAME_REGEX;
+        data->m_strValueName = "\\x44ata";
+        data->m_regexValueName.assign(data->m_strValueName, std::regex::ECMAScript | std::regex::icase);
+
+        RegFind regfind;
+        for (const auto& term : {alpha, beta, data})
+            Assert::IsTrue(SUCCEEDED(regfind.AddSearchTerm(term)));
+
+        std::map<const RegFind::SearchTerm*, std::vector<std::string>> found;
+        const auto onMatch = [&found](const std::vector<std::shared_ptr<RegFind::Match>>& matches) {
+            for (const auto& match : matches)
+            {
+                for (const auto& key : match->MatchingKeys)
+                    found[match->Term.get()].push_back(key.KeyName);
+                for (const auto& value : match->MatchingValues)
+                    found[match->Term.get()].push_back(value.KeyName + ":" + value.ValueName);
+            }
+        };
+        Assert::IsTrue(SUCCEEDED(regfind.Find(stream, onMatch, onMatch)));
+
+        Assert::AreEqual(static_cast<size_t>(3), found.size());
+        Assert::IsTrue(found[alpha.get()] == std::vector<std::string> {"\\Alpha"});
+        Assert::IsTrue(found[beta.get()] == std::vector<std::string> {"\\Beta"});
+        Assert::IsTrue(found[data.get()] == std::vector<std::string> {"\\Alpha:Data"});
+    }
+
+    TEST_METHOD(MappedView)
+    {
+        auto hive = MakeHive();
+
+        // A small "nk" cell at the very end of the hive: its header crosses the end of the mapping
+        constexpr DWORD kLast = kHBinSize - 8;
+        memcpy(Cell<KeyHeader>(hive, kLast, 8)->Signature, "nk", 2);
+
+        WCHAR szTempDir[MAX_PATH];
+        Assert::IsTrue(SUCCEEDED(UtilGetTempDirPath(szTempDir, MAX_PATH)));
+
+        std::wstring strHivePath;
+        Assert::IsTrue(SUCCEEDED(UtilGetUniquePath(szTempDir, L"hive", strHivePath)));
+
+        {
+            FileStream stream;
+            Assert::IsTrue(SUCCEEDED(stream.OpenFile(
+                strHivePath.c_str(), GENERIC_WRITE | GENERIC_READ, 0L, NULL, CREATE_ALWAYS, 0L, NULL)));
+            ULONGLONG ullWritten = 0LL;
+            Assert::IsTrue(SUCCEEDED(stream.Write(hive.data(), hive.size(), &ullWritten)));
+
+            RegistryHiveView view;
+            Assert::IsTrue(SUCCEEDED(view.Open(stream)));
+            Assert::IsTrue(view.GetMode() == RegistryHiveView::Mode::Mapped);
+
+            auto pLast = reinterpret_cast<const KeyHeader*>(view.GetCell(kLast));
+            Assert::IsTrue(!strncmp(pLast->Signature, "nk", 2));
+            Assert::AreEqual(static_cast<ULONGLONG>(0x1000 + kLast), view.OffsetOf(pLast));
+            Assert::AreEqual(static_cast<WORD>(0), pLast->NameLength);
+            Assert::IsTrue(view.Get(0x1000 + kLast, 0x100) == reinterpret_cast<const BYTE*>(pLast));
+
+            auto pRoot = view.GetCell(kRootKey);
+            Assert::AreEqual(static_cast<ULONGLONG>(0x1000 + kRootKey), view.OffsetOf(pRoot));
+            view.Close();
+
+            CheckWalk(Walk(stream));
+        }
+
+        DeleteFile(strHivePath.c_str());
+    }
+};
+}  // namespace Orc::Test
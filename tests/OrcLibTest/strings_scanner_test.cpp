@@ -0,0 +1,403 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "StringsScanner.h"
+#include "StringsStream.h"
+#include "MemoryStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace {
+
+using Span = StringsScanner::Span;
+using Encoding = StringsScanner::Encoding;
+
+std::vector<Span> Scan(const std::vector<BYTE>& data, size_t minChars)
+{
+    StringsScanner scanner;
+    scanner.Load(data.data(), data.size(), minChars);
+
+    std::vector<Span> spans;
+    scanner.Scan([&spans](const Span& span) { spans.push_back(span); });
+    return spans;
+}
+
+// String at 'offset', as StringsStream extracted it byte per byte before StringsScanner
+Span ReferenceSpan(const std::vector<BYTE>& data, size_t offset)
+{
+    Span span {offset, 0, Encoding::Ascii};
+    if (!StringsScanner::IsPrintable(data[offset]))
+        return span;
+
+    if (offset + 1 < data.size() && data[offset + 1] == 0)
+    {
+        span.Type = Encoding::Utf16;
+        while (offset + 2 * span.Length + 1 < data.size()
+               && StringsScanner::IsPrintable(data[offset + 2 * span.Length])
+               && data[offset + 2 * span.Length + 1] == 0)
+            span.Length++;
+    }
+    else
+    {
+        while (offset + span.Length < data.size() && StringsScanner::IsPrintable(data[offset + span.Length]))
+            span.Length++;
+    }
+
+    return span;
+}
+
+std::vector<Span> ReferenceScan(const std::vector<BYTE>& data, size_t minChars)
+{
+    std::vector<Span> spans;
+
+    size_t offset = 0;
+    while (offset + minChars < data.size())
+    {
+        const Span span = ReferenceSpan(data, offset);
+
+        if (span.Length > 0 && span.Length >= minChars)
+        {
+            spans.push_back(span);
+            offset = StringsScanner::End(span);
+        }
+        else
+        {
+            offset++;
+        }
+    }
+
+    return spans;
+}
+
+// Stack string at 'offset', as StringsStream extracted it before StringsScanner: 'C6 45' pushes were never extracted
+// and only word pushes of UTF-16 characters are supported here (the other pushes depended on the previous content of
+// the output buffer). Returns false if there is no such push at 'offset'.
+bool ReferenceStackString(const std::vector<BYTE>& data, size_t offset, std::string& chars, size_t& cbProcessed)
+{
+    struct Push
+    {
+        std::vector<BYTE> opcode;
+        size_t instSize;
+        size_t immSize;
+    };
+
+    static const std::vector<Push> pushes = {
+        {{0xC6, 0x45}, 4, 1}, {{0x66, 0xC7, 0x45}, 6, 2}, {{0x66, 0xC7, 0x85}, 9, 2}};
+
+    const auto Matches = [&data](const Push& push, size_t offset) {
+        return offset + push.opcode.size() <= data.size()
+            && std::equal(std::cbegin(push.opcode), std::cend(push.opcode), std::cbegin(data) + offset);
+    };
+
+    const auto push = std::find_if(
+        std::cbegin(pushes), std::cend(pushes), [&](const Push& push) { return Matches(push, offset); });
+    if (push == std::cend(pushes))
+        return false;
+
+    chars.clear();
+    cbProcessed = 0;
+    if (push->opcode[0] == 0xC6)
+        return true;
+
+    bool bTypeDetermined = false;
+    while (offset + cbProcessed + push->instSize < data.size() && Matches(*push, offset + cbProcessed))
+    {
+        const BYTE* pImm = data.data() + offset + cbProcessed + push->instSize - push->immSize;
+        const bool bChar = StringsScanner::IsPrintable(pImm[0]) && pImm[1] == 0;
+
+        cbProcessed += push->instSize;
+        if (bChar)
+            chars.push_back(pImm[0]);
+        else if (bTypeDetermined)
+            break;
+
+        bTypeDetermined |= bChar;
+    }
+
+    return true;
+}
+
+// Output of StringsStream before StringsScanner
+std::string ReferenceStrings(const std::vector<BYTE>& data, size_t minChars)
+{
+    std::string strings;
+
+    size_t offset = 0;
+    while (offset + minChars < data.size())
+    {
+        std::string chars;
+        size_t cbProcessed = 0;
+
+        if (!ReferenceStackString(data, offset, chars, cbProcessed))
+        {
+            const Span span = ReferenceSpan(data, offset);
+            for (size_t i = 0; i < span.Length; i++)
+                chars.push_back(data[span.Type == Encoding::Utf16 ? offset + 2 * i : offset + i]);
+            cbProcessed = StringsScanner::End(span) - offset;
+        }
+
+        if (!chars.empty() && chars.size() >= minChars)
+        {
+            strings += chars + "\r\n";
+            offset += cbProcessed;
+        }
+        else
+        {
+            offset++;
+        }
+    }
+
+    return strings;
+}
+
+std::string ExtractStrings(const std::vector<BYTE>& data, size_t minChars)
+{
+    auto input = std::make_shared<MemoryStream>();
+    Assert::IsTrue(S_OK == input->OpenForReadWrite(4096));
+    Assert::IsTrue(S_OK == input->Write((const PVOID)data.data(), data.size(), nullptr));
+    Assert::IsTrue(S_OK == input->SetFilePointer(0, FILE_BEGIN, nullptr));
+
+    StringsStream strings;
+    Assert::IsTrue(S_OK == strings.OpenForStrings(input, minChars, 1024));
+
+    std::vector<BYTE> output(data.size());
+    ULONGLONG cbRead = 0LL;
+    Assert::IsTrue(S_OK == strings.Read(output.data(), output.size(), &cbRead));
+
+    return std::string(reinterpret_cast<const char*>(output.data()), static_cast<size_t>(cbRead));
+}
+
+void Append(std::vector<BYTE>& data, const std::string& ascii)
+{
+    data.insert(std::end(data), std::cbegin(ascii), std::cend(ascii));
+}
+
+void AppendUtf16(std::vector<BYTE>& data, const std::string& ascii)
+{
+    for (const auto c : ascii)
+    {
+        data.push_back(c);
+        data.push_back(0);
+    }
+}
+
+// mov word [ebp+disp8], imm16 for each character, as compiled for a wchar_t array on the stack
+void AppendWordPushes(std::vector<BYTE>& data, const std::string& ascii)
+{
+    BYTE disp = 0xD0;
+    for (const auto c : ascii)
+        data.insert(std::end(data), {0x66, 0xC7, 0x45, disp++, static_cast<BYTE>(c), 0x00});
+}
+
+std::vector<BYTE> RandomData(size_t cbData)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 0xFF);
+
+    std::vector<BYTE> data(cbData);
+    std::generate(std::begin(data), std::end(data), [&]() { return static_cast<BYTE>(distribution(generator)); });
+    return data;
+}
+
+// Code, padding, ASCII and UTF-16 strings, as in the sections of an executable
+std::vector<BYTE> PortableExecutableData(size_t cbData)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 0xFF);
+
+    std::vector<BYTE> data;
+    data.reserve(cbData + 0x1000);
+
+    while (data.size() < cbData)
+    {
+        const auto length = distribution(generator) % 64 + 1;
+
+        switch (distribution(generator) % 4)
+        {
+            case 0:
+                for (auto i = 0; i < length * 8; i++)
+                    data.push_back(static_cast<BYTE>(distribution(generator)));
+                break;
+            case 1:
+                data.insert(std::end(data), length * 8, 0);
+                break;
+            case 2:
+                Append(data, std::string(length, static_cast<char>('a' + length % 26)));
+                data.push_back(0);
+                break;
+            case 3:
+                AppendUtf16(data, std::string(length, static_cast<char>('A' + length % 26)));
+                data.insert(std::end(data), 2, 0);
+                break;
+        }
+    }
+
+    data.resize(cbData);
+    return data;
+}
+
+}  // namespace
+
+namespace Orc::Test {
+TEST_CLASS(StringsScannerTest)
+{
+private:
+    UnitTestHelper helper;
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) { StringsScanner::EnableAvx2(true); }
+
+    TEST_METHOD(StringsScannerBasicTest)
+    {
+        std::vector<BYTE> data;
+        Append(data, "\x01\x02" "abc");
+        AppendUtf16(data, "unicode");
+        data.push_back(0xFF);
+        Append(data, "ascii string");
+        data.insert(std::end(data), 3, 0);
+
+        // "abc" and the first character of "unicode" make an ASCII string
+        const auto spans = Scan(data, 4);
+        Assert::IsTrue(spans.size() == 3);
+        Assert::IsTrue(spans[0] == Span {2, 4, Encoding::Ascii});
+        Assert::IsTrue(spans[1] == Span {7, 6, Encoding::Utf16});
+        Assert::IsTrue(spans[2] == Span {20, 12, Encoding::Ascii});
+
+        Assert::IsTrue(Scan(data, 13).empty());
+    }
+
+    TEST_METHOD(StringsScannerReferenceTest)
+    {
+        // strings across the 64 bytes words and at the end of the buffer
+        for (const auto& data : {RandomData(4096 + 17), PortableExecutableData(65536 + 63)})
+        {
+            for (const auto minChars : {1, 3, 4, 8})
+            {
+                const auto expected = ReferenceScan(data, minChars);
+
+                StringsScanner::EnableAvx2(false);
+                Assert::IsTrue(Scan(data, minChars) == expected);
+
+                StringsScanner::EnableAvx2(true);
+                Assert::IsTrue(Scan(data, minChars) == expected);
+            }
+        }
+    }
+
+    TEST_METHOD(StringsStreamStackStringsTest)
+    {
+        std::vector<BYTE> data(0x10, 0x90);
+        AppendWordPushes(data, "wide stack string");
+        data.insert(std::end(data), 0x10, 0x90);
+        Append(data, "ascii");
+        data.push_back(0xCC);
+        AppendWordPushes(data, "f");  // too short
+        data.insert(std::end(data), {0xC6, 0x45, 0xD0, 'x'});  // never extracted
+        AppendUtf16(data, "unicode");
+        data.insert(std::end(data), 0x10, 0);
+
+        const auto expected = ReferenceStrings(data, 4);
+        Assert::IsTrue(expected == "wide stack string\r\nascii\r\nunicode\r\n");
+        Assert::IsTrue(ExtractStrings(data, 4) == expected);
+    }
+
+    TEST_METHOD(StringsStreamOffsetsTest)
+    {
+        std::vector<BYTE> data(0x10, 0);
+        Append(data, "first string");
+        data.insert(std::end(data), 0x10, 0xFF);
+        AppendUtf16(data, "second");
+        data.insert(std::end(data), 0x10, 0);
+
+        auto input = std::make_shared<MemoryStream>();
+        Assert::IsTrue(S_OK == input->OpenForReadWrite(4096));
+        Assert::IsTrue(S_OK == input->Write(data.data(), data.size(), nullptr));
+        Assert::IsTrue(S_OK == input->SetFilePointer(0, FILE_BEGIN, nullptr));
+
+        StringsStream strings;
+        Assert::IsTrue(S_OK == strings.OpenForStrings(input, 4, 1024, true));
+
+        std::vector<BYTE> output(data.size());
+        ULONGLONG cbRead = 0LL;
+        Assert::IsTrue(S_OK == strings.Read(output.data(), output.size(), &cbRead));
+
+        const std::string expected = "00000010 first string\r\n0000002C second\r\n";
+        Assert::IsTrue(std::string(reinterpret_cast<const char*>(output.data()), cbRead) == expected);
+    }
+
+    // Not a functional test: throughput of the extraction, with and without AVX2
+    BEGIN_TEST_METHOD_ATTRIBUTE(StringsScannerBenchmark)
+    TEST_IGNORE()
+    END_TEST_METHOD_ATTRIBUTE()
+    TEST_METHOD(StringsScannerBenchmark)
+    {
+        const size_t cbData = 64 * 1024 * 1024;
+        const size_t cbRead = 1024 * 1024;
+
+        const auto Throughput = [&](const std::vector<BYTE>& data, bool bAvx2) {
+            StringsScanner::EnableAvx2(bAvx2);
+
+            StringsScanner scanner;
+            size_t cchStrings = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t offset = 0; offset < data.size(); offset += cbRead)
+            {
+                scanner.Load(data.data() + offset, cbRead, 4);
+                scanner.Scan([&cchStrings](const Span& span) { cchStrings += span.Length; });
+            }
+
+            const auto duration = std::chrono::steady_clock::now() - start;
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+            Assert::IsTrue(cchStrings > 0);
+            return (cbData / (1024 * 1024)) * 1000 / std::max<long long>(ms, 1);
+        };
+
+        const auto ReferenceThroughput = [&](const std::vector<BYTE>& data) {
+            size_t cchStrings = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t offset = 0; offset < data.size(); offset += cbRead)
+            {
+                const std::vector<BYTE> block(data.data() + offset, data.data() + offset + cbRead);
+                for (const auto& span : ReferenceScan(block, 4))
+                    cchStrings += span.Length;
+            }
+
+            const auto duration = std::chrono::steady_clock::now() - start;
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+            Assert::IsTrue(cchStrings > 0);
+            return (cbData / (1024 * 1024)) * 1000 / std::max<long long>(ms, 1);
+        };
+
+        for (const auto& [name, data] :
+             {std::make_pair(L"random", RandomData(cbData)),
+              std::make_pair(L"PE-like", PortableExecutableData(cbData))})
+        {
+            Logger::WriteMessage(
+                fmt::format(
+                    L"Strings of {}MB of {} data: byte per byte {}MB/s, SSE2 {}MB/s, AVX2 ({}) {}MB/s\n",
+                    cbData / (1024 * 1024),
+                    name,
+                    ReferenceThroughput(data),
+                    Throughput(data, false),
+                    StringsScanner::HasAvx2() ? L"available" : L"not available",
+                    Throughput(data, true))
+                    .c_str());
+        }
+    }
+};
+}  // namespace Orc::Test
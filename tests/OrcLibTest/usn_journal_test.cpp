@@ -163,6 +163,66 @@ public:
         }
     }
 
+    TEST_METHOD(USNJournalWalkerOfflineParseChunkTest)
+    {
+        // a V2 record, zeroes, a V3 record, invalid data then another V2 record
+        std::vector<BYTE> journal;
+        const auto a = AppendRecord(journal, 2, L"a.txt");
+        journal.resize(journal.size() + 16, 0);
+        const auto b = AppendRecord(journal, 3, L"b.txt");
+        journal.resize(journal.size() + 8, 0xCC);
+        const auto c = AppendRecord(journal, 2, L"system.LOG");
+
+        const auto cbJournal = static_cast<ULONG>(journal.size());
+
+        std::vector<ULONG> records;
+        auto ulNext = USNJournalWalkerOffline::ParseUSNRecords(journal.data(), cbJournal, cbJournal, 0L, records);
+        Assert::IsTrue(records == std::vector<ULONG> {a, b, c});
+        Assert::IsTrue(ulNext >= cbJournal);
+
+        // the first chunk ends in the V3 record: the next chunk starts after it
+        const ULONG cbFirst = b + 8;
+        records.clear();
+        ulNext = USNJournalWalkerOffline::ParseUSNRecords(journal.data(), cbJournal, cbFirst, 0L, records);
+        Assert::IsTrue(records == std::vector<ULONG> {a, b});
+        Assert::IsTrue(ulNext == c - 8);
+
+        // the second chunk resynchronizes on the last record, on its own or from where the first chunk ended
+        for (const auto ulFrom : {0UL, ulNext - cbFirst})
+        {
+            records.clear();
+            USNJournalWalkerOffline::ParseUSNRecords(
+                journal.data() + cbFirst, cbJournal - cbFirst, cbJournal - cbFirst, ulFrom, records);
+            Assert::IsTrue(records == std::vector<ULONG> {c - cbFirst});
+        }
+
+        // a resynchronization point past the chunk, or a chunk too small for a record length, yields no record
+        records.clear();
+        ulNext = USNJournalWalkerOffline::ParseUSNRecords(journal.data(), cbJournal, cbJournal, MAXULONG - 2, records);
+        Assert::IsTrue(records.empty());
+        Assert::IsTrue(ulNext >= cbJournal);
+
+        ulNext = USNJournalWalkerOffline::ParseUSNRecords(journal.data(), 2, 2, 0L, records);
+        Assert::IsTrue(records.empty());
+    }
+
+    TEST_METHOD(USNJournalWalkerOfflineChunksTest)
+    {
+        for (const auto archive : {L"\\usn_journal\\winxp.7z", L"\\usn_journal\\win7.7z"})
+        {
+            m_NbRecords = 0;
+            m_Records.clear();
+            ProcessArchive(helper.GetDirectoryName(__WFILE__) + archive);
+            const auto sequential = m_Records;
+            Assert::IsTrue(sequential.size() == m_NbRecords);
+
+            m_NbRecords = 0;
+            m_Records.clear();
+            ProcessArchive(helper.GetDirectoryName(__WFILE__) + archive, USNJournalWalkerOffline::kMinChunkSize);
+            Assert::IsTrue(m_Records == sequential);
+        }
+    }
+
     TEST_METHOD(USNJournalWalkerOfflineDifferentOsTest)
     {
         // WIN XP
@@ -191,11 +251,46 @@ public:
 
 private:
     DWORD64 m_NbRecords;
+    std::vector<std::pair<USN, std::wstring>> m_Records;
     typedef std::map<int, OrcArchive::ArchiveItem> ITEMS;
     typedef std::map<int, std::wstring> ITEM_PATHS;
     ITEMS m_Items;
 
-    void ProcessArchive(const std::wstring& archive)
+    // Appends a record named szName, returns its offset
+    static ULONG AppendRecord(std::vector<BYTE>& journal, WORD wMajorVersion, const WCHAR* szName)
+    {
+        const auto ulOffset = static_cast<ULONG>(journal.size());
+        const auto cbName = static_cast<WORD>(wcslen(szName) * sizeof(WCHAR));
+
+        const auto wNameOffset = static_cast<WORD>(
+            wMajorVersion == 3 ? offsetof(USNJournalWalkerBase::USN_RECORD_V3, FileName)
+                               : offsetof(USNJournalWalkerBase::USN_RECORD_V2, FileName));
+        const DWORD cbRecord = (wNameOffset + cbName + 7) & ~7;
+
+        journal.resize(ulOffset + cbRecord, 0);
+        auto pRecord = reinterpret_cast<USNJournalWalkerBase::USN_RECORD_V2*>(journal.data() + ulOffset);
+        pRecord->RecordLength = cbRecord;
+        pRecord->MajorVersion = wMajorVersion;
+        pRecord->MinorVersion = 0;
+
+        if (wMajorVersion == 3)
+        {
+            auto pV3 = reinterpret_cast<USNJournalWalkerBase::USN_RECORD_V3*>(pRecord);
+            pV3->Usn = ulOffset;
+            pV3->FileNameLength = cbName;
+            pV3->FileNameOffset = wNameOffset;
+        }
+        else
+        {
+            pRecord->Usn = ulOffset;
+            pRecord->FileNameLength = cbName;
+            pRecord->FileNameOffset = wNameOffset;
+        }
+        CopyMemory(journal.data() + ulOffset + wNameOffset, szName, cbName);
+        return ulOffset;
+    }
+
+    void ProcessArchive(const std::wstring& archive, DWORD dwChunkSize = 0L)
     {
         // first extract archive
         LPCWSTR archiveStr = archive.c_str();
@@ -250,8 +345,10 @@ private:
             callbacks.RecordCallback =
                 [this](const std::shared_ptr<VolumeReader>& volreader, WCHAR* szFullName, USN_RECORD* pElt) {
                     ++m_NbRecords;
+                    m_Records.emplace_back(pElt->Usn, szFullName);
                 };
 
+            walker.SetChunkSize(dwChunkSize);
             Assert::AreEqual(walker.ReadJournal(callbacks), S_OK);
             // final
             Assert::AreEqual(vbrStream->Close(), S_OK);
@@ -0,0 +1,136 @@
+//
+// SPDX-License-Identifier: LGPL-2.1-or-later
+//
+// Copyright © 2026 ANSSI. All Rights Reserved.
+//
+#include "stdafx.h"
+
+#include "USNRecordStore.h"
+
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Orc;
+using namespace Orc::Test;
+
+namespace {
+
+constexpr DWORDLONG kSequence = 0x0001000000000000LL;
+
+std::vector<BYTE> Record(DWORDLONG frn, DWORDLONG parent, const std::wstring& name, DWORD dwAttributes)
+{
+    std::vector<BYTE> buffer((offsetof(USN_RECORD, FileName) + name.size() * sizeof(WCHAR) + 7) & ~(size_t)7, 0);
+
+    auto pRecord = reinterpret_cast<USN_RECORD*>(buffer.data());
+    pRecord->RecordLength = static_cast<DWORD>(buffer.size());
+    pRecord->MajorVersion = 2;
+    pRecord->FileReferenceNumber = frn;
+    pRecord->ParentFileReferenceNumber = parent;
+    pRecord->Usn = frn * 0x100;
+    pRecord->TimeStamp.QuadPart = 0x01D0000000000000LL + frn;
+    pRecord->Reason = USN_REASON_FILE_CREATE;
+    pRecord->FileAttributes = dwAttributes;
+    pRecord->SecurityId = 0x100;
+    pRecord->FileNameLength = static_cast<WORD>(name.size() * sizeof(WCHAR));
+    pRecord->FileNameOffset = static_cast<WORD>(offsetof(USN_RECORD, FileName));
+    std::copy(begin(name), end(name), pRecord->FileName);
+    return buffer;
+}
+
+}  // namespace
+
+namespace Orc::Test {
+TEST_CLASS(USNRecordStoreTest)
+{
+private:
+    UnitTestHelper helper;
+
+public:
+    TEST_METHOD_INITIALIZE(Initialize) {}
+
+    TEST_METHOD_CLEANUP(Finalize) {}
+
+    TEST_METHOD(USNRecordStoreBasicTest)
+    {
+        USNRecordStore store;
+
+        const auto windows = Record(kSequence | 30, kSequence | 5, L"Windows", FILE_ATTRIBUTE_DIRECTORY);
+        const auto system32 = Record(kSequence | 31, kSequence | 30, L"System32", FILE_ATTRIBUTE_DIRECTORY);
+        const auto file = Record(kSequence | 0x12345678, kSequence | 31, L"kernel32.dll", FILE_ATTRIBUTE_ARCHIVE);
+
+        Assert::IsTrue(S_OK == store.Add(*reinterpret_cast<const USN_RECORD*>(windows.data())));
+        Assert::IsTrue(S_OK == store.Add(*reinterpret_cast<const USN_RECORD*>(system32.data())));
+        Assert::IsTrue(S_OK == store.Add(*reinterpret_cast<const USN_RECORD*>(file.data())));
+        Assert::IsTrue(S_FALSE == store.Add(*reinterpret_cast<const USN_RECORD*>(windows.data())));
+        Assert::IsTrue(store.GetRowCount() == 3);
+
+        // a reference with another sequence number is a reused segment
+        Assert::IsTrue(store.Find((2 * kSequence) | 30) == USNRecordStore::kNoRow);
+        Assert::IsTrue(store.Find(kSequence | 32) == USNRecordStore::kNoRow);
+
+        const DWORD dwRow = store.Find(kSequence | 31);
+        Assert::IsTrue(dwRow != USNRecordStore::kNoRow);
+        Assert::IsTrue(store.FileName(dwRow) == L"System32");
+        Assert::IsTrue(store.ParentFileReferenceNumber(dwRow) == (kSequence | 30));
+
+        std::vector<BYTE> buffer;
+        const auto pRecord = store.GetRecord(store.Find(kSequence | 0x12345678), buffer);
+        const auto pExpected = reinterpret_cast<const USN_RECORD*>(file.data());
+        Assert::IsTrue(pRecord->FileReferenceNumber == pExpected->FileReferenceNumber);
+        Assert::IsTrue(pRecord->ParentFileReferenceNumber == pExpected->ParentFileReferenceNumber);
+        Assert::IsTrue(pRecord->Usn == pExpected->Usn);
+        Assert::IsTrue(pRecord->TimeStamp.QuadPart == pExpected->TimeStamp.QuadPart);
+        Assert::IsTrue(pRecord->Reason == pExpected->Reason);
+        Assert::IsTrue(pRecord->FileAttributes == pExpected->FileAttributes);
+        Assert::IsTrue(pRecord->SecurityId == pExpected->SecurityId);
+        Assert::IsTrue(pRecord->FileNameLength == pExpected->FileNameLength);
+        Assert::IsTrue(memcmp(pRecord->FileName, pExpected->FileName, pExpected->FileNameLength) == 0);
+
+        std::wstring_view path;
+        bool bFlag = false;
+        Assert::IsFalse(store.GetPath(dwRow, path, bFlag));
+        store.SetPath(dwRow, L"\\\\.\\C:Windows\\System32\\", true);
+        Assert::IsTrue(store.GetPath(dwRow, path, bFlag));
+        Assert::IsTrue(path == L"\\\\.\\C:Windows\\System32\\");
+        Assert::IsTrue(bFlag);
+
+        store.Remove(kSequence | 0x12345678);
+        Assert::IsTrue(store.Find(kSequence | 0x12345678) == USNRecordStore::kNoRow);
+        store.Compact();
+        Assert::IsTrue(store.GetRowCount() == 2);
+
+        // rows moved, memoized paths are kept
+        const DWORD dwMoved = store.Find(kSequence | 31);
+        Assert::IsTrue(store.GetPath(dwMoved, path, bFlag));
+        Assert::IsTrue(path == L"\\\\.\\C:Windows\\System32\\");
+    }
+
+    TEST_METHOD(USNRecordStoreInternTest)
+    {
+        USNRecordStore store;
+
+        for (DWORDLONG i = 0; i < 10000; i++)
+        {
+            const auto record = Record(kSequence | (i + 100), kSequence | 5, fmt::format(L"Dir{}", i % 10), 0L);
+            Assert::IsTrue(S_OK == store.Add(*reinterpret_cast<const USN_RECORD*>(record.data())));
+        }
+
+        // segments past the dense index
+        const auto sparse = Record(kSequence | 0x0000100000000000LL, kSequence | 5, L"Dir1", 0L);
+        Assert::IsTrue(S_OK == store.Add(*reinterpret_cast<const USN_RECORD*>(sparse.data())));
+        Assert::IsTrue(store.Find(kSequence | 0x0000100000000000LL) == 10000);
+
+        for (DWORDLONG i = 0; i < 10000; i++)
+        {
+            const DWORD dwRow = store.Find(kSequence | (i + 100));
+            Assert::IsTrue(dwRow == i);
+            Assert::IsTrue(store.FileName(dwRow) == fmt::format(L"Dir{}", i % 10));
+        }
+
+        // the ten names are stored once
+        Assert::IsTrue(store.FileName(10000).data() == store.FileName(1).data());
+        Assert::IsTrue(store.FileName(0).data() == store.FileName(9990).data());
+    }
+};
+}  // namespace Orc::Test
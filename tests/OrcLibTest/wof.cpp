@@ -12,6 +12,8 @@
 #include "MemoryStream.h"
 
 #include "CompressAPIExtension.h"
+#include "UncompressWofStream.h"
+#include "MultiHash.h"
 
 #include <filesystem>
 
@@ -28,6 +30,35 @@ TEST_CLASS(WindowsOverlayFile)
 private:
     UnitTestHelper helper;
 
+    static std::wstring Sha256(const BYTE* pData, size_t cbData)
+    {
+        MultiHash hash(MultiHash::Algorithm::SHA256);
+        hash.Update(pData, cbData);
+
+        CBinaryBuffer digest;
+        if (FAILED(hash.GetHash(MultiHash::Algorithm::SHA256, digest)))
+            return {};
+        return digest.ToHex();
+    }
+
+    // Reads the whole uncompressed stream with reads which are not aligned on chunks
+    static std::vector<BYTE> ReadAll(UncompressWofStream& stream)
+    {
+        std::vector<BYTE> content;
+        CBinaryBuffer block;
+        block.SetCount(10000);
+
+        for (;;)
+        {
+            ULONGLONG ullRead = 0LLU;
+            Assert::IsTrue(SUCCEEDED(stream.Read(block.GetData(), block.GetCount(), &ullRead)));
+            if (ullRead == 0LLU)
+                break;
+            content.insert(end(content), block.GetData(), block.GetData() + ullRead);
+        }
+        return content;
+    }
+
 public:
     TEST_METHOD_INITIALIZE(Initialize)
     {
@@ -90,7 +121,7 @@ public:
             Assert::IsTrue(strMessage._Equal(expandBuffer.GetP<WCHAR>()), L"Note the expected message");
         }
     }
-#ifdef BASIC_WOLF_DECOMPRESSION
+
     TEST_METHOD(BasicWofDecompression)
     {
         auto sample =
@@ -98,52 +129,126 @@ public:
 
         Assert::IsTrue(exists(sample), L"Sample file \\binaries\\vcpkg.exe.WofCompressedData does not exist");
 
-        auto wofStream = std::make_shared<FileStream>();
-        Assert::IsTrue(SUCCEEDED(wofStream->ReadFrom(sample.c_str())));
+        auto compressedStream = std::make_shared<FileStream>();
+        Assert::IsTrue(SUCCEEDED(compressedStream->ReadFrom(sample.c_str())));
 
-        ULONGLONG wofSize = wofStream->GetSize();
+        // vcpkg.exe is compressed with LZX, its unnamed data stream is 921600 bytes
+        constexpr ULONGLONG vcpkgSize = 921600LLU;
 
-        auto compressedStream = std::make_shared<MemoryStream>();
-        Assert::IsTrue(SUCCEEDED(compressedStream->OpenForReadWrite()));
+        auto wofStream = std::make_shared<UncompressWofStream>();
+        Assert::IsTrue(SUCCEEDED(wofStream->Open(compressedStream, WofAlgorithm::LZX, vcpkgSize)));
+        Assert::AreEqual(vcpkgSize, wofStream->GetSize());
 
-        ULONGLONG compressedSize = 0LLU;
-        Assert::IsTrue(SUCCEEDED(wofStream->CopyTo(compressedStream, &compressedSize)));
-        Assert::IsTrue(SUCCEEDED(wofStream->Close()));
+        CBinaryBuffer expanded;
+        expanded.SetCount(static_cast<size_t>(vcpkgSize));
+
+        ULONGLONG ullRead = 0LLU;
+        Assert::IsTrue(SUCCEEDED(wofStream->Read(expanded.GetData(), expanded.GetCount(), &ullRead)));
+        Assert::AreEqual(vcpkgSize, ullRead);
 
-        Assert::AreEqual(compressedSize, wofSize);
-        const auto compressedData = compressedStream->GetConstBuffer();
+        Assert::IsTrue(expanded.Get<BYTE>(0) == 'M' && expanded.Get<BYTE>(1) == 'Z', L"Not a PE file");
+        const auto peOffset = *reinterpret_cast<const DWORD*>(expanded.GetData() + 0x3C);
+        Assert::IsTrue(memcmp(expanded.GetData() + peOffset, "PE\0\0", 4) == 0, L"Not a PE file");
+
+        // reads which are not aligned on chunks must give the same data
+        Assert::IsTrue(SUCCEEDED(wofStream->SetFilePointer(0LL, FILE_BEGIN, nullptr)));
+
+        CBinaryBuffer block;
+        block.SetCount(10000);
+
+        ULONGLONG ullOffset = 0LLU;
+        for (;;)
+        {
+            ULONGLONG ullBlockRead = 0LLU;
+            Assert::IsTrue(SUCCEEDED(wofStream->Read(block.GetData(), block.GetCount(), &ullBlockRead)));
+            if (ullBlockRead == 0LLU)
+                break;
 
+            Assert::IsTrue(
+                memcmp(block.GetData(), expanded.GetData() + ullOffset, static_cast<size_t>(ullBlockRead)) == 0,
+                L"Unaligned read does not match");
+            ullOffset += ullBlockRead;
+        }
+        Assert::AreEqual(vcpkgSize, ullOffset);
+
+        Assert::AreEqual(
+            L"4F19EFE116C10DAC9EF64CF2648B0A489E74E6FFFC8F8AAA244777A62496E864"s,
+            Sha256(expanded.GetData(), expanded.GetCount()),
+            L"Unexpected content of vcpkg.exe");
+
+        Assert::IsTrue(SUCCEEDED(wofStream->Close()));
+    }
+
+    TEST_METHOD(XpressWofDecompression)
+    {
         auto compressAPI = ExtensionLibrary::GetLibrary<CompressAPIExtension>();
-        COMPRESSOR_HANDLE decompressor = INVALID_HANDLE_VALUE;
-        Assert::IsTrue(!compressAPI->CreateDecompressor(COMPRESS_ALGORITHM_MSZIP, nullptr, &decompressor));
+        Assert::IsTrue((bool)compressAPI, L"Could not load compression API cabinet.dll");
 
-        SIZE_T bytesNeeded = 0L;
-        HRESULT hr = E_FAIL;
+        // compressible text followed by pseudo random bytes: some chunks are stored as is, the last one is short
+        std::vector<BYTE> content;
+        for (int i = 0; content.size() < 3 * 16384; i++)
+        {
+            const auto line = "line "s + std::to_string(i) + " of the WOF compressed content\r\n"s;
+            content.insert(end(content), begin(line), end(line));
+        }
+        DWORD dwSeed = 0x12345678;
+        while (content.size() < 5 * 16384 + 1234)
+        {
+            dwSeed = dwSeed * 1103515245 + 12345;
+            content.push_back(static_cast<BYTE>(dwSeed >> 16));
+        }
+        const auto reference = Sha256(content.data(), content.size());
 
-        if (auto hr = compressAPI->Decompress(
-                decompressor,
-                (PVOID)compressedData.GetData(),
-                (SIZE_T)compressedData.GetCount(),
-                nullptr,
-                0L,
-                &bytesNeeded);
-            FAILED(hr))
-            Assert::IsFalse(SUCCEEDED(hr));
-
-        Assert::IsTrue(GetLastError() == ERROR_INSUFFICIENT_BUFFER);
-
-        CBinaryBuffer expandedBytes;
-        expandedBytes.SetCount(bytesNeeded);
-
-        Assert::IsTrue(SUCCEEDED(compressAPI->Decompress(
-            decompressor,
-            (PVOID)compressedData.GetData(),
-            (SIZE_T)compressedData.GetCount(),
-            (PVOID)expandedBytes.GetData(),
-            (SIZE_T)expandedBytes.GetCount(),
-            nullptr)));
-    };
-
-#endif  // BASIC_WOLF_DECOMPRESSION
+        for (const auto algorithm : {WofAlgorithm::Xpress4K, WofAlgorithm::Xpress8K, WofAlgorithm::Xpress16K})
+        {
+            const size_t cbChunkSize = wof_chunk_size(algorithm);
+            const size_t chunks = (content.size() + cbChunkSize - 1) / cbChunkSize;
+
+            // WOF chunks are single Xpress Huffman blocks, as produced by the raw Xpress Huffman compressor
+            COMPRESSOR_HANDLE compressor = nullptr;
+            Assert::IsTrue(SUCCEEDED(
+                compressAPI->CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF | COMPRESS_RAW, nullptr, &compressor)));
+
+            // the offsets of the chunks but the first one, relative to the end of the table, then the chunks
+            std::vector<BYTE> chunkData;
+            std::vector<DWORD> chunkTable;
+            std::vector<BYTE> compressed(cbChunkSize * 2);
+            for (size_t i = 0; i < chunks; i++)
+            {
+                const BYTE* pChunk = content.data() + i * cbChunkSize;
+                const size_t cbChunk = std::min(cbChunkSize, content.size() - i * cbChunkSize);
+
+                SIZE_T cbCompressed = 0L;
+                if (SUCCEEDED(compressAPI->Compress(
+                        compressor, (PVOID)pChunk, cbChunk, compressed.data(), compressed.size(), &cbCompressed))
+                    && cbCompressed < cbChunk)
+                    chunkData.insert(end(chunkData), compressed.data(), compressed.data() + cbCompressed);
+                else
+                    chunkData.insert(end(chunkData), pChunk, pChunk + cbChunk);  // stored as is
+
+                if (i + 1 < chunks)
+                    chunkTable.push_back(static_cast<DWORD>(chunkData.size()));
+            }
+            Assert::IsTrue(SUCCEEDED(compressAPI->CloseCompressor(compressor)));
+            Assert::IsTrue(chunkData.size() < content.size(), L"Content was not compressed");
+
+            std::vector<BYTE> wofData(
+                reinterpret_cast<const BYTE*>(chunkTable.data()),
+                reinterpret_cast<const BYTE*>(chunkTable.data() + chunkTable.size()));
+            wofData.insert(end(wofData), begin(chunkData), end(chunkData));
+
+            auto compressedStream = std::make_shared<MemoryStream>();
+            Assert::IsTrue(SUCCEEDED(compressedStream->OpenForReadOnly(wofData.data(), wofData.size())));
+
+            UncompressWofStream wofStream;
+            Assert::IsTrue(SUCCEEDED(wofStream.Open(compressedStream, algorithm, content.size())));
+
+            const auto expanded = ReadAll(wofStream);
+            Assert::AreEqual(content.size(), expanded.size());
+            Assert::AreEqual(reference, Sha256(expanded.data(), expanded.size()), L"Unexpected Xpress content");
+
+            Assert::IsTrue(SUCCEEDED(wofStream.Close()));
+        }
+    }
 };
 }  // namespace Orc::Test
@@ -9,6 +9,9 @@
 #include "stdafx.h"
 
 #include "YaraScanner.h"
+#include "YaraScanService.h"
+
+#include "MemoryStream.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace Orc;
@@ -99,5 +102,191 @@ public:
             }
         }
     }
+
+    TEST_METHOD(StreamScan)
+    {
+        YaraScanner scanner;
+
+        Assert::IsTrue(SUCCEEDED(scanner.Initialize()));
+
+        auto yaraConfig = std::make_unique<YaraConfig>();
+        Assert::IsTrue(SUCCEEDED(yaraConfig->SetBlockSize(4096)));
+        Assert::IsTrue(SUCCEEDED(yaraConfig->SetOverlapSize(4096)));
+        Assert::IsTrue(SUCCEEDED(yaraConfig->SetScanMethod(L"stream")));
+        Assert::IsTrue(SUCCEEDED(scanner.Configure(yaraConfig)));
+
+        auto rules = R"(
+				rule across_blocks{
+					strings:
+						$text_string = "HelloWorld"
+					condition :
+						$text_string at 8187
+				}
+				rule first_block{
+					condition :
+						uint32be(0) == 0x4D5A9000
+				}
+				rule last_block{
+					condition :
+						uint8(39999) == 0x42
+				}
+				rule not_there{
+					strings:
+						$text_string = "GoodbyeWorld"
+					condition :
+						$text_string
+				}
+			)"s;
+
+        CBinaryBuffer ruleBuffer;
+        ruleBuffer.SetData((LPBYTE)rules.c_str(), rules.size());
+        Assert::IsTrue(SUCCEEDED(scanner.AddRules(ruleBuffer)));
+
+        // Ten 4KB blocks: the string crosses the boundary between the second and third ones
+        std::vector<BYTE> data(40000, 0);
+        const BYTE header[] = {0x4D, 0x5A, 0x90, 0x00};
+        std::copy(std::cbegin(header), std::cend(header), data.begin());
+        const auto text = "HelloWorld"s;
+        std::copy(text.cbegin(), text.cend(), data.begin() + 8187);
+        data.back() = 0x42;
+
+        auto stream = std::make_shared<MemoryStream>();
+        Assert::IsTrue(SUCCEEDED(stream->OpenForReadWrite()));
+        ULONGLONG ullWritten = 0LL;
+        Assert::IsTrue(SUCCEEDED(stream->Write(data.data(), data.size(), &ullWritten)));
+
+        auto [hr, matchingRules] = scanner.Scan(stream);
+        Assert::IsTrue(SUCCEEDED(hr));
+
+        std::sort(matchingRules.begin(), matchingRules.end());
+        Assert::IsTrue(matchingRules == MatchingRuleCollection {"across_blocks", "first_block", "last_block"});
+    }
+
+    TEST_METHOD(CompiledRules)
+    {
+        auto rules = R"(
+				rule hello{
+					strings:
+						$text_string = "HelloWorld"
+					condition :
+						$text_string
+				}
+			)"s;
+
+        auto strText = "This is a text with HelloWorld inside it"s;
+        CBinaryBuffer text;
+        text.SetData((LPBYTE)strText.c_str(), strText.size());
+
+        auto compiled = std::make_shared<MemoryStream>();
+        Assert::IsTrue(SUCCEEDED(compiled->OpenForReadWrite()));
+
+        {
+            YaraScanner scanner;
+            Assert::IsTrue(SUCCEEDED(scanner.Initialize()));
+
+            CBinaryBuffer ruleBuffer;
+            ruleBuffer.SetData((LPBYTE)rules.c_str(), rules.size());
+            Assert::IsFalse(YaraScanner::IsCompiledRules(ruleBuffer));
+            Assert::IsTrue(SUCCEEDED(scanner.AddRules(ruleBuffer)));
+
+            auto [hr, matchingRules] = scanner.Scan(text);
+            Assert::IsTrue(SUCCEEDED(hr));
+            Assert::IsTrue(matchingRules == MatchingRuleCollection {"hello"});
+
+            Assert::IsTrue(SUCCEEDED(scanner.SaveRules(compiled)));
+        }
+
+        // invalid sources fail when they are added, not when the first file is scanned
+        {
+            YaraScanner scanner;
+            Assert::IsTrue(SUCCEEDED(scanner.Initialize()));
+
+            auto invalid = "rule broken { condition: $undefined }"s;
+            CBinaryBuffer ruleBuffer;
+            ruleBuffer.SetData((LPBYTE)invalid.c_str(), invalid.size());
+            Assert::IsTrue(FAILED(scanner.AddRules(ruleBuffer)));
+        }
+
+        // precompiled rules are given as is, and cannot be mixed with sources
+        {
+            YaraScanner scanner;
+            Assert::IsTrue(SUCCEEDED(scanner.Initialize()));
+
+            CBinaryBuffer compiledBuffer = compiled->GetBuffer();
+            Assert::IsTrue(YaraScanner::IsCompiledRules(compiledBuffer));
+            Assert::IsTrue(SUCCEEDED(scanner.AddRules(compiledBuffer)));
+
+            CBinaryBuffer ruleBuffer;
+            ruleBuffer.SetData((LPBYTE)rules.c_str(), rules.size());
+            Assert::IsTrue(FAILED(scanner.AddRules(ruleBuffer)));
+
+            auto [hr, matchingRules] = scanner.Scan(text);
+            Assert::IsTrue(SUCCEEDED(hr));
+            Assert::IsTrue(matchingRules == MatchingRuleCollection {"hello"});
+        }
+    }
+
+    TEST_METHOD(ScanService)
+    {
+        YaraScanner scanner;
+
+        Assert::IsTrue(SUCCEEDED(scanner.Initialize()));
+
+        auto yaraConfig = std::make_unique<YaraConfig>();
+        Assert::IsTrue(SUCCEEDED(scanner.Configure(yaraConfig)));
+
+        auto rules = R"(
+				rule hello{
+					strings:
+						$text_string = "HelloWorld"
+					condition :
+						$text_string
+				}
+				rule goodbye{
+					strings:
+						$text_string = "GoodbyeWorld"
+					condition :
+						$text_string
+				}
+			)"s;
+
+        CBinaryBuffer ruleBuffer;
+        ruleBuffer.SetData((LPBYTE)rules.c_str(), rules.size());
+        Assert::IsTrue(SUCCEEDED(scanner.AddRules(ruleBuffer)));
+        scanner.DisableRule("goodbye");
+
+        const auto texts = {"HelloWorld"s, "GoodbyeWorld"s, "HelloWorld and GoodbyeWorld"s, "Nothing"s};
+
+        YaraScanService::Options options;
+        options.dwWorkers = 3;
+        YaraScanService service(scanner, options);
+        Assert::AreEqual(3UL, service.GetWorkers());
+
+        // each text is scanned many times, on whichever worker is free
+        std::vector<std::pair<std::string, std::shared_ptr<YaraScanJob>>> jobs;
+        for (int i = 0; i < 64; i++)
+        {
+            for (const auto& text : texts)
+            {
+                auto stream = std::make_shared<MemoryStream>();
+                Assert::IsTrue(SUCCEEDED(stream->OpenForReadWrite()));
+                ULONGLONG ullWritten = 0LL;
+                Assert::IsTrue(SUCCEEDED(stream->Write((const BYTE*)text.c_str(), text.size(), &ullWritten)));
+
+                jobs.emplace_back(text, service.Submit(stream));
+            }
+        }
+
+        for (const auto& [text, job] : jobs)
+        {
+            Assert::IsTrue(SUCCEEDED(job->Wait()));
+            if (text.find("HelloWorld") != std::string::npos)
+                Assert::IsTrue(job->MatchingRules() == MatchingRuleCollection {"hello"});
+            else
+                Assert::IsTrue(job->MatchingRules().empty(), L"disabled rules must not match");
+        }
+
+        Assert::AreEqual(256ULL, service.GetStatistics().ullJobs);
+    }
 };
 }  // namespace Orc::Test